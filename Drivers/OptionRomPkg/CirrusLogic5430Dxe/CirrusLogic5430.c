@@ -593,6 +593,16 @@ CirrusLogic5430UgaDrawDestructor (
   CIRRUS_LOGIC_5430_PRIVATE_DATA  *Private
   )
 {
+  if (Private->LineBuffer != NULL) {
+    FreePool (Private->LineBuffer);
+    Private->LineBuffer = NULL;
+  }
+
+  if (Private->ShadowBuffer != NULL) {
+    FreePool (Private->ShadowBuffer);
+    Private->ShadowBuffer = NULL;
+  }
+
   return EFI_SUCCESS;
 }
 
@@ -805,6 +815,58 @@ DrawLogo (
 {
 }
 
+/**
+  Allocate the line buffer and the shadow frame buffer of a video mode.
+
+  The shadow is a system memory copy of the visible frame buffer, so that
+  reads never have to touch video memory. It is zeroed, which matches the
+  screen cleared by InitializeGraphicsMode(). The buffers of the current
+  mode are only freed once the new ones are allocated, so that a failure
+  leaves the current mode usable.
+
+  @param  Private               Driver private data.
+  @param  HorizontalResolution  Width of the mode in pixels.
+  @param  VerticalResolution    Height of the mode in pixels.
+
+  @retval EFI_SUCCESS           The buffers were allocated.
+  @retval EFI_OUT_OF_RESOURCES  Not enough memory, the current buffers are kept.
+
+**/
+EFI_STATUS
+CirrusLogic5430AllocateModeBuffers (
+  CIRRUS_LOGIC_5430_PRIVATE_DATA  *Private,
+  UINTN                           HorizontalResolution,
+  UINTN                           VerticalResolution
+  )
+{
+  UINT8  *LineBuffer;
+  UINT8  *ShadowBuffer;
+
+  LineBuffer   = AllocatePool (HorizontalResolution);
+  ShadowBuffer = AllocateZeroPool (HorizontalResolution * VerticalResolution);
+  if (LineBuffer == NULL || ShadowBuffer == NULL) {
+    if (LineBuffer != NULL) {
+      FreePool (LineBuffer);
+    }
+    if (ShadowBuffer != NULL) {
+      FreePool (ShadowBuffer);
+    }
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  if (Private->LineBuffer != NULL) {
+    FreePool (Private->LineBuffer);
+  }
+  if (Private->ShadowBuffer != NULL) {
+    FreePool (Private->ShadowBuffer);
+  }
+
+  Private->LineBuffer   = LineBuffer;
+  Private->ShadowBuffer = ShadowBuffer;
+
+  return EFI_SUCCESS;
+}
+
 /**
   TODO: Add function description
 
@@ -96,6 +96,8 @@ typedef struct {
   UINTN                                 MaxMode;
   CIRRUS_LOGIC_5430_MODE_DATA           ModeData[CIRRUS_LOGIC_5430_MODE_COUNT];
   UINT8                                 *LineBuffer;
+  UINT8                                 *ShadowBuffer;
+  BOOLEAN                               SolidFillSupported;
   BOOLEAN                               HardwareNeedsStarting;
 } CIRRUS_LOGIC_5430_PRIVATE_DATA;
 
@@ -152,6 +154,32 @@ extern EFI_DRIVER_SUPPORTED_EFI_VERSION_PROTOCOL  gCirrusLogic5430DriverSupporte
 #define PALETTE_INDEX_REGISTER  0x3c8
 #define PALETTE_DATA_REGISTER   0x3c9
 
+//
+// BitBLT engine registers, accessed through GRAPH_ADDRESS_REGISTER
+//
+#define BLT_FOREGROUND_COLOR    0x01
+#define BLT_WIDTH_LOW           0x20
+#define BLT_HEIGHT_LOW          0x22
+#define BLT_DEST_PITCH_LOW      0x24
+#define BLT_SOURCE_PITCH_LOW    0x26
+#define BLT_DEST_START_LOW      0x28
+#define BLT_SOURCE_START_LOW    0x2c
+#define BLT_DEST_WRITE_MASK     0x2f
+#define BLT_MODE                0x30
+#define BLT_START_STATUS        0x31
+#define BLT_ROP                 0x32
+#define BLT_MODE_EXTENSIONS     0x33
+#define BLT_TRANSPARENT_COLOR   0x34
+#define BLT_TRANSPARENT_MASK    0x35
+
+#define BLT_MODE_BACKWARDS      BIT0
+#define BLT_MODE_PATTERN_COPY   BIT6
+#define BLT_MODE_COLOR_EXPAND   BIT7
+#define BLT_STATUS_BUSY         BIT0
+#define BLT_STATUS_START        BIT1
+#define BLT_ROP_SOURCE_COPY     0x0d
+#define BLT_MODE_EXT_SOLID_FILL BIT2
+
 //
 // UGA Draw Hardware abstraction internal worker functions
 //
@@ -398,6 +426,13 @@ DrawLogo (
   UINTN                           ScreenHeight
   );
 
+EFI_STATUS
+CirrusLogic5430AllocateModeBuffers (
+  CIRRUS_LOGIC_5430_PRIVATE_DATA  *Private,
+  UINTN                           HorizontalResolution,
+  UINTN                           VerticalResolution
+  );
+
 VOID
 outb (
   CIRRUS_LOGIC_5430_PRIVATE_DATA  *Private,
@@ -424,6 +459,18 @@ inw (
   UINTN                           Address
   );
 
+VOID
+CirrusLogic5430VideoToVideo (
+  CIRRUS_LOGIC_5430_PRIVATE_DATA  *Private,
+  UINTN                           ScreenWidth,
+  UINTN                           SourceX,
+  UINTN                           SourceY,
+  UINTN                           DestinationX,
+  UINTN                           DestinationY,
+  UINTN                           Width,
+  UINTN                           Height
+  );
+
 EFI_STATUS
 CirrusLogic5430VideoModeSetup (
   CIRRUS_LOGIC_5430_PRIVATE_DATA  *Private
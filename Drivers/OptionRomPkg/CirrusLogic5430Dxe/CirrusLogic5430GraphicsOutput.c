@@ -60,6 +60,159 @@ CirrusLogic5430CompleteModeData (
 }
 
 
+/**
+  Program the BitBLT engine for a video to video operation and wait for it
+  to complete.
+
+  Width and Height are in pixels (one byte per pixel in the supported
+  modes); the engine registers take them minus one. When Mode has
+  BLT_MODE_BACKWARDS set, the start offsets must address the last pixel of
+  the last line of each rectangle.
+
+  @param  Private       Pointer to the driver private data
+  @param  Mode          Value for the BLT mode register
+  @param  ModeExtension Value for the BLT mode extensions register
+  @param  DestOffset    Frame buffer offset of the destination start pixel
+  @param  SourceOffset  Frame buffer offset of the source start pixel
+  @param  Width         Width of the rectangle in pixels
+  @param  Height        Height of the rectangle in lines
+  @param  Pitch         Frame buffer line length in bytes
+
+**/
+STATIC
+VOID
+CirrusLogic5430BitBlt (
+  IN  CIRRUS_LOGIC_5430_PRIVATE_DATA  *Private,
+  IN  UINT8                           Mode,
+  IN  UINT8                           ModeExtension,
+  IN  UINTN                           DestOffset,
+  IN  UINTN                           SourceOffset,
+  IN  UINTN                           Width,
+  IN  UINTN                           Height,
+  IN  UINTN                           Pitch
+  )
+{
+  Width--;
+  Height--;
+
+  outw (Private, GRAPH_ADDRESS_REGISTER, (UINT16) (((Width << 8) & 0xff00) | BLT_WIDTH_LOW));
+  outw (Private, GRAPH_ADDRESS_REGISTER, (UINT16) ((Width & 0xff00) | (BLT_WIDTH_LOW + 1)));
+  outw (Private, GRAPH_ADDRESS_REGISTER, (UINT16) (((Height << 8) & 0xff00) | BLT_HEIGHT_LOW));
+  outw (Private, GRAPH_ADDRESS_REGISTER, (UINT16) ((Height & 0xff00) | (BLT_HEIGHT_LOW + 1)));
+  outw (Private, GRAPH_ADDRESS_REGISTER, (UINT16) (((Pitch << 8) & 0xff00) | BLT_DEST_PITCH_LOW));
+  outw (Private, GRAPH_ADDRESS_REGISTER, (UINT16) ((Pitch & 0xff00) | (BLT_DEST_PITCH_LOW + 1)));
+  outw (Private, GRAPH_ADDRESS_REGISTER, (UINT16) (((Pitch << 8) & 0xff00) | BLT_SOURCE_PITCH_LOW));
+  outw (Private, GRAPH_ADDRESS_REGISTER, (UINT16) ((Pitch & 0xff00) | (BLT_SOURCE_PITCH_LOW + 1)));
+  outw (Private, GRAPH_ADDRESS_REGISTER, (UINT16) (((DestOffset << 8) & 0xff00) | BLT_DEST_START_LOW));
+  outw (Private, GRAPH_ADDRESS_REGISTER, (UINT16) (((DestOffset >> 0) & 0xff00) | (BLT_DEST_START_LOW + 1)));
+  outw (Private, GRAPH_ADDRESS_REGISTER, (UINT16) (((DestOffset >> 8) & 0xff00) | (BLT_DEST_START_LOW + 2)));
+  outw (Private, GRAPH_ADDRESS_REGISTER, (UINT16) (((SourceOffset << 8) & 0xff00) | BLT_SOURCE_START_LOW));
+  outw (Private, GRAPH_ADDRESS_REGISTER, (UINT16) (((SourceOffset >> 0) & 0xff00) | (BLT_SOURCE_START_LOW + 1)));
+  outw (Private, GRAPH_ADDRESS_REGISTER, (UINT16) (((SourceOffset >> 8) & 0xff00) | (BLT_SOURCE_START_LOW + 2)));
+  outw (Private, GRAPH_ADDRESS_REGISTER, BLT_DEST_WRITE_MASK);
+  outw (Private, GRAPH_ADDRESS_REGISTER, (UINT16) ((Mode << 8) | BLT_MODE));
+  outw (Private, GRAPH_ADDRESS_REGISTER, (UINT16) ((BLT_ROP_SOURCE_COPY << 8) | BLT_ROP));
+  outw (Private, GRAPH_ADDRESS_REGISTER, (UINT16) ((ModeExtension << 8) | BLT_MODE_EXTENSIONS));
+  outw (Private, GRAPH_ADDRESS_REGISTER, BLT_TRANSPARENT_COLOR);
+  outw (Private, GRAPH_ADDRESS_REGISTER, BLT_TRANSPARENT_MASK);
+
+  outw (Private, GRAPH_ADDRESS_REGISTER, (UINT16) ((BLT_STATUS_START << 8) | BLT_START_STATUS));
+
+  outb (Private, GRAPH_ADDRESS_REGISTER, BLT_START_STATUS);
+  while ((inb (Private, GRAPH_DATA_REGISTER) & BLT_STATUS_BUSY) == BLT_STATUS_BUSY)
+    ;
+}
+
+
+/**
+  Copy a rectangle of video memory with the BitBLT engine and replay the
+  copy on the shadow frame buffer.
+
+  Both rectangles must lie within the current mode; they may overlap.
+
+  @param  Private       Pointer to the driver private data
+  @param  ScreenWidth   Horizontal resolution of the current mode
+  @param  SourceX       X coordinate of the source rectangle
+  @param  SourceY       Y coordinate of the source rectangle
+  @param  DestinationX  X coordinate of the destination rectangle
+  @param  DestinationY  Y coordinate of the destination rectangle
+  @param  Width         Width of the rectangle in pixels
+  @param  Height        Height of the rectangle in lines
+
+**/
+VOID
+CirrusLogic5430VideoToVideo (
+  IN  CIRRUS_LOGIC_5430_PRIVATE_DATA  *Private,
+  IN  UINTN                           ScreenWidth,
+  IN  UINTN                           SourceX,
+  IN  UINTN                           SourceY,
+  IN  UINTN                           DestinationX,
+  IN  UINTN                           DestinationY,
+  IN  UINTN                           Width,
+  IN  UINTN                           Height
+  )
+{
+  UINTN  Offset;
+  UINTN  SourceOffset;
+  UINTN  Line;
+  UINT8  BltMode;
+  INTN   LineStride;
+  UINT8  *Shadow;
+  UINT8  *ShadowSource;
+
+  SourceOffset = (SourceY * ScreenWidth) + SourceX;
+  Offset       = (DestinationY * ScreenWidth) + DestinationX;
+
+  //
+  // Copy backwards when the destination follows an overlapping source,
+  // in which case the engine takes the address of the last pixel.
+  //
+  BltMode    = 0;
+  LineStride = (INTN) ScreenWidth;
+  if (Offset > SourceOffset) {
+    BltMode    = BLT_MODE_BACKWARDS;
+    LineStride = -LineStride;
+  }
+
+  if (BltMode == BLT_MODE_BACKWARDS) {
+    CirrusLogic5430BitBlt (
+      Private,
+      BltMode,
+      0,
+      Offset + (Height - 1) * ScreenWidth + Width - 1,
+      SourceOffset + (Height - 1) * ScreenWidth + Width - 1,
+      Width,
+      Height,
+      ScreenWidth
+      );
+    Offset       += (Height - 1) * ScreenWidth;
+    SourceOffset += (Height - 1) * ScreenWidth;
+  } else {
+    CirrusLogic5430BitBlt (
+      Private,
+      BltMode,
+      0,
+      Offset,
+      SourceOffset,
+      Width,
+      Height,
+      ScreenWidth
+      );
+  }
+
+  //
+  // Replay the copy on the shadow in the same line order
+  //
+  Shadow       = Private->ShadowBuffer + Offset;
+  ShadowSource = Private->ShadowBuffer + SourceOffset;
+  for (Line = 0; Line < Height; Line++) {
+    CopyMem (Shadow, ShadowSource, Width);
+    Shadow       += LineStride;
+    ShadowSource += LineStride;
+  }
+}
+
+
 //
 // Graphics Output Protocol Member Functions
 //
@@ -143,6 +296,7 @@ Routine Description:
 {
   CIRRUS_LOGIC_5430_PRIVATE_DATA    *Private;
   CIRRUS_LOGIC_5430_MODE_DATA       *ModeData;
+  EFI_STATUS                        Status;
 
   Private = CIRRUS_LOGIC_5430_PRIVATE_DATA_FROM_GRAPHICS_OUTPUT_THIS (This);
 
@@ -152,14 +306,13 @@ Routine Description:
 
   ModeData = &Private->ModeData[ModeNumber];
 
-  if (Private->LineBuffer) {
-    gBS->FreePool (Private->LineBuffer);
-  }
-
-  Private->LineBuffer = NULL;
-  Private->LineBuffer = AllocatePool (ModeData->HorizontalResolution);
-  if (Private->LineBuffer == NULL) {
-    return EFI_OUT_OF_RESOURCES;
+  Status = CirrusLogic5430AllocateModeBuffers (
+             Private,
+             ModeData->HorizontalResolution,
+             ModeData->VerticalResolution
+             );
+  if (EFI_ERROR (Status)) {
+    return Status;
   }
 
   InitializeGraphicsMode (Private, &CirrusLogic5430VideoModes[ModeData->ModeNumber]);
@@ -229,8 +382,8 @@ Returns:
   UINT32                          WidePixel;
   UINTN                           ScreenWidth;
   UINTN                           Offset;
-  UINTN                           SourceOffset;
   UINT32                          CurrentMode;
+  UINT8                           *Shadow;
 
   Private = CIRRUS_LOGIC_5430_PRIVATE_DATA_FROM_GRAPHICS_OUTPUT_THIS (This);
 
@@ -284,6 +437,19 @@ Returns:
     if (DestinationX + Width > Private->ModeData[CurrentMode].HorizontalResolution) {
       return EFI_INVALID_PARAMETER;
     }
+
+    //
+    // Video to Video also reads the source rectangle from the shadow buffer
+    //
+    if (BltOperation == EfiBltVideoToVideo) {
+      if (SourceY + Height > Private->ModeData[CurrentMode].VerticalResolution) {
+        return EFI_INVALID_PARAMETER;
+      }
+
+      if (SourceX + Width > Private->ModeData[CurrentMode].HorizontalResolution) {
+        return EFI_INVALID_PARAMETER;
+      }
+    }
   }
   //
   // We have to raise to TPL Notify, so we make an atomic write the frame buffer.
@@ -299,81 +465,33 @@ Returns:
     //
     for (SrcY = SourceY, DstY = DestinationY; DstY < (Height + DestinationY); SrcY++, DstY++) {
 
+      //
+      // Read from the shadow copy rather than from video memory
+      //
       Offset = (SrcY * Private->ModeData[CurrentMode].HorizontalResolution) + SourceX;
-      if (((Offset & 0x03) == 0) && ((Width & 0x03) == 0)) {
-        Private->PciIo->Mem.Read (
-                              Private->PciIo,
-                              EfiPciIoWidthUint32,
-                              0,
-                              Offset,
-                              Width >> 2,
-                              Private->LineBuffer
-                              );
-      } else {
-        Private->PciIo->Mem.Read (
-                              Private->PciIo,
-                              EfiPciIoWidthUint8,
-                              0,
-                              Offset,
-                              Width,
-                              Private->LineBuffer
-                              );
-      }
+      Shadow = Private->ShadowBuffer + Offset;
 
       for (X = 0; X < Width; X++) {
         Blt         = (EFI_GRAPHICS_OUTPUT_BLT_PIXEL *) ((UINT8 *) BltBuffer + (DstY * Delta) + (DestinationX + X) * sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL));
 
-        Blt->Red    = PIXEL_TO_RED_BYTE (Private->LineBuffer[X]);
-        Blt->Green  = PIXEL_TO_GREEN_BYTE (Private->LineBuffer[X]);
-        Blt->Blue   = PIXEL_TO_BLUE_BYTE (Private->LineBuffer[X]);
+        Blt->Red    = PIXEL_TO_RED_BYTE (Shadow[X]);
+        Blt->Green  = PIXEL_TO_GREEN_BYTE (Shadow[X]);
+        Blt->Blue   = PIXEL_TO_BLUE_BYTE (Shadow[X]);
       }
     }
     break;
 
   case EfiBltVideoToVideo:
-    //
-    // Perform hardware acceleration for Video to Video operations
-    //
-    ScreenWidth   = Private->ModeData[CurrentMode].HorizontalResolution;
-    SourceOffset  = (SourceY * Private->ModeData[CurrentMode].HorizontalResolution) + (SourceX);
-    Offset        = (DestinationY * Private->ModeData[CurrentMode].HorizontalResolution) + (DestinationX);
-
-    outw (Private, GRAPH_ADDRESS_REGISTER, 0x0000);
-    outw (Private, GRAPH_ADDRESS_REGISTER, 0x0010);
-    outw (Private, GRAPH_ADDRESS_REGISTER, 0x0012);
-    outw (Private, GRAPH_ADDRESS_REGISTER, 0x0014);
-
-    outw (Private, GRAPH_ADDRESS_REGISTER, 0x0001);
-    outw (Private, GRAPH_ADDRESS_REGISTER, 0x0011);
-    outw (Private, GRAPH_ADDRESS_REGISTER, 0x0013);
-    outw (Private, GRAPH_ADDRESS_REGISTER, 0x0015);
-
-    outw (Private, GRAPH_ADDRESS_REGISTER, (UINT16) (((Width << 8) & 0xff00) | 0x20));
-    outw (Private, GRAPH_ADDRESS_REGISTER, (UINT16) ((Width & 0xff00) | 0x21));
-    outw (Private, GRAPH_ADDRESS_REGISTER, (UINT16) (((Height << 8) & 0xff00) | 0x22));
-    outw (Private, GRAPH_ADDRESS_REGISTER, (UINT16) ((Height & 0xff00) | 0x23));
-    outw (Private, GRAPH_ADDRESS_REGISTER, (UINT16) (((ScreenWidth << 8) & 0xff00) | 0x24));
-    outw (Private, GRAPH_ADDRESS_REGISTER, (UINT16) ((ScreenWidth & 0xff00) | 0x25));
-    outw (Private, GRAPH_ADDRESS_REGISTER, (UINT16) (((ScreenWidth << 8) & 0xff00) | 0x26));
-    outw (Private, GRAPH_ADDRESS_REGISTER, (UINT16) ((ScreenWidth & 0xff00) | 0x27));
-    outw (Private, GRAPH_ADDRESS_REGISTER, (UINT16) ((((Offset) << 8) & 0xff00) | 0x28));
-    outw (Private, GRAPH_ADDRESS_REGISTER, (UINT16) ((((Offset) >> 0) & 0xff00) | 0x29));
-    outw (Private, GRAPH_ADDRESS_REGISTER, (UINT16) ((((Offset) >> 8) & 0xff00) | 0x2a));
-    outw (Private, GRAPH_ADDRESS_REGISTER, (UINT16) ((((SourceOffset) << 8) & 0xff00) | 0x2c));
-    outw (Private, GRAPH_ADDRESS_REGISTER, (UINT16) ((((SourceOffset) >> 0) & 0xff00) | 0x2d));
-    outw (Private, GRAPH_ADDRESS_REGISTER, (UINT16) ((((SourceOffset) >> 8) & 0xff00) | 0x2e));
-    outw (Private, GRAPH_ADDRESS_REGISTER, 0x002f);
-    outw (Private, GRAPH_ADDRESS_REGISTER, 0x0030);
-    outw (Private, GRAPH_ADDRESS_REGISTER, 0x0d32);
-    outw (Private, GRAPH_ADDRESS_REGISTER, 0x0033);
-    outw (Private, GRAPH_ADDRESS_REGISTER, 0x0034);
-    outw (Private, GRAPH_ADDRESS_REGISTER, 0x0035);
-
-    outw (Private, GRAPH_ADDRESS_REGISTER, 0x0231);
-
-    outb (Private, GRAPH_ADDRESS_REGISTER, 0x31);
-    while ((inb (Private, GRAPH_DATA_REGISTER) & 0x01) == 0x01)
-      ;
+    CirrusLogic5430VideoToVideo (
+      Private,
+      Private->ModeData[CurrentMode].HorizontalResolution,
+      SourceX,
+      SourceY,
+      DestinationX,
+      DestinationY,
+      Width,
+      Height
+      );
     break;
 
   case EfiBltVideoFill:
@@ -382,7 +500,28 @@ Returns:
     WidePixel = (Pixel << 8) | Pixel;
     WidePixel = (WidePixel << 16) | WidePixel;
 
-    if (DestinationX == 0 && Width == Private->ModeData[CurrentMode].HorizontalResolution) {
+    ScreenWidth = Private->ModeData[CurrentMode].HorizontalResolution;
+    for (DstY = DestinationY; DstY < (Height + DestinationY); DstY++) {
+      SetMem (Private->ShadowBuffer + (DstY * ScreenWidth) + DestinationX, Width, Pixel);
+    }
+
+    if (Private->SolidFillSupported) {
+      //
+      // Let the engine expand the foreground color over the rectangle
+      //
+      outw (Private, GRAPH_ADDRESS_REGISTER, (UINT16) ((Pixel << 8) | BLT_FOREGROUND_COLOR));
+      CirrusLogic5430BitBlt (
+        Private,
+        BLT_MODE_COLOR_EXPAND | BLT_MODE_PATTERN_COPY,
+        BLT_MODE_EXT_SOLID_FILL,
+        (DestinationY * ScreenWidth) + DestinationX,
+        0,
+        Width,
+        Height,
+        ScreenWidth
+        );
+      outw (Private, GRAPH_ADDRESS_REGISTER, BLT_FOREGROUND_COLOR);
+    } else if (DestinationX == 0 && Width == ScreenWidth) {
       Offset = DestinationY * Private->ModeData[CurrentMode].HorizontalResolution;
       if (((Offset & 0x03) == 0) && (((Width * Height) & 0x03) == 0)) {
         Private->PciIo->Mem.Write (
@@ -444,6 +583,7 @@ Returns:
       }
 
       Offset = (DstY * Private->ModeData[CurrentMode].HorizontalResolution) + DestinationX;
+      CopyMem (Private->ShadowBuffer + Offset, Private->LineBuffer, Width);
 
       if (((Offset & 0x03) == 0) && ((Width & 0x03) == 0)) {
         Private->PciIo->Mem.Write (
@@ -482,6 +622,7 @@ CirrusLogic5430GraphicsOutputConstructor (
 {
   EFI_STATUS                   Status;
   EFI_GRAPHICS_OUTPUT_PROTOCOL *GraphicsOutput;
+  UINT16                       DeviceId;
 
 
   GraphicsOutput            = &Private->GraphicsOutput;
@@ -512,6 +653,21 @@ CirrusLogic5430GraphicsOutputConstructor (
   Private->GraphicsOutput.Mode->Mode    = GRAPHICS_OUTPUT_INVALIDE_MODE_NUMBER;
   Private->HardwareNeedsStarting        = TRUE;
   Private->LineBuffer                   = NULL;
+  Private->ShadowBuffer                 = NULL;
+
+  //
+  // The solid fill BitBLT extension first appeared in the GD5436, so only
+  // the 5446 can fill rectangles without a pattern in video memory.
+  //
+  Status = Private->PciIo->Pci.Read (
+                                 Private->PciIo,
+                                 EfiPciIoWidthUint16,
+                                 PCI_DEVICE_ID_OFFSET,
+                                 1,
+                                 &DeviceId
+                                 );
+  Private->SolidFillSupported = (BOOLEAN) (!EFI_ERROR (Status) &&
+                                           DeviceId == CIRRUS_LOGIC_5446_DEVICE_ID);
 
   //
   // Initialize the hardware
@@ -550,6 +706,11 @@ Returns:
     gBS->FreePool (Private->GraphicsOutput.Mode);
   }
 
+  if (Private->ShadowBuffer != NULL) {
+    FreePool (Private->ShadowBuffer);
+    Private->ShadowBuffer = NULL;
+  }
+
   return EFI_SUCCESS;
 }
 
@@ -58,6 +58,7 @@ CirrusLogic5430UgaDrawSetMode (
 {
   CIRRUS_LOGIC_5430_PRIVATE_DATA  *Private;
   UINTN                           Index;
+  EFI_STATUS                      Status;
 
   Private = CIRRUS_LOGIC_5430_PRIVATE_DATA_FROM_UGA_DRAW_THIS (This);
 
@@ -79,14 +80,13 @@ CirrusLogic5430UgaDrawSetMode (
       continue;
     }
 
-    if (Private->LineBuffer) {
-      gBS->FreePool (Private->LineBuffer);
-    }
-
-    Private->LineBuffer = NULL;
-    Private->LineBuffer = AllocatePool (HorizontalResolution);
-    if (Private->LineBuffer == NULL) {
-      return EFI_OUT_OF_RESOURCES;
+    Status = CirrusLogic5430AllocateModeBuffers (
+               Private,
+               HorizontalResolution,
+               VerticalResolution
+               );
+    if (EFI_ERROR (Status)) {
+      return Status;
     }
 
     InitializeGraphicsMode (Private, &CirrusLogic5430VideoModes[Private->ModeData[Index].ModeNumber]);
@@ -126,7 +126,7 @@ CirrusLogic5430UgaDrawBlt (
   UINT32                          WidePixel;
   UINTN                           ScreenWidth;
   UINTN                           Offset;
-  UINTN                           SourceOffset;
+  UINT8                           *Shadow;
 
   Private = CIRRUS_LOGIC_5430_PRIVATE_DATA_FROM_UGA_DRAW_THIS (This);
 
@@ -179,6 +179,19 @@ CirrusLogic5430UgaDrawBlt (
     if (DestinationX + Width > Private->ModeData[Private->CurrentMode].HorizontalResolution) {
       return EFI_INVALID_PARAMETER;
     }
+
+    //
+    // Video to Video also reads the source rectangle from the shadow buffer
+    //
+    if (BltOperation == EfiUgaVideoToVideo) {
+      if (SourceY + Height > Private->ModeData[Private->CurrentMode].VerticalResolution) {
+        return EFI_INVALID_PARAMETER;
+      }
+
+      if (SourceX + Width > Private->ModeData[Private->CurrentMode].HorizontalResolution) {
+        return EFI_INVALID_PARAMETER;
+      }
+    }
   }
   //
   // We have to raise to TPL Notify, so we make an atomic write the frame buffer.
@@ -194,81 +207,33 @@ CirrusLogic5430UgaDrawBlt (
     //
     for (SrcY = SourceY, DstY = DestinationY; DstY < (Height + DestinationY); SrcY++, DstY++) {
 
+      //
+      // Read from the shadow copy rather than from video memory
+      //
       Offset = (SrcY * Private->ModeData[Private->CurrentMode].HorizontalResolution) + SourceX;
-      if (((Offset & 0x03) == 0) && ((Width & 0x03) == 0)) {
-        Private->PciIo->Mem.Read (
-                              Private->PciIo,
-                              EfiPciIoWidthUint32,
-                              0,
-                              Offset,
-                              Width >> 2,
-                              Private->LineBuffer
-                              );
-      } else {
-        Private->PciIo->Mem.Read (
-                              Private->PciIo,
-                              EfiPciIoWidthUint8,
-                              0,
-                              Offset,
-                              Width,
-                              Private->LineBuffer
-                              );
-      }
+      Shadow = Private->ShadowBuffer + Offset;
 
       for (X = 0; X < Width; X++) {
         Blt         = (EFI_UGA_PIXEL *) ((UINT8 *) BltBuffer + (DstY * Delta) + (DestinationX + X) * sizeof (EFI_UGA_PIXEL));
 
-        Blt->Red    = (UINT8) (Private->LineBuffer[X] & 0xe0);
-        Blt->Green  = (UINT8) ((Private->LineBuffer[X] & 0x1c) << 3);
-        Blt->Blue   = (UINT8) ((Private->LineBuffer[X] & 0x03) << 6);
+        Blt->Red    = (UINT8) (Shadow[X] & 0xe0);
+        Blt->Green  = (UINT8) ((Shadow[X] & 0x1c) << 3);
+        Blt->Blue   = (UINT8) ((Shadow[X] & 0x03) << 6);
       }
     }
     break;
 
   case EfiUgaVideoToVideo:
-    //
-    // Perform hardware acceleration for Video to Video operations
-    //
-    ScreenWidth   = Private->ModeData[Private->CurrentMode].HorizontalResolution;
-    SourceOffset  = (SourceY * Private->ModeData[Private->CurrentMode].HorizontalResolution) + (SourceX);
-    Offset        = (DestinationY * Private->ModeData[Private->CurrentMode].HorizontalResolution) + (DestinationX);
-
-    outw (Private, GRAPH_ADDRESS_REGISTER, 0x0000);
-    outw (Private, GRAPH_ADDRESS_REGISTER, 0x0010);
-    outw (Private, GRAPH_ADDRESS_REGISTER, 0x0012);
-    outw (Private, GRAPH_ADDRESS_REGISTER, 0x0014);
-
-    outw (Private, GRAPH_ADDRESS_REGISTER, 0x0001);
-    outw (Private, GRAPH_ADDRESS_REGISTER, 0x0011);
-    outw (Private, GRAPH_ADDRESS_REGISTER, 0x0013);
-    outw (Private, GRAPH_ADDRESS_REGISTER, 0x0015);
-
-    outw (Private, GRAPH_ADDRESS_REGISTER, (UINT16) (((Width << 8) & 0xff00) | 0x20));
-    outw (Private, GRAPH_ADDRESS_REGISTER, (UINT16) ((Width & 0xff00) | 0x21));
-    outw (Private, GRAPH_ADDRESS_REGISTER, (UINT16) (((Height << 8) & 0xff00) | 0x22));
-    outw (Private, GRAPH_ADDRESS_REGISTER, (UINT16) ((Height & 0xff00) | 0x23));
-    outw (Private, GRAPH_ADDRESS_REGISTER, (UINT16) (((ScreenWidth << 8) & 0xff00) | 0x24));
-    outw (Private, GRAPH_ADDRESS_REGISTER, (UINT16) ((ScreenWidth & 0xff00) | 0x25));
-    outw (Private, GRAPH_ADDRESS_REGISTER, (UINT16) (((ScreenWidth << 8) & 0xff00) | 0x26));
-    outw (Private, GRAPH_ADDRESS_REGISTER, (UINT16) ((ScreenWidth & 0xff00) | 0x27));
-    outw (Private, GRAPH_ADDRESS_REGISTER, (UINT16) ((((Offset) << 8) & 0xff00) | 0x28));
-    outw (Private, GRAPH_ADDRESS_REGISTER, (UINT16) ((((Offset) >> 0) & 0xff00) | 0x29));
-    outw (Private, GRAPH_ADDRESS_REGISTER, (UINT16) ((((Offset) >> 8) & 0xff00) | 0x2a));
-    outw (Private, GRAPH_ADDRESS_REGISTER, (UINT16) ((((SourceOffset) << 8) & 0xff00) | 0x2c));
-    outw (Private, GRAPH_ADDRESS_REGISTER, (UINT16) ((((SourceOffset) >> 0) & 0xff00) | 0x2d));
-    outw (Private, GRAPH_ADDRESS_REGISTER, (UINT16) ((((SourceOffset) >> 8) & 0xff00) | 0x2e));
-    outw (Private, GRAPH_ADDRESS_REGISTER, 0x002f);
-    outw (Private, GRAPH_ADDRESS_REGISTER, 0x0030);
-    outw (Private, GRAPH_ADDRESS_REGISTER, 0x0d32);
-    outw (Private, GRAPH_ADDRESS_REGISTER, 0x0033);
-    outw (Private, GRAPH_ADDRESS_REGISTER, 0x0034);
-    outw (Private, GRAPH_ADDRESS_REGISTER, 0x0035);
-
-    outw (Private, GRAPH_ADDRESS_REGISTER, 0x0231);
-
-    outb (Private, GRAPH_ADDRESS_REGISTER, 0x31);
-    while ((inb (Private, GRAPH_DATA_REGISTER) & 0x01) == 0x01)
-      ;
+    CirrusLogic5430VideoToVideo (
+      Private,
+      Private->ModeData[Private->CurrentMode].HorizontalResolution,
+      SourceX,
+      SourceY,
+      DestinationX,
+      DestinationY,
+      Width,
+      Height
+      );
     break;
 
   case EfiUgaVideoFill:
@@ -277,6 +242,11 @@ CirrusLogic5430UgaDrawBlt (
     WidePixel = (Pixel << 8) | Pixel;
     WidePixel = (WidePixel << 16) | WidePixel;
 
+    ScreenWidth = Private->ModeData[Private->CurrentMode].HorizontalResolution;
+    for (DstY = DestinationY; DstY < (Height + DestinationY); DstY++) {
+      SetMem (Private->ShadowBuffer + (DstY * ScreenWidth) + DestinationX, Width, Pixel);
+    }
+
     if (DestinationX == 0 && Width == Private->ModeData[Private->CurrentMode].HorizontalResolution) {
       Offset = DestinationY * Private->ModeData[Private->CurrentMode].HorizontalResolution;
       if (((Offset & 0x03) == 0) && (((Width * Height) & 0x03) == 0)) {
@@ -333,6 +303,7 @@ CirrusLogic5430UgaDrawBlt (
       }
 
       Offset = (DstY * Private->ModeData[Private->CurrentMode].HorizontalResolution) + DestinationX;
+      CopyMem (Private->ShadowBuffer + Offset, Private->LineBuffer, Width);
 
       if (((Offset & 0x03) == 0) && ((Width & 0x03) == 0)) {
         Private->PciIo->Mem.Write (
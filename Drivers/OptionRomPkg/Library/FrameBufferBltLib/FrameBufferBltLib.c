@@ -20,6 +20,17 @@
 
 #define MAX_LINE_BUFFER_SIZE (SIZE_4KB * sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL))
 
+//
+// Pixel conversions that have a specialized line converter. Anything
+// else goes through the generic mPixelShl/mPixelShr bit-mask conversion.
+//
+typedef enum {
+  BltLibConvertGeneric,
+  BltLibConvertBgrx8888,
+  BltLibConvertRgbx8888,
+  BltLibConvertRgb565
+} BLT_LIB_PIXEL_CONVERSION;
+
 UINTN                           mBltLibColorDepth;
 UINTN                           mBltLibWidthInBytes;
 UINTN                           mBltLibBytesPerPixel;
@@ -31,6 +42,7 @@ EFI_GRAPHICS_PIXEL_FORMAT       mPixelFormat;
 EFI_PIXEL_BITMASK               mPixelBitMasks;
 INTN                            mPixelShl[4]; // R-G-B-Rsvd
 INTN                            mPixelShr[4]; // R-G-B-Rsvd
+BLT_LIB_PIXEL_CONVERSION        mPixelConversion;
 
 
 VOID
@@ -65,6 +77,163 @@ ConfigurePixelBitMaskFormat (
   DEBUG ((EFI_D_INFO, "Bytes per pixel: %d\n", mBltLibBytesPerPixel));
 
   CopyMem (&mPixelBitMasks, BitMask, sizeof (*BitMask));
+
+  //
+  // Pick a specialized line converter for the common layouts. The
+  // reserved mask is ignored, matching the generic conversion.
+  //
+  mPixelConversion = BltLibConvertGeneric;
+  if ((mBltLibBytesPerPixel == 4) &&
+      (BitMask->RedMask == 0x00ff0000) &&
+      (BitMask->GreenMask == 0x0000ff00) &&
+      (BitMask->BlueMask == 0x000000ff)) {
+    mPixelConversion = BltLibConvertBgrx8888;
+  } else if ((mBltLibBytesPerPixel == 4) &&
+             (BitMask->RedMask == 0x000000ff) &&
+             (BitMask->GreenMask == 0x0000ff00) &&
+             (BitMask->BlueMask == 0x00ff0000)) {
+    mPixelConversion = BltLibConvertRgbx8888;
+  } else if ((mBltLibBytesPerPixel == 2) &&
+             (BitMask->RedMask == 0xf800) &&
+             (BitMask->GreenMask == 0x07e0) &&
+             (BitMask->BlueMask == 0x001f)) {
+    mPixelConversion = BltLibConvertRgb565;
+  }
+
+  DEBUG ((EFI_D_INFO, "Pixel conversion: %d\n", mPixelConversion));
+}
+
+
+/**
+  Convert one line of EFI_GRAPHICS_OUTPUT_BLT_PIXEL data into the frame
+  buffer pixel format.
+
+  The common layouts are converted with fixed shifts and masks; other bit
+  masks fall back to the generic mPixelShl/mPixelShr conversion.
+
+  @param[out] Destination  Buffer receiving Width pixels in frame buffer format
+  @param[in]  Source       Width BLT pixels to convert
+  @param[in]  Width        Number of pixels to convert
+
+**/
+STATIC
+VOID
+ConvertBltLineToVideo (
+  OUT UINT8                                 *Destination,
+  IN  EFI_GRAPHICS_OUTPUT_BLT_PIXEL         *Source,
+  IN  UINTN                                 Width
+  )
+{
+  UINTN                           X;
+  UINT32                          Uint32;
+  UINT32                          *Src;
+  UINT32                          *Dst32;
+  UINT16                          *Dst16;
+
+  Src = (UINT32 *) Source;
+
+  switch (mPixelConversion) {
+  case BltLibConvertBgrx8888:
+    CopyMem (Destination, Source, Width * sizeof (UINT32));
+    break;
+
+  case BltLibConvertRgbx8888:
+    Dst32 = (UINT32 *) Destination;
+    for (X = 0; X < Width; X++) {
+      Uint32 = Src[X];
+      Dst32[X] = (Uint32 & 0x0000ff00) |
+                 ((Uint32 >> 16) & 0x000000ff) |
+                 ((Uint32 << 16) & 0x00ff0000);
+    }
+    break;
+
+  case BltLibConvertRgb565:
+    Dst16 = (UINT16 *) Destination;
+    for (X = 0; X < Width; X++) {
+      Uint32 = Src[X];
+      Dst16[X] = (UINT16) (((Uint32 >> 8) & 0xf800) |
+                           ((Uint32 >> 5) & 0x07e0) |
+                           ((Uint32 >> 3) & 0x001f));
+    }
+    break;
+
+  default:
+    for (X = 0; X < Width; X++) {
+      Uint32 = Src[X];
+      *(UINT32*) (Destination + (X * mBltLibBytesPerPixel)) =
+        (UINT32) (
+            (((Uint32 << mPixelShl[0]) >> mPixelShr[0]) & mPixelBitMasks.RedMask) |
+            (((Uint32 << mPixelShl[1]) >> mPixelShr[1]) & mPixelBitMasks.GreenMask) |
+            (((Uint32 << mPixelShl[2]) >> mPixelShr[2]) & mPixelBitMasks.BlueMask)
+          );
+    }
+    break;
+  }
+}
+
+
+/**
+  Convert one line of frame buffer pixels into EFI_GRAPHICS_OUTPUT_BLT_PIXEL
+  data.
+
+  @param[out] Destination  Width BLT pixels receiving the converted data
+  @param[in]  Source       Buffer holding Width pixels in frame buffer format
+  @param[in]  Width        Number of pixels to convert
+
+**/
+STATIC
+VOID
+ConvertVideoLineToBlt (
+  OUT EFI_GRAPHICS_OUTPUT_BLT_PIXEL         *Destination,
+  IN  UINT8                                 *Source,
+  IN  UINTN                                 Width
+  )
+{
+  UINTN                           X;
+  UINT32                          Uint32;
+  UINT32                          *Dst;
+  UINT32                          *Src32;
+  UINT16                          *Src16;
+
+  Dst = (UINT32 *) Destination;
+
+  switch (mPixelConversion) {
+  case BltLibConvertBgrx8888:
+    CopyMem (Destination, Source, Width * sizeof (UINT32));
+    break;
+
+  case BltLibConvertRgbx8888:
+    Src32 = (UINT32 *) Source;
+    for (X = 0; X < Width; X++) {
+      Uint32 = Src32[X];
+      Dst[X] = (Uint32 & 0x0000ff00) |
+               ((Uint32 >> 16) & 0x000000ff) |
+               ((Uint32 << 16) & 0x00ff0000);
+    }
+    break;
+
+  case BltLibConvertRgb565:
+    Src16 = (UINT16 *) Source;
+    for (X = 0; X < Width; X++) {
+      Uint32 = Src16[X];
+      Dst[X] = ((Uint32 & 0xf800) << 8) |
+               ((Uint32 & 0x07e0) << 5) |
+               ((Uint32 & 0x001f) << 3);
+    }
+    break;
+
+  default:
+    for (X = 0; X < Width; X++) {
+      Uint32 = *(UINT32*) (Source + (X * mBltLibBytesPerPixel));
+      Dst[X] =
+        (UINT32) (
+            (((Uint32 & mPixelBitMasks.RedMask)   >> mPixelShl[0]) << mPixelShr[0]) |
+            (((Uint32 & mPixelBitMasks.GreenMask) >> mPixelShl[1]) << mPixelShr[1]) |
+            (((Uint32 & mPixelBitMasks.BlueMask)  >> mPixelShl[2]) << mPixelShr[2])
+          );
+    }
+    break;
+  }
 }
 
 
@@ -421,11 +590,8 @@ BltLibVideoToBltBufferEx (
 {
   UINTN                           DstY;
   UINTN                           SrcY;
-  EFI_GRAPHICS_OUTPUT_BLT_PIXEL   *Blt;
   VOID                            *BltMemSrc;
-  VOID                            *BltMemDst;
-  UINTN                           X;
-  UINT32                          Uint32;
+  EFI_GRAPHICS_OUTPUT_BLT_PIXEL   *BltMemDst;
   UINTN                           Offset;
   UINTN                           WidthInBytes;
 
@@ -464,30 +630,22 @@ BltLibVideoToBltBufferEx (
     Offset = mBltLibBytesPerPixel * Offset;
     BltMemSrc = (VOID *) (mBltLibFrameBuffer + Offset);
 
-    if (mPixelFormat == PixelBlueGreenRedReserved8BitPerColor) {
-      BltMemDst =
-        (VOID *) (
-            (UINT8 *) BltBuffer +
-            (DstY * Delta) +
-            (DestinationX * sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL))
-          );
-    } else {
-      BltMemDst = (VOID *) mBltLibLineBuffer;
-    }
-
-    CopyMem (BltMemDst, BltMemSrc, WidthInBytes);
+    BltMemDst =
+      (EFI_GRAPHICS_OUTPUT_BLT_PIXEL *) (
+          (UINT8 *) BltBuffer +
+          (DstY * Delta) +
+          (DestinationX * sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL))
+        );
 
-    if (mPixelFormat != PixelBlueGreenRedReserved8BitPerColor) {
-      for (X = 0; X < Width; X++) {
-        Blt         = (EFI_GRAPHICS_OUTPUT_BLT_PIXEL *) ((UINT8 *) BltBuffer + (DstY * Delta) + (DestinationX + X) * sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL));
-        Uint32 = *(UINT32*) (mBltLibLineBuffer + (X * mBltLibBytesPerPixel));
-        *(UINT32*) Blt =
-          (UINT32) (
-              (((Uint32 & mPixelBitMasks.RedMask)   >> mPixelShl[0]) << mPixelShr[0]) |
-              (((Uint32 & mPixelBitMasks.GreenMask) >> mPixelShl[1]) << mPixelShr[1]) |
-              (((Uint32 & mPixelBitMasks.BlueMask)  >> mPixelShl[2]) << mPixelShr[2])
-            );
-      }
+    if (mPixelConversion == BltLibConvertBgrx8888) {
+      CopyMem (BltMemDst, BltMemSrc, WidthInBytes);
+    } else {
+      //
+      // Pull the whole line out of video memory with one wide copy, then
+      // convert it from system memory.
+      //
+      CopyMem (mBltLibLineBuffer, BltMemSrc, WidthInBytes);
+      ConvertVideoLineToBlt (BltMemDst, mBltLibLineBuffer, Width);
     }
   }
 
@@ -568,8 +726,6 @@ BltLibBufferToVideoEx (
   EFI_GRAPHICS_OUTPUT_BLT_PIXEL   *Blt;
   VOID                            *BltMemSrc;
   VOID                            *BltMemDst;
-  UINTN                           X;
-  UINT32                          Uint32;
   UINTN                           Offset;
   UINTN                           WidthInBytes;
 
@@ -605,24 +761,21 @@ BltLibBufferToVideoEx (
     Offset = mBltLibBytesPerPixel * Offset;
     BltMemDst = (VOID*) (mBltLibFrameBuffer + Offset);
 
-    if (mPixelFormat == PixelBlueGreenRedReserved8BitPerColor) {
-      BltMemSrc = (VOID *) ((UINT8 *) BltBuffer + (SrcY * Delta));
+    Blt =
+      (EFI_GRAPHICS_OUTPUT_BLT_PIXEL *) (
+          (UINT8 *) BltBuffer +
+          (SrcY * Delta) +
+          (SourceX * sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL))
+        );
+
+    if (mPixelConversion == BltLibConvertBgrx8888) {
+      BltMemSrc = (VOID *) Blt;
     } else {
-      for (X = 0; X < Width; X++) {
-        Blt =
-          (EFI_GRAPHICS_OUTPUT_BLT_PIXEL *) (
-              (UINT8 *) BltBuffer +
-              (SrcY * Delta) +
-              ((SourceX + X) * sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL))
-            );
-        Uint32 = *(UINT32*) Blt;
-        *(UINT32*) (mBltLibLineBuffer + (X * mBltLibBytesPerPixel)) =
-          (UINT32) (
-              (((Uint32 << mPixelShl[0]) >> mPixelShr[0]) & mPixelBitMasks.RedMask) |
-              (((Uint32 << mPixelShl[1]) >> mPixelShr[1]) & mPixelBitMasks.GreenMask) |
-              (((Uint32 << mPixelShl[2]) >> mPixelShr[2]) & mPixelBitMasks.BlueMask)
-            );
-      }
+      //
+      // Convert into the line buffer so video memory only sees one
+      // sequential wide copy per line.
+      //
+      ConvertBltLineToVideo (mBltLibLineBuffer, Blt, Width);
       BltMemSrc = (VOID *) mBltLibLineBuffer;
     }
 
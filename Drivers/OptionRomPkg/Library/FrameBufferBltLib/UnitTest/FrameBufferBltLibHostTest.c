@@ -0,0 +1,401 @@
+/** @file
+  Host based unit test and benchmark of FrameBufferBltLib.
+
+  Every supported pixel layout is checked against a reference conversion
+  computed from the bit masks, so the specialized line converters must
+  produce the same frame buffer contents as the generic bit-mask path.
+  The benchmark times full screen BufferToVideo and VideoToBltBuffer
+  operations for the specialized layouts and for layouts that take the
+  generic path.
+
+  Copyright (c) 2026, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <time.h>
+#include <PiDxe.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/BltLib.h>
+#include <Library/DebugLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/UnitTestLib.h>
+
+#define UNIT_TEST_NAME     "FrameBufferBltLib Host Test"
+#define UNIT_TEST_VERSION  "1.0"
+
+#define TEST_WIDTH          61
+#define TEST_HEIGHT         17
+#define BENCHMARK_WIDTH     1024
+#define BENCHMARK_HEIGHT    768
+#define BENCHMARK_FRAMES    50
+
+typedef struct {
+  CHAR8                        *Name;
+  EFI_GRAPHICS_PIXEL_FORMAT    PixelFormat;
+  EFI_PIXEL_BITMASK            BitMask;
+  UINTN                        BytesPerPixel;
+} BLT_TEST_FORMAT;
+
+STATIC BLT_TEST_FORMAT  mFormats[] = {
+  { "BGRX8888",              PixelBlueGreenRedReserved8BitPerColor, { 0x00ff0000, 0x0000ff00, 0x000000ff, 0xff000000 }, 4 },
+  { "RGBX8888",              PixelRedGreenBlueReserved8BitPerColor, { 0x000000ff, 0x0000ff00, 0x00ff0000, 0xff000000 }, 4 },
+  { "BGRX8888 bit mask",     PixelBitMask,                          { 0x00ff0000, 0x0000ff00, 0x000000ff, 0xff000000 }, 4 },
+  { "RGB565 bit mask",       PixelBitMask,                          { 0x0000f800, 0x000007e0, 0x0000001f, 0x00000000 }, 2 },
+  { "RGBX8888 shifted mask", PixelBitMask,                          { 0xff000000, 0x00ff0000, 0x0000ff00, 0x000000ff }, 4 },
+  { "BGR888 bit mask",       PixelBitMask,                          { 0x00ff0000, 0x0000ff00, 0x000000ff, 0x00000000 }, 3 }
+};
+
+/**
+  Place an 8 bit color channel into the bits selected by a mask, keeping
+  the most significant bits of the channel when the mask is narrower.
+
+  @param[in] Channel  8 bit channel value
+  @param[in] Mask     Bit mask of the channel in the pixel
+
+  @return The channel bits of the pixel
+**/
+STATIC
+UINT32
+EncodeChannel (
+  IN UINT8   Channel,
+  IN UINT32  Mask
+  )
+{
+  UINTN  Width;
+  UINTN  Low;
+
+  Low   = (UINTN)LowBitSet32 (Mask);
+  Width = (UINTN)HighBitSet32 (Mask) - Low + 1;
+  return ((UINT32)Channel >> (8 - Width)) << Low;
+}
+
+/**
+  Extract an 8 bit color channel from the bits selected by a mask.
+
+  @param[in] Pixel  Frame buffer pixel
+  @param[in] Mask   Bit mask of the channel in the pixel
+
+  @return The 8 bit channel value
+**/
+STATIC
+UINT8
+DecodeChannel (
+  IN UINT32  Pixel,
+  IN UINT32  Mask
+  )
+{
+  UINTN  Width;
+  UINTN  Low;
+
+  Low   = (UINTN)LowBitSet32 (Mask);
+  Width = (UINTN)HighBitSet32 (Mask) - Low + 1;
+  return (UINT8)(((Pixel & Mask) >> Low) << (8 - Width));
+}
+
+/**
+  Convert a BLT pixel to the frame buffer layout of a test format.
+
+  @param[in] Format  Test format
+  @param[in] Blt     BLT pixel
+
+  @return The frame buffer pixel
+**/
+STATIC
+UINT32
+ReferenceEncode (
+  IN BLT_TEST_FORMAT                *Format,
+  IN EFI_GRAPHICS_OUTPUT_BLT_PIXEL  *Blt
+  )
+{
+  return EncodeChannel (Blt->Red, Format->BitMask.RedMask) |
+         EncodeChannel (Blt->Green, Format->BitMask.GreenMask) |
+         EncodeChannel (Blt->Blue, Format->BitMask.BlueMask);
+}
+
+/**
+  Configure the library for a test format.
+
+  @param[in] Format       Test format
+  @param[in] FrameBuffer  Frame buffer of Width * Height pixels
+  @param[in] Width        Horizontal resolution
+  @param[in] Height       Vertical resolution
+
+  @return Status of BltLibConfigure
+**/
+STATIC
+EFI_STATUS
+ConfigureFormat (
+  IN BLT_TEST_FORMAT  *Format,
+  IN VOID             *FrameBuffer,
+  IN UINT32           Width,
+  IN UINT32           Height
+  )
+{
+  EFI_GRAPHICS_OUTPUT_MODE_INFORMATION  Info;
+
+  ZeroMem (&Info, sizeof (Info));
+  Info.HorizontalResolution = Width;
+  Info.VerticalResolution   = Height;
+  Info.PixelsPerScanLine    = Width;
+  Info.PixelFormat          = Format->PixelFormat;
+  CopyMem (&Info.PixelInformation, &Format->BitMask, sizeof (Format->BitMask));
+
+  return BltLibConfigure (FrameBuffer, &Info);
+}
+
+/**
+  Fill a BLT buffer with a pattern that exercises every channel bit.
+
+  @param[out] Buffer  BLT buffer
+  @param[in]  Count   Number of pixels
+**/
+STATIC
+VOID
+FillPattern (
+  OUT EFI_GRAPHICS_OUTPUT_BLT_PIXEL  *Buffer,
+  IN  UINTN                          Count
+  )
+{
+  UINTN  Index;
+
+  for (Index = 0; Index < Count; Index++) {
+    Buffer[Index].Red      = (UINT8)(Index * 7);
+    Buffer[Index].Green    = (UINT8)(Index * 13 + 5);
+    Buffer[Index].Blue     = (UINT8)(Index * 29 + 11);
+    Buffer[Index].Reserved = 0;
+  }
+}
+
+/**
+  BufferToVideo writes the reference encoding of a sub-rectangle of the
+  BLT buffer, and VideoToBltBuffer reads back the reference decoding.
+
+  @param[in] Context  Pointer to the BLT_TEST_FORMAT to test
+
+  @retval UNIT_TEST_PASSED  The test passed
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+ConversionMatchesReference (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  BLT_TEST_FORMAT                *Format;
+  EFI_GRAPHICS_OUTPUT_BLT_PIXEL  *Blt;
+  EFI_GRAPHICS_OUTPUT_BLT_PIXEL  *ReadBack;
+  EFI_GRAPHICS_OUTPUT_BLT_PIXEL  *Source;
+  UINT8                          *FrameBuffer;
+  UINTN                          FrameBufferSize;
+  UINT32                         Pixel;
+  UINT32                         Expected;
+  UINTN                          X;
+  UINTN                          Y;
+  EFI_STATUS                     Status;
+
+  Format          = (BLT_TEST_FORMAT *)Context;
+  FrameBufferSize = TEST_WIDTH * TEST_HEIGHT * Format->BytesPerPixel;
+  FrameBuffer     = AllocatePool (FrameBufferSize + sizeof (UINT32));
+  Blt             = AllocatePool (TEST_WIDTH * TEST_HEIGHT * sizeof (*Blt));
+  ReadBack        = AllocateZeroPool (TEST_WIDTH * TEST_HEIGHT * sizeof (*ReadBack));
+  UT_ASSERT_NOT_NULL (FrameBuffer);
+  UT_ASSERT_NOT_NULL (Blt);
+  UT_ASSERT_NOT_NULL (ReadBack);
+
+  SetMem (FrameBuffer, FrameBufferSize, 0xA5);
+  FillPattern (Blt, TEST_WIDTH * TEST_HEIGHT);
+  UT_ASSERT_NOT_EFI_ERROR (ConfigureFormat (Format, FrameBuffer, TEST_WIDTH, TEST_HEIGHT));
+
+  //
+  // Copy the rectangle at (3, 2) of the BLT buffer to (5, 4) on screen.
+  //
+  Status = BltLibBufferToVideoEx (
+             Blt,
+             3,
+             2,
+             5,
+             4,
+             TEST_WIDTH - 8,
+             TEST_HEIGHT - 6,
+             TEST_WIDTH * sizeof (*Blt)
+             );
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+
+  for (Y = 0; Y < TEST_HEIGHT; Y++) {
+    for (X = 0; X < TEST_WIDTH; X++) {
+      Pixel = 0;
+      CopyMem (&Pixel, FrameBuffer + (Y * TEST_WIDTH + X) * Format->BytesPerPixel, Format->BytesPerPixel);
+      if ((X < 5) || (X >= TEST_WIDTH - 3) || (Y < 4) || (Y >= TEST_HEIGHT - 2)) {
+        SetMem (&Expected, sizeof (Expected), 0xA5);
+        Expected &= (UINT32)(LShiftU64 (1, Format->BytesPerPixel * 8) - 1);
+      } else {
+        Source   = &Blt[(Y - 2) * TEST_WIDTH + (X - 2)];
+        Expected = ReferenceEncode (Format, Source);
+        Pixel   &= ~Format->BitMask.ReservedMask;
+      }
+
+      UT_ASSERT_EQUAL (Pixel, Expected);
+    }
+  }
+
+  Status = BltLibVideoToBltBufferEx (
+             ReadBack,
+             5,
+             4,
+             1,
+             1,
+             TEST_WIDTH - 8,
+             TEST_HEIGHT - 6,
+             TEST_WIDTH * sizeof (*ReadBack)
+             );
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+
+  for (Y = 1; Y < TEST_HEIGHT - 5; Y++) {
+    for (X = 1; X < TEST_WIDTH - 7; X++) {
+      Source = &Blt[(Y + 1) * TEST_WIDTH + (X + 2)];
+      Pixel  = ReferenceEncode (Format, Source);
+      UT_ASSERT_EQUAL (ReadBack[Y * TEST_WIDTH + X].Red, DecodeChannel (Pixel, Format->BitMask.RedMask));
+      UT_ASSERT_EQUAL (ReadBack[Y * TEST_WIDTH + X].Green, DecodeChannel (Pixel, Format->BitMask.GreenMask));
+      UT_ASSERT_EQUAL (ReadBack[Y * TEST_WIDTH + X].Blue, DecodeChannel (Pixel, Format->BitMask.BlueMask));
+    }
+  }
+
+  FreePool (FrameBuffer);
+  FreePool (Blt);
+  FreePool (ReadBack);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Time full screen BufferToVideo and VideoToBltBuffer operations.
+
+  @param[in] Context  Pointer to the BLT_TEST_FORMAT to benchmark
+
+  @retval UNIT_TEST_PASSED  The benchmark ran
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+BltBenchmark (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  BLT_TEST_FORMAT                *Format;
+  EFI_GRAPHICS_OUTPUT_BLT_PIXEL  *Blt;
+  UINT8                          *FrameBuffer;
+  UINTN                          Frame;
+  clock_t                        Start;
+  UINT64                         ToVideo;
+  UINT64                         FromVideo;
+  UINT64                         Pixels;
+
+  Format      = (BLT_TEST_FORMAT *)Context;
+  FrameBuffer = AllocatePool (BENCHMARK_WIDTH * BENCHMARK_HEIGHT * Format->BytesPerPixel + sizeof (UINT32));
+  Blt         = AllocatePool (BENCHMARK_WIDTH * BENCHMARK_HEIGHT * sizeof (*Blt));
+  UT_ASSERT_NOT_NULL (FrameBuffer);
+  UT_ASSERT_NOT_NULL (Blt);
+
+  FillPattern (Blt, BENCHMARK_WIDTH * BENCHMARK_HEIGHT);
+  UT_ASSERT_NOT_EFI_ERROR (ConfigureFormat (Format, FrameBuffer, BENCHMARK_WIDTH, BENCHMARK_HEIGHT));
+
+  Start = clock ();
+  for (Frame = 0; Frame < BENCHMARK_FRAMES; Frame++) {
+    BltLibBufferToVideo (Blt, 0, 0, BENCHMARK_WIDTH, BENCHMARK_HEIGHT);
+  }
+
+  ToVideo = (UINT64)(clock () - Start);
+
+  Start = clock ();
+  for (Frame = 0; Frame < BENCHMARK_FRAMES; Frame++) {
+    BltLibVideoToBltBuffer (Blt, 0, 0, BENCHMARK_WIDTH, BENCHMARK_HEIGHT);
+  }
+
+  FromVideo = (UINT64)(clock () - Start);
+
+  //
+  // Megapixels per second, with the clock ticks rounded up to avoid a
+  // division by zero on a fast host.
+  //
+  Pixels = (UINT64)BENCHMARK_WIDTH * BENCHMARK_HEIGHT * BENCHMARK_FRAMES;
+  UT_LOG_INFO (
+    "%a: BufferToVideo %ld Mpixel/s, VideoToBltBuffer %ld Mpixel/s\n",
+    Format->Name,
+    DivU64x64Remainder (MultU64x32 (Pixels, CLOCKS_PER_SEC), MultU64x32 (ToVideo + 1, 1000000), NULL),
+    DivU64x64Remainder (MultU64x32 (Pixels, CLOCKS_PER_SEC), MultU64x32 (FromVideo + 1, 1000000), NULL)
+    );
+
+  FreePool (FrameBuffer);
+  FreePool (Blt);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Initialize the unit test framework, suites and test cases, and run them.
+
+  @retval EFI_SUCCESS           All test cases were dispatched.
+  @retval EFI_OUT_OF_RESOURCES  There are not enough resources available to
+                                initialize the unit tests.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+UnitTestingEntry (
+  VOID
+  )
+{
+  EFI_STATUS                  Status;
+  UNIT_TEST_FRAMEWORK_HANDLE  Framework;
+  UNIT_TEST_SUITE_HANDLE      ConversionTests;
+  UNIT_TEST_SUITE_HANDLE      Benchmark;
+  UINTN                       Index;
+
+  Framework = NULL;
+
+  DEBUG ((DEBUG_INFO, "%a v%a\n", UNIT_TEST_NAME, UNIT_TEST_VERSION));
+
+  Status = InitUnitTestFramework (&Framework, UNIT_TEST_NAME, gEfiCallerBaseName, UNIT_TEST_VERSION);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in InitUnitTestFramework. Status = %r\n", Status));
+    goto EXIT;
+  }
+
+  Status = CreateUnitTestSuite (&ConversionTests, Framework, "Pixel Conversion Tests", "FrameBufferBltLib.Conversion", NULL, NULL);
+  if (EFI_ERROR (Status)) {
+    Status = EFI_OUT_OF_RESOURCES;
+    goto EXIT;
+  }
+
+  Status = CreateUnitTestSuite (&Benchmark, Framework, "Blt Benchmark", "FrameBufferBltLib.Benchmark", NULL, NULL);
+  if (EFI_ERROR (Status)) {
+    Status = EFI_OUT_OF_RESOURCES;
+    goto EXIT;
+  }
+
+  for (Index = 0; Index < ARRAY_SIZE (mFormats); Index++) {
+    AddTestCase (ConversionTests, mFormats[Index].Name, "Conversion", ConversionMatchesReference, NULL, NULL, &mFormats[Index]);
+    AddTestCase (Benchmark, mFormats[Index].Name, "Benchmark", BltBenchmark, NULL, NULL, &mFormats[Index]);
+  }
+
+  Status = RunAllTestSuites (Framework);
+
+EXIT:
+  if (Framework) {
+    FreeUnitTestFramework (Framework);
+  }
+
+  return Status;
+}
+
+/**
+  Standard POSIX C entry point for host based unit test execution.
+**/
+int
+main (
+  int   argc,
+  char  *argv[]
+  )
+{
+  return UnitTestingEntry ();
+}
@@ -445,6 +445,7 @@ IssueCB (
   )
 {
   UINT16  status;
+  TxCB    *prev_ptr;
 
   wait_for_cmd_done (AdapterInfo->ioaddr + SCBCmd);
 
@@ -478,10 +479,17 @@ IssueCB (
     OutByte (AdapterInfo, CU_START, AdapterInfo->ioaddr + SCBCmd);
   } else {
     //
-    // either active or suspended, give a resume
+    // either active or suspended, give a resume. Once the previous CB has
+    // completed the CU is suspended on it and the resume moves on to this
+    // CB, so its suspend bit is left alone. Otherwise the CU is still on
+    // its way there: clear the bit so it runs straight into this CB, and
+    // let the resume restart it in case it read the bit first.
     //
+    prev_ptr = cmd_ptr->PrevTCBVirtualLinkPtr;
+    if ((prev_ptr->cb_header.status & CMD_STATUS_MASK) == 0) {
+      prev_ptr->cb_header.command &= ~(CmdSuspend | CmdIntr);
+    }
 
-    cmd_ptr->PrevTCBVirtualLinkPtr->cb_header.command &= ~(CmdSuspend | CmdIntr);
     OutByte (AdapterInfo, CU_RESUME, AdapterInfo->ioaddr + SCBCmd);
   }
 
@@ -768,10 +776,12 @@ E100bInit (
   AdapterInfo->rx_ring        = (RxFD *) (UINTN) (AdapterInfo->MemoryPtr);
   AdapterInfo->tx_ring        = (TxCB *) (UINTN) (AdapterInfo->MemoryPtr + rx_size);
   AdapterInfo->statistics     = (struct speedo_stats *) (UINTN) (AdapterInfo->MemoryPtr + rx_size + tx_size);
+  AdapterInfo->tx_frames      = (UINT8 *) (UINTN) (AdapterInfo->MemoryPtr + rx_size + tx_size + sizeof (struct speedo_stats));
 
   AdapterInfo->rx_phy_addr    = AdapterInfo->Mapped_MemoryPtr;
   AdapterInfo->tx_phy_addr    = AdapterInfo->Mapped_MemoryPtr + rx_size;
   AdapterInfo->stat_phy_addr  = AdapterInfo->tx_phy_addr + tx_size;
+  AdapterInfo->tx_frames_phy_addr = AdapterInfo->stat_phy_addr + sizeof (struct speedo_stats);
 
   //
   // auto detect.
@@ -1011,14 +1021,14 @@ E100bTransmit (
   PXE_CPB_TRANSMIT_FRAGMENTS  *tx_ptr_f;
   PXE_CPB_TRANSMIT            *tx_ptr_1;
   TxCB                        *tcb_ptr;
-  UINT64                      Tmp_ptr;
-  UINTN                       stat;
+  UINTN                       tcb_index;
+  UINT8                       *frame_ptr;
+  UINT32                      frame_len;
   INT32                       Index;
   UINT16                      wait_sec;
 
   tx_ptr_1  = (PXE_CPB_TRANSMIT *) (UINTN) cpb;
   tx_ptr_f  = (PXE_CPB_TRANSMIT_FRAGMENTS *) (UINTN) cpb;
-  Tmp_ptr = 0;
 
   //
   // stop reentrancy here
@@ -1040,22 +1050,15 @@ E100bTransmit (
     return PXE_STATCODE_QUEUE_FULL;
   }
 
-  AdapterInfo->TxTotals++;
-
-  tcb_ptr->cb_header.command  = (CmdSuspend | CmdTx | CmdTxFlex);
-  tcb_ptr->cb_header.status   = 0;
-
   //
-  // no immediate data, set EOF in the ByteCount
+  // Every CB owns a frame buffer inside the memory block that was mapped
+  // once at init time. Gathering the frame there avoids mapping and
+  // unmapping the caller's buffers for each packet.
   //
-  tcb_ptr->ByteCount = 0x8000;
+  tcb_index = (UINTN) (tcb_ptr - AdapterInfo->tx_ring);
+  frame_ptr = AdapterInfo->tx_frames + (tcb_index * TX_FRAME_BUFFER_SIZE);
+  frame_len = 0;
 
-  //
-  // The data region is always in one buffer descriptor, Tx FIFO
-  // threshold of 256.
-  // 82557 multiplies the threashold value by 8, so give 256/8
-  //
-  tcb_ptr->Threshold = 32;
   if ((opflags & PXE_OPFLAGS_TRANSMIT_FRAGMENTED) != 0) {
 
     if (tx_ptr_f->FragCnt > MAX_XMIT_FRAGMENTS) {
@@ -1064,24 +1067,19 @@ E100bTransmit (
       return PXE_STATCODE_INVALID_PARAMETER;
     }
 
-    tcb_ptr->TBDCount = (UINT8) tx_ptr_f->FragCnt;
-
     for (Index = 0; Index < tx_ptr_f->FragCnt; Index++) {
-      stat = MapIt (
-              AdapterInfo,
-              tx_ptr_f->FragDesc[Index].FragAddr,
-              tx_ptr_f->FragDesc[Index].FragLen,
-              TO_DEVICE,
-              (UINT64)(UINTN) &Tmp_ptr
-              );
-      if (stat != 0) {
+      if (tx_ptr_f->FragDesc[Index].FragLen > TX_FRAME_BUFFER_SIZE - frame_len) {
         SetFreeCB (AdapterInfo, tcb_ptr);
         AdapterInfo->in_transmit = FALSE;
         return PXE_STATCODE_INVALID_PARAMETER;
       }
 
-      tcb_ptr->TBDArray[Index].phys_buf_addr  = (UINT32) Tmp_ptr;
-      tcb_ptr->TBDArray[Index].buf_len        = tx_ptr_f->FragDesc[Index].FragLen;
+      CopyMem (
+        frame_ptr + frame_len,
+        (VOID *) (UINTN) tx_ptr_f->FragDesc[Index].FragAddr,
+        tx_ptr_f->FragDesc[Index].FragLen
+        );
+      frame_len += tx_ptr_f->FragDesc[Index].FragLen;
     }
 
     tcb_ptr->free_data_ptr = tx_ptr_f->FragDesc[0].FragAddr;
@@ -1090,27 +1088,41 @@ E100bTransmit (
     //
     // non fragmented case
     //
-    tcb_ptr->TBDCount = 1;
-    stat = MapIt (
-            AdapterInfo,
-            tx_ptr_1->FrameAddr,
-            tx_ptr_1->DataLen + tx_ptr_1->MediaheaderLen,
-            TO_DEVICE,
-            (UINT64)(UINTN) &Tmp_ptr
-            );
-    if (stat != 0) {
+    frame_len = tx_ptr_1->DataLen + tx_ptr_1->MediaheaderLen;
+    if (frame_len > TX_FRAME_BUFFER_SIZE) {
       SetFreeCB (AdapterInfo, tcb_ptr);
       AdapterInfo->in_transmit = FALSE;
       return PXE_STATCODE_INVALID_PARAMETER;
     }
 
-    tcb_ptr->TBDArray[0].phys_buf_addr  = (UINT32) (Tmp_ptr);
-    tcb_ptr->TBDArray[0].buf_len        = tx_ptr_1->DataLen + tx_ptr_1->MediaheaderLen;
-    tcb_ptr->free_data_ptr              = tx_ptr_1->FrameAddr;
+    CopyMem (frame_ptr, (VOID *) (UINTN) tx_ptr_1->FrameAddr, frame_len);
+    tcb_ptr->free_data_ptr = tx_ptr_1->FrameAddr;
   }
 
+  AdapterInfo->TxTotals++;
+
+  tcb_ptr->cb_header.command  = (CmdSuspend | CmdTx | CmdTxFlex);
+  tcb_ptr->cb_header.status   = 0;
+
+  //
+  // no immediate data, set EOF in the ByteCount
+  //
+  tcb_ptr->ByteCount = 0x8000;
+
+  //
+  // The data region is always in one buffer descriptor, Tx FIFO
+  // threshold of 256.
+  // 82557 multiplies the threashold value by 8, so give 256/8
+  //
+  tcb_ptr->Threshold = 32;
+  tcb_ptr->TBDCount  = 1;
+  tcb_ptr->TBDArray[0].phys_buf_addr  = (UINT32) (AdapterInfo->tx_frames_phy_addr + (tcb_index * TX_FRAME_BUFFER_SIZE));
+  tcb_ptr->TBDArray[0].buf_len        = frame_len;
+
   //
-  // must wait for previous command completion only if it was a non-transmit
+  // Hand the CB to the CU right away. While the CU is still sending earlier
+  // frames it runs on into this one, so back to back transmits go out in
+  // one pass of the CU; completions are reaped later from GetStatus.
   //
   BlockIt (AdapterInfo, TRUE);
   IssueCB (AdapterInfo, tcb_ptr);
@@ -1131,31 +1143,6 @@ E100bTransmit (
         break;
       }
     }
-    //
-    // we need to un-map any mapped buffers here
-    //
-    if ((opflags & PXE_OPFLAGS_TRANSMIT_FRAGMENTED) != 0) {
-
-      for (Index = 0; Index < tx_ptr_f->FragCnt; Index++) {
-        Tmp_ptr = tcb_ptr->TBDArray[Index].phys_buf_addr;
-        UnMapIt (
-          AdapterInfo,
-          tx_ptr_f->FragDesc[Index].FragAddr,
-          tx_ptr_f->FragDesc[Index].FragLen,
-          TO_DEVICE,
-          (UINT64) Tmp_ptr
-          );
-      }
-    } else {
-      Tmp_ptr = tcb_ptr->TBDArray[0].phys_buf_addr;
-      UnMapIt (
-        AdapterInfo,
-        tx_ptr_1->FrameAddr,
-        tx_ptr_1->DataLen + tx_ptr_1->MediaheaderLen,
-        TO_DEVICE,
-        (UINT64) Tmp_ptr
-        );
-    }
 
     if (tcb_ptr->cb_header.status == 0) {
       SetFreeCB (AdapterInfo, tcb_ptr);
@@ -1201,19 +1188,9 @@ E100bReceive (
   PXE_FRAME_TYPE  pkt_type;
   UINT16          Tmp_len;
   EtherHeader     *hdr_ptr;
+  UINT16          scb_status;
   ret_code  = PXE_STATCODE_NO_DATA;
   pkt_type  = PXE_FRAME_TYPE_NONE;
-  status    = InWord (AdapterInfo, AdapterInfo->ioaddr + SCBStatus);
-  AdapterInfo->Int_Status = (UINT16) (AdapterInfo->Int_Status | status);
-  //
-  // acknoledge the interrupts
-  //
-  OutWord (AdapterInfo, (UINT16) (status & 0xfc00), (UINT32) (AdapterInfo->ioaddr + SCBStatus));
-
-  //
-  // include the prev ints as well
-  //
-  status = AdapterInfo->Int_Status;
   rx_cpbptr = (PXE_CPB_RECEIVE *) (UINTN) cpb;
   rx_dbptr  = (PXE_DB_RECEIVE *) (UINTN) db;
 
@@ -1335,15 +1312,27 @@ FreeRFD:
     rx_ptr = &AdapterInfo->rx_ring[AdapterInfo->cur_rx_ind];
   }
 
-  if (pkt_type == PXE_FRAME_TYPE_NONE) {
-    AdapterInfo->Int_Status &= (~SCB_STATUS_FR);
+  if (pkt_type != PXE_FRAME_TYPE_NONE) {
+    //
+    // Completed RFDs are consumed straight from memory. The SCB is only
+    // touched once the ring has been drained, so a burst of frames costs
+    // no register accesses until the last one has been handed up.
+    //
+    return ret_code;
   }
 
-  status = InWord (AdapterInfo, AdapterInfo->ioaddr + SCBStatus);
-  if ((status & SCB_RUS_NO_RESOURCES) != 0) {
+  scb_status = InWord (AdapterInfo, AdapterInfo->ioaddr + SCBStatus);
+  AdapterInfo->Int_Status = (UINT16) (AdapterInfo->Int_Status | scb_status);
+  //
+  // acknoledge the interrupts
+  //
+  OutWord (AdapterInfo, (UINT16) (scb_status & 0xfc00), (UINT32) (AdapterInfo->ioaddr + SCBStatus));
+  AdapterInfo->Int_Status &= (~SCB_STATUS_FR);
+
+  if ((scb_status & SCB_RUS_NO_RESOURCES) != 0) {
     //
-    // start the receive unit here!
-    // leave all the filled frames,
+    // start the receive unit here! Every completed frame has already been
+    // consumed, so nothing is lost by resetting the ring.
     //
     SetupReceiveQueues (AdapterInfo);
     OutLong (AdapterInfo, (UINT32) AdapterInfo->rx_phy_addr, AdapterInfo->ioaddr + SCBPointer);
@@ -1603,15 +1592,6 @@ CheckCBList (
       if (next (AdapterInfo->xmit_done_tail) != AdapterInfo->xmit_done_head) {
         ASSERT (AdapterInfo->xmit_done_tail < TX_BUFFER_COUNT << 1);
         AdapterInfo->xmit_done[AdapterInfo->xmit_done_tail] = Tmp_ptr->free_data_ptr;
-
-        UnMapIt (
-          AdapterInfo,
-          Tmp_ptr->free_data_ptr,
-          Tmp_ptr->TBDArray[0].buf_len,
-          TO_DEVICE,
-          (UINT64) Tmp_ptr->TBDArray[0].phys_buf_addr
-          );
-
         AdapterInfo->xmit_done_tail = next (AdapterInfo->xmit_done_tail);
       }
 
@@ -56,6 +56,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #define MAX_ETHERNET_PKT_SIZE 1514  // including eth header
 #define RX_BUFFER_SIZE 1536  // including crc and padding
 #define TX_BUFFER_SIZE 64
+#define TX_FRAME_BUFFER_SIZE 1536  // per-CB copy of the frame being sent
 #define ETH_MTU 1500  // does not include ethernet header length
 
 #define SPEEDO3_TOTAL_SIZE 0x20
@@ -453,6 +454,14 @@ struct Krn_Mem{
   RxFD rx_ring[RX_BUFFER_COUNT];
   TxCB tx_ring[TX_BUFFER_COUNT];
   struct speedo_stats statistics;
+  //
+  // One frame buffer per tx CB (48KB, about the size of rx_ring). Transmit
+  // copies each frame here instead of mapping the caller's buffer, and a CB
+  // keeps its buffer until the CU has sent it, so all TX_BUFFER_COUNT CBs
+  // can be in flight. The block comes from the MemoryRequired the protocol
+  // driver allocates once at Initialize.
+  //
+  UINT8 tx_frames[TX_BUFFER_COUNT][TX_FRAME_BUFFER_SIZE];
 };
 #define MEMORY_NEEDED  sizeof(struct Krn_Mem)
 
@@ -598,6 +607,7 @@ typedef struct s_data_instance {
   RxFD *rx_ring;  // array of rx buffers
   TxCB *tx_ring;  // array of tx buffers
   struct speedo_stats *statistics;
+  UINT8 *tx_frames;  // one frame buffer per tx CB, mapped with the rest of Krn_Mem
   TxCB *FreeTxHeadPtr;
   TxCB *FreeTxTailPtr;
   RxFD *RFDTailPtr;
@@ -605,6 +615,7 @@ typedef struct s_data_instance {
   UINT64 rx_phy_addr;  // physical addresses
   UINT64 tx_phy_addr;
   UINT64 stat_phy_addr;
+  UINT64 tx_frames_phy_addr;
   UINT64 MemoryPtr;
   UINT64 Mapped_MemoryPtr;
 
@@ -89,6 +89,171 @@ Ext4ValidDirent (
   return TRUE;
 }
 
+/**
+   Compares a directory entry's name with a filename, case-insensitively, directly on
+   the on-disk bytes. This only works for plain ASCII names, where case folding is
+   trivial; other names need to be converted and compared with Ext4StrCmpInsensitive.
+
+   @param[in]      Entry       Pointer to the directory entry.
+   @param[in]      Name        Pointer to the ASCII-only UCS-2 formatted filename,
+                               which is Entry->name_len characters long.
+
+   @retval EFI_SUCCESS         The names are equal.
+   @retval EFI_NOT_FOUND       The names are different.
+   @retval EFI_UNSUPPORTED     The directory entry's name isn't plain ASCII.
+**/
+STATIC
+EFI_STATUS
+Ext4AsciiDirentNameCmp (
+  IN CONST EXT4_DIR_ENTRY  *Entry,
+  IN CONST CHAR16          *Name
+  )
+{
+  UINT8   Index;
+  CHAR16  DirentChar;
+  CHAR16  NameChar;
+
+  for (Index = 0; Index < Entry->name_len; Index++) {
+    DirentChar = (UINT8)Entry->name[Index];
+
+    if (DirentChar >= 0x80) {
+      return EFI_UNSUPPORTED;
+    }
+
+    NameChar = Name[Index];
+
+    if ((DirentChar >= L'a') && (DirentChar <= L'z')) {
+      DirentChar -= L'a' - L'A';
+    }
+
+    if ((NameChar >= L'a') && (NameChar <= L'z')) {
+      NameChar -= L'a' - L'A';
+    }
+
+    // The ASCII prefix of a name converts 1:1 to UCS-2, so a mismatch in it is final
+    if (DirentChar != NameChar) {
+      return EFI_NOT_FOUND;
+    }
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+   Looks up a name in the partition's name lookup cache.
+   On a hit, the entry is moved to the front of the cache.
+
+   @param[in]      Partition   Pointer to the ext4 partition.
+   @param[in]      DirInode    Inode number of the directory being searched.
+   @param[in]      Name        Pointer to the UCS-2 formatted filename.
+   @param[in]      NameLength  Length of Name, in characters.
+
+   @return Pointer to the cache entry, or NULL if the name isn't cached.
+**/
+STATIC
+EXT4_DCACHE_ENTRY *
+Ext4DentryCacheLookup (
+  IN EXT4_PARTITION  *Partition,
+  IN EXT4_INO_NR     DirInode,
+  IN CONST CHAR16    *Name,
+  IN UINTN           NameLength
+  )
+{
+  LIST_ENTRY         *Node;
+  EXT4_DCACHE_ENTRY  *CacheEntry;
+
+  BASE_LIST_FOR_EACH (Node, &Partition->DentryCache) {
+    CacheEntry = EXT4_DCACHE_ENTRY_FROM_LIST (Node);
+
+    if ((CacheEntry->DirInode == DirInode) &&
+        (CacheEntry->NameLength == NameLength) &&
+        (Ext4StrCmpInsensitive (CacheEntry->Name, (CHAR16 *)Name) == 0))
+    {
+      RemoveEntryList (Node);
+      InsertHeadList (&Partition->DentryCache, Node);
+      return CacheEntry;
+    }
+  }
+
+  return NULL;
+}
+
+/**
+   Adds the result of a directory lookup to the partition's name lookup cache.
+   If the cache is full, the least recently used entry is recycled.
+   Failure to allocate an entry is not an error, the lookup just isn't cached.
+
+   @param[in]      Partition   Pointer to the ext4 partition.
+   @param[in]      DirInode    Inode number of the directory that was searched.
+   @param[in]      Name        Pointer to the UCS-2 formatted filename.
+   @param[in]      NameLength  Length of Name, in characters.
+   @param[in]      Dirent      Directory entry found, or NULL if the name doesn't exist.
+**/
+STATIC
+VOID
+Ext4DentryCacheInsert (
+  IN EXT4_PARTITION        *Partition,
+  IN EXT4_INO_NR           DirInode,
+  IN CONST CHAR16          *Name,
+  IN UINTN                 NameLength,
+  IN CONST EXT4_DIR_ENTRY  *Dirent OPTIONAL
+  )
+{
+  EXT4_DCACHE_ENTRY  *CacheEntry;
+
+  if (NameLength > EXT4_NAME_MAX) {
+    return;
+  }
+
+  if (Partition->DentryCacheSize >= EXT4_DCACHE_MAX_ENTRIES) {
+    CacheEntry = EXT4_DCACHE_ENTRY_FROM_LIST (GetPreviousNode (&Partition->DentryCache, &Partition->DentryCache));
+    RemoveEntryList (&CacheEntry->ListNode);
+  } else {
+    CacheEntry = AllocatePool (sizeof (EXT4_DCACHE_ENTRY));
+
+    if (CacheEntry == NULL) {
+      return;
+    }
+
+    Partition->DentryCacheSize++;
+  }
+
+  CacheEntry->DirInode   = DirInode;
+  CacheEntry->NameLength = NameLength;
+  CopyMem (CacheEntry->Name, Name, NameLength * sizeof (CHAR16));
+  CacheEntry->Name[NameLength] = L'\0';
+
+  if (Dirent != NULL) {
+    CacheEntry->Negative = FALSE;
+    CopyMem (&CacheEntry->Dirent, Dirent, sizeof (EXT4_DIR_ENTRY));
+  } else {
+    CacheEntry->Negative = TRUE;
+  }
+
+  InsertHeadList (&Partition->DentryCache, &CacheEntry->ListNode);
+}
+
+/**
+   Frees every entry of the partition's name lookup cache.
+
+   @param[in out]  Partition   Pointer to the ext4 partition.
+**/
+VOID
+Ext4FreeDentryCache (
+  IN OUT EXT4_PARTITION  *Partition
+  )
+{
+  LIST_ENTRY  *Node;
+  LIST_ENTRY  *NextNode;
+
+  BASE_LIST_FOR_EACH_SAFE (Node, NextNode, &Partition->DentryCache) {
+    RemoveEntryList (Node);
+    FreePool (EXT4_DCACHE_ENTRY_FROM_LIST (Node));
+  }
+
+  Partition->DentryCacheSize = 0;
+}
+
 /**
    Retrieves a directory entry.
 
@@ -107,18 +272,41 @@ Ext4RetrieveDirent (
   OUT EXT4_DIR_ENTRY  *Result
   )
 {
-  EFI_STATUS      Status;
-  CHAR8           *Buf;
-  UINT64          Off;
-  EXT4_INODE      *Inode;
-  UINT64          DirInoSize;
-  UINT32          BlockRemainder;
-  UINTN           Length;
-  EXT4_DIR_ENTRY  *Entry;
-  UINTN           RemainingBlock;
-  CHAR16          DirentUcs2Name[EXT4_NAME_MAX + 1];
-  UINTN           ToCopy;
-  UINTN           BlockOffset;
+  EFI_STATUS         Status;
+  CHAR8              *Buf;
+  UINT64             Off;
+  EXT4_INODE         *Inode;
+  UINT64             DirInoSize;
+  UINT32             BlockRemainder;
+  UINTN              Length;
+  EXT4_DIR_ENTRY     *Entry;
+  UINTN              RemainingBlock;
+  CHAR16             DirentUcs2Name[EXT4_NAME_MAX + 1];
+  UINTN              ToCopy;
+  UINTN              BlockOffset;
+  UINTN              NameLength;
+  BOOLEAN            NameIsAscii;
+  EXT4_DCACHE_ENTRY  *CacheEntry;
+
+  NameIsAscii = TRUE;
+
+  for (NameLength = 0; Name[NameLength] != L'\0'; NameLength++) {
+    if (Name[NameLength] >= 0x80) {
+      NameIsAscii = FALSE;
+    }
+  }
+
+  // Repeated lookups (including of names that don't exist) are served from the cache
+  CacheEntry = Ext4DentryCacheLookup (Partition, Directory->InodeNum, Name, NameLength);
+
+  if (CacheEntry != NULL) {
+    if (CacheEntry->Negative) {
+      return EFI_NOT_FOUND;
+    }
+
+    CopyMem (Result, &CacheEntry->Dirent, sizeof (EXT4_DIR_ENTRY));
+    return EFI_SUCCESS;
+  }
 
   Buf = AllocatePool (Partition->BlockSize);
 
@@ -173,6 +361,31 @@ Ext4RetrieveDirent (
         continue;
       }
 
+      // Names of a different length can never match
+      if (Entry->name_len != NameLength) {
+        BlockOffset += Entry->rec_len;
+        continue;
+      }
+
+      // Plain ASCII names are compared in place, without the UTF-8 conversion and
+      // the collation protocol call.
+      if (NameIsAscii) {
+        Status = Ext4AsciiDirentNameCmp (Entry, Name);
+
+        if (Status == EFI_NOT_FOUND) {
+          BlockOffset += Entry->rec_len;
+          continue;
+        }
+
+        if (Status == EFI_SUCCESS) {
+          ToCopy = MIN (Entry->rec_len, sizeof (EXT4_DIR_ENTRY));
+
+          CopyMem (Result, Entry, ToCopy);
+          Ext4DentryCacheInsert (Partition, Directory->InodeNum, Name, NameLength, Result);
+          goto Out;
+        }
+      }
+
       Status = Ext4GetUcs2DirentName (Entry, DirentUcs2Name);
 
       /* In theory, this should never fail.
@@ -193,12 +406,11 @@ Ext4RetrieveDirent (
         return Status;
       }
 
-      if ((Entry->name_len == StrLen (Name)) &&
-          !Ext4StrCmpInsensitive (DirentUcs2Name, (CHAR16 *)Name))
-      {
+      if (!Ext4StrCmpInsensitive (DirentUcs2Name, (CHAR16 *)Name)) {
         ToCopy = MIN (Entry->rec_len, sizeof (EXT4_DIR_ENTRY));
 
         CopyMem (Result, Entry, ToCopy);
+        Ext4DentryCacheInsert (Partition, Directory->InodeNum, Name, NameLength, Result);
         Status = EFI_SUCCESS;
         goto Out;
       }
@@ -209,6 +421,7 @@ Ext4RetrieveDirent (
     Off += Partition->BlockSize;
   }
 
+  Ext4DentryCacheInsert (Partition, Directory->InodeNum, Name, NameLength, NULL);
   Status = EFI_NOT_FOUND;
 
 Out:
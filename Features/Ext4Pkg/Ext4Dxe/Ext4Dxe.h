@@ -54,6 +54,11 @@
 //
 #define EXT4_LOG_BLOCK_SIZE_MAX  11
 
+//
+// Maximum number of entries kept in a partition's name lookup cache.
+//
+#define EXT4_DCACHE_MAX_ENTRIES  128
+
 /**
    Opens an ext4 partition and installs the Simple File System protocol.
 
@@ -104,8 +109,30 @@ typedef struct _Ext4_PARTITION {
   LIST_ENTRY                         OpenFiles;
 
   EXT4_DENTRY                        *RootDentry;
+
+  // Name lookup cache, most recently used entry first.
+  LIST_ENTRY                         DentryCache;
+  UINTN                              DentryCacheSize;
 } EXT4_PARTITION;
 
+/**
+   This structure represents an entry of the partition's name lookup cache.
+   It maps a name inside a directory to the directory entry found on disk, or
+   records that no such name exists (a negative entry). Names are matched
+   case-insensitively, like Ext4RetrieveDirent does.
+   As the driver is read-only, cached entries never become stale.
+ */
+typedef struct {
+  LIST_ENTRY        ListNode;
+  EXT4_INO_NR       DirInode;
+  BOOLEAN           Negative;
+  UINTN             NameLength;
+  CHAR16            Name[EXT4_NAME_MAX + 1];
+  EXT4_DIR_ENTRY    Dirent;
+} EXT4_DCACHE_ENTRY;
+
+#define EXT4_DCACHE_ENTRY_FROM_LIST(Node)  BASE_CR(Node, EXT4_DCACHE_ENTRY, ListNode)
+
 /**
    This structure represents a directory entry inside our directory entry tree.
    For now, it will be used as a way to track file names inside our opening
@@ -432,6 +459,16 @@ Ext4RetrieveDirent (
   OUT EXT4_DIR_ENTRY  *Result
   );
 
+/**
+   Frees every entry of the partition's name lookup cache.
+
+   @param[in out]  Partition   Pointer to the ext4 partition.
+**/
+VOID
+Ext4FreeDentryCache (
+  IN OUT EXT4_PARTITION  *Partition
+  );
+
 /**
    Opens a file.
 
@@ -36,6 +36,7 @@ Ext4OpenPartition (
   }
 
   InitializeListHead (&Part->OpenFiles);
+  InitializeListHead (&Part->DentryCache);
 
   Part->BlockIo = BlockIo;
   Part->DiskIo  = DiskIo;
@@ -119,6 +120,8 @@ Ext4UnmountAndFreePartition (
     Ext4CloseInternal (File);
   }
 
+  Ext4FreeDentryCache (Partition);
+
   DeletedRootDentry = Ext4UnrefDentry (Partition->RootDentry);
 
   if (!DeletedRootDentry) {
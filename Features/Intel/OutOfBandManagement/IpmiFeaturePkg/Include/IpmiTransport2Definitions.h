@@ -29,6 +29,7 @@ typedef struct {
   BOOLEAN    BtTransportLocked;    ///< Interface lock.
   UINT8      HosttoBmcBufferSize;  ///< Host to Bmc Buffer Size.
   UINT8      BmctoHostBufferSize;  ///< Bmc to Host Buffer Size.
+  UINT32     BtResponseTime;       ///< Average Bmc response time in microseconds.
 } BT_SYSTEM_INTERFACE;
 
 /** @internal
@@ -44,6 +45,7 @@ typedef struct {
   BOOLEAN     SmbAlertSupport;      ///< Smbus alert support.
   UINT8       SsifSoftErrorCount;   ///< Soft error count.
   BOOLEAN     SsifTransportLocked;  ///< Interface lock.
+  UINT32      SsifResponseTime;     ///< Average Bmc response time in microseconds.
 } SSIF_SYSTEM_INTERFACE;
 
 /** @internal
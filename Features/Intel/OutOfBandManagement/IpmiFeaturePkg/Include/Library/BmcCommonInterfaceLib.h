@@ -35,6 +35,16 @@
 
 #define IPMI_MAX_BT_CMD_DATA_SIZE  0xFF
 
+//
+// Exponential backoff state used while polling the BMC.
+//
+typedef struct {
+  UINT32    Delay;    ///< Delay before the next retry in microseconds.
+  UINT32    MaxDelay; ///< Upper bound of a single retry delay in microseconds.
+  UINT64    Elapsed;  ///< Sum of the retry delays handed out so far.
+  UINT64    Budget;   ///< Maximum sum of the retry delays.
+} IPMI_BACKOFF;
+
 #define IPMI_ERROR_COMPLETION_CODE(a)  !((a == IPMI_COMPLETION_CODE_SUCCESS) ||   \
                                              ((a >= IPMI_COMPLETION_CODE_DEVICE_SPECIFIC_START) && \
                                               (a <= IPMI_COMPLETION_CODE_DEVICE_SPECIFIC_END)) || \
@@ -156,6 +166,63 @@ IpmiUpdateSoftErrorCount (
 
 /*++
 
+Routine Description:
+  Initializes the exponential backoff state for polling the BMC.
+
+Arguments:
+  Backoff  - Pointer to the backoff state.
+  MinDelay - First retry delay in microseconds.
+  MaxDelay - Upper bound of a single retry delay in microseconds.
+  Budget   - Maximum sum of all retry delays in microseconds.
+
+Returns:
+  VOID - Nothing.
+--*/
+VOID
+IpmiBackoffInit (
+  OUT IPMI_BACKOFF  *Backoff,
+  IN  UINT32        MinDelay,
+  IN  UINT32        MaxDelay,
+  IN  UINT64        Budget
+  );
+
+/*++
+
+Routine Description:
+  Returns the delay to wait before the next retry and doubles the delay
+  for the retry after it, up to the maximum delay.
+
+Arguments:
+  Backoff - Pointer to the backoff state.
+
+Returns:
+  UINT32 - Delay in microseconds, 0 when the retry budget is exhausted.
+--*/
+UINT32
+IpmiBackoffNextDelay (
+  IN OUT IPMI_BACKOFF  *Backoff
+  );
+
+/*++
+
+Routine Description:
+  Folds an observed BMC response time into the running average.
+
+Arguments:
+  ResponseTime - Current average response time in microseconds, 0 if none yet.
+  ObservedTime - Response time observed for the last command in microseconds.
+
+Returns:
+  UINT32 - Updated average response time in microseconds.
+--*/
+UINT32
+IpmiUpdateResponseTime (
+  IN UINT32  ResponseTime,
+  IN UINT64  ObservedTime
+  );
+
+/*++
+
 Routine Description:
   Check the BMC Interface self test for the specified Interface.
 
@@ -8,6 +8,7 @@
 **/
 
 #include <Uefi/UefiBaseType.h>
+#include <Library/BaseLib.h>
 #include <Library/IoLib.h>
 #include <Library/DebugLib.h>
 #include <Library/PcdLib.h>
@@ -187,6 +188,100 @@ IpmiUpdateSoftErrorCount (
 
 /*++
 
+Routine Description:
+  Initializes the exponential backoff state for polling the BMC.
+
+Arguments:
+  Backoff  - Pointer to the backoff state.
+  MinDelay - First retry delay in microseconds.
+  MaxDelay - Upper bound of a single retry delay in microseconds.
+  Budget   - Maximum sum of all retry delays in microseconds.
+
+Returns:
+  VOID - Nothing.
+--*/
+VOID
+IpmiBackoffInit (
+  OUT IPMI_BACKOFF  *Backoff,
+  IN  UINT32        MinDelay,
+  IN  UINT32        MaxDelay,
+  IN  UINT64        Budget
+  )
+{
+  Backoff->Delay    = MAX (MinDelay, 1);
+  Backoff->MaxDelay = MAX (MaxDelay, Backoff->Delay);
+  Backoff->Elapsed  = 0;
+  Backoff->Budget   = Budget;
+}
+
+/*++
+
+Routine Description:
+  Returns the delay to wait before the next retry and doubles the delay
+  for the retry after it, up to the maximum delay.
+
+Arguments:
+  Backoff - Pointer to the backoff state.
+
+Returns:
+  UINT32 - Delay in microseconds, 0 when the retry budget is exhausted.
+--*/
+UINT32
+IpmiBackoffNextDelay (
+  IN OUT IPMI_BACKOFF  *Backoff
+  )
+{
+  UINT32  Delay;
+
+  if (Backoff->Elapsed >= Backoff->Budget) {
+    return 0;
+  }
+
+  Delay = Backoff->Delay;
+  if (Delay > Backoff->Budget - Backoff->Elapsed) {
+    Delay = (UINT32)(Backoff->Budget - Backoff->Elapsed);
+  }
+
+  Backoff->Elapsed += Delay;
+
+  if (Backoff->Delay > Backoff->MaxDelay / 2) {
+    Backoff->Delay = Backoff->MaxDelay;
+  } else {
+    Backoff->Delay *= 2;
+  }
+
+  return Delay;
+}
+
+/*++
+
+Routine Description:
+  Folds an observed BMC response time into the running average.
+  New samples are weighted 1/4 so that a single slow command does not
+  dominate the estimate.
+
+Arguments:
+  ResponseTime - Current average response time in microseconds, 0 if none yet.
+  ObservedTime - Response time observed for the last command in microseconds.
+
+Returns:
+  UINT32 - Updated average response time in microseconds.
+--*/
+UINT32
+IpmiUpdateResponseTime (
+  IN UINT32  ResponseTime,
+  IN UINT64  ObservedTime
+  )
+{
+  if (ResponseTime != 0) {
+    ObservedTime = RShiftU64 (MultU64x32 (ResponseTime, 3) + ObservedTime, 2);
+  }
+
+  return (UINT32)MIN (ObservedTime, MAX_UINT32);
+}
+
+/*++
+
 Routine Description:
   Check the BMC Interface self test for the specified Interface.
 
@@ -8,13 +8,15 @@
 **/
 
 #include <Uefi/UefiBaseType.h>
+#include <Library/BaseLib.h>
 #include <Library/DebugLib.h>
 #include <Library/TimerLib.h>
 #include <Library/BaseMemoryLib.h>
 #include <Library/BmcCommonInterfaceLib.h>
 #include <Library/BtInterfaceLib.h>
 
-#define IPMI_BT_DELAY_PER_RETRY  FixedPcdGet32 (PcdBtDelayPerRetry)
+#define IPMI_BT_DELAY_PER_RETRY      FixedPcdGet32 (PcdBtDelayPerRetry)
+#define IPMI_BT_MAX_DELAY_PER_RETRY  (IPMI_BT_DELAY_PER_RETRY * 64)
 
 /*++
 
@@ -49,6 +51,65 @@ GetBtPortAddresses (
 
 /*++
 
+Routine Description:
+  Polls the BT control register until the given bit reaches the expected
+  state. The poll interval starts at 1 microsecond and doubles up to 1/8 of
+  the average BMC response time, so fast responses are noticed quickly and
+  slow ones are not polled needlessly. The sum of the delays is bounded by
+  BtRetryCount * PcdBtDelayPerRetry, the same timeout as fixed-interval polling.
+
+Arguments:
+  Interface  - Pointer to System interface.
+  BtCtrlPort - BT control port.
+  BitMask    - Control register bit to poll.
+  BitSet     - TRUE to wait for the bit to be set, FALSE to wait for it to clear.
+  WaitTime   - Optional pointer to return the time waited in microseconds.
+
+Returns:
+  EFI_TIMEOUT - Bit did not reach the expected state in time.
+  EFI_SUCCESS - Bit reached the expected state.
+--*/
+STATIC
+EFI_STATUS
+BtWaitForControlBit (
+  IN  IPMI_SYSTEM_INTERFACE  *Interface,
+  IN  UINTN                  BtCtrlPort,
+  IN  UINT8                  BitMask,
+  IN  BOOLEAN                BitSet,
+  OUT UINT64                 *WaitTime OPTIONAL
+  )
+{
+  IPMI_BACKOFF  Backoff;
+  UINT32        Delay;
+
+  IpmiBackoffInit (
+                   &Backoff,
+                   1,
+                   MIN (
+                     MAX (Interface->Bt.BtResponseTime / 8, IPMI_BT_DELAY_PER_RETRY),
+                     IPMI_BT_MAX_DELAY_PER_RETRY
+                     ),
+                   MultU64x32 (Interface->Bt.BtRetryCount, IPMI_BT_DELAY_PER_RETRY)
+                   );
+
+  while (((IpmiBmcRead8 (Interface->Bt.AccessType, BtCtrlPort) & BitMask) != 0) != BitSet) {
+    Delay = IpmiBackoffNextDelay (&Backoff);
+    if (Delay == 0) {
+      return EFI_TIMEOUT;
+    }
+
+    MicroSecondDelay (Delay);
+  }
+
+  if (WaitTime != NULL) {
+    *WaitTime = Backoff.Elapsed;
+  }
+
+  return EFI_SUCCESS;
+}
+
+/*++
+
 Routine Description:
   Sends the command to BT interface BMC port.
 
@@ -70,18 +131,16 @@ SendDataToBtBmcPort (
   IN UINT8                  DataSize
   )
 {
+  EFI_STATUS        Status;
   UINT8             BtCntlData;
   UINT8             Index;
-  UINT32            Retry;
   UINTN             BtCtrlPort;
   UINTN             BtComBufferPort;
   IPMI_ACCESS_TYPE  AccessType;
   UINT8             TempDataSize;
   BOOLEAN           MultipleDataSend;
-  UINT32            BtRetryCount;
 
   MultipleDataSend = FALSE;
-  BtRetryCount     = Interface->Bt.BtRetryCount;
   AccessType       = Interface->Bt.AccessType;
 
   // Get Bt Ports addresses.
@@ -92,39 +151,28 @@ SendDataToBtBmcPort (
                       );
 
   do {
-    /* Wait for B_BUSY bit to clear (BMC ready to accept a request).
-       Default delay for each retry is 15 micro seconds.*/
-    for (Retry = 0; Retry < BtRetryCount; Retry++) {
-      BtCntlData = IpmiBmcRead8 (
-                                 AccessType,
-                                 BtCtrlPort
-                                 );
-      if (!(BtCntlData & IPMI_B_BUSY_BIT)) {
-        break;
-      }
-
-      MicroSecondDelay (IPMI_BT_DELAY_PER_RETRY);
-    }
-
-    if (Retry == BtRetryCount) {
-      return EFI_TIMEOUT;
+    // Wait for B_BUSY bit to clear (BMC ready to accept a request).
+    Status = BtWaitForControlBit (
+                                  Interface,
+                                  BtCtrlPort,
+                                  IPMI_B_BUSY_BIT,
+                                  FALSE,
+                                  NULL
+                                  );
+    if (EFI_ERROR (Status)) {
+      return Status;
     }
 
     // Wait for H2B_ATN bit to clear (Acknowledgment of previous commands).
-    for (Retry = 0; Retry < BtRetryCount; Retry++) {
-      BtCntlData = IpmiBmcRead8 (
-                                 AccessType,
-                                 BtCtrlPort
-                                 );
-      if (!(BtCntlData & IPMI_H2B_ATN_BIT)) {
-        break;
-      }
-
-      MicroSecondDelay (IPMI_BT_DELAY_PER_RETRY);
-    }
-
-    if (Retry == BtRetryCount) {
-      return EFI_TIMEOUT;
+    Status = BtWaitForControlBit (
+                                  Interface,
+                                  BtCtrlPort,
+                                  IPMI_H2B_ATN_BIT,
+                                  FALSE,
+                                  NULL
+                                  );
+    if (EFI_ERROR (Status)) {
+      return Status;
     }
 
     // Set CLR_WR_PTR.
@@ -165,20 +213,15 @@ SendDataToBtBmcPort (
       Data      = Data + TempDataSize;
       DataSize -= TempDataSize;
 
-      for (Retry = 0; Retry < BtRetryCount; Retry++) {
-        BtCntlData = IpmiBmcRead8 (
-                                   AccessType,
-                                   BtCtrlPort
-                                   );
-        if ((BtCntlData & IPMI_B_BUSY_BIT)) {
-          break;
-        }
-
-        MicroSecondDelay (IPMI_BT_DELAY_PER_RETRY);
-      }
-
-      if (Retry == BtRetryCount) {
-        return EFI_TIMEOUT;
+      Status = BtWaitForControlBit (
+                                    Interface,
+                                    BtCtrlPort,
+                                    IPMI_B_BUSY_BIT,
+                                    TRUE,
+                                    NULL
+                                    );
+      if (EFI_ERROR (Status)) {
+        return Status;
       }
     }
   } while (MultipleDataSend);
@@ -210,20 +253,19 @@ ReceiveBmcDataFromBtPort (
   OUT UINT8                  *DataSize
   )
 {
+  EFI_STATUS        Status;
   UINT8             BtCntlData;
   UINT8             Length;
   UINT8             TempDataSize;
   UINT8             Index;
-  UINT32            Retry;
   UINTN             BtCtrlPort;
   UINTN             BtComBufferPort;
   IPMI_ACCESS_TYPE  AccessType;
   BOOLEAN           MultipleDataReceive;
-  UINT32            BtRetryCount;
+  UINT64            WaitTime;
 
   Length              = 0;
   MultipleDataReceive = FALSE;
-  BtRetryCount        = Interface->Bt.BtRetryCount;
   AccessType          = Interface->Bt.AccessType;
 
   // Get Bt Ports addresses.
@@ -233,22 +275,24 @@ ReceiveBmcDataFromBtPort (
                       &BtComBufferPort
                       );
   do {
-    /* Wait for B2H_ATN bit to be set,signaling data is available for host.
-    Default delay for each retry is 15 micro seconds.*/
-    for (Retry = 0; Retry < BtRetryCount; Retry++) {
-      BtCntlData = IpmiBmcRead8 (
-                                 AccessType,
-                                 BtCtrlPort
-                                 );
-      if (BtCntlData & IPMI_B2H_ATN_BIT) {
-        break;
-      }
-
-      MicroSecondDelay (IPMI_BT_DELAY_PER_RETRY);
+    // Wait for B2H_ATN bit to be set,signaling data is available for host.
+    Status = BtWaitForControlBit (
+                                  Interface,
+                                  BtCtrlPort,
+                                  IPMI_B2H_ATN_BIT,
+                                  TRUE,
+                                  &WaitTime
+                                  );
+    if (EFI_ERROR (Status)) {
+      return Status;
     }
 
-    if (Retry == BtRetryCount) {
-      return EFI_TIMEOUT;
+    // Track the time the BMC takes to respond to a request.
+    if (Length == 0) {
+      Interface->Bt.BtResponseTime = IpmiUpdateResponseTime (
+                                                             Interface->Bt.BtResponseTime,
+                                                             WaitTime
+                                                             );
     }
 
     // Set H_BUSY bit, indicating host is in process of reading data from interface.
@@ -449,6 +493,9 @@ IpmiBtSendCommandToBmc (
                                      &DataSize
                                      );
 
+  // Keep the response time estimate for the next command.
+  This->Interface.Bt.BtResponseTime = Interface.Bt.BtResponseTime;
+
   if (Status != EFI_SUCCESS) {
     Interface.Bt.BtSoftErrorCount++;
     IpmiTransportReleaseLock (&Interface.Bt.BtTransportLocked);
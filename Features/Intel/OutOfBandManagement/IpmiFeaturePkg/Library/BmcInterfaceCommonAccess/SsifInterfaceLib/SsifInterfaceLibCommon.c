@@ -7,12 +7,17 @@
   SPDX-License-Identifier: BSD-2-Clause-Patent
 **/
 
+#include <Library/BaseLib.h>
 #include <Library/DebugLib.h>
 #include <Library/TimerLib.h>
 #include <Library/BaseMemoryLib.h>
 #include <Library/BmcCommonInterfaceLib.h>
 #include <Library/SsifInterfaceLib.h>
 
+// Failed SMBus transactions are retried after 1ms, doubling up to the PCD delay.
+#define IPMI_SSIF_MIN_RETRY_DELAY  1000
+#define IPMI_SSIF_RETRY_DELAY      FixedPcdGet32 (PcdSsifRequestRetriesDelay)
+
 SSIF_ALERT_PIN_CHECK  *gSsifAlertPinCheckHookList[] =
 {
   NULL
@@ -74,17 +79,24 @@ SendDataToSsifBmcPort (
   UINTN                     DataLength;
   UINT8                     DataIndex;
   BOOLEAN                   PECSupport;
-  UINT8                     RetryCount;
+  IPMI_BACKOFF              Backoff;
+  UINT32                    Delay;
   UINT8                     OriginalDataSize;
 
   DataLength                    = DataSize;
   DataIndex                     = 0;
-  RetryCount                    = 0;
   OriginalDataSize              = DataSize;
   PECSupport                    = Interface->Ssif.PecSupport;
   BmcAddress.SmbusDeviceAddress = FixedPcdGet16 (PcdSsifSlaveAddress);
   ZeroMem (IpmiData, sizeof (IpmiData));
 
+  IpmiBackoffInit (
+                   &Backoff,
+                   IPMI_SSIF_MIN_RETRY_DELAY,
+                   IPMI_SSIF_RETRY_DELAY,
+                   MultU64x32 (Interface->Ssif.SsifRetryCounter, IPMI_SSIF_RETRY_DELAY)
+                   );
+
   do {
     if (OriginalDataSize == DataSize) {
       if (DataSize <= IPMI_SMBUS_BLOCK_LENGTH) {
@@ -139,19 +151,23 @@ SendDataToSsifBmcPort (
                                    );
     if (!EFI_ERROR (Status)) {
       if (DataSize >=  IPMI_SMBUS_BLOCK_LENGTH) {
-        RetryCount = 0;
-        DataSize  -= IPMI_SMBUS_BLOCK_LENGTH;
+        IpmiBackoffInit (
+                         &Backoff,
+                         IPMI_SSIF_MIN_RETRY_DELAY,
+                         IPMI_SSIF_RETRY_DELAY,
+                         MultU64x32 (Interface->Ssif.SsifRetryCounter, IPMI_SSIF_RETRY_DELAY)
+                         );
+        DataSize -= IPMI_SMBUS_BLOCK_LENGTH;
         DataIndex++;
       } else {
         DataSize = 0;
       }
     } else {
-      if (RetryCount == Interface->Ssif.SsifRetryCounter) {
+      Delay = IpmiBackoffNextDelay (&Backoff);
+      if (Delay == 0) {
         break;
       } else {
-        RetryCount++;
-        // Failed retries delay about 60ms to 250ms.
-        MicroSecondDelay (FixedPcdGet32 (PcdSsifRequestRetriesDelay));
+        MicroSecondDelay (Delay);
 
         /* If the Multi-part write fails, then try to write the
            data from the beginning.*/
@@ -194,17 +210,39 @@ ReceiveBmcDataFromSsifPort (
   UINT8                     IpmiData[IPMI_SMBUS_BLOCK_LENGTH];
   UINTN                     DataLength;
   BOOLEAN                   PECSupport;
-  UINT8                     RetryCount;
+  IPMI_BACKOFF              Backoff;
+  UINT32                    Delay;
+  UINT32                    ResponseWait;
   UINT8                     OriginalDataSize;
 
   DataLength                    = *DataSize;
-  RetryCount                    = 0;
   OriginalDataSize              = *DataSize;
   PECSupport                    = Interface->Ssif.PecSupport;
   BmcAddress.SmbusDeviceAddress = FixedPcdGet16 (PcdSsifSlaveAddress);
   IpmiReadCommand               = IPMI_SMBUS_SINGLE_READ_CMD;
+  ResponseWait                  = 0;
+
+  /* Without SMBus alert, wait half the average response time before the first
+     read so the estimate can follow a faster BMC, then back off from there
+     while the response is not ready. The first command waits the full delay.*/
+  if (!Interface->Ssif.SmbAlertSupport) {
+    if (Interface->Ssif.SsifResponseTime == 0) {
+      ResponseWait = IPMI_SSIF_RETRY_DELAY;
+    } else {
+      ResponseWait = MIN (Interface->Ssif.SsifResponseTime / 2, IPMI_SSIF_RETRY_DELAY);
+    }
 
-  while (RetryCount <= Interface->Ssif.SsifRetryCounter) {
+    MicroSecondDelay (ResponseWait);
+  }
+
+  IpmiBackoffInit (
+                   &Backoff,
+                   IPMI_SSIF_MIN_RETRY_DELAY,
+                   IPMI_SSIF_RETRY_DELAY,
+                   MultU64x32 ((UINT32)Interface->Ssif.SsifRetryCounter + 1, IPMI_SSIF_RETRY_DELAY)
+                   );
+
+  while (TRUE) {
     Status = IpmiSmbusSendCommand (
                                    Interface,
                                    BmcAddress,
@@ -215,9 +253,12 @@ ReceiveBmcDataFromSsifPort (
                                    (VOID *)IpmiData
                                    );
     if (EFI_ERROR (Status)) {
-      RetryCount++;
-      // Failed retries delay about 60ms to 250ms.
-      MicroSecondDelay (FixedPcdGet32 (PcdSsifRequestRetriesDelay));
+      Delay = IpmiBackoffNextDelay (&Backoff);
+      if (Delay == 0) {
+        break;
+      }
+
+      MicroSecondDelay (Delay);
 
       /* If the Multi-part Read command fails, then try to read the
          data from the beginning.*/
@@ -274,6 +315,13 @@ ReceiveBmcDataFromSsifPort (
     }
   }
 
+  if (!EFI_ERROR (Status)) {
+    Interface->Ssif.SsifResponseTime = IpmiUpdateResponseTime (
+                                                               Interface->Ssif.SsifResponseTime,
+                                                               ResponseWait + Backoff.Elapsed
+                                                               );
+  }
+
   return Status;
 }
 
@@ -397,8 +445,6 @@ IpmiSsifSendCommandToBmc (
       IpmiTransportReleaseLock (&Interface.Ssif.SsifTransportLocked);
       return EFI_DEVICE_ERROR;
     }
-  } else {
-    MicroSecondDelay (FixedPcdGet32 (PcdSsifRequestRetriesDelay));
   }
 
   DataSize = IPMI_SMBUS_BLOCK_LENGTH;
@@ -409,6 +455,10 @@ IpmiSsifSendCommandToBmc (
                                        CmdDataBuffer,
                                        &DataSize
                                        );
+
+  // Keep the response time estimate for the next command.
+  This->Interface.Ssif.SsifResponseTime = Interface.Ssif.SsifResponseTime;
+
   if (Status != EFI_SUCCESS) {
     Interface.Ssif.SsifSoftErrorCount++;
     IpmiTransportReleaseLock (&Interface.Ssif.SsifTransportLocked);
@@ -0,0 +1,1311 @@
+/** @file BmcInterfaceHostTest.c
+  Host based unit test and benchmark of the BMC polling backoff in
+  BmcCommonInterfaceLib and of BtInterfaceLib and SsifInterfaceLib against
+  simulated BMCs.
+
+  @copyright
+  Copyright 2026 Intel Corporation. <BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+**/
+
+#include <Uefi.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/DebugLib.h>
+#include <Library/UnitTestLib.h>
+#include <Library/BmcCommonInterfaceLib.h>
+#include <Library/BtInterfaceLib.h>
+#include <Library/SsifInterfaceLib.h>
+#include "BmcSimClock.h"
+#include "BtBmcSim.h"
+#include "SsifBmcSim.h"
+
+#define UNIT_TEST_NAME     "BMC Interface Host Test"
+#define UNIT_TEST_VERSION  "1.0"
+
+#define BT_DELAY_PER_RETRY     FixedPcdGet32 (PcdBtDelayPerRetry)
+#define BT_BENCHMARK_COMMANDS  16
+#define BT_LEARN_COMMANDS      8
+
+#define SSIF_RETRY_DELAY         FixedPcdGet32 (PcdSsifRequestRetriesDelay)
+#define SSIF_BENCHMARK_COMMANDS  16
+#define SSIF_LEARN_COMMANDS      8
+
+//
+// Without an alert the first read waits half the learned response time, so
+// the estimate drops by at most 1/8 per command and a fast BMC is learned
+// only a few dozen commands after the full wait of the first command.
+//
+#define SSIF_SETTLE_COMMANDS  32
+
+STATIC IPMI_TRANSPORT2  mIpmiTransport2;
+
+//
+// BMC response times in microseconds used as test context.
+//
+STATIC UINT32  mFastBmc        = 50;
+STATIC UINT32  mSlowBmc        = 2000;
+STATIC UINT32  mSilentBmc      = BT_BMC_SIM_NO_RESPONSE;
+STATIC UINT32  mBenchmarkBmc[] = { 10, 100, 1000, 10000, 100000 };
+
+STATIC UINT32  mSsifFastBmc        = 2000;
+STATIC UINT32  mSsifSlowBmc        = 20000;
+STATIC UINT32  mSsifSilentBmc      = SSIF_BMC_SIM_NO_RESPONSE;
+STATIC UINT32  mSsifBenchmarkBmc[] = { 1000, 5000, 20000, 50000, 100000 };
+
+/*++
+
+Routine Description:
+  IpmiSubmitCommand2 of the test transport, sends the command over BT.
+
+Arguments:
+  See IPMI_SEND_COMMAND2.
+
+Returns:
+  Status of IpmiBtSendCommandToBmc.
+--*/
+STATIC
+EFI_STATUS
+EFIAPI
+BtSubmitCommand2 (
+  IN  IPMI_TRANSPORT2  *This,
+  IN  UINT8            NetFunction,
+  IN  UINT8            Lun,
+  IN  UINT8            Command,
+  IN  UINT8            *CommandData,
+  IN  UINT32           CommandDataSize,
+  OUT UINT8            *ResponseData,
+  OUT UINT32           *ResponseDataSize
+  )
+{
+  return IpmiBtSendCommandToBmc (
+                                 This,
+                                 NetFunction,
+                                 Lun,
+                                 Command,
+                                 CommandData,
+                                 (UINT8)CommandDataSize,
+                                 ResponseData,
+                                 (UINT8 *)ResponseDataSize,
+                                 NULL
+                                 );
+}
+
+/*++
+
+Routine Description:
+  IpmiSubmitCommand2Ex of the test transport, sends the command over BT.
+
+Arguments:
+  See IPMI_SEND_COMMAND2Ex.
+
+Returns:
+  Status of IpmiBtSendCommandToBmc.
+--*/
+STATIC
+EFI_STATUS
+EFIAPI
+BtSubmitCommand2Ex (
+  IN  IPMI_TRANSPORT2        *This,
+  IN  UINT8                  NetFunction,
+  IN  UINT8                  Lun,
+  IN  UINT8                  Command,
+  IN  UINT8                  *CommandData,
+  IN  UINT32                 CommandDataSize,
+  OUT UINT8                  *ResponseData,
+  OUT UINT32                 *ResponseDataSize,
+  IN  SYSTEM_INTERFACE_TYPE  InterfaceType
+  )
+{
+  return BtSubmitCommand2 (
+                           This,
+                           NetFunction,
+                           Lun,
+                           Command,
+                           CommandData,
+                           CommandDataSize,
+                           ResponseData,
+                           ResponseDataSize
+                           );
+}
+
+/*++
+
+Routine Description:
+  Resets the simulated BMC with the response time passed as test context
+  and sets up an initialized BT transport for it.
+
+Arguments:
+  Context - Pointer to the UINT32 BMC response time in microseconds.
+
+Returns:
+  UNIT_TEST_PASSED - The transport is ready.
+--*/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+BtTransportSetup (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  BtBmcSimReset (
+                 FixedPcdGet16 (PcdBtControlPort),
+                 FixedPcdGet16 (PcdBtBufferPort),
+                 *(UINT32 *)Context
+                 );
+
+  ZeroMem (&mIpmiTransport2, sizeof (mIpmiTransport2));
+  mIpmiTransport2.IpmiSubmitCommand2   = BtSubmitCommand2;
+  mIpmiTransport2.IpmiSubmitCommand2Ex = BtSubmitCommand2Ex;
+  mIpmiTransport2.InterfaceType        = SysInterfaceBt;
+
+  mIpmiTransport2.Interface.Bt.CtrlPort            = FixedPcdGet16 (PcdBtControlPort);
+  mIpmiTransport2.Interface.Bt.ComBuffer           = FixedPcdGet16 (PcdBtBufferPort);
+  mIpmiTransport2.Interface.Bt.BtRetryCount        = FixedPcdGet32 (PcdBtCommandRetryCounter);
+  mIpmiTransport2.Interface.Bt.HosttoBmcBufferSize = FixedPcdGet8 (PcdBtBufferSize);
+  mIpmiTransport2.Interface.Bt.BmctoHostBufferSize = FixedPcdGet8 (PcdBtBufferSize);
+  mIpmiTransport2.Interface.Bt.AccessType          = IpmiIoAccess;
+  mIpmiTransport2.Interface.Bt.InterfaceState      = IpmiInterfaceInitialized;
+
+  return UNIT_TEST_PASSED;
+}
+
+/*++
+
+Routine Description:
+  Sends a command that the simulated BMC echoes back.
+
+Arguments:
+  ResponseData     - Buffer of IPMI_MAX_BT_CMD_DATA_SIZE bytes for the response.
+  ResponseDataSize - Returns the size of the response.
+
+Returns:
+  Status of IpmiBtSendCommandToBmc.
+--*/
+STATIC
+EFI_STATUS
+BtSendEchoCommand (
+  OUT UINT8  *ResponseData,
+  OUT UINT8  *ResponseDataSize
+  )
+{
+  UINT8  CommandData[3];
+
+  CommandData[0]    = 0x11;
+  CommandData[1]    = 0x22;
+  CommandData[2]    = 0x33;
+  *ResponseDataSize = IPMI_MAX_BT_CMD_DATA_SIZE;
+
+  return IpmiBtSendCommandToBmc (
+                                 &mIpmiTransport2,
+                                 IPMI_NETFN_APP,
+                                 BMC_LUN,
+                                 IPMI_APP_GET_DEVICE_ID,
+                                 CommandData,
+                                 sizeof (CommandData),
+                                 ResponseData,
+                                 ResponseDataSize,
+                                 NULL
+                                 );
+}
+
+/*++
+
+Routine Description:
+  IpmiSubmitCommand2 of the test transport, sends the command over SSIF.
+
+Arguments:
+  See IPMI_SEND_COMMAND2.
+
+Returns:
+  Status of IpmiSsifSendCommandToBmc.
+--*/
+STATIC
+EFI_STATUS
+EFIAPI
+SsifSubmitCommand2 (
+  IN  IPMI_TRANSPORT2  *This,
+  IN  UINT8            NetFunction,
+  IN  UINT8            Lun,
+  IN  UINT8            Command,
+  IN  UINT8            *CommandData,
+  IN  UINT32           CommandDataSize,
+  OUT UINT8            *ResponseData,
+  OUT UINT32           *ResponseDataSize
+  )
+{
+  return IpmiSsifSendCommandToBmc (
+                                   This,
+                                   NetFunction,
+                                   Lun,
+                                   Command,
+                                   CommandData,
+                                   (UINT8)CommandDataSize,
+                                   ResponseData,
+                                   (UINT8 *)ResponseDataSize,
+                                   NULL
+                                   );
+}
+
+/*++
+
+Routine Description:
+  IpmiSubmitCommand2Ex of the test transport, sends the command over SSIF.
+
+Arguments:
+  See IPMI_SEND_COMMAND2Ex.
+
+Returns:
+  Status of IpmiSsifSendCommandToBmc.
+--*/
+STATIC
+EFI_STATUS
+EFIAPI
+SsifSubmitCommand2Ex (
+  IN  IPMI_TRANSPORT2        *This,
+  IN  UINT8                  NetFunction,
+  IN  UINT8                  Lun,
+  IN  UINT8                  Command,
+  IN  UINT8                  *CommandData,
+  IN  UINT32                 CommandDataSize,
+  OUT UINT8                  *ResponseData,
+  OUT UINT32                 *ResponseDataSize,
+  IN  SYSTEM_INTERFACE_TYPE  InterfaceType
+  )
+{
+  return SsifSubmitCommand2 (
+                             This,
+                             NetFunction,
+                             Lun,
+                             Command,
+                             CommandData,
+                             CommandDataSize,
+                             ResponseData,
+                             ResponseDataSize
+                             );
+}
+
+/*++
+
+Routine Description:
+  Resets the simulated SSIF BMC with the response time passed as test
+  context and sets up an initialized SSIF transport for it.
+
+Arguments:
+  Context - Pointer to the UINT32 BMC response time in microseconds.
+
+Returns:
+  UNIT_TEST_PASSED - The transport is ready.
+--*/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+SsifTransportSetup (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  SsifBmcSimReset (FixedPcdGet16 (PcdSsifSlaveAddress), *(UINT32 *)Context);
+
+  ZeroMem (&mIpmiTransport2, sizeof (mIpmiTransport2));
+  mIpmiTransport2.IpmiSubmitCommand2   = SsifSubmitCommand2;
+  mIpmiTransport2.IpmiSubmitCommand2Ex = SsifSubmitCommand2Ex;
+  mIpmiTransport2.InterfaceType        = SysInterfaceSsif;
+
+  mIpmiTransport2.Interface.Ssif.SsifRetryCounter = FixedPcdGet16 (PcdSsifCommandtRetryCounter);
+  mIpmiTransport2.Interface.Ssif.RwSupport        = SsifSinglePartRw;
+  mIpmiTransport2.Interface.Ssif.InterfaceState   = IpmiInterfaceInitialized;
+
+  return UNIT_TEST_PASSED;
+}
+
+/*++
+
+Routine Description:
+  Sends a command that the simulated SSIF BMC echoes back.
+
+Arguments:
+  ResponseData     - Buffer of IPMI_MAX_SSIF_CMD_DATA_SIZE bytes for the response.
+  ResponseDataSize - Returns the size of the response.
+
+Returns:
+  Status of IpmiSsifSendCommandToBmc.
+--*/
+STATIC
+EFI_STATUS
+SsifSendEchoCommand (
+  OUT UINT8  *ResponseData,
+  OUT UINT8  *ResponseDataSize
+  )
+{
+  UINT8  CommandData[3];
+
+  CommandData[0]    = 0x11;
+  CommandData[1]    = 0x22;
+  CommandData[2]    = 0x33;
+  *ResponseDataSize = IPMI_MAX_SSIF_CMD_DATA_SIZE;
+
+  return IpmiSsifSendCommandToBmc (
+                                   &mIpmiTransport2,
+                                   IPMI_NETFN_APP,
+                                   BMC_LUN,
+                                   IPMI_APP_GET_DEVICE_ID,
+                                   CommandData,
+                                   sizeof (CommandData),
+                                   ResponseData,
+                                   ResponseDataSize,
+                                   NULL
+                                   );
+}
+
+/*++
+
+Routine Description:
+  The backoff doubles the delay up to the maximum delay.
+
+Arguments:
+  Context - Unused.
+
+Returns:
+  UNIT_TEST_PASSED - The test passed.
+--*/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+BackoffDoublesUpToMaxDelay (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  IPMI_BACKOFF  Backoff;
+  UINT32        Expected[] = { 1, 2, 4, 8, 12, 12, 12 };
+  UINTN         Index;
+
+  IpmiBackoffInit (&Backoff, 1, 12, 1000);
+  for (Index = 0; Index < ARRAY_SIZE (Expected); Index++) {
+    UT_ASSERT_EQUAL (IpmiBackoffNextDelay (&Backoff), Expected[Index]);
+  }
+
+  UT_ASSERT_EQUAL (Backoff.Elapsed, 51);
+
+  //
+  // A zero first delay starts at 1 and a maximum below the first delay
+  // keeps the delay constant.
+  //
+  IpmiBackoffInit (&Backoff, 0, 0, 1000);
+  UT_ASSERT_EQUAL (IpmiBackoffNextDelay (&Backoff), 1);
+  UT_ASSERT_EQUAL (IpmiBackoffNextDelay (&Backoff), 1);
+
+  IpmiBackoffInit (&Backoff, 100, 10, 1000);
+  UT_ASSERT_EQUAL (IpmiBackoffNextDelay (&Backoff), 100);
+  UT_ASSERT_EQUAL (IpmiBackoffNextDelay (&Backoff), 100);
+
+  //
+  // Doubling does not overflow near MAX_UINT32.
+  //
+  IpmiBackoffInit (&Backoff, BIT31, MAX_UINT32, MAX_UINT64);
+  UT_ASSERT_EQUAL (IpmiBackoffNextDelay (&Backoff), BIT31);
+  UT_ASSERT_EQUAL (IpmiBackoffNextDelay (&Backoff), MAX_UINT32);
+  UT_ASSERT_EQUAL (IpmiBackoffNextDelay (&Backoff), MAX_UINT32);
+
+  return UNIT_TEST_PASSED;
+}
+
+/*++
+
+Routine Description:
+  The backoff clamps the last delay to the remaining budget and returns 0
+  once the budget is exhausted.
+
+Arguments:
+  Context - Unused.
+
+Returns:
+  UNIT_TEST_PASSED - The test passed.
+--*/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+BackoffStopsAtBudget (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  IPMI_BACKOFF  Backoff;
+
+  IpmiBackoffInit (&Backoff, 4, 8, 20);
+  UT_ASSERT_EQUAL (IpmiBackoffNextDelay (&Backoff), 4);
+  UT_ASSERT_EQUAL (IpmiBackoffNextDelay (&Backoff), 8);
+  UT_ASSERT_EQUAL (IpmiBackoffNextDelay (&Backoff), 8);
+  UT_ASSERT_EQUAL (IpmiBackoffNextDelay (&Backoff), 0);
+  UT_ASSERT_EQUAL (Backoff.Elapsed, 20);
+
+  IpmiBackoffInit (&Backoff, 4, 8, 18);
+  UT_ASSERT_EQUAL (IpmiBackoffNextDelay (&Backoff), 4);
+  UT_ASSERT_EQUAL (IpmiBackoffNextDelay (&Backoff), 8);
+  UT_ASSERT_EQUAL (IpmiBackoffNextDelay (&Backoff), 6);
+  UT_ASSERT_EQUAL (IpmiBackoffNextDelay (&Backoff), 0);
+  UT_ASSERT_EQUAL (IpmiBackoffNextDelay (&Backoff), 0);
+  UT_ASSERT_EQUAL (Backoff.Elapsed, 18);
+
+  IpmiBackoffInit (&Backoff, 4, 8, 0);
+  UT_ASSERT_EQUAL (IpmiBackoffNextDelay (&Backoff), 0);
+
+  return UNIT_TEST_PASSED;
+}
+
+/*++
+
+Routine Description:
+  The response time average starts at the first sample and weights later
+  samples 1/4.
+
+Arguments:
+  Context - Unused.
+
+Returns:
+  UNIT_TEST_PASSED - The test passed.
+--*/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+ResponseTimeAverage (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  UT_ASSERT_EQUAL (IpmiUpdateResponseTime (0, 1000), 1000);
+  UT_ASSERT_EQUAL (IpmiUpdateResponseTime (1000, 2000), 1250);
+  UT_ASSERT_EQUAL (IpmiUpdateResponseTime (1000, 0), 750);
+  UT_ASSERT_EQUAL (IpmiUpdateResponseTime (0, LShiftU64 (1, 40)), MAX_UINT32);
+  UT_ASSERT_EQUAL (IpmiUpdateResponseTime (MAX_UINT32, MAX_UINT32), MAX_UINT32);
+
+  return UNIT_TEST_PASSED;
+}
+
+/*++
+
+Routine Description:
+  A command is framed on the BT interface and the response is returned.
+
+Arguments:
+  Context - Unused.
+
+Returns:
+  UNIT_TEST_PASSED - The test passed.
+--*/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+BtSendCommandRoundTrip (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  EFI_STATUS  Status;
+  UINT8       ResponseData[IPMI_MAX_BT_CMD_DATA_SIZE];
+  UINT8       ResponseDataSize;
+  UINT8       *Request;
+  UINTN       RequestSize;
+  UINT8       ExpectedRequest[]  = { 6, IPMI_NETFN_APP << 2, 0, IPMI_APP_GET_DEVICE_ID, 0x11, 0x22, 0x33 };
+  UINT8       ExpectedResponse[] = { IPMI_COMPLETION_CODE_SUCCESS, 0x11, 0x22, 0x33 };
+
+  Status = BtSendEchoCommand (ResponseData, &ResponseDataSize);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+
+  Request = BtBmcSimLastRequest (&RequestSize);
+  UT_ASSERT_EQUAL (RequestSize, sizeof (ExpectedRequest));
+  UT_ASSERT_MEM_EQUAL (Request, ExpectedRequest, sizeof (ExpectedRequest));
+
+  UT_ASSERT_EQUAL (ResponseDataSize, sizeof (ExpectedResponse));
+  UT_ASSERT_MEM_EQUAL (ResponseData, ExpectedResponse, sizeof (ExpectedResponse));
+
+  UT_ASSERT_EQUAL (BtBmcSimStats ()->Requests, 1);
+  UT_ASSERT_TRUE (mIpmiTransport2.Interface.Bt.BtResponseTime >= mFastBmc);
+  UT_ASSERT_FALSE (mIpmiTransport2.Interface.Bt.BtTransportLocked);
+
+  return UNIT_TEST_PASSED;
+}
+
+/*++
+
+Routine Description:
+  InitBtInterfaceData runs the self test and reads the BT interface
+  capabilities from the BMC.
+
+Arguments:
+  Context - Unused.
+
+Returns:
+  UNIT_TEST_PASSED - The test passed.
+--*/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+BtInitInterfaceData (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  EFI_STATUS  Status;
+
+  ZeroMem (&mIpmiTransport2.Interface, sizeof (mIpmiTransport2.Interface));
+
+  Status = InitBtInterfaceData (&mIpmiTransport2);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+  UT_ASSERT_EQUAL (mIpmiTransport2.Interface.Bt.InterfaceState, IpmiInterfaceInitialized);
+  UT_ASSERT_EQUAL (mIpmiTransport2.Interface.Bt.HosttoBmcBufferSize, 0x40);
+  UT_ASSERT_EQUAL (mIpmiTransport2.Interface.Bt.BmctoHostBufferSize, 0x40);
+  UT_ASSERT_EQUAL (BtBmcSimStats ()->Requests, 2);
+
+  return UNIT_TEST_PASSED;
+}
+
+/*++
+
+Routine Description:
+  The transport learns the BMC response time and polls a slow BMC less
+  often once it has.
+
+Arguments:
+  Context - Unused.
+
+Returns:
+  UNIT_TEST_PASSED - The test passed.
+--*/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+BtResponseTimeIsLearned (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  EFI_STATUS        Status;
+  UINT8             ResponseData[IPMI_MAX_BT_CMD_DATA_SIZE];
+  UINT8             ResponseDataSize;
+  BT_BMC_SIM_STATS  *Stats;
+  UINT64            FirstPolls;
+  UINT64            Polls;
+  UINTN             Index;
+
+  Stats  = BtBmcSimStats ();
+  Status = BtSendEchoCommand (ResponseData, &ResponseDataSize);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+  FirstPolls = Stats->CtrlPolls;
+
+  for (Index = 1; Index < BT_LEARN_COMMANDS; Index++) {
+    Polls  = Stats->CtrlPolls;
+    Status = BtSendEchoCommand (ResponseData, &ResponseDataSize);
+    UT_ASSERT_NOT_EFI_ERROR (Status);
+    Polls = Stats->CtrlPolls - Polls;
+  }
+
+  UT_LOG_INFO ("Polls for the first command %ld, after learning %ld\n", FirstPolls, Polls);
+
+  UT_ASSERT_TRUE (mIpmiTransport2.Interface.Bt.BtResponseTime >= mSlowBmc);
+  UT_ASSERT_TRUE (mIpmiTransport2.Interface.Bt.BtResponseTime <= mSlowBmc + mSlowBmc / 8);
+  UT_ASSERT_TRUE (Polls * 4 < FirstPolls);
+
+  return UNIT_TEST_PASSED;
+}
+
+/*++
+
+Routine Description:
+  The learned response time follows the BMC when its response time steps
+  up and back down.
+
+Arguments:
+  Context - Unused.
+
+Returns:
+  UNIT_TEST_PASSED - The test passed.
+--*/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+BtResponseTimeFollowsBmc (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  EFI_STATUS  Status;
+  UINT8       ResponseData[IPMI_MAX_BT_CMD_DATA_SIZE];
+  UINT8       ResponseDataSize;
+  UINT32      Script[2 * BT_LEARN_COMMANDS];
+  UINT32      SlowResponseTime;
+  UINTN       Index;
+
+  for (Index = 0; Index < BT_LEARN_COMMANDS; Index++) {
+    Script[Index]                     = mSlowBmc;
+    Script[BT_LEARN_COMMANDS + Index] = mFastBmc;
+  }
+
+  BtBmcSimSetResponseScript (Script, ARRAY_SIZE (Script));
+
+  for (Index = 0; Index < BT_LEARN_COMMANDS; Index++) {
+    Status = BtSendEchoCommand (ResponseData, &ResponseDataSize);
+    UT_ASSERT_NOT_EFI_ERROR (Status);
+  }
+
+  SlowResponseTime = mIpmiTransport2.Interface.Bt.BtResponseTime;
+
+  for (Index = 0; Index < BT_LEARN_COMMANDS; Index++) {
+    Status = BtSendEchoCommand (ResponseData, &ResponseDataSize);
+    UT_ASSERT_NOT_EFI_ERROR (Status);
+  }
+
+  UT_LOG_INFO (
+    "Response time learned for a %dus BMC %dus, for a %dus BMC %dus\n",
+    mSlowBmc,
+    SlowResponseTime,
+    mFastBmc,
+    mIpmiTransport2.Interface.Bt.BtResponseTime
+    );
+
+  UT_ASSERT_TRUE (SlowResponseTime >= mSlowBmc);
+  UT_ASSERT_TRUE (SlowResponseTime <= mSlowBmc + mSlowBmc / 8);
+  UT_ASSERT_TRUE (mIpmiTransport2.Interface.Bt.BtResponseTime < mSlowBmc / 4);
+  UT_ASSERT_EQUAL (BtBmcSimStats ()->Requests, 2 * BT_LEARN_COMMANDS);
+
+  return UNIT_TEST_PASSED;
+}
+
+/*++
+
+Routine Description:
+  A BMC that never responds times out after BtRetryCount * PcdBtDelayPerRetry.
+
+Arguments:
+  Context - Unused.
+
+Returns:
+  UNIT_TEST_PASSED - The test passed.
+--*/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+BtNoResponseTimesOut (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  EFI_STATUS  Status;
+  UINT8       ResponseData[IPMI_MAX_BT_CMD_DATA_SIZE];
+  UINT8       ResponseDataSize;
+
+  Status = BtSendEchoCommand (ResponseData, &ResponseDataSize);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_TIMEOUT);
+  UT_ASSERT_EQUAL (
+    BmcSimClockNow (),
+    MultU64x32 (mIpmiTransport2.Interface.Bt.BtRetryCount, BT_DELAY_PER_RETRY)
+    );
+  UT_ASSERT_FALSE (mIpmiTransport2.Interface.Bt.BtTransportLocked);
+
+  return UNIT_TEST_PASSED;
+}
+
+/*++
+
+Routine Description:
+  Sends BT_BENCHMARK_COMMANDS commands once the response time is learned
+  and reports the control register polls and the time between the response
+  being ready and it being noticed, next to fixed PcdBtDelayPerRetry polling.
+
+Arguments:
+  Context - Pointer to the UINT32 BMC response time in microseconds.
+
+Returns:
+  UNIT_TEST_PASSED - The detection latency is within bounds.
+--*/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+BtPollingBenchmark (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  EFI_STATUS        Status;
+  UINT8             ResponseData[IPMI_MAX_BT_CMD_DATA_SIZE];
+  UINT8             ResponseDataSize;
+  BT_BMC_SIM_STATS  *Stats;
+  BT_BMC_SIM_STATS  Start;
+  UINT32            ResponseTime;
+  UINT64            Polls;
+  UINT64            DetectTime;
+  UINT64            FixedPolls;
+  UINTN             Index;
+
+  ResponseTime = *(UINT32 *)Context;
+  Stats        = BtBmcSimStats ();
+
+  Status = BtSendEchoCommand (ResponseData, &ResponseDataSize);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+
+  CopyMem (&Start, Stats, sizeof (Start));
+  for (Index = 0; Index < BT_BENCHMARK_COMMANDS; Index++) {
+    Status = BtSendEchoCommand (ResponseData, &ResponseDataSize);
+    UT_ASSERT_NOT_EFI_ERROR (Status);
+  }
+
+  Polls      = DivU64x32 (Stats->CtrlPolls - Start.CtrlPolls, BT_BENCHMARK_COMMANDS);
+  DetectTime = DivU64x32 (Stats->DetectTime - Start.DetectTime, BT_BENCHMARK_COMMANDS);
+  FixedPolls = (ResponseTime + BT_DELAY_PER_RETRY - 1) / BT_DELAY_PER_RETRY;
+
+  UT_LOG_INFO (
+    "%dus BMC: %ld control polls and %ldus detection latency per command (%ld polls and %ldus with %dus polling)\n",
+    ResponseTime,
+    Polls,
+    DetectTime,
+    FixedPolls + 5,
+    FixedPolls * BT_DELAY_PER_RETRY - ResponseTime,
+    BT_DELAY_PER_RETRY
+    );
+
+  UT_ASSERT_TRUE (DetectTime <= MIN (MAX (ResponseTime / 4, BT_DELAY_PER_RETRY), BT_DELAY_PER_RETRY * 64));
+
+  return UNIT_TEST_PASSED;
+}
+
+/*++
+
+Routine Description:
+  A command is written to the SSIF BMC and the response is read back.
+
+Arguments:
+  Context - Unused.
+
+Returns:
+  UNIT_TEST_PASSED - The test passed.
+--*/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+SsifSendCommandRoundTrip (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  EFI_STATUS          Status;
+  UINT8               ResponseData[IPMI_MAX_SSIF_CMD_DATA_SIZE];
+  UINT8               ResponseDataSize;
+  UINT8               *Request;
+  UINTN               RequestSize;
+  SSIF_BMC_SIM_STATS  *Stats;
+  UINT8               ExpectedRequest[]  = { IPMI_NETFN_APP << 2, IPMI_APP_GET_DEVICE_ID, 0x11, 0x22, 0x33 };
+  UINT8               ExpectedResponse[] = { IPMI_COMPLETION_CODE_SUCCESS, 0x11, 0x22, 0x33 };
+
+  Status = SsifSendEchoCommand (ResponseData, &ResponseDataSize);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+
+  Request = SsifBmcSimLastRequest (&RequestSize);
+  UT_ASSERT_EQUAL (RequestSize, sizeof (ExpectedRequest));
+  UT_ASSERT_MEM_EQUAL (Request, ExpectedRequest, sizeof (ExpectedRequest));
+
+  UT_ASSERT_EQUAL (ResponseDataSize, sizeof (ExpectedResponse));
+  UT_ASSERT_MEM_EQUAL (ResponseData, ExpectedResponse, sizeof (ExpectedResponse));
+
+  //
+  // The first command waits the full retry delay, so the response is read
+  // without being NACKed.
+  //
+  Stats = SsifBmcSimStats ();
+  UT_ASSERT_EQUAL (Stats->Requests, 1);
+  UT_ASSERT_EQUAL (Stats->Writes, 1);
+  UT_ASSERT_EQUAL (Stats->Reads, 1);
+  UT_ASSERT_EQUAL (Stats->Nacks, 0);
+  UT_ASSERT_EQUAL (mIpmiTransport2.Interface.Ssif.SsifResponseTime, SSIF_RETRY_DELAY);
+
+  return UNIT_TEST_PASSED;
+}
+
+/*++
+
+Routine Description:
+  Requests and responses longer than one SMBus block are sent in
+  multi-part writes and reads.
+
+Arguments:
+  Context - Unused.
+
+Returns:
+  UNIT_TEST_PASSED - The test passed.
+--*/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+SsifMultiPartRoundTrip (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  EFI_STATUS          Status;
+  UINT8               CommandData[40];
+  UINT8               ResponseData[IPMI_MAX_SSIF_CMD_DATA_SIZE];
+  UINT8               ResponseDataSize;
+  UINT8               *Request;
+  UINTN               RequestSize;
+  SSIF_BMC_SIM_STATS  *Stats;
+  UINTN               Index;
+
+  for (Index = 0; Index < sizeof (CommandData); Index++) {
+    CommandData[Index] = (UINT8)Index;
+  }
+
+  mIpmiTransport2.Interface.Ssif.RwSupport = SsifMultiPartRw;
+  ResponseDataSize                         = sizeof (ResponseData);
+
+  Status = IpmiSsifSendCommandToBmc (
+                                     &mIpmiTransport2,
+                                     IPMI_NETFN_APP,
+                                     BMC_LUN,
+                                     IPMI_APP_GET_DEVICE_ID,
+                                     CommandData,
+                                     sizeof (CommandData),
+                                     ResponseData,
+                                     &ResponseDataSize,
+                                     NULL
+                                     );
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+
+  Request = SsifBmcSimLastRequest (&RequestSize);
+  UT_ASSERT_EQUAL (RequestSize, sizeof (CommandData) + 2);
+  UT_ASSERT_MEM_EQUAL (&Request[2], CommandData, sizeof (CommandData));
+
+  UT_ASSERT_EQUAL (ResponseDataSize, sizeof (CommandData) + 1);
+  UT_ASSERT_EQUAL (ResponseData[0], IPMI_COMPLETION_CODE_SUCCESS);
+  UT_ASSERT_MEM_EQUAL (&ResponseData[1], CommandData, sizeof (CommandData));
+
+  Stats = SsifBmcSimStats ();
+  UT_ASSERT_EQUAL (Stats->Requests, 1);
+  UT_ASSERT_EQUAL (Stats->Writes, 2);
+  UT_ASSERT_EQUAL (Stats->Reads, 2);
+
+  return UNIT_TEST_PASSED;
+}
+
+/*++
+
+Routine Description:
+  InitSsifInterfaceData runs the self test and reads the SSIF capabilities
+  and global enables from the BMC.
+
+Arguments:
+  Context - Unused.
+
+Returns:
+  UNIT_TEST_PASSED - The test passed.
+--*/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+SsifInitInterfaceData (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  EFI_STATUS  Status;
+
+  ZeroMem (&mIpmiTransport2.Interface, sizeof (mIpmiTransport2.Interface));
+
+  Status = InitSsifInterfaceData (&mIpmiTransport2);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+  UT_ASSERT_EQUAL (mIpmiTransport2.Interface.Ssif.InterfaceState, IpmiInterfaceInitialized);
+  UT_ASSERT_EQUAL (mIpmiTransport2.Interface.Ssif.SsifRetryCounter, FixedPcdGet16 (PcdSsifCommandtRetryCounter));
+  UT_ASSERT_EQUAL (mIpmiTransport2.Interface.Ssif.RwSupport, SsifMultiPartRw);
+  UT_ASSERT_FALSE (mIpmiTransport2.Interface.Ssif.PecSupport);
+  UT_ASSERT_FALSE (mIpmiTransport2.Interface.Ssif.SmbAlertSupport);
+  UT_ASSERT_EQUAL (SsifBmcSimStats ()->Requests, 3);
+
+  return UNIT_TEST_PASSED;
+}
+
+/*++
+
+Routine Description:
+  The transport learns the SSIF BMC response time and, once it has, reads
+  the response shortly after it is ready instead of after the full retry
+  delay.
+
+Arguments:
+  Context - Unused.
+
+Returns:
+  UNIT_TEST_PASSED - The test passed.
+--*/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+SsifResponseTimeIsLearned (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  EFI_STATUS          Status;
+  UINT8               ResponseData[IPMI_MAX_SSIF_CMD_DATA_SIZE];
+  UINT8               ResponseDataSize;
+  SSIF_BMC_SIM_STATS  *Stats;
+  UINT64              FirstTime;
+  UINT64              Time;
+  UINT64              Reads;
+  UINTN               Index;
+
+  Stats  = SsifBmcSimStats ();
+  Status = SsifSendEchoCommand (ResponseData, &ResponseDataSize);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+  FirstTime = BmcSimClockNow ();
+
+  for (Index = 1; Index < SSIF_LEARN_COMMANDS; Index++) {
+    Time   = BmcSimClockNow ();
+    Reads  = Stats->Reads;
+    Status = SsifSendEchoCommand (ResponseData, &ResponseDataSize);
+    UT_ASSERT_NOT_EFI_ERROR (Status);
+    Time  = BmcSimClockNow () - Time;
+    Reads = Stats->Reads - Reads;
+  }
+
+  UT_LOG_INFO (
+    "Time for the first command %ldus, after learning %ldus with %ld reads, response time %dus\n",
+    FirstTime,
+    Time,
+    Reads,
+    mIpmiTransport2.Interface.Ssif.SsifResponseTime
+    );
+
+  UT_ASSERT_TRUE (mIpmiTransport2.Interface.Ssif.SsifResponseTime >= mSsifSlowBmc);
+  UT_ASSERT_TRUE (mIpmiTransport2.Interface.Ssif.SsifResponseTime <= mSsifSlowBmc + mSsifSlowBmc / 2);
+  UT_ASSERT_TRUE (Time <= mSsifSlowBmc + mSsifSlowBmc / 2);
+  UT_ASSERT_TRUE (Reads <= 6);
+
+  return UNIT_TEST_PASSED;
+}
+
+/*++
+
+Routine Description:
+  The learned SSIF response time follows the BMC when its response time
+  steps up and back down.
+
+Arguments:
+  Context - Unused.
+
+Returns:
+  UNIT_TEST_PASSED - The test passed.
+--*/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+SsifResponseTimeFollowsBmc (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  EFI_STATUS  Status;
+  UINT8       ResponseData[IPMI_MAX_SSIF_CMD_DATA_SIZE];
+  UINT8       ResponseDataSize;
+  UINT32      Script[2 * SSIF_LEARN_COMMANDS];
+  UINT32      SlowResponseTime;
+  UINTN       Index;
+
+  for (Index = 0; Index < SSIF_LEARN_COMMANDS; Index++) {
+    Script[Index]                       = mSsifSlowBmc;
+    Script[SSIF_LEARN_COMMANDS + Index] = mSsifFastBmc;
+  }
+
+  SsifBmcSimSetResponseScript (Script, ARRAY_SIZE (Script));
+
+  for (Index = 0; Index < SSIF_LEARN_COMMANDS; Index++) {
+    Status = SsifSendEchoCommand (ResponseData, &ResponseDataSize);
+    UT_ASSERT_NOT_EFI_ERROR (Status);
+  }
+
+  SlowResponseTime = mIpmiTransport2.Interface.Ssif.SsifResponseTime;
+
+  for (Index = 0; Index < SSIF_LEARN_COMMANDS; Index++) {
+    Status = SsifSendEchoCommand (ResponseData, &ResponseDataSize);
+    UT_ASSERT_NOT_EFI_ERROR (Status);
+  }
+
+  UT_LOG_INFO (
+    "Response time learned for a %dus BMC %dus, for a %dus BMC %dus\n",
+    mSsifSlowBmc,
+    SlowResponseTime,
+    mSsifFastBmc,
+    mIpmiTransport2.Interface.Ssif.SsifResponseTime
+    );
+
+  UT_ASSERT_TRUE (SlowResponseTime >= mSsifSlowBmc);
+  UT_ASSERT_TRUE (SlowResponseTime <= mSsifSlowBmc + mSsifSlowBmc / 2);
+  UT_ASSERT_TRUE (mIpmiTransport2.Interface.Ssif.SsifResponseTime < SlowResponseTime / 2);
+  UT_ASSERT_EQUAL (SsifBmcSimStats ()->Requests, 2 * SSIF_LEARN_COMMANDS);
+
+  return UNIT_TEST_PASSED;
+}
+
+/*++
+
+Routine Description:
+  A BMC that never responds fails the read after the first wait and the
+  (SsifRetryCounter + 1) * PcdSsifRequestRetriesDelay read budget.
+
+Arguments:
+  Context - Unused.
+
+Returns:
+  UNIT_TEST_PASSED - The test passed.
+--*/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+SsifNoResponseTimesOut (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  EFI_STATUS          Status;
+  UINT8               ResponseData[IPMI_MAX_SSIF_CMD_DATA_SIZE];
+  UINT8               ResponseDataSize;
+  SSIF_BMC_SIM_STATS  *Stats;
+
+  Status = SsifSendEchoCommand (ResponseData, &ResponseDataSize);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_DEVICE_ERROR);
+  UT_ASSERT_EQUAL (
+    BmcSimClockNow (),
+    SSIF_RETRY_DELAY + MultU64x32 (mIpmiTransport2.Interface.Ssif.SsifRetryCounter + 1, SSIF_RETRY_DELAY)
+    );
+
+  Stats = SsifBmcSimStats ();
+  UT_ASSERT_EQUAL (Stats->Requests, 1);
+  UT_ASSERT_EQUAL (Stats->Nacks, Stats->Reads);
+  UT_ASSERT_EQUAL (mIpmiTransport2.Interface.Ssif.SsifResponseTime, 0);
+
+  return UNIT_TEST_PASSED;
+}
+
+/*++
+
+Routine Description:
+  A BMC that NACKs its address fails the write after the
+  SsifRetryCounter * PcdSsifRequestRetriesDelay write budget.
+
+Arguments:
+  Context - Unused.
+
+Returns:
+  UNIT_TEST_PASSED - The test passed.
+--*/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+SsifNoBmcTimesOut (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  EFI_STATUS          Status;
+  UINT8               ResponseData[IPMI_MAX_SSIF_CMD_DATA_SIZE];
+  UINT8               ResponseDataSize;
+  SSIF_BMC_SIM_STATS  *Stats;
+
+  SsifBmcSimSetPresent (FALSE);
+
+  Status = SsifSendEchoCommand (ResponseData, &ResponseDataSize);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_DEVICE_ERROR);
+  UT_ASSERT_EQUAL (
+    BmcSimClockNow (),
+    MultU64x32 (mIpmiTransport2.Interface.Ssif.SsifRetryCounter, SSIF_RETRY_DELAY)
+    );
+
+  Stats = SsifBmcSimStats ();
+  UT_ASSERT_EQUAL (Stats->Requests, 0);
+  UT_ASSERT_EQUAL (Stats->Reads, 0);
+  UT_ASSERT_EQUAL (Stats->Nacks, Stats->Writes);
+
+  return UNIT_TEST_PASSED;
+}
+
+/*++
+
+Routine Description:
+  Sends SSIF_BENCHMARK_COMMANDS commands through IpmiSsifSendCommandToBmc
+  once the response time is learned and reports the reads, the NACKs, the
+  time per command and the time between the response being ready and it
+  being read, next to a fixed PcdSsifRequestRetriesDelay wait before each
+  read.
+
+Arguments:
+  Context - Pointer to the UINT32 BMC response time in microseconds.
+
+Returns:
+  UNIT_TEST_PASSED - The detection latency is within bounds.
+--*/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+SsifPollingBenchmark (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  EFI_STATUS          Status;
+  UINT8               ResponseData[IPMI_MAX_SSIF_CMD_DATA_SIZE];
+  UINT8               ResponseDataSize;
+  SSIF_BMC_SIM_STATS  *Stats;
+  SSIF_BMC_SIM_STATS  Start;
+  UINT64              StartTime;
+  UINT32              ResponseTime;
+  UINT64              Reads;
+  UINT64              Nacks;
+  UINT64              Time;
+  UINT64              DetectTime;
+  UINT64              FixedReads;
+  UINTN               Index;
+
+  ResponseTime = *(UINT32 *)Context;
+  Stats        = SsifBmcSimStats ();
+
+  for (Index = 0; Index < SSIF_SETTLE_COMMANDS; Index++) {
+    Status = SsifSendEchoCommand (ResponseData, &ResponseDataSize);
+    UT_ASSERT_NOT_EFI_ERROR (Status);
+  }
+
+  CopyMem (&Start, Stats, sizeof (Start));
+  StartTime = BmcSimClockNow ();
+  for (Index = 0; Index < SSIF_BENCHMARK_COMMANDS; Index++) {
+    Status = SsifSendEchoCommand (ResponseData, &ResponseDataSize);
+    UT_ASSERT_NOT_EFI_ERROR (Status);
+  }
+
+  Reads      = DivU64x32 (Stats->Reads - Start.Reads, SSIF_BENCHMARK_COMMANDS);
+  Nacks      = DivU64x32 (Stats->Nacks - Start.Nacks, SSIF_BENCHMARK_COMMANDS);
+  Time       = DivU64x32 (BmcSimClockNow () - StartTime, SSIF_BENCHMARK_COMMANDS);
+  DetectTime = DivU64x32 (Stats->DetectTime - Start.DetectTime, SSIF_BENCHMARK_COMMANDS);
+  FixedReads = (ResponseTime + SSIF_RETRY_DELAY - 1) / SSIF_RETRY_DELAY;
+
+  UT_LOG_INFO (
+    "%dus BMC: %ld reads (%ld NACKed), %ldus and %ldus detection latency per command (%ld reads, %ldus and %ldus with a %dus wait)\n",
+    ResponseTime,
+    Reads,
+    Nacks,
+    Time,
+    DetectTime,
+    FixedReads,
+    FixedReads * SSIF_RETRY_DELAY,
+    FixedReads * SSIF_RETRY_DELAY - ResponseTime,
+    SSIF_RETRY_DELAY
+    );
+
+  UT_ASSERT_TRUE (DetectTime <= MIN (ResponseTime / 2 + 1000, SSIF_RETRY_DELAY));
+
+  return UNIT_TEST_PASSED;
+}
+
+/*++
+
+Routine Description:
+  Initializes the unit test framework, suites and test cases, and runs them.
+
+Arguments:
+  None.
+
+Returns:
+  EFI_SUCCESS          - All test cases were dispatched.
+  EFI_OUT_OF_RESOURCES - There are not enough resources available to
+                         initialize the unit tests.
+--*/
+STATIC
+EFI_STATUS
+EFIAPI
+UnitTestingEntry (
+  VOID
+  )
+{
+  EFI_STATUS                  Status;
+  UNIT_TEST_FRAMEWORK_HANDLE  Framework;
+  UNIT_TEST_SUITE_HANDLE      BackoffTests;
+  UNIT_TEST_SUITE_HANDLE      BtTests;
+  UNIT_TEST_SUITE_HANDLE      Benchmark;
+  UNIT_TEST_SUITE_HANDLE      SsifTests;
+  UNIT_TEST_SUITE_HANDLE      SsifBenchmark;
+  UINTN                       Index;
+
+  Framework = NULL;
+
+  DEBUG ((DEBUG_INFO, "%a v%a\n", UNIT_TEST_NAME, UNIT_TEST_VERSION));
+
+  Status = InitUnitTestFramework (&Framework, UNIT_TEST_NAME, gEfiCallerBaseName, UNIT_TEST_VERSION);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in InitUnitTestFramework. Status = %r\n", Status));
+    goto EXIT;
+  }
+
+  Status = CreateUnitTestSuite (&BackoffTests, Framework, "BMC Polling Backoff Tests", "BmcCommonInterfaceLib.Backoff", NULL, NULL);
+  if (EFI_ERROR (Status)) {
+    Status = EFI_OUT_OF_RESOURCES;
+    goto EXIT;
+  }
+
+  AddTestCase (BackoffTests, "Backoff doubles up to the maximum delay", "Doubling", BackoffDoublesUpToMaxDelay, NULL, NULL, NULL);
+  AddTestCase (BackoffTests, "Backoff stops at the budget", "Budget", BackoffStopsAtBudget, NULL, NULL, NULL);
+  AddTestCase (BackoffTests, "Response time average", "ResponseTime", ResponseTimeAverage, NULL, NULL, NULL);
+
+  Status = CreateUnitTestSuite (&BtTests, Framework, "BT Transport Tests", "BtInterfaceLib.Transport", NULL, NULL);
+  if (EFI_ERROR (Status)) {
+    Status = EFI_OUT_OF_RESOURCES;
+    goto EXIT;
+  }
+
+  AddTestCase (BtTests, "Send command round trip", "RoundTrip", BtSendCommandRoundTrip, BtTransportSetup, NULL, &mFastBmc);
+  AddTestCase (BtTests, "Initialize the BT interface", "Init", BtInitInterfaceData, BtTransportSetup, NULL, &mFastBmc);
+  AddTestCase (BtTests, "Response time is learned", "Learn", BtResponseTimeIsLearned, BtTransportSetup, NULL, &mSlowBmc);
+  AddTestCase (BtTests, "Response time follows the BMC", "Follow", BtResponseTimeFollowsBmc, BtTransportSetup, NULL, &mFastBmc);
+  AddTestCase (BtTests, "No response times out", "Timeout", BtNoResponseTimesOut, BtTransportSetup, NULL, &mSilentBmc);
+
+  Status = CreateUnitTestSuite (&Benchmark, Framework, "BT Polling Benchmark", "BtInterfaceLib.Benchmark", NULL, NULL);
+  if (EFI_ERROR (Status)) {
+    Status = EFI_OUT_OF_RESOURCES;
+    goto EXIT;
+  }
+
+  for (Index = 0; Index < ARRAY_SIZE (mBenchmarkBmc); Index++) {
+    AddTestCase (Benchmark, "BT polling", "Polling", BtPollingBenchmark, BtTransportSetup, NULL, &mBenchmarkBmc[Index]);
+  }
+
+  Status = CreateUnitTestSuite (&SsifTests, Framework, "SSIF Transport Tests", "SsifInterfaceLib.Transport", NULL, NULL);
+  if (EFI_ERROR (Status)) {
+    Status = EFI_OUT_OF_RESOURCES;
+    goto EXIT;
+  }
+
+  AddTestCase (SsifTests, "Send command round trip", "RoundTrip", SsifSendCommandRoundTrip, SsifTransportSetup, NULL, &mSsifFastBmc);
+  AddTestCase (SsifTests, "Multi-part round trip", "MultiPart", SsifMultiPartRoundTrip, SsifTransportSetup, NULL, &mSsifFastBmc);
+  AddTestCase (SsifTests, "Initialize the SSIF interface", "Init", SsifInitInterfaceData, SsifTransportSetup, NULL, &mSsifFastBmc);
+  AddTestCase (SsifTests, "Response time is learned", "Learn", SsifResponseTimeIsLearned, SsifTransportSetup, NULL, &mSsifSlowBmc);
+  AddTestCase (SsifTests, "Response time follows the BMC", "Follow", SsifResponseTimeFollowsBmc, SsifTransportSetup, NULL, &mSsifFastBmc);
+  AddTestCase (SsifTests, "No response times out", "Timeout", SsifNoResponseTimesOut, SsifTransportSetup, NULL, &mSsifSilentBmc);
+  AddTestCase (SsifTests, "No BMC times out", "NoBmc", SsifNoBmcTimesOut, SsifTransportSetup, NULL, &mSsifFastBmc);
+
+  Status = CreateUnitTestSuite (&SsifBenchmark, Framework, "SSIF Polling Benchmark", "SsifInterfaceLib.Benchmark", NULL, NULL);
+  if (EFI_ERROR (Status)) {
+    Status = EFI_OUT_OF_RESOURCES;
+    goto EXIT;
+  }
+
+  for (Index = 0; Index < ARRAY_SIZE (mSsifBenchmarkBmc); Index++) {
+    AddTestCase (SsifBenchmark, "SSIF polling", "Polling", SsifPollingBenchmark, SsifTransportSetup, NULL, &mSsifBenchmarkBmc[Index]);
+  }
+
+  Status = RunAllTestSuites (Framework);
+
+EXIT:
+  if (Framework) {
+    FreeUnitTestFramework (Framework);
+  }
+
+  return Status;
+}
+
+/*++
+
+Routine Description:
+  Standard POSIX C entry point for host based unit test execution.
+
+Arguments:
+  argc - Number of arguments.
+  argv - Arguments.
+
+Returns:
+  Status of the unit test run.
+--*/
+int
+main (
+  int   argc,
+  char  *argv[]
+  )
+{
+  return UnitTestingEntry ();
+}
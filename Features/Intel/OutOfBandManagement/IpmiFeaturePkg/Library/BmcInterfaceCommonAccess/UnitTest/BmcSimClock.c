@@ -0,0 +1,65 @@
+/** @file BmcSimClock.c
+  Virtual clock shared by the simulated BMCs.
+
+  @copyright
+  Copyright 2026 Intel Corporation. <BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+**/
+
+#include <Uefi/UefiBaseType.h>
+#include <Library/TimerLib.h>
+#include "BmcSimClock.h"
+
+STATIC UINT64  mNow;
+
+/*++
+
+Routine Description:
+  Sets the virtual time back to zero.
+
+Arguments:
+  None.
+
+Returns:
+  VOID - Nothing.
+--*/
+VOID
+BmcSimClockReset (
+  VOID
+  )
+{
+  mNow = 0;
+}
+
+/*++
+
+Routine Description:
+  Returns the virtual time.
+
+Arguments:
+  None.
+
+Returns:
+  UINT64 - Microseconds delayed since the last reset.
+--*/
+UINT64
+BmcSimClockNow (
+  VOID
+  )
+{
+  return mNow;
+}
+
+//
+// TimerLib function used by BmcCommonInterfaceLib and the transports.
+//
+
+UINTN
+EFIAPI
+MicroSecondDelay (
+  IN UINTN  MicroSeconds
+  )
+{
+  mNow += MicroSeconds;
+  return MicroSeconds;
+}
@@ -0,0 +1,50 @@
+/** @file BmcSimClock.h
+  Virtual clock shared by the simulated BMCs of the host based
+  BmcInterfaceCommonAccess unit test.
+
+  The clock implements MicroSecondDelay. Time only advances through it, so
+  the results do not depend on the host.
+
+  @copyright
+  Copyright 2026 Intel Corporation. <BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+**/
+
+#ifndef _BMC_SIM_CLOCK_H_
+#define _BMC_SIM_CLOCK_H_
+
+#include <Uefi.h>
+
+/*++
+
+Routine Description:
+  Sets the virtual time back to zero.
+
+Arguments:
+  None.
+
+Returns:
+  VOID - Nothing.
+--*/
+VOID
+BmcSimClockReset (
+  VOID
+  );
+
+/*++
+
+Routine Description:
+  Returns the virtual time.
+
+Arguments:
+  None.
+
+Returns:
+  UINT64 - Microseconds delayed since the last reset.
+--*/
+UINT64
+BmcSimClockNow (
+  VOID
+  );
+
+#endif
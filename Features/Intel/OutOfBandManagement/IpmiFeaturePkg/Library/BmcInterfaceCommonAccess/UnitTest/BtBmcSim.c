@@ -0,0 +1,410 @@
+/** @file BtBmcSim.c
+  Simulated BMC behind a BT system interface.
+
+  Setting H2B_ATN hands a request to the BMC, which sets B_BUSY while it
+  processes it. Once the response time scripted for the request, or else
+  the configured response time, has elapsed the BMC places the response
+  in the buffer, clears B_BUSY and sets B2H_ATN.
+  Get Self Test Results and Get BT Interface Capabilities are answered
+  with fixed data, any other command is answered with a zero completion
+  code followed by the request data.
+
+  @copyright
+  Copyright 2026 Intel Corporation. <BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+**/
+
+#include <Uefi/UefiBaseType.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/DebugLib.h>
+#include <Library/IoLib.h>
+#include <Library/BtInterfaceLib.h>
+#include "BmcSimClock.h"
+#include "BtBmcSim.h"
+
+STATIC UINT16            mCtrlPort;
+STATIC UINT16            mBufferPort;
+STATIC UINT32            mResponseTime;
+STATIC UINT32            mScript[BT_BMC_SIM_SCRIPT_SIZE];
+STATIC UINTN             mScriptCount;
+STATIC UINTN             mScriptIndex;
+STATIC UINT32            mRequestResponseTime;
+STATIC BT_BMC_SIM_STATS  mStats;
+STATIC UINT8             mCtrl;
+STATIC UINT8             mRequest[BT_BMC_SIM_BUFFER_SIZE];
+STATIC UINT8             mWritePtr;
+STATIC UINT8             mResponse[BT_BMC_SIM_BUFFER_SIZE];
+STATIC UINT8             mReadPtr;
+STATIC UINT8             mLastRequest[BT_BMC_SIM_BUFFER_SIZE];
+STATIC UINTN             mLastRequestSize;
+STATIC BOOLEAN           mBusy;
+STATIC BOOLEAN           mResponseSeen;
+STATIC UINT64            mResponseReady;
+
+/*++
+
+Routine Description:
+  Builds the response to the request in the request buffer.
+
+Arguments:
+  None.
+
+Returns:
+  VOID - Nothing.
+--*/
+STATIC
+VOID
+BtBmcSimBuildResponse (
+  VOID
+  )
+{
+  UINT8  NetFunction;
+  UINT8  Command;
+  UINT8  DataSize;
+  UINT8  *Data;
+
+  NetFunction = mLastRequest[1] >> 2;
+  Command     = mLastRequest[3];
+  DataSize    = 0;
+  Data        = &mResponse[4];
+
+  Data[DataSize++] = IPMI_COMPLETION_CODE_SUCCESS;
+  if ((NetFunction == IPMI_NETFN_APP) && (Command == IPMI_APP_GET_SELFTEST_RESULTS)) {
+    Data[DataSize++] = IPMI_APP_SELFTEST_NO_ERROR;
+    Data[DataSize++] = 0;
+  } else if ((NetFunction == IPMI_NETFN_APP) && (Command == IPMI_APP_GET_BT_INTERFACE_CAPABILITY)) {
+    Data[DataSize++] = 1;     // Outstanding requests
+    Data[DataSize++] = 0x40;  // Input buffer size
+    Data[DataSize++] = 0x40;  // Output buffer size
+    Data[DataSize++] = 5;     // Request to response time in seconds
+    Data[DataSize++] = 1;     // Retries
+  } else if (mLastRequestSize > 4) {
+    CopyMem (&Data[DataSize], &mLastRequest[4], mLastRequestSize - 4);
+    DataSize += (UINT8)(mLastRequestSize - 4);
+  }
+
+  mResponse[0] = DataSize + 3;
+  mResponse[1] = mLastRequest[1] | BIT2;
+  mResponse[2] = mLastRequest[2];
+  mResponse[3] = Command;
+}
+
+/*++
+
+Routine Description:
+  Completes the request in progress if its response time has elapsed.
+
+Arguments:
+  None.
+
+Returns:
+  VOID - Nothing.
+--*/
+STATIC
+VOID
+BtBmcSimUpdate (
+  VOID
+  )
+{
+  if (!mBusy || (mRequestResponseTime == BT_BMC_SIM_NO_RESPONSE) || (BmcSimClockNow () < mResponseReady)) {
+    return;
+  }
+
+  BtBmcSimBuildResponse ();
+  mCtrl        &= (UINT8) ~IPMI_B_BUSY_BIT;
+  mCtrl        |= IPMI_B2H_ATN_BIT;
+  mBusy         = FALSE;
+  mResponseSeen = FALSE;
+}
+
+/*++
+
+Routine Description:
+  Handles a write to the BT control register. Writing 1 to CLR_WR_PTR or
+  CLR_RD_PTR clears the pointer, to H2B_ATN hands the request to the BMC,
+  to B2H_ATN clears it and to H_BUSY toggles it.
+
+Arguments:
+  Value - Value written.
+
+Returns:
+  VOID - Nothing.
+--*/
+STATIC
+VOID
+BtBmcSimWriteCtrl (
+  IN UINT8  Value
+  )
+{
+  BtBmcSimUpdate ();
+
+  if ((Value & IPMI_CLR_WR_PTR_BIT) != 0) {
+    mWritePtr = 0;
+  }
+
+  if ((Value & IPMI_CLR_RD_PTR_BIT) != 0) {
+    mReadPtr = 0;
+  }
+
+  if ((Value & IPMI_B2H_ATN_BIT) != 0) {
+    mCtrl &= (UINT8) ~IPMI_B2H_ATN_BIT;
+  }
+
+  if ((Value & IPMI_H_BUSY) != 0) {
+    mCtrl ^= IPMI_H_BUSY;
+  }
+
+  if (((Value & IPMI_H2B_ATN_BIT) != 0) && !mBusy) {
+    //
+    // The BMC takes the request right away and keeps B_BUSY set while it
+    // works on the response.
+    //
+    if (mScriptIndex < mScriptCount) {
+      mRequestResponseTime = mScript[mScriptIndex++];
+    } else {
+      mRequestResponseTime = mResponseTime;
+    }
+
+    CopyMem (mLastRequest, mRequest, mWritePtr);
+    mLastRequestSize = mWritePtr;
+    mBusy            = TRUE;
+    mResponseReady   = BmcSimClockNow () + mRequestResponseTime;
+    mCtrl           |= IPMI_B_BUSY_BIT;
+    mStats.Requests++;
+  }
+}
+
+/*++
+
+Routine Description:
+  Reads a BT register.
+
+Arguments:
+  Port - I/O port to read.
+
+Returns:
+  UINT8 - The register value, 0xFF if the port is not simulated.
+--*/
+STATIC
+UINT8
+BtBmcSimRead (
+  IN UINTN  Port
+  )
+{
+  BtBmcSimUpdate ();
+
+  if (Port == mCtrlPort) {
+    mStats.CtrlPolls++;
+    if (((mCtrl & IPMI_B2H_ATN_BIT) != 0) && !mResponseSeen) {
+      mStats.DetectTime += BmcSimClockNow () - mResponseReady;
+      mResponseSeen      = TRUE;
+    }
+
+    return mCtrl;
+  }
+
+  if (Port == mBufferPort) {
+    return mResponse[mReadPtr++];
+  }
+
+  return 0xFF;
+}
+
+/*++
+
+Routine Description:
+  Writes a BT register.
+
+Arguments:
+  Port  - I/O port to write.
+  Value - Value to write.
+
+Returns:
+  VOID - Nothing.
+--*/
+STATIC
+VOID
+BtBmcSimWrite (
+  IN UINTN  Port,
+  IN UINT8  Value
+  )
+{
+  if (Port == mCtrlPort) {
+    BtBmcSimWriteCtrl (Value);
+  } else if (Port == mBufferPort) {
+    mRequest[mWritePtr++] = Value;
+  }
+}
+
+/*++
+
+Routine Description:
+  Resets the simulated BMC and the virtual clock and clears the statistics.
+
+Arguments:
+  CtrlPort     - I/O port of the BT control register.
+  BufferPort   - I/O port of the BT buffer.
+  ResponseTime - Time in microseconds the BMC takes to respond to a request,
+                 BT_BMC_SIM_NO_RESPONSE to never respond.
+
+Returns:
+  VOID - Nothing.
+--*/
+VOID
+BtBmcSimReset (
+  IN UINT16  CtrlPort,
+  IN UINT16  BufferPort,
+  IN UINT32  ResponseTime
+  )
+{
+  mCtrlPort        = CtrlPort;
+  mBufferPort      = BufferPort;
+  mResponseTime    = ResponseTime;
+  mScriptCount     = 0;
+  mScriptIndex     = 0;
+  mCtrl            = 0;
+  mWritePtr        = 0;
+  mReadPtr         = 0;
+  mLastRequestSize = 0;
+  mBusy            = FALSE;
+  mResponseSeen    = FALSE;
+  mResponseReady   = 0;
+  ZeroMem (&mStats, sizeof (mStats));
+  ZeroMem (mRequest, sizeof (mRequest));
+  ZeroMem (mResponse, sizeof (mResponse));
+  ZeroMem (mLastRequest, sizeof (mLastRequest));
+  BmcSimClockReset ();
+}
+
+/*++
+
+Routine Description:
+  Changes the time the BMC takes to respond to the following requests.
+
+Arguments:
+  ResponseTime - Response time in microseconds, BT_BMC_SIM_NO_RESPONSE to
+                 never respond.
+
+Returns:
+  VOID - Nothing.
+--*/
+VOID
+BtBmcSimSetResponseTime (
+  IN UINT32  ResponseTime
+  )
+{
+  mResponseTime = ResponseTime;
+}
+
+/*++
+
+Routine Description:
+  Scripts the time the BMC takes to respond to each of the following
+  requests. Once the script is used up the response time set by
+  BtBmcSimReset or BtBmcSimSetResponseTime applies again.
+
+Arguments:
+  Script - Response times in microseconds, BT_BMC_SIM_NO_RESPONSE to not
+           respond to that request.
+  Count  - Number of entries in Script, at most BT_BMC_SIM_SCRIPT_SIZE.
+
+Returns:
+  VOID - Nothing.
+--*/
+VOID
+BtBmcSimSetResponseScript (
+  IN CONST UINT32  *Script,
+  IN UINTN         Count
+  )
+{
+  ASSERT (Count <= BT_BMC_SIM_SCRIPT_SIZE);
+
+  mScriptCount = MIN (Count, BT_BMC_SIM_SCRIPT_SIZE);
+  mScriptIndex = 0;
+  CopyMem (mScript, Script, mScriptCount * sizeof (mScript[0]));
+}
+
+/*++
+
+Routine Description:
+  Returns the last request the BMC accepted, including the length byte.
+
+Arguments:
+  Size - Returns the size of the request in bytes.
+
+Returns:
+  UINT8 * - Pointer to the request.
+--*/
+UINT8 *
+BtBmcSimLastRequest (
+  OUT UINTN  *Size
+  )
+{
+  *Size = mLastRequestSize;
+  return mLastRequest;
+}
+
+/*++
+
+Routine Description:
+  Returns the statistics collected since the last reset.
+
+Arguments:
+  None.
+
+Returns:
+  BT_BMC_SIM_STATS * - Pointer to the statistics.
+--*/
+BT_BMC_SIM_STATS *
+BtBmcSimStats (
+  VOID
+  )
+{
+  return &mStats;
+}
+
+//
+// IoLib functions used by BmcCommonInterfaceLib and BtInterfaceLib. MMIO
+// accesses are routed to the same registers.
+//
+
+UINT8
+EFIAPI
+IoRead8 (
+  IN UINTN  Port
+  )
+{
+  return BtBmcSimRead (Port);
+}
+
+UINT8
+EFIAPI
+IoWrite8 (
+  IN UINTN  Port,
+  IN UINT8  Value
+  )
+{
+  BtBmcSimWrite (Port, Value);
+  return Value;
+}
+
+UINT8
+EFIAPI
+MmioRead8 (
+  IN UINTN  Address
+  )
+{
+  return BtBmcSimRead (Address);
+}
+
+UINT8
+EFIAPI
+MmioWrite8 (
+  IN UINTN  Address,
+  IN UINT8  Value
+  )
+{
+  BtBmcSimWrite (Address, Value);
+  return Value;
+}
@@ -0,0 +1,122 @@
+/** @file BtBmcSim.h
+  Simulated BMC behind a BT system interface for the host based
+  BmcInterfaceCommonAccess unit test.
+
+  The simulator implements the I/O port accessors used by BtInterfaceLib
+  and runs on the virtual clock of BmcSimClock.
+
+  @copyright
+  Copyright 2026 Intel Corporation. <BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+**/
+
+#ifndef _BT_BMC_SIM_H_
+#define _BT_BMC_SIM_H_
+
+#include <Uefi.h>
+
+#define BT_BMC_SIM_NO_RESPONSE  MAX_UINT32
+#define BT_BMC_SIM_BUFFER_SIZE  0x100
+#define BT_BMC_SIM_SCRIPT_SIZE  0x40
+
+//
+// Counters collected by the simulator.
+//
+typedef struct {
+  UINT64    Requests;         ///< Requests the BMC accepted.
+  UINT64    CtrlPolls;        ///< Reads of the BT control register.
+  UINT64    DetectTime;       ///< Sum of the time between a response being ready and B2H_ATN being seen.
+} BT_BMC_SIM_STATS;
+
+/*++
+
+Routine Description:
+  Resets the simulated BMC and the virtual clock and clears the statistics.
+
+Arguments:
+  CtrlPort     - I/O port of the BT control register.
+  BufferPort   - I/O port of the BT buffer.
+  ResponseTime - Time in microseconds the BMC takes to respond to a request,
+                 BT_BMC_SIM_NO_RESPONSE to never respond.
+
+Returns:
+  VOID - Nothing.
+--*/
+VOID
+BtBmcSimReset (
+  IN UINT16  CtrlPort,
+  IN UINT16  BufferPort,
+  IN UINT32  ResponseTime
+  );
+
+/*++
+
+Routine Description:
+  Changes the time the BMC takes to respond to the following requests.
+
+Arguments:
+  ResponseTime - Response time in microseconds, BT_BMC_SIM_NO_RESPONSE to
+                 never respond.
+
+Returns:
+  VOID - Nothing.
+--*/
+VOID
+BtBmcSimSetResponseTime (
+  IN UINT32  ResponseTime
+  );
+
+/*++
+
+Routine Description:
+  Scripts the time the BMC takes to respond to each of the following
+  requests. Once the script is used up the response time set by
+  BtBmcSimReset or BtBmcSimSetResponseTime applies again.
+
+Arguments:
+  Script - Response times in microseconds, BT_BMC_SIM_NO_RESPONSE to not
+           respond to that request.
+  Count  - Number of entries in Script, at most BT_BMC_SIM_SCRIPT_SIZE.
+
+Returns:
+  VOID - Nothing.
+--*/
+VOID
+BtBmcSimSetResponseScript (
+  IN CONST UINT32  *Script,
+  IN UINTN         Count
+  );
+
+/*++
+
+Routine Description:
+  Returns the last request the BMC accepted, including the length byte.
+
+Arguments:
+  Size - Returns the size of the request in bytes.
+
+Returns:
+  UINT8 * - Pointer to the request.
+--*/
+UINT8 *
+BtBmcSimLastRequest (
+  OUT UINTN  *Size
+  );
+
+/*++
+
+Routine Description:
+  Returns the statistics collected since the last reset.
+
+Arguments:
+  None.
+
+Returns:
+  BT_BMC_SIM_STATS * - Pointer to the statistics.
+--*/
+BT_BMC_SIM_STATS *
+BtBmcSimStats (
+  VOID
+  );
+
+#endif
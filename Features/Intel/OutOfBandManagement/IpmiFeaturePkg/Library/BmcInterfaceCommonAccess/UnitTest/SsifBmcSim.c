@@ -0,0 +1,511 @@
+/** @file SsifBmcSim.c
+  Simulated BMC behind an SSIF system interface.
+
+  A single part write, or the end of a multi-part write, hands a request to
+  the BMC. The BMC NACKs reads until the response time scripted for the
+  request, or else the configured response time, has elapsed, and then
+  returns the response in a single part read or, when it does not fit in
+  one block, in a multi-part read. Get Self Test Results, Get System
+  Interface Capabilities and Get BMC Global Enables are answered with fixed
+  data, any other command is answered with a zero completion code followed
+  by the request data.
+
+  @copyright
+  Copyright 2026 Intel Corporation. <BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+**/
+
+#include <Uefi/UefiBaseType.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/DebugLib.h>
+#include <Library/SsifInterfaceLib.h>
+#include "BmcSimClock.h"
+#include "SsifBmcSim.h"
+
+STATIC UINT16              mSlaveAddress;
+STATIC UINT32              mResponseTime;
+STATIC UINT32              mScript[SSIF_BMC_SIM_SCRIPT_SIZE];
+STATIC UINTN               mScriptCount;
+STATIC UINTN               mScriptIndex;
+STATIC UINT32              mRequestResponseTime;
+STATIC BOOLEAN             mPresent;
+STATIC SSIF_BMC_SIM_STATS  mStats;
+STATIC UINT8               mRequest[SSIF_BMC_SIM_BUFFER_SIZE];
+STATIC UINTN               mRequestSize;
+STATIC BOOLEAN             mMultiPartWrite;
+STATIC UINT8               mLastRequest[SSIF_BMC_SIM_BUFFER_SIZE];
+STATIC UINTN               mLastRequestSize;
+STATIC UINT8               mResponse[SSIF_BMC_SIM_BUFFER_SIZE];
+STATIC UINTN               mResponseSize;
+STATIC UINTN               mReadOffset;
+STATIC UINT8               mReadBlock;
+STATIC BOOLEAN             mBusy;
+STATIC BOOLEAN             mResponseSeen;
+STATIC UINT64              mResponseReady;
+
+/*++
+
+Routine Description:
+  Builds the response to the last request.
+
+Arguments:
+  None.
+
+Returns:
+  VOID - Nothing.
+--*/
+STATIC
+VOID
+SsifBmcSimBuildResponse (
+  VOID
+  )
+{
+  UINT8  NetFunction;
+  UINT8  Command;
+  UINTN  DataSize;
+  UINT8  *Data;
+
+  NetFunction = mLastRequest[0] >> 2;
+  Command     = mLastRequest[1];
+  DataSize    = 0;
+  Data        = &mResponse[2];
+
+  Data[DataSize++] = IPMI_COMPLETION_CODE_SUCCESS;
+  if ((NetFunction == IPMI_NETFN_APP) && (Command == IPMI_APP_GET_SELFTEST_RESULTS)) {
+    Data[DataSize++] = IPMI_APP_SELFTEST_NO_ERROR;
+    Data[DataSize++] = 0;
+  } else if ((NetFunction == IPMI_NETFN_APP) && (Command == IPMI_APP_GET_SYSTEM_INTERFACE_CAPABILITIES)) {
+    Data[DataSize++] = 0;                     // Reserved
+    Data[DataSize++] = SsifMultiPartRw << 6;  // Multi-part transactions, no PEC
+    Data[DataSize++] = 2 * IPMI_SMBUS_BLOCK_LENGTH;
+    Data[DataSize++] = 2 * IPMI_SMBUS_BLOCK_LENGTH;
+  } else if ((NetFunction == IPMI_NETFN_APP) && (Command == IPMI_APP_GET_BMC_GLOBAL_ENABLES)) {
+    Data[DataSize++] = BIT3 | BIT2;           // SEL and event message buffer, no alert
+  } else if (mLastRequestSize > 2) {
+    CopyMem (&Data[DataSize], &mLastRequest[2], mLastRequestSize - 2);
+    DataSize += mLastRequestSize - 2;
+  }
+
+  mResponse[0]  = mLastRequest[0] | BIT2;
+  mResponse[1]  = Command;
+  mResponseSize = DataSize + 2;
+}
+
+/*++
+
+Routine Description:
+  Hands the assembled request to the BMC.
+
+Arguments:
+  None.
+
+Returns:
+  VOID - Nothing.
+--*/
+STATIC
+VOID
+SsifBmcSimAcceptRequest (
+  VOID
+  )
+{
+  if (mScriptIndex < mScriptCount) {
+    mRequestResponseTime = mScript[mScriptIndex++];
+  } else {
+    mRequestResponseTime = mResponseTime;
+  }
+
+  CopyMem (mLastRequest, mRequest, mRequestSize);
+  mLastRequestSize = mRequestSize;
+  mMultiPartWrite  = FALSE;
+  mBusy            = TRUE;
+  mResponseSeen    = FALSE;
+  mResponseReady   = BmcSimClockNow () + mRequestResponseTime;
+  mReadOffset      = 0;
+  mStats.Requests++;
+
+  SsifBmcSimBuildResponse ();
+}
+
+/*++
+
+Routine Description:
+  Handles an SMBus block write to the BMC.
+
+Arguments:
+  Command - SSIF write command.
+  Length  - Number of bytes to write.
+  Buffer  - Bytes to write.
+
+Returns:
+  EFI_SUCCESS      - The BMC ACKed the write.
+  EFI_DEVICE_ERROR - The BMC NACKed the write.
+--*/
+STATIC
+EFI_STATUS
+SsifBmcSimWrite (
+  IN UINTN  Command,
+  IN UINTN  Length,
+  IN UINT8  *Buffer
+  )
+{
+  mStats.Writes++;
+
+  if ((Length > IPMI_SMBUS_BLOCK_LENGTH) ||
+      (((Command == IPMI_SMBUS_MULTI_WRITE_MIDDLE_CMD) || (Command == IPMI_SMBUS_MULTI_WRITE_END_CMD)) &&
+       (!mMultiPartWrite || (mRequestSize + Length > SSIF_BMC_SIM_BUFFER_SIZE))))
+  {
+    mStats.Nacks++;
+    return EFI_DEVICE_ERROR;
+  }
+
+  switch (Command) {
+    case IPMI_SMBUS_SINGLE_WRITE_CMD:
+    case IPMI_SMBUS_MULTI_WRITE_START_CMD:
+      //
+      // A new request aborts the one in progress.
+      //
+      mBusy           = FALSE;
+      mRequestSize    = 0;
+      mMultiPartWrite = (BOOLEAN)(Command == IPMI_SMBUS_MULTI_WRITE_START_CMD);
+      break;
+
+    case IPMI_SMBUS_MULTI_WRITE_MIDDLE_CMD:
+    case IPMI_SMBUS_MULTI_WRITE_END_CMD:
+      break;
+
+    default:
+      mStats.Nacks++;
+      return EFI_DEVICE_ERROR;
+  }
+
+  CopyMem (&mRequest[mRequestSize], Buffer, Length);
+  mRequestSize += Length;
+
+  if ((Command == IPMI_SMBUS_SINGLE_WRITE_CMD) || (Command == IPMI_SMBUS_MULTI_WRITE_END_CMD)) {
+    SsifBmcSimAcceptRequest ();
+  }
+
+  return EFI_SUCCESS;
+}
+
+/*++
+
+Routine Description:
+  Handles an SMBus block read from the BMC. The BMC NACKs the read while
+  it has no response ready.
+
+Arguments:
+  Command - SSIF read command.
+  Length  - Returns the number of bytes read.
+  Buffer  - Buffer of IPMI_SMBUS_BLOCK_LENGTH bytes for the data.
+
+Returns:
+  EFI_SUCCESS      - The BMC returned a block.
+  EFI_DEVICE_ERROR - The BMC NACKed the read.
+--*/
+STATIC
+EFI_STATUS
+SsifBmcSimRead (
+  IN  UINTN  Command,
+  OUT UINTN  *Length,
+  OUT UINT8  *Buffer
+  )
+{
+  UINTN  Remaining;
+
+  mStats.Reads++;
+
+  if (!mBusy ||
+      (mRequestResponseTime == SSIF_BMC_SIM_NO_RESPONSE) ||
+      (BmcSimClockNow () < mResponseReady) ||
+      ((Command != IPMI_SMBUS_SINGLE_READ_CMD) && ((Command != IPMI_SMBUS_MULTI_READ_MIDDLE_CMD) || (mReadOffset == 0))))
+  {
+    mStats.Nacks++;
+    return EFI_DEVICE_ERROR;
+  }
+
+  if (!mResponseSeen) {
+    mStats.DetectTime += BmcSimClockNow () - mResponseReady;
+    mResponseSeen      = TRUE;
+  }
+
+  if (Command == IPMI_SMBUS_SINGLE_READ_CMD) {
+    //
+    // A single part read always starts the response over.
+    //
+    if (mResponseSize <= IPMI_SMBUS_BLOCK_LENGTH) {
+      CopyMem (Buffer, mResponse, mResponseSize);
+      *Length = mResponseSize;
+      mBusy   = FALSE;
+      return EFI_SUCCESS;
+    }
+
+    Buffer[0] = IPMI_MULTI_READ_ZEROTH_STRT_BIT;
+    Buffer[1] = IPMI_MULTI_READ_FIRST_STRT_BIT;
+    CopyMem (&Buffer[2], mResponse, IPMI_SMBUS_BLOCK_LENGTH - 2);
+    *Length     = IPMI_SMBUS_BLOCK_LENGTH;
+    mReadOffset = IPMI_SMBUS_BLOCK_LENGTH - 2;
+    mReadBlock  = 1;
+    return EFI_SUCCESS;
+  }
+
+  Remaining = mResponseSize - mReadOffset;
+  if (Remaining < IPMI_SMBUS_BLOCK_LENGTH) {
+    Buffer[0] = 0xFF;
+    CopyMem (&Buffer[1], &mResponse[mReadOffset], Remaining);
+    *Length = Remaining + 1;
+    mBusy   = FALSE;
+    return EFI_SUCCESS;
+  }
+
+  Buffer[0] = mReadBlock++;
+  CopyMem (&Buffer[1], &mResponse[mReadOffset], IPMI_SMBUS_BLOCK_LENGTH - 1);
+  *Length      = IPMI_SMBUS_BLOCK_LENGTH;
+  mReadOffset += IPMI_SMBUS_BLOCK_LENGTH - 1;
+  return EFI_SUCCESS;
+}
+
+/*++
+
+Routine Description:
+  Resets the simulated BMC and the virtual clock and clears the statistics.
+
+Arguments:
+  SlaveAddress - SMBus address the BMC answers on.
+  ResponseTime - Time in microseconds the BMC takes to respond to a request,
+                 SSIF_BMC_SIM_NO_RESPONSE to never respond.
+
+Returns:
+  VOID - Nothing.
+--*/
+VOID
+SsifBmcSimReset (
+  IN UINT16  SlaveAddress,
+  IN UINT32  ResponseTime
+  )
+{
+  mSlaveAddress        = SlaveAddress;
+  mResponseTime        = ResponseTime;
+  mScriptCount         = 0;
+  mScriptIndex         = 0;
+  mRequestResponseTime = ResponseTime;
+  mPresent             = TRUE;
+  mRequestSize         = 0;
+  mMultiPartWrite      = FALSE;
+  mLastRequestSize     = 0;
+  mResponseSize        = 0;
+  mReadOffset          = 0;
+  mReadBlock           = 0;
+  mBusy                = FALSE;
+  mResponseSeen        = FALSE;
+  mResponseReady       = 0;
+  ZeroMem (&mStats, sizeof (mStats));
+  ZeroMem (mRequest, sizeof (mRequest));
+  ZeroMem (mLastRequest, sizeof (mLastRequest));
+  ZeroMem (mResponse, sizeof (mResponse));
+  BmcSimClockReset ();
+}
+
+/*++
+
+Routine Description:
+  Changes the time the BMC takes to respond to the following requests.
+
+Arguments:
+  ResponseTime - Response time in microseconds, SSIF_BMC_SIM_NO_RESPONSE to
+                 never respond.
+
+Returns:
+  VOID - Nothing.
+--*/
+VOID
+SsifBmcSimSetResponseTime (
+  IN UINT32  ResponseTime
+  )
+{
+  mResponseTime = ResponseTime;
+}
+
+/*++
+
+Routine Description:
+  Scripts the time the BMC takes to respond to each of the following
+  requests. Once the script is used up the response time set by
+  SsifBmcSimReset or SsifBmcSimSetResponseTime applies again.
+
+Arguments:
+  Script - Response times in microseconds, SSIF_BMC_SIM_NO_RESPONSE to not
+           respond to that request.
+  Count  - Number of entries in Script, at most SSIF_BMC_SIM_SCRIPT_SIZE.
+
+Returns:
+  VOID - Nothing.
+--*/
+VOID
+SsifBmcSimSetResponseScript (
+  IN CONST UINT32  *Script,
+  IN UINTN         Count
+  )
+{
+  ASSERT (Count <= SSIF_BMC_SIM_SCRIPT_SIZE);
+
+  mScriptCount = MIN (Count, SSIF_BMC_SIM_SCRIPT_SIZE);
+  mScriptIndex = 0;
+  CopyMem (mScript, Script, mScriptCount * sizeof (mScript[0]));
+}
+
+/*++
+
+Routine Description:
+  Attaches the BMC to or detaches it from the SMBus. A detached BMC NACKs
+  every transaction.
+
+Arguments:
+  Present - TRUE to attach the BMC, FALSE to detach it.
+
+Returns:
+  VOID - Nothing.
+--*/
+VOID
+SsifBmcSimSetPresent (
+  IN BOOLEAN  Present
+  )
+{
+  mPresent = Present;
+}
+
+/*++
+
+Routine Description:
+  Returns the last request the BMC accepted, starting with the NetFn/LUN
+  byte.
+
+Arguments:
+  Size - Returns the size of the request in bytes.
+
+Returns:
+  UINT8 * - Pointer to the request.
+--*/
+UINT8 *
+SsifBmcSimLastRequest (
+  OUT UINTN  *Size
+  )
+{
+  *Size = mLastRequestSize;
+  return mLastRequest;
+}
+
+/*++
+
+Routine Description:
+  Returns the statistics collected since the last reset.
+
+Arguments:
+  None.
+
+Returns:
+  SSIF_BMC_SIM_STATS * - Pointer to the statistics.
+--*/
+SSIF_BMC_SIM_STATS *
+SsifBmcSimStats (
+  VOID
+  )
+{
+  return &mStats;
+}
+
+//
+// SsifInterfaceLib phase functions, in place of the SMBus host controller
+// used by the Pei, Dxe and Smm instances.
+//
+
+/*++
+
+Routine Description:
+  Send IPMI command through SMBUS instance.
+
+Arguments:
+  Interface     - Pointer to System interface.
+  SlaveAddress  - The SMBUS hardware address.
+  Command       - This command is transmitted by the SMBus host controller to the SMBus slave device..
+  Operation     - Operation to be performed.
+  PecCheck      - Defines if Packet Error Code (PEC) checking is required for this operation.
+  Length        - Signifies the number of bytes that this operation will do.
+  Buffer        - Contains the value of data to execute to
+                  the SMBus slave device. The length of this buffer is identified by Length.
+
+Returns:
+  EFI_SUCCESS      - The BMC ACKed the transaction.
+  EFI_DEVICE_ERROR - The BMC NACKed the transaction.
+  EFI_UNSUPPORTED  - The operation is not a block read or write.
+--*/
+EFI_STATUS
+IpmiSmbusSendCommand (
+  IN     IPMI_SYSTEM_INTERFACE     *Interface,
+  IN     EFI_SMBUS_DEVICE_ADDRESS  SlaveAddress,
+  IN     EFI_SMBUS_DEVICE_COMMAND  Command,
+  IN     EFI_SMBUS_OPERATION       Operation,
+  IN     BOOLEAN                   PecCheck,
+  IN OUT UINTN                     *Length,
+  IN OUT VOID                      *Buffer
+  )
+{
+  if ((Operation != EfiSmbusReadBlock) && (Operation != EfiSmbusWriteBlock)) {
+    return EFI_UNSUPPORTED;
+  }
+
+  if (!mPresent || (SlaveAddress.SmbusDeviceAddress != mSlaveAddress)) {
+    if (Operation == EfiSmbusReadBlock) {
+      mStats.Reads++;
+    } else {
+      mStats.Writes++;
+    }
+
+    mStats.Nacks++;
+    return EFI_DEVICE_ERROR;
+  }
+
+  if (Operation == EfiSmbusWriteBlock) {
+    return SsifBmcSimWrite (Command, *Length, Buffer);
+  }
+
+  return SsifBmcSimRead (Command, Length, Buffer);
+}
+
+/*++
+
+Routine Description:
+  Initializes the interface on the simulated SMBus the way the phase
+  instances do once they have located an SMBus instance.
+
+Arguments:
+  IpmiTransport2     - Pointer to IPMI transport2 instance.
+
+Returns:
+  Status - Status of the self test.
+--*/
+EFI_STATUS
+IpmiGetSmbusApiPtr (
+  IN OUT IPMI_TRANSPORT2  *IpmiTransport2
+  )
+{
+  EFI_STATUS            Status;
+  BMC_INTERFACE_STATUS  BmcStatus;
+
+  IpmiTransport2->Interface.Ssif.InterfaceState = IpmiInterfaceInitialized;
+
+  Status = CheckSelfTestByInterfaceType (
+                                         IpmiTransport2,
+                                         &BmcStatus,
+                                         SysInterfaceSsif
+                                         );
+  if (EFI_ERROR (Status) || (BmcStatus == BmcStatusHardFail)) {
+    IpmiTransport2->Interface.Ssif.InterfaceState = IpmiInterfaceInitError;
+    return Status;
+  }
+
+  GetSystemInterfaceCapability (IpmiTransport2);
+  GetGlobalEnables (IpmiTransport2);
+  return Status;
+}
@@ -0,0 +1,140 @@
+/** @file SsifBmcSim.h
+  Simulated BMC behind an SSIF system interface for the host based
+  BmcInterfaceCommonAccess unit test.
+
+  The simulator implements the SMBus functions used by SsifInterfaceLib
+  and runs on the virtual clock of BmcSimClock.
+
+  @copyright
+  Copyright 2026 Intel Corporation. <BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+**/
+
+#ifndef _SSIF_BMC_SIM_H_
+#define _SSIF_BMC_SIM_H_
+
+#include <Uefi.h>
+
+#define SSIF_BMC_SIM_NO_RESPONSE  MAX_UINT32
+#define SSIF_BMC_SIM_BUFFER_SIZE  0x100
+#define SSIF_BMC_SIM_SCRIPT_SIZE  0x40
+
+//
+// Counters collected by the simulator.
+//
+typedef struct {
+  UINT64    Requests;         ///< Requests the BMC accepted.
+  UINT64    Writes;           ///< SMBus block writes, including NACKed ones.
+  UINT64    Reads;            ///< SMBus block reads, including NACKed ones.
+  UINT64    Nacks;            ///< SMBus transactions the BMC NACKed.
+  UINT64    DetectTime;       ///< Sum of the time between a response being ready and its first read.
+} SSIF_BMC_SIM_STATS;
+
+/*++
+
+Routine Description:
+  Resets the simulated BMC and the virtual clock and clears the statistics.
+
+Arguments:
+  SlaveAddress - SMBus address the BMC answers on.
+  ResponseTime - Time in microseconds the BMC takes to respond to a request,
+                 SSIF_BMC_SIM_NO_RESPONSE to never respond.
+
+Returns:
+  VOID - Nothing.
+--*/
+VOID
+SsifBmcSimReset (
+  IN UINT16  SlaveAddress,
+  IN UINT32  ResponseTime
+  );
+
+/*++
+
+Routine Description:
+  Changes the time the BMC takes to respond to the following requests.
+
+Arguments:
+  ResponseTime - Response time in microseconds, SSIF_BMC_SIM_NO_RESPONSE to
+                 never respond.
+
+Returns:
+  VOID - Nothing.
+--*/
+VOID
+SsifBmcSimSetResponseTime (
+  IN UINT32  ResponseTime
+  );
+
+/*++
+
+Routine Description:
+  Scripts the time the BMC takes to respond to each of the following
+  requests. Once the script is used up the response time set by
+  SsifBmcSimReset or SsifBmcSimSetResponseTime applies again.
+
+Arguments:
+  Script - Response times in microseconds, SSIF_BMC_SIM_NO_RESPONSE to not
+           respond to that request.
+  Count  - Number of entries in Script, at most SSIF_BMC_SIM_SCRIPT_SIZE.
+
+Returns:
+  VOID - Nothing.
+--*/
+VOID
+SsifBmcSimSetResponseScript (
+  IN CONST UINT32  *Script,
+  IN UINTN         Count
+  );
+
+/*++
+
+Routine Description:
+  Attaches the BMC to or detaches it from the SMBus. A detached BMC NACKs
+  every transaction.
+
+Arguments:
+  Present - TRUE to attach the BMC, FALSE to detach it.
+
+Returns:
+  VOID - Nothing.
+--*/
+VOID
+SsifBmcSimSetPresent (
+  IN BOOLEAN  Present
+  );
+
+/*++
+
+Routine Description:
+  Returns the last request the BMC accepted, starting with the NetFn/LUN
+  byte.
+
+Arguments:
+  Size - Returns the size of the request in bytes.
+
+Returns:
+  UINT8 * - Pointer to the request.
+--*/
+UINT8 *
+SsifBmcSimLastRequest (
+  OUT UINTN  *Size
+  );
+
+/*++
+
+Routine Description:
+  Returns the statistics collected since the last reset.
+
+Arguments:
+  None.
+
+Returns:
+  SSIF_BMC_SIM_STATS * - Pointer to the statistics.
+--*/
+SSIF_BMC_SIM_STATS *
+SsifBmcSimStats (
+  VOID
+  );
+
+#endif
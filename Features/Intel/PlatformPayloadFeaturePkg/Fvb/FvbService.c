@@ -264,6 +264,7 @@ FvbReadBlock (
   )
 {
   EFI_FVB_ATTRIBUTES_2  Attributes;
+  EFI_FW_VOL_INSTANCE   *FwhInstance;
   UINTN                 LbaAddress;
   UINTN                 LbaLength;
   EFI_STATUS            Status;
@@ -297,6 +298,15 @@ FvbReadBlock (
     Status    = EFI_BAD_BUFFER_SIZE;
   }
 
+  //
+  // Serve the read from the RAM copy of the FV when available.
+  //
+  FwhInstance = GetFvbInstance (Instance);
+  if ((FwhInstance != NULL) && (FwhInstance->FvCache != NULL)) {
+    CopyMem (Buffer, FwhInstance->FvCache + (LbaAddress - FwhInstance->FvBase) + BlockOffset, *NumBytes);
+    return Status;
+  }
+
   ReadStatus = LibFvbFlashDeviceRead (LbaAddress + BlockOffset, NumBytes, Buffer);
   if (EFI_ERROR (ReadStatus)) {
     return ReadStatus;
@@ -336,8 +346,14 @@ FvbWriteBlock (
   )
 {
   EFI_FVB_ATTRIBUTES_2  Attributes;
+  EFI_FW_VOL_INSTANCE   *FwhInstance;
   UINTN                 LbaAddress;
   UINTN                 LbaLength;
+  UINTN                 Start;
+  UINTN                 End;
+  UINTN                 Length;
+  UINTN                 Index;
+  UINT8                 *Cache;
   EFI_STATUS            Status;
 
   if ((NumBytes == NULL) || (Buffer == NULL)) {
@@ -379,19 +395,68 @@ FvbWriteBlock (
     return EFI_BAD_BUFFER_SIZE;
   }
 
+  FwhInstance = GetFvbInstance (Instance);
+  if ((FwhInstance == NULL) || (FwhInstance->FvCache == NULL)) {
+    LibFvbFlashDeviceBlockLock (LbaAddress, LbaLength, FALSE);
+    Status = LibFvbFlashDeviceWrite (LbaAddress + BlockOffset, NumBytes, Buffer);
+
+    LibFvbFlashDeviceBlockLock (LbaAddress, LbaLength, TRUE);
+    WriteBackInvalidateDataCacheRange ((VOID *)(LbaAddress + BlockOffset), *NumBytes);
+    return Status;
+  }
+
+  //
+  // Only program the bytes that differ from the current flash content. The
+  // variable driver mostly rewrites headers with a single changed State byte,
+  // so trimming the unchanged head and tail saves most of the SPI cycles.
+  //
+  Cache = FwhInstance->FvCache + (LbaAddress - FwhInstance->FvBase) + BlockOffset;
+  Start = 0;
+  End   = *NumBytes;
+  while ((Start < End) && (Cache[Start] == Buffer[Start])) {
+    Start++;
+  }
+
+  while ((End > Start) && (Cache[End - 1] == Buffer[End - 1])) {
+    End--;
+  }
+
+  if (Start == End) {
+    return EFI_SUCCESS;
+  }
+
+  Length = End - Start;
   LibFvbFlashDeviceBlockLock (LbaAddress, LbaLength, FALSE);
-  Status = LibFvbFlashDeviceWrite (LbaAddress + BlockOffset, NumBytes, Buffer);
+  Status = LibFvbFlashDeviceWrite (LbaAddress + BlockOffset + Start, &Length, Buffer + Start);
 
   LibFvbFlashDeviceBlockLock (LbaAddress, LbaLength, TRUE);
-  WriteBackInvalidateDataCacheRange ((VOID *)(LbaAddress + BlockOffset), *NumBytes);
+  WriteBackInvalidateDataCacheRange ((VOID *)(LbaAddress + BlockOffset + Start), Length);
+  if (EFI_ERROR (Status)) {
+    //
+    // The flash content is unknown after a failed write, drop the RAM copy.
+    //
+    FreePool (FwhInstance->FvCache);
+    FwhInstance->FvCache = NULL;
+    return Status;
+  }
+
+  //
+  // Programming can only clear bits, mirror that in the RAM copy.
+  //
+  for (Index = Start; Index < End; Index++) {
+    Cache[Index] &= Buffer[Index];
+  }
+
   return Status;
 }
 
 /**
-  Erases and initializes a firmware volume block
+  Erases and initializes a run of consecutive firmware volume blocks
 
   @param[in]    Instance    The FV instance to be erased
-  @param[in]    Lba         The logical block index to be erased
+  @param[in]    Lba         The first logical block index to be erased
+  @param[in]    NumOfLba    The number of consecutive blocks to be erased, all
+                            within the same block map entry
 
   @retval   EFI_SUCCESS       The erase request was successfully completed
   @retval   EFI_ACCESS_DENIED The firmware volume is in the WriteDisabled state
@@ -404,12 +469,15 @@ FvbWriteBlock (
 EFI_STATUS
 FvbEraseBlock (
   IN UINTN    Instance,
-  IN EFI_LBA  Lba
+  IN EFI_LBA  Lba,
+  IN UINTN    NumOfLba
   )
 {
   EFI_FVB_ATTRIBUTES_2  Attributes;
+  EFI_FW_VOL_INSTANCE   *FwhInstance;
   UINTN                 LbaAddress;
   UINTN                 LbaLength;
+  UINTN                 EraseLength;
   EFI_STATUS            Status;
 
   //
@@ -429,13 +497,25 @@ FvbEraseBlock (
     return Status;
   }
 
-  LibFvbFlashDeviceBlockLock (LbaAddress, LbaLength, FALSE);
+  EraseLength = LbaLength * NumOfLba;
 
-  Status = LibFvbFlashDeviceBlockErase (LbaAddress, LbaLength);
+  LibFvbFlashDeviceBlockLock (LbaAddress, EraseLength, FALSE);
 
-  LibFvbFlashDeviceBlockLock (LbaAddress, LbaLength, TRUE);
+  Status = LibFvbFlashDeviceBlockErase (LbaAddress, EraseLength);
+
+  LibFvbFlashDeviceBlockLock (LbaAddress, EraseLength, TRUE);
 
-  WriteBackInvalidateDataCacheRange ((VOID *)LbaAddress, LbaLength);
+  WriteBackInvalidateDataCacheRange ((VOID *)LbaAddress, EraseLength);
+
+  FwhInstance = GetFvbInstance (Instance);
+  if ((FwhInstance != NULL) && (FwhInstance->FvCache != NULL)) {
+    if (EFI_ERROR (Status)) {
+      FreePool (FwhInstance->FvCache);
+      FwhInstance->FvCache = NULL;
+    } else {
+      SetMem (FwhInstance->FvCache + (LbaAddress - FwhInstance->FvBase), EraseLength, 0xFF);
+    }
+  }
 
   return Status;
 }
@@ -712,6 +792,7 @@ FvbProtocolEraseBlocks (
   VA_LIST                  args;
   EFI_LBA                  StartingLba;
   UINTN                    NumOfLba;
+  UINTN                    NumOfErased;
   EFI_STATUS               Status;
 
   FvbDevice   = FVB_DEVICE_FROM_THIS (This);
@@ -756,14 +837,23 @@ FvbProtocolEraseBlocks (
     NumOfLba = VA_ARG (args, UINT32);
 
     while ( NumOfLba > 0 ) {
-      Status = FvbEraseBlock (FvbDevice->Instance, StartingLba);
+      //
+      // Blocks of the same block map entry are contiguous, erase them with one
+      // request so the SPI library can use 64KB erase cycles where possible.
+      //
+      Status = FvbGetLbaAddress (FvbDevice->Instance, StartingLba, NULL, NULL, &NumOfErased);
+      if (!EFI_ERROR (Status)) {
+        NumOfErased = MIN (NumOfErased, NumOfLba);
+        Status      = FvbEraseBlock (FvbDevice->Instance, StartingLba, NumOfErased);
+      }
+
       if ( EFI_ERROR (Status)) {
         VA_END (args);
         return Status;
       }
 
-      StartingLba++;
-      NumOfLba--;
+      StartingLba += NumOfErased;
+      NumOfLba    -= NumOfErased;
     }
   } while (1);
 
@@ -1077,6 +1167,21 @@ FvbInitialize (
     FwVolInstance->NumOfBlocks += BlockMap->NumBlocks;
   }
 
+  //
+  // Load the whole FV into RAM once. Reads are then served from this copy,
+  // and writes and erases keep it in sync with the flash.
+  //
+  Length                 = (UINTN)FvHeader->FvLength;
+  FwVolInstance->FvCache = AllocateRuntimePool (Length);
+  if (FwVolInstance->FvCache != NULL) {
+    Status = LibFvbFlashDeviceRead (FwVolInstance->FvBase, &Length, FwVolInstance->FvCache);
+    if (EFI_ERROR (Status) || (Length != (UINTN)FvHeader->FvLength)) {
+      DEBUG ((DEBUG_WARN, "Fvb: Failed to cache FV 0x%lx: %r\n", BaseAddress, Status));
+      FreePool (FwVolInstance->FvCache);
+      FwVolInstance->FvCache = NULL;
+    }
+  }
+
   //
   // Add a FVB Protocol Instance
   //
@@ -49,6 +49,11 @@ typedef struct {
   UINTN                         FvBase;
   UINTN                         NumOfBlocks;
   //
+  // RAM copy of the whole FV, used to serve reads without SPI cycles and to
+  // skip bytes a write would not change. NULL if it could not be allocated.
+  //
+  UINT8                         *FvCache;
+  //
   // Note!!!: VolumeHeader must be the last element
   // of the structure.
   //
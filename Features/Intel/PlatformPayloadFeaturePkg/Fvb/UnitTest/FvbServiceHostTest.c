@@ -0,0 +1,661 @@
+/** @file
+  Host based unit test of the FVB service.
+
+  FvbService.c runs on top of FlashDeviceLib and SpiFlashLib, with the
+  simulated SPI controller of the SpiFlashLib unit test underneath. The
+  tests check that the RAM copy of the FV serves reads and stays in sync
+  with the flash, that writes only program the bytes that change, and
+  that erases of consecutive blocks are merged into large erase cycles.
+  The benchmark replays the FVB traffic of variable updates and a reclaim
+  with and without the RAM copy.
+
+  The simulated flash holds an address pattern, or a copy of the flash
+  image whose path is passed as the first argument. The tests overwrite
+  the variable FV at FVB_TEST_FV_OFFSET in the simulated copy.
+
+  Copyright (c) 2026, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "../FvbService.h"
+#include <Library/UnitTestLib.h>
+#include "../../Library/SpiFlashLib/UnitTest/SpiControllerSim.h"
+
+#define UNIT_TEST_NAME     "FVB Service Host Test"
+#define UNIT_TEST_VERSION  "1.0"
+
+//
+// Offset of the variable FV in the simulated flash
+//
+#define FVB_TEST_FV_OFFSET  SIZE_512KB
+
+//
+// Variable updates replayed by the benchmark, and the size of their name
+// and data
+//
+#define BENCHMARK_VARIABLE_UPDATES    200
+#define BENCHMARK_VARIABLE_NAME_SIZE  16
+#define BENCHMARK_VARIABLE_DATA_SIZE  40
+
+STATIC SPI_SIM_TIMING  mTypicalTiming = { 3, 12, 45000, 350000, FALSE, FALSE };
+STATIC SPI_SIM_TIMING  mErrorTiming   = { 3, 12, 45000, 350000, FALSE, TRUE };
+
+STATIC EFI_FW_VOL_BLOCK_DEVICE  mFvbDevice = {
+  FVB_DEVICE_SIGNATURE,
+  NULL,
+  0,
+  { NULL }
+};
+
+/**
+  Reset the simulated controller and create FVB instance 0 over an erased
+  variable FV, the way FvbInitialize does on the target.
+
+  The RAM copy is taken directly from the simulated flash, so the setup
+  also works when the simulator fails every cycle.
+
+  @param[in] Context              Pointer to the SPI_SIM_TIMING to simulate.
+
+  @retval UNIT_TEST_PASSED             The FVB instance was created.
+  @retval UNIT_TEST_ERROR_TEST_FAILED  Out of memory.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+FvbSimSetup (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  EFI_FIRMWARE_VOLUME_HEADER  *FvHeader;
+  EFI_FW_VOL_INSTANCE         *FwVolInstance;
+  UINT8                       *Flash;
+  UINTN                       BufferSize;
+
+  SpiSimReset ((SPI_SIM_TIMING *)Context);
+
+  FvHeader = GetFvHeaderTemplate ();
+  Flash    = SpiSimFlash () + FVB_TEST_FV_OFFSET;
+  SetMem (Flash, (UINTN)FvHeader->FvLength, 0xFF);
+  CopyMem (Flash, FvHeader, FvHeader->HeaderLength);
+
+  BufferSize    = FvHeader->HeaderLength + sizeof (EFI_FW_VOL_INSTANCE) - sizeof (EFI_FIRMWARE_VOLUME_HEADER);
+  FwVolInstance = AllocateZeroPool (BufferSize);
+  UT_ASSERT_NOT_NULL (FwVolInstance);
+
+  FwVolInstance->FvBase      = SPI_SIM_BIOS_BASE + FVB_TEST_FV_OFFSET;
+  FwVolInstance->NumOfBlocks = FvHeader->BlockMap[0].NumBlocks;
+  CopyMem (&FwVolInstance->VolumeHeader, FvHeader, FvHeader->HeaderLength);
+
+  FwVolInstance->FvCache = AllocateCopyPool ((UINTN)FvHeader->FvLength, Flash);
+  UT_ASSERT_NOT_NULL (FwVolInstance->FvCache);
+
+  mFvbModuleGlobal.FvInstance = FwVolInstance;
+  mFvbModuleGlobal.NumFv      = 1;
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Free FVB instance 0.
+
+  @param[in] Context              Unused.
+**/
+STATIC
+VOID
+EFIAPI
+FvbSimCleanup (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  if (mFvbModuleGlobal.FvInstance != NULL) {
+    if (mFvbModuleGlobal.FvInstance->FvCache != NULL) {
+      FreePool (mFvbModuleGlobal.FvInstance->FvCache);
+    }
+
+    FreePool (mFvbModuleGlobal.FvInstance);
+  }
+
+  mFvbModuleGlobal.FvInstance = NULL;
+  mFvbModuleGlobal.NumFv      = 0;
+}
+
+/**
+  Data written through the FVB protocol lands in the flash and is read
+  back from the RAM copy without any SPI cycle.
+
+  @param[in] Context              Unused.
+
+  @retval UNIT_TEST_PASSED        The test passed.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+WrittenDataIsReadFromCache (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  UINT8       Data[32];
+  UINT8       Buffer[32];
+  UINTN       BlockSize;
+  UINTN       NumBytes;
+  UINTN       Index;
+  UINT64      Cycles;
+  EFI_STATUS  Status;
+
+  for (Index = 0; Index < sizeof (Data); Index++) {
+    Data[Index] = (UINT8)(0x5A ^ Index);
+  }
+
+  BlockSize = GetFvbInstance (0)->VolumeHeader.BlockMap[0].Length;
+  NumBytes  = sizeof (Data);
+  Status    = FvbProtocolWrite (&mFvbDevice.FwVolBlockInstance, 1, 0x10, &NumBytes, Data);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+  UT_ASSERT_EQUAL (NumBytes, sizeof (Data));
+  UT_ASSERT_MEM_EQUAL (SpiSimFlash () + FVB_TEST_FV_OFFSET + BlockSize + 0x10, Data, sizeof (Data));
+
+  Cycles = SpiSimStats ()->Cycles;
+  Status = FvbProtocolRead (&mFvbDevice.FwVolBlockInstance, 1, 0x10, &NumBytes, Buffer);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+  UT_ASSERT_EQUAL (NumBytes, sizeof (Buffer));
+  UT_ASSERT_MEM_EQUAL (Buffer, Data, sizeof (Buffer));
+  UT_ASSERT_EQUAL (SpiSimStats ()->Cycles, Cycles);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Rewriting a buffer with a single changed byte, like a variable header
+  State update, programs only that byte, and rewriting it unchanged does
+  not start any SPI cycle.
+
+  @param[in] Context              Unused.
+
+  @retval UNIT_TEST_PASSED        The test passed.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+UnchangedBytesAreNotWritten (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  UINT8          Buffer[256];
+  UINT8          *Flash;
+  UINTN          BlockSize;
+  UINTN          NumBytes;
+  EFI_STATUS     Status;
+  SPI_SIM_STATS  *Stats;
+
+  Stats     = SpiSimStats ();
+  BlockSize = GetFvbInstance (0)->VolumeHeader.BlockMap[0].Length;
+  Flash     = SpiSimFlash () + FVB_TEST_FV_OFFSET + 2 * BlockSize;
+
+  NumBytes = sizeof (Buffer);
+  Status   = FvbProtocolRead (&mFvbDevice.FwVolBlockInstance, 2, 0, &NumBytes, Buffer);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+  Buffer[100] &= 0xFE;
+
+  //
+  // Programming all 256 bytes would take four 64 byte cycles
+  //
+  Stats->Cycles = 0;
+  Status        = FvbProtocolWrite (&mFvbDevice.FwVolBlockInstance, 2, 0, &NumBytes, Buffer);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+  UT_ASSERT_EQUAL (NumBytes, sizeof (Buffer));
+  UT_ASSERT_EQUAL (Stats->Cycles, 1);
+  UT_ASSERT_MEM_EQUAL (Flash, Buffer, sizeof (Buffer));
+
+  Stats->Cycles = 0;
+  Status        = FvbProtocolWrite (&mFvbDevice.FwVolBlockInstance, 2, 0, &NumBytes, Buffer);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+  UT_ASSERT_EQUAL (Stats->Cycles, 0);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  A failed write drops the RAM copy, so later reads go to the flash.
+
+  @param[in] Context              Unused.
+
+  @retval UNIT_TEST_PASSED        The test passed.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+FailedWriteDropsCache (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  UINT8       Buffer[16];
+  UINTN       NumBytes;
+  UINT64      Cycles;
+  EFI_STATUS  Status;
+
+  ZeroMem (Buffer, sizeof (Buffer));
+  NumBytes = sizeof (Buffer);
+  Status   = FvbProtocolWrite (&mFvbDevice.FwVolBlockInstance, 1, 0, &NumBytes, Buffer);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_DEVICE_ERROR);
+  UT_ASSERT_TRUE (GetFvbInstance (0)->FvCache == NULL);
+
+  //
+  // The read now starts SPI cycles, which keep failing
+  //
+  Cycles = SpiSimStats ()->Cycles;
+  Status = FvbProtocolRead (&mFvbDevice.FwVolBlockInstance, 1, 0, &NumBytes, Buffer);
+  UT_ASSERT_TRUE (EFI_ERROR (Status));
+  UT_ASSERT_TRUE (SpiSimStats ()->Cycles > Cycles);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Erasing a run of 4KB blocks uses 64KB erase cycles, only touches the
+  requested blocks and keeps the RAM copy in sync.
+
+  @param[in] Context              Unused.
+
+  @retval UNIT_TEST_PASSED        The test passed.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+EraseBlocksAreCoalesced (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  EFI_FW_VOL_INSTANCE  *FwVolInstance;
+  UINT8                *Flash;
+  UINTN                BlockSize;
+  UINTN                Index;
+  EFI_STATUS           Status;
+
+  FwVolInstance = GetFvbInstance (0);
+  BlockSize     = FwVolInstance->VolumeHeader.BlockMap[0].Length;
+  Flash         = SpiSimFlash () + FVB_TEST_FV_OFFSET;
+
+  //
+  // Program the erased range and one block on each side of it
+  //
+  SetMem (Flash + SIZE_64KB - BlockSize, SIZE_128KB + 2 * BlockSize, 0);
+  SetMem (FwVolInstance->FvCache + SIZE_64KB - BlockSize, SIZE_128KB + 2 * BlockSize, 0);
+
+  Status = FvbProtocolEraseBlocks (
+             &mFvbDevice.FwVolBlockInstance,
+             (EFI_LBA)(SIZE_64KB / BlockSize),
+             (UINTN)(SIZE_128KB / BlockSize),
+             EFI_LBA_LIST_TERMINATOR
+             );
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+  UT_ASSERT_EQUAL (SpiSimStats ()->Cycles, 2);
+
+  for (Index = SIZE_64KB - BlockSize; Index < SIZE_64KB + SIZE_128KB + BlockSize; Index++) {
+    if ((Index < SIZE_64KB) || (Index >= SIZE_64KB + SIZE_128KB)) {
+      UT_ASSERT_EQUAL (Flash[Index], 0);
+    } else {
+      UT_ASSERT_EQUAL (Flash[Index], 0xFF);
+    }
+  }
+
+  UT_ASSERT_MEM_EQUAL (FwVolInstance->FvCache, Flash, (UINTN)FwVolInstance->VolumeHeader.FvLength);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Write a range of FV instance 0, split at the block boundaries like the
+  variable driver does.
+
+  @param[in] Offset               Offset of the range in the FV.
+  @param[in] Size                 Size of the range in bytes.
+  @param[in] Buffer               Data to write.
+
+  @retval EFI_SUCCESS             The range was written.
+  @retval others                  The FVB write failed.
+**/
+STATIC
+EFI_STATUS
+FvbTestWrite (
+  IN UINTN  Offset,
+  IN UINTN  Size,
+  IN UINT8  *Buffer
+  )
+{
+  UINTN       BlockSize;
+  UINTN       NumBytes;
+  EFI_STATUS  Status;
+
+  BlockSize = GetFvbInstance (0)->VolumeHeader.BlockMap[0].Length;
+  while (Size > 0) {
+    NumBytes = MIN (Size, BlockSize - Offset % BlockSize);
+    Status   = FvbProtocolWrite (&mFvbDevice.FwVolBlockInstance, Offset / BlockSize, Offset % BlockSize, &NumBytes, Buffer);
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+
+    Offset += NumBytes;
+    Buffer += NumBytes;
+    Size   -= NumBytes;
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Read a range of FV instance 0, split at the block boundaries.
+
+  @param[in]  Offset              Offset of the range in the FV.
+  @param[in]  Size                Size of the range in bytes.
+  @param[out] Buffer              Buffer receiving the data.
+
+  @retval EFI_SUCCESS             The range was read.
+  @retval others                  The FVB read failed.
+**/
+STATIC
+EFI_STATUS
+FvbTestRead (
+  IN  UINTN  Offset,
+  IN  UINTN  Size,
+  OUT UINT8  *Buffer
+  )
+{
+  UINTN       BlockSize;
+  UINTN       NumBytes;
+  EFI_STATUS  Status;
+
+  BlockSize = GetFvbInstance (0)->VolumeHeader.BlockMap[0].Length;
+  while (Size > 0) {
+    NumBytes = MIN (Size, BlockSize - Offset % BlockSize);
+    Status   = FvbProtocolRead (&mFvbDevice.FwVolBlockInstance, Offset / BlockSize, Offset % BlockSize, &NumBytes, Buffer);
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+
+    Offset += NumBytes;
+    Buffer += NumBytes;
+    Size   -= NumBytes;
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Replay the FVB traffic of BENCHMARK_VARIABLE_UPDATES updates of one
+  variable in the first half of the FV, followed by a reclaim.
+
+  Each update appends the header with State VAR_HEADER_VALID_ONLY, then
+  the name and data, sets State to VAR_ADDED and deletes the previous
+  copy in two State writes. The reclaim reads the store, erases it and
+  writes back the FV header and the last copy, followed by erased bytes.
+
+  @param[out] Stats               Simulator statistics of the replay.
+
+  @retval EFI_SUCCESS             The store holds the reclaimed data.
+  @retval EFI_OUT_OF_RESOURCES    Out of memory.
+  @retval others                  An FVB call failed, or the store does not
+                                  match the reclaimed data.
+**/
+STATIC
+EFI_STATUS
+ReplayVariableStoreTraffic (
+  OUT SPI_SIM_STATS  *Stats
+  )
+{
+  AUTHENTICATED_VARIABLE_HEADER  Header;
+  UINT8                          Payload[BENCHMARK_VARIABLE_NAME_SIZE + BENCHMARK_VARIABLE_DATA_SIZE];
+  UINT8                          *Store;
+  UINTN                          StoreSize;
+  UINTN                          BlockSize;
+  UINTN                          Start;
+  UINTN                          Offset;
+  UINTN                          Previous;
+  UINTN                          RecordSize;
+  UINTN                          Index;
+  UINT8                          State;
+  EFI_STATUS                     Status;
+
+  BlockSize  = GetFvbInstance (0)->VolumeHeader.BlockMap[0].Length;
+  StoreSize  = (UINTN)GetFvbInstance (0)->VolumeHeader.FvLength / 2;
+  Start      = HEADER_ALIGN (GetFvbInstance (0)->VolumeHeader.HeaderLength + sizeof (VARIABLE_STORE_HEADER));
+  RecordSize = sizeof (Header) + sizeof (Payload);
+  Store      = AllocatePool (StoreSize);
+  if (Store == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  ZeroMem (SpiSimStats (), sizeof (SPI_SIM_STATS));
+
+  Status   = EFI_SUCCESS;
+  Offset   = Start;
+  Previous = 0;
+  for (Index = 0; (Index < BENCHMARK_VARIABLE_UPDATES) && !EFI_ERROR (Status); Index++) {
+    ZeroMem (&Header, sizeof (Header));
+    Header.StartId    = VARIABLE_DATA;
+    Header.State      = VAR_HEADER_VALID_ONLY;
+    Header.Attributes = EFI_VARIABLE_NON_VOLATILE | EFI_VARIABLE_BOOTSERVICE_ACCESS | EFI_VARIABLE_RUNTIME_ACCESS;
+    Header.NameSize   = BENCHMARK_VARIABLE_NAME_SIZE;
+    Header.DataSize   = BENCHMARK_VARIABLE_DATA_SIZE;
+    SetMem (Payload, sizeof (Payload), (UINT8)Index);
+
+    Status = FvbTestWrite (Offset, sizeof (Header), (UINT8 *)&Header);
+    if (!EFI_ERROR (Status)) {
+      Status = FvbTestWrite (Offset + sizeof (Header), sizeof (Payload), Payload);
+    }
+
+    State = VAR_ADDED;
+    if (!EFI_ERROR (Status)) {
+      Status = FvbTestWrite (Offset + OFFSET_OF (AUTHENTICATED_VARIABLE_HEADER, State), sizeof (State), &State);
+    }
+
+    if (!EFI_ERROR (Status) && (Previous != 0)) {
+      State &= VAR_IN_DELETED_TRANSITION;
+      Status = FvbTestWrite (Previous + OFFSET_OF (AUTHENTICATED_VARIABLE_HEADER, State), sizeof (State), &State);
+      if (!EFI_ERROR (Status)) {
+        State &= VAR_DELETED;
+        Status = FvbTestWrite (Previous + OFFSET_OF (AUTHENTICATED_VARIABLE_HEADER, State), sizeof (State), &State);
+      }
+    }
+
+    Previous = Offset;
+    Offset  += HEADER_ALIGN (RecordSize);
+  }
+
+  //
+  // Reclaim: keep the FV and store headers and the last copy
+  //
+  if (!EFI_ERROR (Status)) {
+    Status = FvbTestRead (0, StoreSize, Store);
+  }
+
+  if (!EFI_ERROR (Status)) {
+    CopyMem (Store + Start, Store + Previous, RecordSize);
+    SetMem (Store + Start + RecordSize, StoreSize - Start - RecordSize, 0xFF);
+    Status = FvbProtocolEraseBlocks (&mFvbDevice.FwVolBlockInstance, (EFI_LBA)0, StoreSize / BlockSize, EFI_LBA_LIST_TERMINATOR);
+  }
+
+  if (!EFI_ERROR (Status)) {
+    Status = FvbTestWrite (0, StoreSize, Store);
+  }
+
+  if (!EFI_ERROR (Status) && (CompareMem (SpiSimFlash () + FVB_TEST_FV_OFFSET, Store, StoreSize) != 0)) {
+    Status = EFI_DEVICE_ERROR;
+  }
+
+  FreePool (Store);
+  CopyMem (Stats, SpiSimStats (), sizeof (*Stats));
+  return Status;
+}
+
+/**
+  Replay the variable store traffic with and without the RAM copy of the
+  FV, and report the SPI cycles and the flash time of both.
+
+  @param[in] Context              Unused.
+
+  @retval UNIT_TEST_PASSED        The RAM copy needs fewer SPI cycles.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+VariableStoreBenchmark (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  SPI_SIM_STATS        Cached;
+  SPI_SIM_STATS        Uncached;
+  EFI_FW_VOL_INSTANCE  *FwVolInstance;
+  EFI_STATUS           Status;
+
+  Status = ReplayVariableStoreTraffic (&Cached);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+
+  FvbSimCleanup (Context);
+  UT_ASSERT_EQUAL (FvbSimSetup (&mTypicalTiming), UNIT_TEST_PASSED);
+  FwVolInstance = GetFvbInstance (0);
+  FreePool (FwVolInstance->FvCache);
+  FwVolInstance->FvCache = NULL;
+
+  Status = ReplayVariableStoreTraffic (&Uncached);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+
+  UT_LOG_INFO (
+    "%d variable updates and a reclaim: %ld cycles, %ldus with the RAM copy, %ld cycles, %ldus without\n",
+    BENCHMARK_VARIABLE_UPDATES,
+    Cached.Cycles,
+    Cached.Now,
+    Uncached.Cycles,
+    Uncached.Now
+    );
+
+  UT_ASSERT_TRUE (Cached.Cycles < Uncached.Cycles);
+  UT_ASSERT_TRUE (Cached.Now < Uncached.Now);
+  return UNIT_TEST_PASSED;
+}
+
+//
+// CacheMaintenanceLib, DxeServicesLib and FvbServiceSmm.c functions used by
+// FvbService.c. The simulated flash is not memory mapped, so there is no
+// cache to maintain.
+//
+
+VOID *
+EFIAPI
+WriteBackInvalidateDataCacheRange (
+  IN VOID   *Address,
+  IN UINTN  Length
+  )
+{
+  return Address;
+}
+
+EFI_STATUS
+EFIAPI
+GetSectionFromAnyFv (
+  IN CONST  EFI_GUID          *NameGuid,
+  IN        EFI_SECTION_TYPE  SectionType,
+  IN        UINTN             SectionInstance,
+  OUT       VOID              **Buffer,
+  OUT       UINTN             *Size
+  )
+{
+  return EFI_NOT_FOUND;
+}
+
+EFI_STATUS
+InstallFvbProtocol (
+  IN  EFI_FW_VOL_INSTANCE  *FwhInstance,
+  IN  UINTN                InstanceNum
+  )
+{
+  return EFI_SUCCESS;
+}
+
+/**
+  Initialize the unit test framework, suites and test cases, and run them.
+
+  @param[in] ImageFile            Path of a flash image to simulate, or NULL
+                                  to simulate an address pattern.
+
+  @retval EFI_SUCCESS             All test cases were dispatched.
+  @retval EFI_OUT_OF_RESOURCES    There are not enough resources available to
+                                  initialize the unit tests.
+  @retval others                  The flash image could not be loaded.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+UnitTestingEntry (
+  IN CONST CHAR8  *ImageFile
+  )
+{
+  EFI_STATUS                  Status;
+  UNIT_TEST_FRAMEWORK_HANDLE  Framework;
+  UNIT_TEST_SUITE_HANDLE      FvbTests;
+  UNIT_TEST_SUITE_HANDLE      Benchmark;
+
+  Framework = NULL;
+
+  DEBUG ((DEBUG_INFO, "%a v%a\n", UNIT_TEST_NAME, UNIT_TEST_VERSION));
+
+  Status = InitUnitTestFramework (&Framework, UNIT_TEST_NAME, gEfiCallerBaseName, UNIT_TEST_VERSION);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in InitUnitTestFramework. Status = %r\n", Status));
+    goto EXIT;
+  }
+
+  if (ImageFile != NULL) {
+    Status = SpiSimLoadImage (ImageFile);
+    if (EFI_ERROR (Status)) {
+      DEBUG ((DEBUG_ERROR, "Failed to load flash image %a. Status = %r\n", ImageFile, Status));
+      goto EXIT;
+    }
+  }
+
+  //
+  // LibFvbFlashDeviceInit reads the controller setup through the simulator
+  //
+  SpiSimReset (&mTypicalTiming);
+  Status = LibFvbFlashDeviceInit ();
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "LibFvbFlashDeviceInit failed. Status = %r\n", Status));
+    goto EXIT;
+  }
+
+  Status = CreateUnitTestSuite (&FvbTests, Framework, "FVB Service Tests", "Fvb.Service", NULL, NULL);
+  if (EFI_ERROR (Status)) {
+    Status = EFI_OUT_OF_RESOURCES;
+    goto EXIT;
+  }
+
+  AddTestCase (FvbTests, "Written data is read from the RAM copy", "CachedRead", WrittenDataIsReadFromCache, FvbSimSetup, FvbSimCleanup, &mTypicalTiming);
+  AddTestCase (FvbTests, "Unchanged bytes are not written", "TrimmedWrite", UnchangedBytesAreNotWritten, FvbSimSetup, FvbSimCleanup, &mTypicalTiming);
+  AddTestCase (FvbTests, "Failed write drops the RAM copy", "FailedWrite", FailedWriteDropsCache, FvbSimSetup, FvbSimCleanup, &mErrorTiming);
+  AddTestCase (FvbTests, "Erase of consecutive blocks uses 64KB cycles", "CoalescedErase", EraseBlocksAreCoalesced, FvbSimSetup, FvbSimCleanup, &mTypicalTiming);
+
+  Status = CreateUnitTestSuite (&Benchmark, Framework, "FVB Service Benchmark", "Fvb.Benchmark", NULL, NULL);
+  if (EFI_ERROR (Status)) {
+    Status = EFI_OUT_OF_RESOURCES;
+    goto EXIT;
+  }
+
+  AddTestCase (Benchmark, "Variable store traffic", "VariableStore", VariableStoreBenchmark, FvbSimSetup, FvbSimCleanup, &mTypicalTiming);
+
+  Status = RunAllTestSuites (Framework);
+
+EXIT:
+  if (Framework) {
+    FreeUnitTestFramework (Framework);
+  }
+
+  return Status;
+}
+
+/**
+  Standard POSIX C entry point for host based unit test execution.
+
+  An optional argument names the flash image to simulate.
+**/
+int
+main (
+  int   argc,
+  char  *argv[]
+  )
+{
+  return UnitTestingEntry ((argc > 1) ? argv[1] : NULL);
+}
@@ -11,6 +11,48 @@ Copyright (c) 2018 - 2021, Intel Corporation. All rights reserved. <BR>
 #include <Library/DebugLib.h>
 #include <Library/SpiFlashLib.h>
 
+//
+// Size of the BIOS region, cached on first use so that the flash
+// accessors do not re-read the descriptor registers on every call.
+//
+STATIC UINT32  mBiosRegionSize = 0;
+
+/**
+  Convert a physical address in the memory mapped BIOS region into the
+  offset within the BIOS region used by the SPI flash library.
+
+  @param[in]  PAddress        The physical address to convert.
+  @param[out] AddrOffset      The corresponding BIOS region offset.
+
+  @retval     EFI_SUCCESS     The offset is returned in AddrOffset.
+  @retval     others          The BIOS region size could not be retrieved.
+
+**/
+STATIC
+EFI_STATUS
+GetBiosRegionOffset (
+  IN  UINTN   PAddress,
+  OUT UINT32  *AddrOffset
+  )
+{
+  EFI_STATUS  Status;
+  UINT32      RgnSize;
+
+  if (mBiosRegionSize == 0) {
+    Status = SpiGetRegionAddress (FlashRegionBios, NULL, &RgnSize);
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+
+    mBiosRegionSize = RgnSize;
+  }
+
+  // BIOS region offset can be calculated by (PAddress - (0x100000000 - RgnSize))
+  // which equal (PAddress + RgnSize) here.
+  *AddrOffset = (UINT32)((UINT32)PAddress + mBiosRegionSize);
+  return EFI_SUCCESS;
+}
+
 /**
   Initialize spi flash device.
 
@@ -50,18 +92,14 @@ LibFvbFlashDeviceRead (
 {
   EFI_STATUS  Status;
   UINT32      ByteCount;
-  UINT32      RgnSize;
   UINT32      AddrOffset;
 
-  Status = SpiGetRegionAddress (FlashRegionBios, NULL, &RgnSize);
+  Status = GetBiosRegionOffset (PAddress, &AddrOffset);
   if (EFI_ERROR (Status)) {
     return Status;
   }
 
-  // BIOS region offset can be calculated by (PAddress - (0x100000000 - RgnSize))
-  // which equal (PAddress + RgnSize) here.
-  AddrOffset = (UINT32)((UINT32)PAddress + RgnSize);
-  ByteCount  = (UINT32)*NumBytes;
+  ByteCount = (UINT32)*NumBytes;
   return SpiFlashRead (FlashRegionBios, AddrOffset, ByteCount, Buffer);
 }
 
@@ -88,18 +126,14 @@ LibFvbFlashDeviceWrite (
 {
   EFI_STATUS  Status;
   UINT32      ByteCount;
-  UINT32      RgnSize;
   UINT32      AddrOffset;
 
-  Status = SpiGetRegionAddress (FlashRegionBios, NULL, &RgnSize);
+  Status = GetBiosRegionOffset (PAddress, &AddrOffset);
   if (EFI_ERROR (Status)) {
     return Status;
   }
 
-  // BIOS region offset can be calculated by (PAddress - (0x100000000 - RgnSize))
-  // which equal (PAddress + RgnSize) here.
-  AddrOffset = (UINT32)((UINT32)PAddress + RgnSize);
-  ByteCount  = (UINT32)*NumBytes;
+  ByteCount = (UINT32)*NumBytes;
   return SpiFlashWrite (FlashRegionBios, AddrOffset, ByteCount, Buffer);
 }
 
@@ -109,7 +143,7 @@ LibFvbFlashDeviceWrite (
   @param[in]  PAddress        The starting physical address of the block to be erased.
                               This library assume that caller garantee that the PAddress
                               is at the starting address of this block.
-  @param[in]  LbaLength       The length of the logical block to be erased.
+  @param[in]  LbaLength       The length of the logical block(s) to be erased.
 
   @retval     EFI_SUCCESS.      Opertion is successful.
   @retval     EFI_DEVICE_ERROR  If there is any device errors.
@@ -123,17 +157,13 @@ LibFvbFlashDeviceBlockErase (
   )
 {
   EFI_STATUS  Status;
-  UINT32      RgnSize;
   UINT32      AddrOffset;
 
-  Status = SpiGetRegionAddress (FlashRegionBios, NULL, &RgnSize);
+  Status = GetBiosRegionOffset (PAddress, &AddrOffset);
   if (EFI_ERROR (Status)) {
     return Status;
   }
 
-  // BIOS region offset can be calculated by (PAddress - (0x100000000 - RgnSize))
-  // which equal (PAddress + RgnSize) here.
-  AddrOffset = (UINT32)((UINT32)PAddress + RgnSize);
   return SpiFlashErase (FlashRegionBios, AddrOffset, (UINT32)LbaLength);
 }
 
@@ -28,8 +28,14 @@
 ///  Wait Time = 6 seconds = 6000000 microseconds
 ///  Wait Period = 10 microseconds
 ///
-#define WAIT_TIME    6000000    ///< Wait Time = 6 seconds = 6000000 microseconds
-#define WAIT_PERIOD  10         ///< Wait Period = 10 microseconds
+/// Read, write and status cycles usually finish within a few microseconds, so
+/// the first WAIT_FAST_TIME microseconds are polled every WAIT_FAST_PERIOD
+/// microsecond before falling back to the slower period used for erases.
+///
+#define WAIT_TIME         6000000 ///< Wait Time = 6 seconds = 6000000 microseconds
+#define WAIT_PERIOD       10      ///< Wait Period = 10 microseconds
+#define WAIT_FAST_TIME    100     ///< Fast Wait Time = 100 microseconds
+#define WAIT_FAST_PERIOD  1       ///< Fast Wait Period = 1 microsecond
 
 ///
 /// Flash cycle Type
@@ -639,10 +639,13 @@ SendSpiCmd (
     }
 
     if (FlashCycleType == FlashCycleErase) {
-      if (((ByteCount / SIZE_64KB) != 0) &&
-          ((ByteCount % SIZE_64KB) == 0) &&
-          ((HardwareSpiAddr % SIZE_64KB) == 0))
-      {
+      //
+      // Use a 64KB erase for every 64KB aligned chunk of the remaining range and
+      // fall back to 4KB erases for the unaligned head and tail, so that a large
+      // range is not erased entirely in 4KB steps just because it is not a
+      // multiple of 64KB.
+      //
+      if ((ByteCount >= SIZE_64KB) && ((HardwareSpiAddr % SIZE_64KB) == 0)) {
         if (HardwareSpiAddr < SpiInstance->Component1StartAddr) {
           //
           // Check whether Component0 support 64k Erase
@@ -776,18 +779,13 @@ WaitForSpiCycleComplete (
   IN     BOOLEAN  ErrorCheck
   )
 {
-  UINT64  WaitTicks;
-  UINT64  WaitCount;
+  UINT64  WaitTime;
   UINT32  Data32;
 
-  //
-  // Convert the wait period allowed into to tick count
-  //
-  WaitCount = WAIT_TIME / WAIT_PERIOD;
   //
   // Wait for the SPI cycle to complete.
   //
-  for (WaitTicks = 0; WaitTicks < WaitCount; WaitTicks++) {
+  for (WaitTime = 0; WaitTime < WAIT_TIME;) {
     Data32 = MmioRead32 (ScSpiBar0 + R_SPI_HSFS);
     if ((Data32 & B_SPI_HSFS_SCIP) == 0) {
       MmioWrite32 (ScSpiBar0 + R_SPI_HSFS, B_SPI_HSFS_FCERR | B_SPI_HSFS_FDONE);
@@ -798,7 +796,17 @@ WaitForSpiCycleComplete (
       }
     }
 
-    MicroSecondDelay (WAIT_PERIOD);
+    //
+    // Poll quickly first since most cycles complete within a few microseconds,
+    // then back off to the normal period for long running erase cycles.
+    //
+    if (WaitTime < WAIT_FAST_TIME) {
+      MicroSecondDelay (WAIT_FAST_PERIOD);
+      WaitTime += WAIT_FAST_PERIOD;
+    } else {
+      MicroSecondDelay (WAIT_PERIOD);
+      WaitTime += WAIT_PERIOD;
+    }
   }
 
   return FALSE;
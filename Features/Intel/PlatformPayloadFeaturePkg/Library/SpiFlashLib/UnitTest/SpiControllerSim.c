@@ -0,0 +1,576 @@
+/** @file
+  Simulated PCH SPI controller for the host based SpiFlashLib unit test.
+
+  Only the hardware sequencing registers used by SpiFlashLib are modeled.
+  A cycle started with FGO keeps SCIP set until the virtual time has
+  advanced by the duration configured for its cycle type, then performs
+  the read, write or erase on the simulated flash and sets FDONE, or FCERR
+  when a failure is requested.
+
+  The flash is a heap buffer, so a flash image of any supported size can
+  be loaded from a host file.
+
+  Copyright (c) 2026, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <stdio.h>
+#include <PiDxe.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/DebugLib.h>
+#include <Library/HobLib.h>
+#include <Library/IoLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/TimerLib.h>
+#include <Guid/SpiFlashInfoGuid.h>
+#include "../RegsSpi.h"
+#include "SpiControllerSim.h"
+
+#define SPI_SIM_REGISTER_SIZE  0x100
+#define SPI_SIM_FDATA_SIZE     64
+
+typedef struct {
+  EFI_HOB_GUID_TYPE    Header;
+  SPI_FLASH_INFO       Info;
+} SPI_SIM_FLASH_INFO_HOB;
+
+STATIC SPI_SIM_TIMING          mTiming;
+STATIC SPI_SIM_STATS           mStats;
+STATIC UINT8                   *mFlash;
+STATIC UINTN                   mFlashSize;
+STATIC UINT8                   *mImage;
+STATIC UINTN                   mImageSize;
+STATIC UINT8                   mPciConfig[SPI_SIM_REGISTER_SIZE];
+STATIC UINT8                   mBar0[SPI_SIM_REGISTER_SIZE];
+STATIC BOOLEAN                 mCycleBusy;
+STATIC UINT64                  mCycleEnd;
+STATIC SPI_SIM_FLASH_INFO_HOB  mSpiFlashInfoHob;
+
+/**
+  Return the simulated register backing an MMIO access.
+
+  @param[in] Address              MMIO address of the access.
+  @param[in] Size                 Size of the access in bytes.
+
+  @return Pointer to the register, NULL if the address is not simulated.
+**/
+STATIC
+UINT8 *
+SpiSimRegister (
+  IN UINTN  Address,
+  IN UINTN  Size
+  )
+{
+  if ((Address >= SPI_SIM_SPI_BAR0) && (Address + Size <= SPI_SIM_SPI_BAR0 + SPI_SIM_REGISTER_SIZE)) {
+    return &mBar0[Address - SPI_SIM_SPI_BAR0];
+  }
+
+  if ((Address >= SPI_SIM_PCH_SPI_BASE) && (Address + Size <= SPI_SIM_PCH_SPI_BASE + SPI_SIM_REGISTER_SIZE)) {
+    return &mPciConfig[Address - SPI_SIM_PCH_SPI_BASE];
+  }
+
+  return NULL;
+}
+
+/**
+  Return the time a cycle type takes on the simulated flash.
+
+  @param[in] Cycle                HSFS cycle type.
+
+  @return Duration of the cycle in microseconds.
+**/
+STATIC
+UINT32
+SpiSimCycleTime (
+  IN UINT32  Cycle
+  )
+{
+  switch (Cycle) {
+    case V_SPI_HSFS_CYCLE_WRITE:
+    case V_SPI_HSFS_CYCLE_WRITE_STATUS:
+      return mTiming.WriteCycleTime;
+
+    case V_SPI_HSFS_CYCLE_4K_ERASE:
+      return mTiming.Erase4KTime;
+
+    case V_SPI_HSFS_CYCLE_64K_ERASE:
+      return mTiming.Erase64KTime;
+
+    default:
+      return mTiming.ReadCycleTime;
+  }
+}
+
+/**
+  Complete the cycle in progress if its time has elapsed.
+**/
+STATIC
+VOID
+SpiSimUpdateCycle (
+  VOID
+  )
+{
+  UINT32  Hsfs;
+  UINT32  Cycle;
+  UINT32  Count;
+  UINT32  Address;
+  UINT32  Index;
+  UINT8   *Data;
+
+  if (!mCycleBusy || mTiming.NeverComplete || (mStats.Now < mCycleEnd)) {
+    return;
+  }
+
+  Hsfs    = ReadUnaligned32 ((UINT32 *)&mBar0[R_SPI_HSFS]);
+  Cycle   = (Hsfs & B_SPI_HSFS_CYCLE_MASK) >> N_SPI_HSFS_CYCLE;
+  Count   = ((Hsfs & B_SPI_HSFS_FDBC_MASK) >> N_SPI_HSFS_FDBC) + 1;
+  Address = ReadUnaligned32 ((UINT32 *)&mBar0[R_SPI_FADDR]) & B_SPI_FADDR_MASK;
+  Data    = &mBar0[R_SPI_FDATA00];
+
+  if (!mTiming.FailCycle) {
+    switch (Cycle) {
+      case V_SPI_HSFS_CYCLE_READ:
+        for (Index = 0; Index < Count; Index++) {
+          Data[Index] = mFlash[(Address + Index) % mFlashSize];
+        }
+
+        break;
+
+      case V_SPI_HSFS_CYCLE_WRITE:
+        //
+        // Programming can only clear bits, like on a NOR flash
+        //
+        for (Index = 0; Index < Count; Index++) {
+          mFlash[(Address + Index) % mFlashSize] &= Data[Index];
+        }
+
+        break;
+
+      case V_SPI_HSFS_CYCLE_4K_ERASE:
+        SetMem (&mFlash[(Address % mFlashSize) & ~(SIZE_4KB - 1)], SIZE_4KB, 0xFF);
+        break;
+
+      case V_SPI_HSFS_CYCLE_64K_ERASE:
+        SetMem (&mFlash[(Address % mFlashSize) & ~(SIZE_64KB - 1)], MIN (SIZE_64KB, mFlashSize), 0xFF);
+        break;
+
+      default:
+        ZeroMem (Data, SPI_SIM_FDATA_SIZE);
+        break;
+    }
+  }
+
+  Hsfs &= (UINT32) ~(B_SPI_HSFS_SCIP | B_SPI_HSFS_CYCLE_FGO);
+  Hsfs |= mTiming.FailCycle ? B_SPI_HSFS_FCERR : B_SPI_HSFS_FDONE;
+  WriteUnaligned32 ((UINT32 *)&mBar0[R_SPI_HSFS], Hsfs);
+  mCycleBusy = FALSE;
+}
+
+/**
+  Handle a write to the HSFS register.
+
+  FCERR and FDONE are write one to clear. The byte count and cycle type
+  can only be changed while no cycle is in progress, and setting FGO then
+  starts a cycle.
+
+  @param[in] Value                Value written to HSFS.
+**/
+STATIC
+VOID
+SpiSimWriteHsfs (
+  IN UINT32  Value
+  )
+{
+  UINT32  Hsfs;
+  UINT32  Duration;
+
+  SpiSimUpdateCycle ();
+
+  Hsfs  = ReadUnaligned32 ((UINT32 *)&mBar0[R_SPI_HSFS]);
+  Hsfs &= ~(Value & (B_SPI_HSFS_FCERR | B_SPI_HSFS_FDONE));
+
+  if (!mCycleBusy) {
+    Hsfs &= ~(B_SPI_HSFS_FDBC_MASK | B_SPI_HSFS_CYCLE_MASK);
+    Hsfs |= Value & (B_SPI_HSFS_FDBC_MASK | B_SPI_HSFS_CYCLE_MASK);
+
+    if ((Value & B_SPI_HSFS_CYCLE_FGO) != 0) {
+      Duration          = SpiSimCycleTime ((Hsfs & B_SPI_HSFS_CYCLE_MASK) >> N_SPI_HSFS_CYCLE);
+      Hsfs             |= B_SPI_HSFS_SCIP | B_SPI_HSFS_CYCLE_FGO;
+      mCycleBusy        = TRUE;
+      mCycleEnd         = mStats.Now + Duration;
+      mStats.Cycles    += 1;
+      mStats.CycleTime += Duration;
+    }
+  }
+
+  WriteUnaligned32 ((UINT32 *)&mBar0[R_SPI_HSFS], Hsfs);
+}
+
+/**
+  Read a simulated register.
+
+  @param[in] Address              MMIO address to read.
+  @param[in] Size                 Size of the access in bytes.
+
+  @return The register value, 0 if the address is not simulated.
+**/
+STATIC
+UINT32
+SpiSimRead (
+  IN UINTN  Address,
+  IN UINTN  Size
+  )
+{
+  UINT8   *Register;
+  UINT32  Value;
+
+  if (Address == SPI_SIM_SPI_BAR0 + R_SPI_HSFS) {
+    SpiSimUpdateCycle ();
+    if (mCycleBusy) {
+      mStats.BusyPolls++;
+    }
+  }
+
+  Value    = 0;
+  Register = SpiSimRegister (Address, Size);
+  if (Register != NULL) {
+    CopyMem (&Value, Register, Size);
+  }
+
+  return Value;
+}
+
+/**
+  Write a simulated register.
+
+  @param[in] Address              MMIO address to write.
+  @param[in] Value                Value to write.
+  @param[in] Size                 Size of the access in bytes.
+**/
+STATIC
+VOID
+SpiSimWrite (
+  IN UINTN   Address,
+  IN UINT32  Value,
+  IN UINTN   Size
+  )
+{
+  UINT8  *Register;
+
+  if ((Address == SPI_SIM_SPI_BAR0 + R_SPI_HSFS) && (Size == sizeof (UINT32))) {
+    SpiSimWriteHsfs (Value);
+    return;
+  }
+
+  Register = SpiSimRegister (Address, Size);
+  if (Register != NULL) {
+    CopyMem (Register, &Value, Size);
+  }
+}
+
+/**
+  Reset the simulated controller and flash.
+
+  The flash is filled with the loaded image, or with a byte pattern derived
+  from the address when there is none. The BIOS region covers the whole
+  flash, the controller is idle and the statistics are cleared.
+
+  @param[in] Timing               Cycle timing to simulate.
+**/
+VOID
+SpiSimReset (
+  IN CONST SPI_SIM_TIMING  *Timing
+  )
+{
+  UINTN  Index;
+  UINTN  Size;
+
+  CopyMem (&mTiming, Timing, sizeof (mTiming));
+  ZeroMem (&mStats, sizeof (mStats));
+  ZeroMem (mPciConfig, sizeof (mPciConfig));
+  ZeroMem (mBar0, sizeof (mBar0));
+  mCycleBusy = FALSE;
+  mCycleEnd  = 0;
+
+  Size = (mImage != NULL) ? mImageSize : SPI_SIM_DEFAULT_FLASH_SIZE;
+  if (mFlashSize != Size) {
+    if (mFlash != NULL) {
+      FreePool (mFlash);
+    }
+
+    mFlash     = AllocatePool (Size);
+    mFlashSize = Size;
+    ASSERT (mFlash != NULL);
+  }
+
+  if (mImage != NULL) {
+    CopyMem (mFlash, mImage, mFlashSize);
+  } else {
+    for (Index = 0; Index < mFlashSize; Index++) {
+      mFlash[Index] = (UINT8)(Index ^ (Index >> 8));
+    }
+  }
+
+  WriteUnaligned32 ((UINT32 *)&mPciConfig[R_SPI_BASE], SPI_SIM_SPI_BAR0);
+  WriteUnaligned32 ((UINT32 *)&mBar0[R_SPI_HSFS], B_SPI_HSFS_FDV);
+  WriteUnaligned32 ((UINT32 *)&mBar0[R_SPI_FRAP], MAX_UINT32);
+  WriteUnaligned32 ((UINT32 *)&mBar0[R_SPI_FREG1_BIOS], (UINT32)((mFlashSize / SIZE_4KB) - 1) << N_SPI_FREGX_LIMIT);
+  WriteUnaligned32 ((UINT32 *)&mBar0[R_SPI_LVSCC], B_SPI_LVSCC_EO_64K);
+  WriteUnaligned32 ((UINT32 *)&mBar0[R_SPI_UVSCC], B_SPI_LVSCC_EO_64K);
+
+  ZeroMem (&mSpiFlashInfoHob, sizeof (mSpiFlashInfoHob));
+  mSpiFlashInfoHob.Header.Header.HobType   = EFI_HOB_TYPE_GUID_EXTENSION;
+  mSpiFlashInfoHob.Header.Header.HobLength = (UINT16)sizeof (mSpiFlashInfoHob);
+  CopyGuid (&mSpiFlashInfoHob.Header.Name, &gSpiFlashInfoGuid);
+  mSpiFlashInfoHob.Info.SpiAddress.AddressSpaceId    = EFI_ACPI_3_0_PCI_CONFIGURATION_SPACE;
+  mSpiFlashInfoHob.Info.SpiAddress.RegisterBitWidth  = 32;
+  mSpiFlashInfoHob.Info.SpiAddress.RegisterBitOffset = 0;
+  mSpiFlashInfoHob.Info.SpiAddress.AccessSize        = EFI_ACPI_3_0_DWORD;
+  mSpiFlashInfoHob.Info.SpiAddress.Address           = SPI_SIM_PCH_SPI_BASE;
+}
+
+/**
+  Back the simulated flash with a copy of a flash image file.
+
+  Every following SpiSimReset restores the flash from the image instead
+  of the address pattern. The image file itself is never written.
+
+  @param[in] FileName             Path of the flash image on the host.
+
+  @retval EFI_SUCCESS             The image was loaded.
+  @retval EFI_NOT_FOUND           The file could not be opened or read.
+  @retval EFI_UNSUPPORTED         The size is below SPI_SIM_DEFAULT_FLASH_SIZE,
+                                  not a multiple of 4KB or above
+                                  SPI_SIM_MAX_FLASH_SIZE.
+  @retval EFI_OUT_OF_RESOURCES    There is not enough memory for the image.
+**/
+EFI_STATUS
+SpiSimLoadImage (
+  IN CONST CHAR8  *FileName
+  )
+{
+  FILE        *File;
+  long        Size;
+  UINT8       *Image;
+  EFI_STATUS  Status;
+
+  File = fopen (FileName, "rb");
+  if (File == NULL) {
+    return EFI_NOT_FOUND;
+  }
+
+  if ((fseek (File, 0, SEEK_END) != 0) || ((Size = ftell (File)) < 0) || (fseek (File, 0, SEEK_SET) != 0)) {
+    Status = EFI_NOT_FOUND;
+    goto Done;
+  }
+
+  if ((Size < SPI_SIM_DEFAULT_FLASH_SIZE) || ((Size % SIZE_4KB) != 0) || ((UINT64)Size > SPI_SIM_MAX_FLASH_SIZE)) {
+    Status = EFI_UNSUPPORTED;
+    goto Done;
+  }
+
+  Image = AllocatePool ((UINTN)Size);
+  if (Image == NULL) {
+    Status = EFI_OUT_OF_RESOURCES;
+    goto Done;
+  }
+
+  if (fread (Image, 1, (size_t)Size, File) != (size_t)Size) {
+    FreePool (Image);
+    Status = EFI_NOT_FOUND;
+    goto Done;
+  }
+
+  if (mImage != NULL) {
+    FreePool (mImage);
+  }
+
+  mImage     = Image;
+  mImageSize = (UINTN)Size;
+  Status     = EFI_SUCCESS;
+
+Done:
+  fclose (File);
+  return Status;
+}
+
+/**
+  Return the contents of the simulated flash.
+
+  @return Pointer to SpiSimFlashSize () bytes of flash.
+**/
+UINT8 *
+SpiSimFlash (
+  VOID
+  )
+{
+  return mFlash;
+}
+
+/**
+  Return the size of the simulated flash.
+
+  @return Size of the flash in bytes.
+**/
+UINTN
+SpiSimFlashSize (
+  VOID
+  )
+{
+  return mFlashSize;
+}
+
+/**
+  Return the statistics collected since the last reset.
+
+  @return Pointer to the statistics.
+**/
+SPI_SIM_STATS *
+SpiSimStats (
+  VOID
+  )
+{
+  return &mStats;
+}
+
+//
+// IoLib, TimerLib and HobLib functions used by SpiFlashLib
+//
+
+UINT8
+EFIAPI
+MmioRead8 (
+  IN UINTN  Address
+  )
+{
+  return (UINT8)SpiSimRead (Address, sizeof (UINT8));
+}
+
+UINT8
+EFIAPI
+MmioWrite8 (
+  IN UINTN  Address,
+  IN UINT8  Value
+  )
+{
+  SpiSimWrite (Address, Value, sizeof (UINT8));
+  return Value;
+}
+
+UINT16
+EFIAPI
+MmioRead16 (
+  IN UINTN  Address
+  )
+{
+  return (UINT16)SpiSimRead (Address, sizeof (UINT16));
+}
+
+UINT16
+EFIAPI
+MmioWrite16 (
+  IN UINTN   Address,
+  IN UINT16  Value
+  )
+{
+  SpiSimWrite (Address, Value, sizeof (UINT16));
+  return Value;
+}
+
+UINT32
+EFIAPI
+MmioRead32 (
+  IN UINTN  Address
+  )
+{
+  return SpiSimRead (Address, sizeof (UINT32));
+}
+
+UINT32
+EFIAPI
+MmioWrite32 (
+  IN UINTN   Address,
+  IN UINT32  Value
+  )
+{
+  SpiSimWrite (Address, Value, sizeof (UINT32));
+  return Value;
+}
+
+UINT8
+EFIAPI
+MmioOr8 (
+  IN UINTN  Address,
+  IN UINT8  OrData
+  )
+{
+  return MmioWrite8 (Address, (UINT8)(MmioRead8 (Address) | OrData));
+}
+
+UINT8
+EFIAPI
+MmioAnd8 (
+  IN UINTN  Address,
+  IN UINT8  AndData
+  )
+{
+  return MmioWrite8 (Address, (UINT8)(MmioRead8 (Address) & AndData));
+}
+
+UINT8
+EFIAPI
+MmioAndThenOr8 (
+  IN UINTN  Address,
+  IN UINT8  AndData,
+  IN UINT8  OrData
+  )
+{
+  return MmioWrite8 (Address, (UINT8)((MmioRead8 (Address) & AndData) | OrData));
+}
+
+UINT32
+EFIAPI
+MmioOr32 (
+  IN UINTN   Address,
+  IN UINT32  OrData
+  )
+{
+  return MmioWrite32 (Address, MmioRead32 (Address) | OrData);
+}
+
+UINT32
+EFIAPI
+MmioAndThenOr32 (
+  IN UINTN   Address,
+  IN UINT32  AndData,
+  IN UINT32  OrData
+  )
+{
+  return MmioWrite32 (Address, (MmioRead32 (Address) & AndData) | OrData);
+}
+
+UINTN
+EFIAPI
+MicroSecondDelay (
+  IN UINTN  MicroSeconds
+  )
+{
+  mStats.Now += MicroSeconds;
+  mStats.Delays++;
+  return MicroSeconds;
+}
+
+VOID *
+EFIAPI
+GetFirstGuidHob (
+  IN CONST EFI_GUID  *Guid
+  )
+{
+  if (!CompareGuid (Guid, &mSpiFlashInfoHob.Header.Name)) {
+    return NULL;
+  }
+
+  return &mSpiFlashInfoHob;
+}
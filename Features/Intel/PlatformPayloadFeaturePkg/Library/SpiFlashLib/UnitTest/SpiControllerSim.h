@@ -0,0 +1,114 @@
+/** @file
+  Simulated PCH SPI controller for the host based SpiFlashLib unit test.
+
+  The simulator implements the MMIO accessors, MicroSecondDelay and
+  GetFirstGuidHob used by SpiFlashLib. Time is virtual: it only advances
+  through MicroSecondDelay, so the results do not depend on the host.
+
+  The flash holds SPI_SIM_DEFAULT_FLASH_SIZE bytes of an address pattern,
+  or the contents of a flash image loaded with SpiSimLoadImage.
+
+  Copyright (c) 2026, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef SPI_CONTROLLER_SIM_H_
+#define SPI_CONTROLLER_SIM_H_
+
+#include <Uefi.h>
+
+#define SPI_SIM_PCH_SPI_BASE  0xE00FD000  ///< PCI configuration space of the SPI controller, D31:F5
+#define SPI_SIM_SPI_BAR0      0xFE010000  ///< SPI BAR0 reported by the controller
+#define SPI_SIM_DEFAULT_FLASH_SIZE  SIZE_1MB
+#define SPI_SIM_MAX_FLASH_SIZE      SIZE_128MB                          ///< Limit of the 27 bit flash linear address
+#define SPI_SIM_BIOS_BASE           (SIZE_4GB - SpiSimFlashSize ())     ///< Memory mapped address of the BIOS region
+
+///
+/// Time in microseconds the simulated flash takes for each cycle type.
+///
+typedef struct {
+  UINT32     ReadCycleTime;    ///< Read, read SFDP, read JEDEC ID and read status cycles.
+  UINT32     WriteCycleTime;   ///< Write and write status cycles.
+  UINT32     Erase4KTime;
+  UINT32     Erase64KTime;
+  BOOLEAN    NeverComplete;    ///< Keep SCIP set forever.
+  BOOLEAN    FailCycle;        ///< Report FCERR when a cycle completes.
+} SPI_SIM_TIMING;
+
+///
+/// Counters collected by the simulator.
+///
+typedef struct {
+  UINT64    Now;               ///< Virtual time in microseconds.
+  UINT64    Cycles;            ///< SPI cycles started with FGO.
+  UINT64    CycleTime;         ///< Sum of the durations of the started cycles.
+  UINT64    BusyPolls;         ///< HSFS reads while a cycle was in progress.
+  UINT64    Delays;            ///< MicroSecondDelay calls.
+} SPI_SIM_STATS;
+
+/**
+  Reset the simulated controller and flash.
+
+  The flash is filled with a byte pattern derived from the address, the
+  BIOS region covers the whole flash, the controller is idle and the
+  statistics are cleared.
+
+  @param[in] Timing               Cycle timing to simulate.
+**/
+VOID
+SpiSimReset (
+  IN CONST SPI_SIM_TIMING  *Timing
+  );
+
+/**
+  Back the simulated flash with a copy of a flash image file.
+
+  Every following SpiSimReset restores the flash from the image instead
+  of the address pattern. The image file itself is never written.
+
+  @param[in] FileName             Path of the flash image on the host.
+
+  @retval EFI_SUCCESS             The image was loaded.
+  @retval EFI_NOT_FOUND           The file could not be opened or read.
+  @retval EFI_UNSUPPORTED         The size is below SPI_SIM_DEFAULT_FLASH_SIZE,
+                                  not a multiple of 4KB or above
+                                  SPI_SIM_MAX_FLASH_SIZE.
+  @retval EFI_OUT_OF_RESOURCES    There is not enough memory for the image.
+**/
+EFI_STATUS
+SpiSimLoadImage (
+  IN CONST CHAR8  *FileName
+  );
+
+/**
+  Return the contents of the simulated flash.
+
+  @return Pointer to SpiSimFlashSize () bytes of flash.
+**/
+UINT8 *
+SpiSimFlash (
+  VOID
+  );
+
+/**
+  Return the size of the simulated flash.
+
+  @return Size of the flash in bytes.
+**/
+UINTN
+SpiSimFlashSize (
+  VOID
+  );
+
+/**
+  Return the statistics collected since the last reset.
+
+  @return Pointer to the statistics.
+**/
+SPI_SIM_STATS *
+SpiSimStats (
+  VOID
+  );
+
+#endif
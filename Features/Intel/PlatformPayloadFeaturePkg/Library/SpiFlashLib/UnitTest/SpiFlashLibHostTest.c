@@ -0,0 +1,541 @@
+/** @file
+  Host based unit test and benchmark of SpiFlashLib.
+
+  SpiFlashLib runs against a simulated SPI controller with virtual time,
+  so the tests check both the data path and how long WaitForSpiCycleComplete
+  takes to notice that a cycle has completed. The benchmarks read, write
+  and erase flash with different cycle times and report the polling
+  overhead and the resulting throughput.
+
+  The simulated flash holds an address pattern, or a copy of the flash
+  image whose path is passed as the first argument.
+
+  Copyright (c) 2026, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "../SpiCommon.h"
+#include <Library/UnitTestLib.h>
+#include "SpiControllerSim.h"
+
+#define UNIT_TEST_NAME     "SpiFlashLib Host Test"
+#define UNIT_TEST_VERSION  "1.0"
+
+#define BENCHMARK_READ_SIZE   SIZE_256KB
+#define BENCHMARK_WRITE_SIZE  SIZE_64KB
+
+///
+/// Flash range erased by the erase benchmark.
+///
+typedef struct {
+  UINT32    Offset;
+  UINT32    Length;
+} ERASE_BENCHMARK_RANGE;
+
+//
+// Read and write cycle times of a typical SPI NOR flash at 50 MHz for a
+// 64 byte cycle, and typical erase times.
+//
+STATIC SPI_SIM_TIMING  mTypicalTiming = { 3, 12, 45000, 350000, FALSE, FALSE };
+STATIC SPI_SIM_TIMING  mHangTiming    = { 3, 12, 45000, 350000, TRUE, FALSE };
+STATIC SPI_SIM_TIMING  mErrorTiming   = { 3, 12, 45000, 350000, FALSE, TRUE };
+
+STATIC SPI_SIM_TIMING  mBenchmarkTiming[] = {
+  { 1,   12, 45000, 350000, FALSE, FALSE },
+  { 3,   12, 45000, 350000, FALSE, FALSE },
+  { 8,   12, 45000, 350000, FALSE, FALSE },
+  { 20,  12, 45000, 350000, FALSE, FALSE },
+  { 155, 12, 45000, 350000, FALSE, FALSE }
+};
+
+//
+// 64 byte writes with a fast cycle, and with the page program time of a
+// slow part
+//
+STATIC SPI_SIM_TIMING  mWriteBenchmarkTiming[] = {
+  { 3, 12,  45000, 350000, FALSE, FALSE },
+  { 3, 700, 45000, 350000, FALSE, FALSE }
+};
+
+//
+// A 64KB aligned range, the same range without its first and last 4KB,
+// and a range too short for a 64KB erase
+//
+STATIC ERASE_BENCHMARK_RANGE  mEraseBenchmarkRange[] = {
+  { SIZE_256KB,            SIZE_256KB            },
+  { SIZE_256KB + SIZE_4KB, SIZE_256KB - SIZE_8KB },
+  { SIZE_256KB + SIZE_4KB, SIZE_32KB             }
+};
+
+/**
+  Reset the simulated controller with the timing passed as test context.
+
+  @param[in] Context              Pointer to the SPI_SIM_TIMING to simulate.
+
+  @retval UNIT_TEST_PASSED        The simulator was reset.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+SpiSimSetup (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  SpiSimReset ((SPI_SIM_TIMING *)Context);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  A read spanning many cycles and an unaligned start returns the flash
+  contents.
+
+  @param[in] Context              Unused.
+
+  @retval UNIT_TEST_PASSED        The test passed.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+ReadReturnsFlashContents (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  UINT8       Buffer[SIZE_4KB];
+  EFI_STATUS  Status;
+
+  Status = SpiFlashRead (FlashRegionAll, 0x1F8, sizeof (Buffer), Buffer);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+  UT_ASSERT_MEM_EQUAL (Buffer, SpiSimFlash () + 0x1F8, sizeof (Buffer));
+
+  //
+  // 8 bytes up to the 256 byte boundary, 63 cycles of 64 bytes and the
+  // remaining 56 bytes
+  //
+  UT_ASSERT_EQUAL (SpiSimStats ()->Cycles, 65);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  A write is split into valid data byte counts and lands in the flash.
+
+  @param[in] Context              Unused.
+
+  @retval UNIT_TEST_PASSED        The test passed.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+WriteProgramsFlash (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  UINT8       Buffer[100];
+  UINTN       Index;
+  EFI_STATUS  Status;
+
+  for (Index = 0; Index < sizeof (Buffer); Index++) {
+    Buffer[Index] = (UINT8)(0xA5 ^ Index);
+  }
+
+  SetMem (SpiSimFlash () + 0x2000, SIZE_4KB, 0xFF);
+  Status = SpiFlashWrite (FlashRegionAll, 0x2000, sizeof (Buffer), Buffer);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+  UT_ASSERT_MEM_EQUAL (SpiSimFlash () + 0x2000, Buffer, sizeof (Buffer));
+
+  //
+  // 64, 32 and 4 bytes
+  //
+  UT_ASSERT_EQUAL (SpiSimStats ()->Cycles, 3);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  An erase uses 64KB cycles for the aligned part of the range and each
+  long cycle is noticed within one slow polling period.
+
+  @param[in] Context              Unused.
+
+  @retval UNIT_TEST_PASSED        The test passed.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+EraseUsesLargeCycles (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  EFI_STATUS     Status;
+  SPI_SIM_STATS  *Stats;
+  UINTN          Index;
+
+  Stats  = SpiSimStats ();
+  Status = SpiFlashErase (FlashRegionAll, SIZE_64KB, SIZE_128KB + SIZE_4KB);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+
+  for (Index = SIZE_64KB; Index < SIZE_64KB + SIZE_128KB + SIZE_4KB; Index++) {
+    UT_ASSERT_EQUAL (SpiSimFlash ()[Index], 0xFF);
+  }
+
+  UT_ASSERT_EQUAL (Stats->Cycles, 3);
+  UT_ASSERT_TRUE (Stats->Now <= Stats->CycleTime + Stats->Cycles * WAIT_PERIOD);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  A short cycle is noticed within one fast polling period.
+
+  @param[in] Context              Unused.
+
+  @retval UNIT_TEST_PASSED        The test passed.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+ShortCycleIsNoticedQuickly (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  UINT8          Buffer[64];
+  EFI_STATUS     Status;
+  SPI_SIM_STATS  *Stats;
+
+  Stats  = SpiSimStats ();
+  Status = SpiFlashRead (FlashRegionAll, 0, sizeof (Buffer), Buffer);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+  UT_ASSERT_EQUAL (Stats->Cycles, 1);
+  UT_ASSERT_TRUE (Stats->Now >= mTypicalTiming.ReadCycleTime);
+  UT_ASSERT_TRUE (Stats->Now <= mTypicalTiming.ReadCycleTime + WAIT_FAST_PERIOD);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  A cycle that never completes times out after WAIT_TIME.
+
+  @param[in] Context              Unused.
+
+  @retval UNIT_TEST_PASSED        The test passed.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+HungCycleTimesOut (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  UINT8       Buffer[64];
+  EFI_STATUS  Status;
+
+  Status = SpiFlashRead (FlashRegionAll, 0, sizeof (Buffer), Buffer);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_DEVICE_ERROR);
+  UT_ASSERT_TRUE (SpiSimStats ()->Now >= WAIT_TIME);
+  UT_ASSERT_TRUE (SpiSimStats ()->Now < WAIT_TIME + WAIT_PERIOD);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  A cycle that completes with FCERR is reported as a device error.
+
+  @param[in] Context              Unused.
+
+  @retval UNIT_TEST_PASSED        The test passed.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+CycleErrorIsReported (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  UINT8       Buffer[64];
+  EFI_STATUS  Status;
+
+  Status = SpiFlashRead (FlashRegionAll, 0, sizeof (Buffer), Buffer);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_DEVICE_ERROR);
+  UT_ASSERT_EQUAL (SpiSimStats ()->Cycles, 1);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Read BENCHMARK_READ_SIZE bytes and report the time spent waiting past
+  the end of each cycle, next to what a fixed WAIT_PERIOD poll would cost.
+
+  @param[in] Context              Pointer to the SPI_SIM_TIMING simulated.
+
+  @retval UNIT_TEST_PASSED        The polling overhead is within bounds.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+ReadThroughputBenchmark (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  SPI_SIM_TIMING  *Timing;
+  SPI_SIM_STATS   *Stats;
+  UINT8           *Buffer;
+  EFI_STATUS      Status;
+  UINT64          Overhead;
+  UINT64          FixedPeriodTime;
+
+  Timing = (SPI_SIM_TIMING *)Context;
+  Stats  = SpiSimStats ();
+  Buffer = AllocatePool (BENCHMARK_READ_SIZE);
+  UT_ASSERT_NOT_NULL (Buffer);
+
+  Status = SpiFlashRead (FlashRegionAll, 0, BENCHMARK_READ_SIZE, Buffer);
+  FreePool (Buffer);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+
+  Overhead        = Stats->Now - Stats->CycleTime;
+  FixedPeriodTime = Stats->Cycles * (((Timing->ReadCycleTime + WAIT_PERIOD - 1) / WAIT_PERIOD) * WAIT_PERIOD);
+
+  UT_LOG_INFO (
+    "%dus cycles: %ld cycles, %ld polls, %ldus total, %ldns overhead per cycle, %ld KB/s (%ld KB/s with %dus polling)\n",
+    Timing->ReadCycleTime,
+    Stats->Cycles,
+    Stats->BusyPolls,
+    Stats->Now,
+    Overhead * 1000 / Stats->Cycles,
+    (UINT64)BENCHMARK_READ_SIZE * 1000000 / 1024 / Stats->Now,
+    (UINT64)BENCHMARK_READ_SIZE * 1000000 / 1024 / FixedPeriodTime,
+    WAIT_PERIOD
+    );
+
+  if (Timing->ReadCycleTime < WAIT_FAST_TIME) {
+    UT_ASSERT_TRUE (Overhead <= Stats->Cycles * WAIT_FAST_PERIOD);
+  } else {
+    UT_ASSERT_TRUE (Overhead <= Stats->Cycles * WAIT_PERIOD);
+  }
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Write BENCHMARK_WRITE_SIZE bytes to erased flash and report the time
+  spent waiting past the end of each cycle and the resulting throughput.
+
+  @param[in] Context              Pointer to the SPI_SIM_TIMING simulated.
+
+  @retval UNIT_TEST_PASSED        The polling overhead is within bounds.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+WriteThroughputBenchmark (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  SPI_SIM_TIMING  *Timing;
+  SPI_SIM_STATS   *Stats;
+  UINT8           *Buffer;
+  UINTN           Index;
+  EFI_STATUS      Status;
+  UINT64          Overhead;
+
+  Timing = (SPI_SIM_TIMING *)Context;
+  Stats  = SpiSimStats ();
+  Buffer = AllocatePool (BENCHMARK_WRITE_SIZE);
+  UT_ASSERT_NOT_NULL (Buffer);
+
+  for (Index = 0; Index < BENCHMARK_WRITE_SIZE; Index++) {
+    Buffer[Index] = (UINT8)(Index * 7);
+  }
+
+  SetMem (SpiSimFlash (), BENCHMARK_WRITE_SIZE, 0xFF);
+  Status = SpiFlashWrite (FlashRegionAll, 0, BENCHMARK_WRITE_SIZE, Buffer);
+  if (!EFI_ERROR (Status)) {
+    Status = (CompareMem (SpiSimFlash (), Buffer, BENCHMARK_WRITE_SIZE) == 0) ? EFI_SUCCESS : EFI_DEVICE_ERROR;
+  }
+
+  FreePool (Buffer);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+
+  Overhead = Stats->Now - Stats->CycleTime;
+  UT_LOG_INFO (
+    "%dus write cycles: %ld cycles, %ld polls, %ldus total, %ldns overhead per cycle, %ld KB/s\n",
+    Timing->WriteCycleTime,
+    Stats->Cycles,
+    Stats->BusyPolls,
+    Stats->Now,
+    Overhead * 1000 / Stats->Cycles,
+    (UINT64)BENCHMARK_WRITE_SIZE * 1000000 / 1024 / Stats->Now
+    );
+
+  if (Timing->WriteCycleTime < WAIT_FAST_TIME) {
+    UT_ASSERT_TRUE (Overhead <= Stats->Cycles * WAIT_FAST_PERIOD);
+  } else {
+    UT_ASSERT_TRUE (Overhead <= Stats->Cycles * WAIT_PERIOD);
+  }
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Reset the simulated controller with typical timing for the erase
+  benchmark.
+
+  @param[in] Context              Unused.
+
+  @retval UNIT_TEST_PASSED        The simulator was reset.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+EraseBenchmarkSetup (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  SpiSimReset (&mTypicalTiming);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Erase a range of flash and report the erase cycles used, the total time
+  and the resulting throughput.
+
+  @param[in] Context              Pointer to the ERASE_BENCHMARK_RANGE erased.
+
+  @retval UNIT_TEST_PASSED        The range was erased within bounds.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+EraseThroughputBenchmark (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  ERASE_BENCHMARK_RANGE  *Range;
+  SPI_SIM_STATS          *Stats;
+  UINTN                  Index;
+  EFI_STATUS             Status;
+
+  Range  = (ERASE_BENCHMARK_RANGE *)Context;
+  Stats  = SpiSimStats ();
+  Status = SpiFlashErase (FlashRegionAll, Range->Offset, Range->Length);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+
+  for (Index = Range->Offset; Index < Range->Offset + Range->Length; Index++) {
+    UT_ASSERT_EQUAL (SpiSimFlash ()[Index], 0xFF);
+  }
+
+  UT_LOG_INFO (
+    "%dKB at 0x%x: %ld cycles, %ldus total, %ldus erasing, %ld KB/s\n",
+    Range->Length / SIZE_1KB,
+    Range->Offset,
+    Stats->Cycles,
+    Stats->Now,
+    Stats->CycleTime,
+    (UINT64)Range->Length * 1000000 / 1024 / Stats->Now
+    );
+
+  UT_ASSERT_TRUE (Stats->Now <= Stats->CycleTime + Stats->Cycles * WAIT_PERIOD);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Initialize the unit test framework, suites and test cases, and run them.
+
+  @param[in] ImageFile            Path of a flash image to simulate, or NULL
+                                  to simulate an address pattern.
+
+  @retval EFI_SUCCESS             All test cases were dispatched.
+  @retval EFI_OUT_OF_RESOURCES    There are not enough resources available to
+                                  initialize the unit tests.
+  @retval others                  The flash image could not be loaded.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+UnitTestingEntry (
+  IN CONST CHAR8  *ImageFile
+  )
+{
+  EFI_STATUS                  Status;
+  UNIT_TEST_FRAMEWORK_HANDLE  Framework;
+  UNIT_TEST_SUITE_HANDLE      CycleTests;
+  UNIT_TEST_SUITE_HANDLE      Benchmark;
+  UINTN                       Index;
+
+  Framework = NULL;
+
+  DEBUG ((DEBUG_INFO, "%a v%a\n", UNIT_TEST_NAME, UNIT_TEST_VERSION));
+
+  Status = InitUnitTestFramework (&Framework, UNIT_TEST_NAME, gEfiCallerBaseName, UNIT_TEST_VERSION);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in InitUnitTestFramework. Status = %r\n", Status));
+    goto EXIT;
+  }
+
+  if (ImageFile != NULL) {
+    Status = SpiSimLoadImage (ImageFile);
+    if (EFI_ERROR (Status)) {
+      DEBUG ((DEBUG_ERROR, "Failed to load flash image %a. Status = %r\n", ImageFile, Status));
+      goto EXIT;
+    }
+  }
+
+  //
+  // SpiConstructor reads the controller setup through the simulator
+  //
+  SpiSimReset (&mTypicalTiming);
+  Status = SpiConstructor ();
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "SpiConstructor failed. Status = %r\n", Status));
+    goto EXIT;
+  }
+
+  Status = CreateUnitTestSuite (&CycleTests, Framework, "SPI Cycle Tests", "SpiFlashLib.Cycle", NULL, NULL);
+  if (EFI_ERROR (Status)) {
+    Status = EFI_OUT_OF_RESOURCES;
+    goto EXIT;
+  }
+
+  AddTestCase (CycleTests, "Read returns the flash contents", "Read", ReadReturnsFlashContents, SpiSimSetup, NULL, &mTypicalTiming);
+  AddTestCase (CycleTests, "Write programs the flash", "Write", WriteProgramsFlash, SpiSimSetup, NULL, &mTypicalTiming);
+  AddTestCase (CycleTests, "Erase uses 64KB cycles", "Erase", EraseUsesLargeCycles, SpiSimSetup, NULL, &mTypicalTiming);
+  AddTestCase (CycleTests, "Short cycle is noticed within the fast period", "ShortCycle", ShortCycleIsNoticedQuickly, SpiSimSetup, NULL, &mTypicalTiming);
+  AddTestCase (CycleTests, "Hung cycle times out", "Timeout", HungCycleTimesOut, SpiSimSetup, NULL, &mHangTiming);
+  AddTestCase (CycleTests, "Cycle error is reported", "CycleError", CycleErrorIsReported, SpiSimSetup, NULL, &mErrorTiming);
+
+  Status = CreateUnitTestSuite (&Benchmark, Framework, "SPI Benchmark", "SpiFlashLib.Benchmark", NULL, NULL);
+  if (EFI_ERROR (Status)) {
+    Status = EFI_OUT_OF_RESOURCES;
+    goto EXIT;
+  }
+
+  for (Index = 0; Index < ARRAY_SIZE (mBenchmarkTiming); Index++) {
+    AddTestCase (Benchmark, "Read throughput", "ReadThroughput", ReadThroughputBenchmark, SpiSimSetup, NULL, &mBenchmarkTiming[Index]);
+  }
+
+  for (Index = 0; Index < ARRAY_SIZE (mWriteBenchmarkTiming); Index++) {
+    AddTestCase (Benchmark, "Write throughput", "WriteThroughput", WriteThroughputBenchmark, SpiSimSetup, NULL, &mWriteBenchmarkTiming[Index]);
+  }
+
+  for (Index = 0; Index < ARRAY_SIZE (mEraseBenchmarkRange); Index++) {
+    AddTestCase (Benchmark, "Erase throughput", "EraseThroughput", EraseThroughputBenchmark, EraseBenchmarkSetup, NULL, &mEraseBenchmarkRange[Index]);
+  }
+
+  Status = RunAllTestSuites (Framework);
+
+EXIT:
+  if (Framework) {
+    FreeUnitTestFramework (Framework);
+  }
+
+  return Status;
+}
+
+/**
+  Standard POSIX C entry point for host based unit test execution.
+
+  An optional argument names the flash image to simulate.
+**/
+int
+main (
+  int   argc,
+  char  *argv[]
+  )
+{
+  return UnitTestingEntry ((argc > 1) ? argv[1] : NULL);
+}
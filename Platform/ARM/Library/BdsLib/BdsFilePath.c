@@ -21,7 +21,21 @@
 #define IS_DEVICE_PATH_NODE(node,type,subtype)    \
         (((node)->Type == (type)) && ((node)->SubType == (subtype)))
 
-#define MAX_TFTP_FILE_SIZE    0x01000000
+// Initial size of the buffer for a TFTP file whose size is not known
+#define TFTP_DEFAULT_BUFFER_SIZE  SIZE_16MB
+
+//
+// Options requested for TFTP downloads (RFC 2348 and RFC 7440). The block size
+// fills an Ethernet frame: 1500 - IPv4 header (20) - UDP header (8) - TFTP
+// header (4).
+//
+#define TFTP_BLKSIZE_OPTION       "blksize"
+#define TFTP_BLKSIZE_VALUE        "1468"
+#define TFTP_WINDOWSIZE_OPTION    "windowsize"
+#define TFTP_WINDOWSIZE_VALUE     "16"
+
+// Block size used when the server does not acknowledge the blksize option
+#define TFTP_DEFAULT_BLKSIZE      512
 
 /* Type and defines to set up the DHCP4 options */
 
@@ -883,6 +897,88 @@ Error :
   return Status;
 }
 
+/**
+  Make room for at least RequiredSize bytes in the buffer a TFTP file of
+  unknown size is downloaded to.
+
+  The buffer is first extended in place with the pages that follow it. If they
+  are not free or would end above the maximum address requested for the image,
+  a buffer twice as large is allocated and the data received so far is moved
+  to it.
+
+  @param[in, out]  Context       TFTP download context
+  @param[in]       RequiredSize  Minimum size in bytes of the buffer
+
+  @retval  EFI_SUCCESS           The buffer is large enough.
+  @retval  EFI_BUFFER_TOO_SMALL  The buffer is at a fixed address and cannot
+                                 be extended.
+  @retval  EFI_OUT_OF_RESOURCES  No memory for a larger buffer.
+
+**/
+STATIC
+EFI_STATUS
+TftpGrowBuffer (
+  IN OUT BDS_TFTP_CONTEXT  *Context,
+  IN     UINT64            RequiredSize
+  )
+{
+  EFI_STATUS            Status;
+  UINTN                 NewSize;
+  EFI_PHYSICAL_ADDRESS  Extension;
+  EFI_PHYSICAL_ADDRESS  NewBuffer;
+
+  NewSize = Context->BufferSize;
+  while (NewSize < RequiredSize) {
+    if (NewSize > (MAX_UINTN / 2)) {
+      return EFI_OUT_OF_RESOURCES;
+    }
+    NewSize *= 2;
+  }
+
+  Extension = Context->Buffer + Context->BufferSize;
+  if ((Context->AllocateType != AllocateMaxAddress) ||
+      (Extension + (NewSize - Context->BufferSize) - 1 <= Context->MaxAddress)) {
+    Status = gBS->AllocatePages (
+                    AllocateAddress,
+                    EfiBootServicesCode,
+                    EFI_SIZE_TO_PAGES (NewSize - Context->BufferSize),
+                    &Extension
+                    );
+    if (!EFI_ERROR (Status)) {
+      Context->BufferSize = NewSize;
+      return EFI_SUCCESS;
+    }
+  }
+
+  // An image requested at a fixed address can only grow in place
+  if (Context->AllocateType == AllocateAddress) {
+    return EFI_BUFFER_TOO_SMALL;
+  }
+
+  NewBuffer = Context->MaxAddress;
+  Status = gBS->AllocatePages (
+                  Context->AllocateType,
+                  EfiBootServicesCode,
+                  EFI_SIZE_TO_PAGES (NewSize),
+                  &NewBuffer
+                  );
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  CopyMem (
+    (VOID*)(UINTN)NewBuffer,
+    (VOID*)(UINTN)Context->Buffer,
+    (UINTN)Context->DownloadedNbOfBytes
+    );
+  gBS->FreePages (Context->Buffer, EFI_SIZE_TO_PAGES (Context->BufferSize));
+
+  Context->Buffer     = NewBuffer;
+  Context->BufferSize = NewSize;
+
+  return EFI_SUCCESS;
+}
+
 /**
   Update the progress of a file download
   This procedure is called each time a new TFTP packet is received.
@@ -892,7 +988,14 @@ Error :
   @param[in]  PacketLen  Length of the packet
   @param[in]  Packet     Address of the packet
 
+  When the size of the file is not known, MTFTP4 does not store the data and
+  the blocks are copied here to the image buffer. As MTFTP4 does, the offset
+  of a block is computed from its number and the negotiated block size, the
+  block number wrapping from 65535 to 0.
+
   @retval  EFI_SUCCESS  All packets are accepted.
+  @retval  Others       The image buffer could not be grown, the download is
+                        aborted.
 
 **/
 STATIC
@@ -904,7 +1007,9 @@ Mtftp4CheckPacket (
   IN EFI_MTFTP4_PACKET    *Packet
   )
 {
+  EFI_STATUS        Status;
   BDS_TFTP_CONTEXT  *Context;
+  UINTN             DataLen;
   CHAR16            Progress[TFTP_PROGRESS_MESSAGE_SIZE];
   UINT64            NbOfKb;
   UINTN             Index;
@@ -912,6 +1017,25 @@ Mtftp4CheckPacket (
   UINTN             Step;
   UINT64            LastNbOf50Kb;
   UINT64            NbOf50Kb;
+  UINT64            Block;
+  UINT64            Offset;
+  EFI_MTFTP4_OPTION *TableOfOptions;
+  UINT32            OptCnt;
+
+  if ((NTOHS (Packet->OpCode)) == EFI_MTFTP4_OPCODE_OACK) {
+    Context = (BDS_TFTP_CONTEXT*)Token->Context;
+
+    Status = This->ParseOptions (This, PacketLen, Packet, &OptCnt, &TableOfOptions);
+    if (!EFI_ERROR (Status)) {
+      for (Index = 0; Index < OptCnt; Index++) {
+        if ((AsciiStriCmp ((CHAR8 *)TableOfOptions[Index].OptionStr, TFTP_BLKSIZE_OPTION) == 0) &&
+            (AsciiStrDecimalToUintn ((CHAR8 *)TableOfOptions[Index].ValueStr) != 0)) {
+          Context->BlockSize = AsciiStrDecimalToUintn ((CHAR8 *)TableOfOptions[Index].ValueStr);
+        }
+      }
+      FreePool (TableOfOptions);
+    }
+  }
 
   if ((NTOHS (Packet->OpCode)) == EFI_MTFTP4_OPCODE_DATA) {
     Context = (BDS_TFTP_CONTEXT*)Token->Context;
@@ -929,7 +1053,39 @@ Mtftp4CheckPacket (
     // . OpCode = EFI_MTFTP4_OPCODE_DATA
     // . Block  = the number of this block of data
     //
-    Context->DownloadedNbOfBytes += PacketLen - sizeof (Packet->OpCode) - sizeof (Packet->Data.Block);
+    DataLen = PacketLen - sizeof (Packet->OpCode) - sizeof (Packet->Data.Block);
+
+    //
+    // Take the block number closest to the last one received, with the
+    // same number of wraparounds or one more or less.
+    //
+    Block = (Context->LastBlock & ~(UINT64)MAX_UINT16) | NTOHS (Packet->Data.Block);
+    if (Block + 0x8000 < Context->LastBlock) {
+      Block += MAX_UINT16 + 1;
+    } else if ((Block > Context->LastBlock + 0x8000) && (Block > MAX_UINT16)) {
+      Block -= MAX_UINT16 + 1;
+    }
+    if (Block == 0) {
+      return EFI_SUCCESS;
+    }
+    Context->LastBlock = MAX (Context->LastBlock, Block);
+    Offset = MultU64x32 (Block - 1, (UINT32)Context->BlockSize);
+
+    if (Token->Buffer == NULL) {
+      if ((Offset + DataLen) > Context->BufferSize) {
+        Status = TftpGrowBuffer (Context, Offset + DataLen);
+        if (EFI_ERROR (Status)) {
+          return Status;
+        }
+      }
+      CopyMem (
+        (UINT8*)(UINTN)Context->Buffer + (UINTN)Offset,
+        Packet->Data.Data,
+        DataLen
+        );
+    }
+
+    Context->DownloadedNbOfBytes = MAX (Context->DownloadedNbOfBytes, Offset + DataLen);
     NbOfKb = Context->DownloadedNbOfBytes / 1024;
 
     Progress[0] = L'\0';
@@ -973,6 +1129,81 @@ Mtftp4CheckPacket (
   return EFI_SUCCESS;
 }
 
+/**
+  Download a file from a TFTP server into the buffer of a TFTP context
+
+  The block size and window size options are requested from the server. A
+  server that answers them with an error is asked again without options.
+
+  @param[in]       Mtftp4     MTFTP4 protocol interface
+  @param[in]       FilePath   Path of the file, Ascii encoded
+  @param[in]       SizeKnown  TRUE if the buffer was allocated for the size
+                              of the file returned by the server. FALSE to
+                              store the blocks from Mtftp4CheckPacket().
+  @param[in, out]  Context    TFTP download context
+
+  @retval  EFI_SUCCESS  The file was downloaded, its size is
+                        Context->DownloadedNbOfBytes.
+  @retval  Others       Error returned by the MTFTP4 ReadFile() function.
+
+**/
+STATIC
+EFI_STATUS
+Mtftp4DownloadFile (
+  IN     EFI_MTFTP4_PROTOCOL  *Mtftp4,
+  IN     CHAR8                *FilePath,
+  IN     BOOLEAN              SizeKnown,
+  IN OUT BDS_TFTP_CONTEXT     *Context
+  )
+{
+  EFI_STATUS         Status;
+  EFI_MTFTP4_TOKEN   Mtftp4Token;
+  EFI_MTFTP4_OPTION  ReqOpt[2];
+
+  ReqOpt[0].OptionStr = (UINT8*)TFTP_BLKSIZE_OPTION;
+  ReqOpt[0].ValueStr  = (UINT8*)TFTP_BLKSIZE_VALUE;
+  ReqOpt[1].OptionStr = (UINT8*)TFTP_WINDOWSIZE_OPTION;
+  ReqOpt[1].ValueStr  = (UINT8*)TFTP_WINDOWSIZE_VALUE;
+
+  ZeroMem (&Mtftp4Token, sizeof (EFI_MTFTP4_TOKEN));
+  Mtftp4Token.Filename    = (UINT8*)FilePath;
+  Mtftp4Token.OptionCount = ARRAY_SIZE (ReqOpt);
+  Mtftp4Token.OptionList  = ReqOpt;
+  Mtftp4Token.CheckPacket = Mtftp4CheckPacket;
+  Mtftp4Token.Context     = (VOID*)Context;
+  if (SizeKnown) {
+    Mtftp4Token.BufferSize = Context->BufferSize;
+    Mtftp4Token.Buffer     = (VOID *)(UINTN)Context->Buffer;
+  }
+
+  Context->DownloadedNbOfBytes   = 0;
+  Context->LastReportedNbOfBytes = 0;
+  Context->BlockSize             = TFTP_DEFAULT_BLKSIZE;
+  Context->LastBlock             = 0;
+
+  Print (L"Downloading the file <%a> from the TFTP server\n", FilePath);
+  Status = Mtftp4->ReadFile (Mtftp4, &Mtftp4Token);
+  Print (L"\n");
+
+  if ((Status == EFI_TFTP_ERROR) && (Context->DownloadedNbOfBytes == 0)) {
+    Print (L"TFTP server rejected the transfer options, retrying without them\n");
+    Mtftp4Token.OptionCount = 0;
+    Mtftp4Token.OptionList  = NULL;
+    Mtftp4Token.BufferSize  = SizeKnown ? Context->BufferSize : 0;
+    Mtftp4Token.Status      = EFI_SUCCESS;
+    Context->BlockSize      = TFTP_DEFAULT_BLKSIZE;
+
+    Status = Mtftp4->ReadFile (Mtftp4, &Mtftp4Token);
+    Print (L"\n");
+  }
+
+  if (!EFI_ERROR (Status) && SizeKnown) {
+    Context->DownloadedNbOfBytes = Mtftp4Token.BufferSize;
+  }
+
+  return Status;
+}
+
 /**
   Download an image from a TFTP server
 
@@ -1014,11 +1245,11 @@ BdsTftpLoadImage (
   IPv4_DEVICE_PATH         *IPv4DevicePathNode;
   CHAR16                   *PathName;
   CHAR8                    *AsciiFilePath;
-  EFI_MTFTP4_TOKEN         Mtftp4Token;
   UINT64                   FileSize;
   UINT64                   TftpBufferSize;
   BDS_TFTP_CONTEXT         *TftpContext;
   UINTN                    PathNameLen;
+  UINTN                    ImagePages;
 
   ASSERT(IS_DEVICE_PATH_NODE (RemainingDevicePath, MESSAGING_DEVICE_PATH, MSG_IPv4_DP));
   IPv4DevicePathNode = (IPv4_DEVICE_PATH*)RemainingDevicePath;
@@ -1168,13 +1399,15 @@ BdsTftpLoadImage (
 
   //
   // Try to get the size of the file in bytes from the server. If it fails,
-  // start with a 8MB buffer to download the file.
+  // start with a 16MB buffer that is grown as the file is downloaded.
   //
   FileSize = 0;
-  if (Mtftp4GetFileSize (Mtftp4, AsciiFilePath, &FileSize) == EFI_SUCCESS) {
+  if ((Mtftp4GetFileSize (Mtftp4, AsciiFilePath, &FileSize) == EFI_SUCCESS) &&
+      (FileSize > 0) && (FileSize <= MAX_UINTN)) {
     TftpBufferSize = FileSize;
   } else {
-    TftpBufferSize = SIZE_16MB;
+    FileSize       = 0;
+    TftpBufferSize = TFTP_DEFAULT_BUFFER_SIZE;
   }
 
   TftpContext = AllocatePool (sizeof (BDS_TFTP_CONTEXT));
@@ -1182,49 +1415,56 @@ BdsTftpLoadImage (
     Status = EFI_OUT_OF_RESOURCES;
     goto Error;
   }
-  TftpContext->FileSize = FileSize;
 
-  for (; TftpBufferSize <= MAX_TFTP_FILE_SIZE;
-         TftpBufferSize = (TftpBufferSize + SIZE_16MB) & (~(SIZE_16MB-1))) {
+  //
+  // Allocate the buffer the file is downloaded to. The data is written
+  // straight to it, whether the size of the file is known or not.
+  //
+  TftpContext->FileSize     = FileSize;
+  TftpContext->AllocateType = Type;
+  TftpContext->MaxAddress   = *Image;
+  TftpContext->BufferSize   = EFI_PAGES_TO_SIZE (EFI_SIZE_TO_PAGES ((UINTN)TftpBufferSize));
+  Status = gBS->AllocatePages (
+                  Type,
+                  EfiBootServicesCode,
+                  EFI_SIZE_TO_PAGES (TftpContext->BufferSize),
+                  &TftpContext->Buffer
+                  );
+  if (EFI_ERROR (Status)) {
+    Print (L"Failed to allocate space for image\n");
+    goto Error;
+  }
+
+  Status = Mtftp4DownloadFile (Mtftp4, AsciiFilePath, (FileSize > 0), TftpContext);
+  if (Status == EFI_BUFFER_TOO_SMALL) {
     //
-    // Allocate a buffer to hold the whole file.
+    // The file is larger than the size announced by the server. Download it
+    // again, growing the buffer as needed.
     //
-    Status = gBS->AllocatePages (
-                    Type,
-                    EfiBootServicesCode,
-                    EFI_SIZE_TO_PAGES (TftpBufferSize),
-                    Image
-                    );
-    if (EFI_ERROR (Status)) {
-      Print (L"Failed to allocate space for image\n");
-      goto Error;
-    }
-
-    TftpContext->DownloadedNbOfBytes   = 0;
-    TftpContext->LastReportedNbOfBytes = 0;
-
-    ZeroMem (&Mtftp4Token, sizeof (EFI_MTFTP4_TOKEN));
-    Mtftp4Token.Filename    = (UINT8*)AsciiFilePath;
-    Mtftp4Token.BufferSize  = TftpBufferSize;
-    Mtftp4Token.Buffer      = (VOID *)(UINTN)*Image;
-    Mtftp4Token.CheckPacket = Mtftp4CheckPacket;
-    Mtftp4Token.Context     = (VOID*)TftpContext;
-
-    Print (L"Downloading the file <%a> from the TFTP server\n", AsciiFilePath);
-    Status = Mtftp4->ReadFile (Mtftp4, &Mtftp4Token);
-    Print (L"\n");
-    if (EFI_ERROR (Status)) {
-      gBS->FreePages (*Image, EFI_SIZE_TO_PAGES (TftpBufferSize));
-      if (Status == EFI_BUFFER_TOO_SMALL) {
-        Print (L"Downloading failed, file larger than expected.\n");
-        continue;
-      } else {
-        goto Error;
-      }
-    }
+    Print (L"Downloading failed, file larger than expected.\n");
+    TftpContext->FileSize = 0;
+    Status = Mtftp4DownloadFile (Mtftp4, AsciiFilePath, FALSE, TftpContext);
+  }
+  if (EFI_ERROR (Status)) {
+    gBS->FreePages (TftpContext->Buffer, EFI_SIZE_TO_PAGES (TftpContext->BufferSize));
+    goto Error;
+  }
 
-    *ImageSize = Mtftp4Token.BufferSize;
-    break;
+  //
+  // Release the pages past the end of the file so that the image can be freed
+  // with its size.
+  //
+  *Image     = TftpContext->Buffer;
+  *ImageSize = (UINTN)TftpContext->DownloadedNbOfBytes;
+  ImagePages = EFI_SIZE_TO_PAGES (*ImageSize);
+  if (ImagePages == 0) {
+    ImagePages = 1;
+  }
+  if (EFI_SIZE_TO_PAGES (TftpContext->BufferSize) > ImagePages) {
+    gBS->FreePages (
+           *Image + EFI_PAGES_TO_SIZE (ImagePages),
+           EFI_SIZE_TO_PAGES (TftpContext->BufferSize) - ImagePages
+           );
   }
 
 Error:
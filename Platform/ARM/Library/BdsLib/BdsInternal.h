@@ -88,9 +88,20 @@ typedef struct _BDS_SYSTEM_MEMORY_RESOURCE {
 } BDS_SYSTEM_MEMORY_RESOURCE;
 
 typedef struct {
-  UINT64  FileSize;
-  UINT64  DownloadedNbOfBytes;
-  UINT64  LastReportedNbOfBytes;
+  UINT64                FileSize;
+  UINT64                DownloadedNbOfBytes;
+  UINT64                LastReportedNbOfBytes;
+  // Buffer the file is downloaded to. When the size of the file is not known
+  // beforehand, the data blocks are stored by the CheckPacket() callback and
+  // the buffer is grown on demand.
+  EFI_ALLOCATE_TYPE     AllocateType;
+  EFI_PHYSICAL_ADDRESS  MaxAddress;
+  EFI_PHYSICAL_ADDRESS  Buffer;
+  UINTN                 BufferSize;
+  // Negotiated block size and number of the last data block received, not
+  // wrapped at 65535, to locate the data blocks in the buffer.
+  UINTN                 BlockSize;
+  UINT64                LastBlock;
 } BDS_TFTP_CONTEXT;
 
 /**
@@ -1027,9 +1027,28 @@ SnpGetStatus (
   // Check Status of transmitted packets
   // (We ignore TXSTATUS_NO_CA has it might happen in Full Duplex)
 
-  NumTxStatusEntries = Lan9118MmioRead32(LAN9118_TX_FIFO_INF) & TXFIFOINF_TXSUSED_MASK;
-  if (NumTxStatusEntries > 0) {
-    TxStatus = Lan9118MmioRead32 (LAN9118_TX_STATUS);
+  // Reap all the statuses present in the Tx status FIFO in one burst. They
+  // are then returned one per call, without accessing the controller again.
+  if (LanDriver->TxStatusCount == 0) {
+    NumTxStatusEntries = (Lan9118MmioRead32 (LAN9118_TX_FIFO_INF) & TXFIFOINF_TXSUSED_MASK) >> 16;
+    if (NumTxStatusEntries > LAN9118_TX_RING_NUM_ENTRIES) {
+      NumTxStatusEntries = LAN9118_TX_RING_NUM_ENTRIES;
+    }
+    if (NumTxStatusEntries > 0) {
+      Lan9118MmioReadFifo32 (LAN9118_TX_STATUS, LanDriver->TxStatusQueue, NumTxStatusEntries);
+      LanDriver->TxStatusHead = 0;
+      LanDriver->TxStatusCount = NumTxStatusEntries;
+    }
+  }
+
+  if (LanDriver->TxStatusCount > 0) {
+    TxStatus = LanDriver->TxStatusQueue[LanDriver->TxStatusHead];
+    LanDriver->TxStatusHead = (LanDriver->TxStatusHead + 1) % LAN9118_TX_RING_NUM_ENTRIES;
+    LanDriver->TxStatusCount--;
+    if (LanDriver->TxPending > 0) {
+      LanDriver->TxPending--;
+    }
+
     PacketTag = TxStatus >> 16;
     TxStatus = TxStatus & 0xFFFF;
     if ((TxStatus & TXSTATUS_ES) && (TxStatus != (TXSTATUS_ES | TXSTATUS_NO_CA))) {
@@ -1080,13 +1099,12 @@ SnpGetStatus (
     }
 
     //
-    // Restart the transmitter and if necessary the receiver.
-    // Do not ask for FIFO reset as it has already been done
-    // by SoftReset().
+    // Restart the transmitter and if necessary the receiver with
+    // empty FIFOs and no frame left queued from before the reset.
     //
-    StartTx (START_TX_MAC | START_TX_CFG, Snp);
+    StartTx (START_TX_MAC | START_TX_CFG | START_TX_CLEAR, Snp);
     if (Snp->Mode->ReceiveFilterSetting != 0) {
-      StartRx (0, Snp);
+      StartRx (START_RX_CLEAR, Snp);
     }
   }
 
@@ -1120,10 +1138,8 @@ SnpTransmit (
 {
   LAN9118_DRIVER *LanDriver;
   UINT32 TxFreeSpace;
-  UINT32 TxStatusSpace;
-  INT32 Count;
-  UINT32 CommandA;
-  UINT32 CommandB;
+  UINT32 Command[2];
+  UINT32 Header[4];
   UINT16 LocalProtocol;
   UINT32 *LocalData;
   UINT16 PacketTag;
@@ -1176,15 +1192,15 @@ SnpTransmit (
     return EFI_NOT_READY;
   }*/
 
-  // Get DATA FIFO free space in bytes
-  TxFreeSpace = TxDataFreeSpace (0, Snp);
-  if (TxFreeSpace < BuffSize) {
+  // Packets are queued until their buffer is returned by GetStatus. The
+  // Tx status FIFO and TxRing have room for LAN9118_TX_RING_NUM_ENTRIES.
+  if (LanDriver->TxPending >= LAN9118_TX_RING_NUM_ENTRIES) {
     return EFI_NOT_READY;
   }
 
-  // Get STATUS FIFO used space in bytes
-  TxStatusSpace = TxStatusUsedSpace (0, Snp);
-  if (TxStatusSpace > 500) {
+  // Get DATA FIFO free space in bytes
+  TxFreeSpace = TxDataFreeSpace (0, Snp);
+  if (TxFreeSpace < BuffSize) {
     return EFI_NOT_READY;
   }
 
@@ -1216,71 +1232,56 @@ SnpTransmit (
     LocalProtocol = *Protocol;
 
     // Create first buffer to pass to controller (for the header)
-    CommandA = TX_CMD_A_FIRST_SEGMENT | TX_CMD_A_BUFF_SIZE (HdrSize);
-    CommandB = TX_CMD_B_PACKET_TAG (PacketTag) | TX_CMD_B_PACKET_LENGTH (BuffSize);
-
-    // Write the commands first
-    Lan9118MmioWrite32 (LAN9118_TX_DATA, CommandA);
-    Lan9118MmioWrite32 (LAN9118_TX_DATA, CommandB);
-
-    // Write the destination address
-    Lan9118MmioWrite32 (LAN9118_TX_DATA,
-               (DstAddr->Addr[0]) |
-               (DstAddr->Addr[1] << 8) |
-               (DstAddr->Addr[2] << 16) |
-               (DstAddr->Addr[3] << 24)
-               );
-
-    Lan9118MmioWrite32 (LAN9118_TX_DATA,
-               (DstAddr->Addr[4]) |
-               (DstAddr->Addr[5] << 8) |
-               (SrcAddr->Addr[0] << 16) | // Write the Source Address
-               (SrcAddr->Addr[1] << 24)
-               );
-
-    Lan9118MmioWrite32 (LAN9118_TX_DATA,
-               (SrcAddr->Addr[2]) |
-               (SrcAddr->Addr[3] << 8) |
-               (SrcAddr->Addr[4] << 16) |
-               (SrcAddr->Addr[5] << 24)
-               );
-
-    // Write the Protocol
-    Lan9118MmioWrite32 (LAN9118_TX_DATA, (UINT32)(HTONS (LocalProtocol)));
+    Command[0] = TX_CMD_A_FIRST_SEGMENT | TX_CMD_A_BUFF_SIZE (HdrSize);
+    Command[1] = TX_CMD_B_PACKET_TAG (PacketTag) | TX_CMD_B_PACKET_LENGTH (BuffSize);
 
-    // Next buffer is the payload
-    CommandA = TX_CMD_A_LAST_SEGMENT | TX_CMD_A_BUFF_SIZE (BuffSize - HdrSize) | TX_CMD_A_COMPLETION_INT | TX_CMD_A_DATA_START_OFFSET (2); // 2 bytes beginning offset
+    // Destination address
+    Header[0] = (DstAddr->Addr[0]) |
+                (DstAddr->Addr[1] << 8) |
+                (DstAddr->Addr[2] << 16) |
+                (DstAddr->Addr[3] << 24);
 
-    // Write the commands
-    Lan9118MmioWrite32 (LAN9118_TX_DATA, CommandA);
-    Lan9118MmioWrite32 (LAN9118_TX_DATA, CommandB);
+    Header[1] = (DstAddr->Addr[4]) |
+                (DstAddr->Addr[5] << 8) |
+                (SrcAddr->Addr[0] << 16) | // Source Address
+                (SrcAddr->Addr[1] << 24);
 
-    // Write the payload
-    for (Count = 0; Count < ((BuffSize + 3) >> 2) - 3; Count++) {
-      Lan9118MmioWrite32 (LAN9118_TX_DATA, LocalData[Count + 3]);
-    }
+    Header[2] = (SrcAddr->Addr[2]) |
+                (SrcAddr->Addr[3] << 8) |
+                (SrcAddr->Addr[4] << 16) |
+                (SrcAddr->Addr[5] << 24);
+
+    // Protocol
+    Header[3] = (UINT32)(HTONS (LocalProtocol));
+
+    // Write the commands first, then the header
+    Lan9118MmioWriteFifo32 (LAN9118_TX_DATA, Command, 2);
+    Lan9118MmioWriteFifo32 (LAN9118_TX_DATA, Header, 4);
+
+    // Next buffer is the payload
+    Command[0] = TX_CMD_A_LAST_SEGMENT | TX_CMD_A_BUFF_SIZE (BuffSize - HdrSize) | TX_CMD_A_COMPLETION_INT | TX_CMD_A_DATA_START_OFFSET (2); // 2 bytes beginning offset
+
+    // Write the commands and the payload
+    Lan9118MmioWriteFifo32 (LAN9118_TX_DATA, Command, 2);
+    Lan9118MmioWriteFifo32 (LAN9118_TX_DATA, &LocalData[3], ((BuffSize + 3) >> 2) - 3);
   } else {
     // Format pointer
     LocalData = (UINT32*) Data;
 
     // Create a buffer to pass to controller
-    CommandA = TX_CMD_A_FIRST_SEGMENT | TX_CMD_A_LAST_SEGMENT | TX_CMD_A_BUFF_SIZE (BuffSize) | TX_CMD_A_COMPLETION_INT;
-    CommandB = TX_CMD_B_PACKET_TAG (PacketTag) | TX_CMD_B_PACKET_LENGTH (BuffSize);
-
-    // Write the commands first
-    Lan9118MmioWrite32 (LAN9118_TX_DATA, CommandA);
-    Lan9118MmioWrite32 (LAN9118_TX_DATA, CommandB);
+    Command[0] = TX_CMD_A_FIRST_SEGMENT | TX_CMD_A_LAST_SEGMENT | TX_CMD_A_BUFF_SIZE (BuffSize) | TX_CMD_A_COMPLETION_INT;
+    Command[1] = TX_CMD_B_PACKET_TAG (PacketTag) | TX_CMD_B_PACKET_LENGTH (BuffSize);
 
-    // Write all the data
-    for (Count = 0; Count < ((BuffSize + 3) >> 2); Count++) {
-      Lan9118MmioWrite32 (LAN9118_TX_DATA, LocalData[Count]);
-    }
+    // Write the commands first, then all the data
+    Lan9118MmioWriteFifo32 (LAN9118_TX_DATA, Command, 2);
+    Lan9118MmioWriteFifo32 (LAN9118_TX_DATA, LocalData, (BuffSize + 3) >> 2);
   }
 
   // Save the address of the submitted packet so we can notify the consumer that
   // it has been sent in GetStatus. When the packet tag appears in the Tx Status
   // Fifo, we will return Buffer in the TxBuff parameter of GetStatus.
   LanDriver->TxRing[PacketTag % LAN9118_TX_RING_NUM_ENTRIES] = Data;
+  LanDriver->TxPending++;
 
 #if defined(EVAL_PERFORMANCE)
   EndClock = GetPerformanceCounter ();
@@ -1312,11 +1313,8 @@ SnpReceive (
   LAN9118_DRIVER  *LanDriver;
   UINT32          IntSts;
   UINT32          RxFifoStatus;
-  UINT32          NumPackets;
-  UINT32          RxCfgValue;
   UINT32          PLength; // Packet length
   UINT32          ReadLimit;
-  UINT32          Count;
   UINT32          Padding;
   UINT32          *RawData;
   EFI_MAC_ADDRESS Dst;
@@ -1366,18 +1364,34 @@ SnpReceive (
     Lan9118MmioWrite32 (LAN9118_INT_STS, INSTS_RXE);
   }
 
-  // Count dropped frames
-  DroppedFrames = Lan9118MmioRead32 (LAN9118_RX_DROP);
-  LanDriver->Stats.RxDroppedFrames += DroppedFrames;
+  // The Rx FIFO information is only polled again once all the frames found
+  // by the previous poll have been drained.
+  if (LanDriver->RxPending == 0) {
+    // Count dropped frames
+    DroppedFrames = Lan9118MmioRead32 (LAN9118_RX_DROP);
+    LanDriver->Stats.RxDroppedFrames += DroppedFrames;
 
-  NumPackets = RxStatusUsedSpace (0, Snp) / 4;
-  if (!NumPackets) {
-    return EFI_NOT_READY;
+    LanDriver->RxPending = RxStatusUsedSpace (0, Snp) / 4;
+    if (LanDriver->RxPending == 0) {
+      return EFI_NOT_READY;
+    }
   }
 
-  // Read Rx Status (only if not empty)
-  RxFifoStatus = Lan9118MmioRead32 (LAN9118_RX_STATUS);
-  LanDriver->Stats.RxTotalFrames += 1;
+  // Peek at the Rx Status so that the frame stays queued if the caller's
+  // buffer turns out to be too small.
+  RxFifoStatus = Lan9118MmioRead32 (LAN9118_RX_STATUS_PEEK);
+
+  // Get the received packet length
+  PLength = GET_RXSTATUS_PACKET_LENGTH(RxFifoStatus);
+
+  // If padding is applied, read more DWORDs
+  if (PLength % 4) {
+    Padding = 4 - (PLength % 4);
+    ReadLimit = (PLength + Padding)/4;
+  } else {
+    ReadLimit = PLength/4;
+    Padding = 0;
+  }
 
   // First check for errors
   if ((RxFifoStatus & RXSTATUS_MII_ERROR) ||
@@ -1385,27 +1399,42 @@ SnpReceive (
       (RxFifoStatus & RXSTATUS_FTL) ||
       (RxFifoStatus & RXSTATUS_LCOLL) ||
       (RxFifoStatus & RXSTATUS_LE) ||
-      (RxFifoStatus & RXSTATUS_DB))
+      (RxFifoStatus & RXSTATUS_DB) ||
+      (RxFifoStatus & RXSTATUS_CRC_ERROR) ||
+      (RxFifoStatus & RXSTATUS_RUNT))
   {
-    DEBUG ((EFI_D_WARN, "Warning: There was an error on frame reception.\n"));
+    // Pop the status and drop the frame data so the next frame can be read
+    Lan9118MmioRead32 (LAN9118_RX_STATUS);
+    DiscardRxFrame (ReadLimit, Snp);
+    LanDriver->RxPending--;
+    LanDriver->Stats.RxTotalFrames += 1;
+
+    // Check if we got a CRC error
+    if (RxFifoStatus & RXSTATUS_CRC_ERROR) {
+      DEBUG ((EFI_D_WARN, "Warning: Crc Error\n"));
+      LanDriver->Stats.RxCrcErrorFrames += 1;
+      LanDriver->Stats.RxDroppedFrames += 1;
+    // Check if we got a runt frame
+    } else if (RxFifoStatus & RXSTATUS_RUNT) {
+      DEBUG ((EFI_D_WARN, "Warning: Runt Frame\n"));
+      LanDriver->Stats.RxUndersizeFrames += 1;
+      LanDriver->Stats.RxDroppedFrames += 1;
+    } else {
+      DEBUG ((EFI_D_WARN, "Warning: There was an error on frame reception.\n"));
+    }
     return EFI_DEVICE_ERROR;
   }
 
-  // Check if we got a CRC error
-  if (RxFifoStatus & RXSTATUS_CRC_ERROR) {
-    DEBUG ((EFI_D_WARN, "Warning: Crc Error\n"));
-    LanDriver->Stats.RxCrcErrorFrames += 1;
-    LanDriver->Stats.RxDroppedFrames += 1;
-    return EFI_DEVICE_ERROR;
+  // Check buffer size
+  if (*BuffSize < (PLength + Padding)) {
+    *BuffSize = PLength + Padding;
+    return EFI_BUFFER_TOO_SMALL;
   }
 
-  // Check if we got a runt frame
-  if (RxFifoStatus & RXSTATUS_RUNT) {
-    DEBUG ((EFI_D_WARN, "Warning: Runt Frame\n"));
-    LanDriver->Stats.RxUndersizeFrames += 1;
-    LanDriver->Stats.RxDroppedFrames += 1;
-    return EFI_DEVICE_ERROR;
-  }
+  // Read Rx Status
+  Lan9118MmioRead32 (LAN9118_RX_STATUS);
+  LanDriver->RxPending--;
+  LanDriver->Stats.RxTotalFrames += 1;
 
   // Check filtering status for this packet
   if (RxFifoStatus & RXSTATUS_FILT_FAIL) {
@@ -1428,35 +1457,8 @@ SnpReceive (
     LanDriver->Stats.RxUnicastFrames += 1;
   }
 
-  // Get the received packet length
-  PLength = GET_RXSTATUS_PACKET_LENGTH(RxFifoStatus);
   LanDriver->Stats.RxTotalBytes += (PLength - 4);
 
-  // If padding is applied, read more DWORDs
-  if (PLength % 4) {
-    Padding = 4 - (PLength % 4);
-    ReadLimit = (PLength + Padding)/4;
-  } else {
-    ReadLimit = PLength/4;
-    Padding = 0;
-  }
-
-  // Check buffer size
-  if (*BuffSize < (PLength + Padding)) {
-    *BuffSize = PLength + Padding;
-    return EFI_BUFFER_TOO_SMALL;
-  }
-
-  // Set the amount of data to be transferred out of FIFO for THIS packet
-  // This can be used to trigger an interrupt, and status can be checked
-  RxCfgValue = Lan9118MmioRead32 (LAN9118_RX_CFG);
-  RxCfgValue &= ~(RXCFG_RX_DMA_CNT_MASK);
-  RxCfgValue |= RXCFG_RX_DMA_CNT (ReadLimit);
-
-  // Set end alignment to 4-bytes
-  RxCfgValue &= ~(RXCFG_RX_END_ALIGN_MASK);
-  Lan9118MmioWrite32 (LAN9118_RX_CFG, RxCfgValue);
-
   // Update buffer size
   *BuffSize = PLength; // -4 bytes may be needed: Received in buffer as
                        // 4 bytes longer than packet actually is, unless
@@ -1469,9 +1471,7 @@ SnpReceive (
   RawData = (UINT32*)Data;
 
   // Read Rx Packet
-  for (Count = 0; Count < ReadLimit; Count++) {
-    RawData[Count] = Lan9118MmioRead32 (LAN9118_RX_DATA);
-  }
+  Lan9118MmioReadFifo32 (LAN9118_RX_DATA, RawData, ReadLimit);
 
   // Get the destination address
   if (DstAddr != NULL) {
@@ -1518,11 +1518,11 @@ SnpReceive (
     }
 
     //
-    // Restart the receiver and the transmitter without resetting the FIFOs
-    // as it has been done by SoftReset().
+    // Restart the receiver and the transmitter with empty FIFOs and
+    // no frame left queued from before the reset.
     //
-    StartRx (0, Snp);
-    StartTx (START_TX_MAC | START_TX_CFG, Snp);
+    StartRx (START_RX_CLEAR, Snp);
+    StartTx (START_TX_MAC | START_TX_CFG | START_TX_CLEAR, Snp);
 
     // Say that command could not be sent
     return EFI_DEVICE_ERROR;
@@ -49,7 +49,8 @@
 #define LAN9118_RX_DATA_SIZE          10560
 #define LAN9118_RX_STATUS_SIZE        704
 
-#define LAN9118_TX_RING_NUM_ENTRIES 32
+// One entry per Tx status the Tx status FIFO can hold
+#define LAN9118_TX_RING_NUM_ENTRIES   (LAN9118_TX_STATUS_SIZE / 4)
 
 /*------------------------------------------------------------------------------
   LAN9118 Information Structure
@@ -70,6 +71,17 @@ typedef struct {
   // Saved transmitted buffers so we can notify consumers when packets have been sent.
   UINT16  NextPacketTag;
   VOID    *TxRing[LAN9118_TX_RING_NUM_ENTRIES];
+
+  // Number of transmitted buffers not yet returned by GetStatus.
+  UINTN   TxPending;
+
+  // Tx statuses already read from the Tx status FIFO but not yet returned by GetStatus.
+  UINT32  TxStatusQueue[LAN9118_TX_RING_NUM_ENTRIES];
+  UINTN   TxStatusHead;
+  UINTN   TxStatusCount;
+
+  // Number of received frames known to be waiting in the Rx FIFOs.
+  UINTN   RxPending;
 } LAN9118_DRIVER;
 
 #define LAN9118_SIGNATURE                       SIGNATURE_32('l', 'a', 'n', '9')
@@ -302,6 +302,9 @@
 #define RXCFG_RX_DMA_CNT(cnt)             (((cnt) & 0xFFF) << 16)  // Amount of data to be read from Rx FIFO
 #define RXCFG_RX_END_ALIGN_MASK           (0xC0000000)             // Alignment to preserve
 
+// RX Datapath Control Register bits
+#define RXDPCTL_RX_FFWD                   BIT31                    // Skip the data of the current Rx frame
+
 // TX Configuration Register bits
 #define TXCFG_STOP_TX                     BIT0                     // Stop the transmitter
 #define TXCFG_TX_ON                       BIT1                     // Start the transmitter
@@ -164,6 +164,44 @@ Lan9118RawMmioWrite32(
   return Value;
 }
 
+/*
+ * The data and status FIFO ports may be accessed back to back. The delays
+ * listed in the data sheet for these ports only apply before the FIFO
+ * information registers are read again, so they are only paid once, after
+ * the last word of a burst.
+ */
+VOID
+Lan9118RawMmioReadFifo32 (
+  UINTN  Address,
+  UINT32 *Buffer,
+  UINTN  Count,
+  UINTN  Delay
+  )
+{
+  UINTN Index;
+
+  for (Index = 0; Index < Count; Index++) {
+    Buffer[Index] = MmioRead32 (Address);
+  }
+  WaitDummyReads (Delay);
+}
+
+VOID
+Lan9118RawMmioWriteFifo32 (
+  UINTN        Address,
+  CONST UINT32 *Buffer,
+  UINTN        Count,
+  UINTN        Delay
+  )
+{
+  UINTN Index;
+
+  for (Index = 0; Index < Count; Index++) {
+    MmioWrite32 (Address, Buffer[Index]);
+  }
+  WaitDummyReads (Delay);
+}
+
 // Function to write to MAC indirect registers
 UINT32
 IndirectMACWrite32 (
@@ -471,9 +509,11 @@ SoftReset (
 {
   UINT32 HwConf;
   UINT32 ResetTime;
+  LAN9118_DRIVER *LanDriver;
 
   // Initialize variable
   ResetTime = 0;
+  LanDriver = INSTANCE_FROM_SNP_THIS (Snp);
 
   // Stop Rx and Tx
   StopTx (STOP_TX_MAC | STOP_TX_CFG | STOP_TX_CLEAR, Snp);
@@ -510,6 +550,12 @@ SoftReset (
   // Check that EEPROM isn't active
   while (Lan9118MmioRead32 (LAN9118_E2P_CMD) & E2P_EPC_BUSY);
 
+  // The reset empties the FIFOs, forget the frames queued in them
+  LanDriver->TxPending = 0;
+  LanDriver->TxStatusHead = 0;
+  LanDriver->TxStatusCount = 0;
+  LanDriver->RxPending = 0;
+
   // TODO we probably need to re-set the mac address here.
 
   // Clear and acknowledge all interrupts
@@ -698,6 +744,21 @@ CheckLinkStatus (
   }
 }
 
+// Forget the packets queued in the Tx FIFOs once they have been cleared
+STATIC
+VOID
+ClearTxQueue (
+  EFI_SIMPLE_NETWORK_PROTOCOL *Snp
+  )
+{
+  LAN9118_DRIVER *LanDriver;
+
+  LanDriver = INSTANCE_FROM_SNP_THIS (Snp);
+  LanDriver->TxPending = 0;
+  LanDriver->TxStatusHead = 0;
+  LanDriver->TxStatusCount = 0;
+}
+
 // Stop the transmitter
 EFI_STATUS
 StopTx (
@@ -716,6 +777,7 @@ StopTx (
     TxCfg = Lan9118MmioRead32 (LAN9118_TX_CFG);
     TxCfg |= TXCFG_TXS_DUMP | TXCFG_TXD_DUMP;
     Lan9118MmioWrite32 (LAN9118_TX_CFG, TxCfg);
+    ClearTxQueue (Snp);
   }
 
   // Check if already stopped
@@ -770,6 +832,7 @@ StopRx (
     Lan9118MmioWrite32 (LAN9118_RX_CFG, RxCfg);
 
     while (Lan9118MmioRead32 (LAN9118_RX_CFG) & RXCFG_RX_DUMP);
+    INSTANCE_FROM_SNP_THIS (Snp)->RxPending = 0;
   }
 
   return EFI_SUCCESS;
@@ -793,6 +856,7 @@ StartTx (
     TxCfg = Lan9118MmioRead32 (LAN9118_TX_CFG);
     TxCfg |= TXCFG_TXS_DUMP | TXCFG_TXD_DUMP;
     Lan9118MmioWrite32 (LAN9118_TX_CFG, TxCfg);
+    ClearTxQueue (Snp);
   }
 
   // Check if tx was started from MAC and enable if not
@@ -841,6 +905,7 @@ StartRx (
       Lan9118MmioWrite32 (LAN9118_RX_CFG, RxCfg);
 
       while (Lan9118MmioRead32 (LAN9118_RX_CFG) & RXCFG_RX_DUMP);
+      INSTANCE_FROM_SNP_THIS (Snp)->RxPending = 0;
     }
 
     MacCsr |= MACCR_RX_EN;
@@ -918,6 +983,24 @@ RxStatusUsedSpace (
   return UsedSpace << 2; // Value in bytes
 }
 
+// Discard the data of the frame at the head of the Rx data FIFO
+VOID
+DiscardRxFrame (
+  UINT32 NumDwords,
+  EFI_SIMPLE_NETWORK_PROTOCOL *Snp
+  )
+{
+  // Fast forward may only be used for frames of at least 4 DWORDs
+  if (NumDwords >= 4) {
+    Lan9118MmioWrite32 (LAN9118_RX_DP_CTL, RXDPCTL_RX_FFWD);
+    while (Lan9118MmioRead32 (LAN9118_RX_DP_CTL) & RXDPCTL_RX_FFWD);
+  } else {
+    while (NumDwords--) {
+      Lan9118MmioRead32 (LAN9118_RX_DATA);
+    }
+  }
+}
+
 
 // Change the allocation of FIFOs
 EFI_STATUS
@@ -56,6 +56,26 @@ Lan9118RawMmioWrite32(
 #define Lan9118MmioWrite32(a, v) \
   Lan9118RawMmioWrite32(a, v, a ## _WR_DELAY)
 
+VOID
+Lan9118RawMmioReadFifo32 (
+  UINTN  Address,
+  UINT32 *Buffer,
+  UINTN  Count,
+  UINTN  Delay
+  );
+#define Lan9118MmioReadFifo32(a, b, c) \
+  Lan9118RawMmioReadFifo32(a, b, c, a ## _RD_DELAY)
+
+VOID
+Lan9118RawMmioWriteFifo32 (
+  UINTN        Address,
+  CONST UINT32 *Buffer,
+  UINTN        Count,
+  UINTN        Delay
+  );
+#define Lan9118MmioWriteFifo32(a, b, c) \
+  Lan9118RawMmioWriteFifo32(a, b, c, a ## _WR_DELAY)
+
 /* ------------------ MAC CSR Access ------------------- */
 
 // Read from MAC indirect registers
@@ -252,6 +272,13 @@ RxStatusUsedSpace (
   EFI_SIMPLE_NETWORK_PROTOCOL *Snp
   );
 
+// Discard the data of the frame at the head of the Rx data FIFO
+VOID
+DiscardRxFrame (
+  UINT32 NumDwords,
+  EFI_SIMPLE_NETWORK_PROTOCOL *Snp
+  );
+
 
 // Flags for FIFO allocation
 #define ALLOC_USE_DEFAULT                 BIT0
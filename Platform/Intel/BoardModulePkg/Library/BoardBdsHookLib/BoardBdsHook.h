@@ -48,6 +48,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Library/CapsuleLib.h>
 #include <Library/PerformanceLib.h>
 
+#include <IndustryStandard/Acpi.h>
 #include <IndustryStandard/Pci30.h>
 #include <IndustryStandard/PciCodeId.h>
 #include <Protocol/PciEnumerationComplete.h>
@@ -164,8 +165,11 @@ MemoryTest (
   the OEM/IBV can customize with their own connect sequence.
 
   @param[in] BootMode          Boot mode of this boot.
+
+  @retval TRUE                 Only the consoles and the boot device were connected.
+  @retval FALSE                All controllers were connected.
 **/
-VOID
+BOOLEAN
 ConnectSequence (
   IN EFI_BOOT_MODE                      BootMode
   );
@@ -22,10 +22,12 @@
 #include "BoardBdsHook.h"
 
 #define IS_FIRST_BOOT_VAR_NAME L"IsFirstBoot"
+#define HW_CONFIG_SIGNATURE_VAR_NAME L"HwConfigSignature"
 
 GLOBAL_REMOVE_IF_UNREFERENCED EFI_BOOT_MODE    gBootMode;
 BOOLEAN                                        gPPRequireUIConfirm;
 extern UINTN                                   mBootMenuOptionNumber;
+extern BOOLEAN                                 mFastBootConnected;
 
 
 GLOBAL_REMOVE_IF_UNREFERENCED USB_CLASS_FORMAT_DEVICE_PATH gUsbClassKeyboardDevicePath = {
@@ -990,18 +992,230 @@ EnumUsbKeyboard (
 }
 
 
+/**
+  Calculate the hardware configuration signature of this boot.
+
+  The signature covers the FACS HardwareSignature, which reflects the ACPI
+  tables, and the location and ID of every PCI device found by enumeration.
+
+  @param[out] Signature        The hardware configuration signature.
+
+  @retval EFI_SUCCESS          The signature is calculated.
+  @retval Others               The signature could not be calculated.
+**/
+EFI_STATUS
+GetHwConfigSignature (
+  OUT UINT32               *Signature
+  )
+{
+  EFI_STATUS                                    Status;
+  EFI_ACPI_6_5_FIRMWARE_ACPI_CONTROL_STRUCTURE  *Facs;
+  EFI_HANDLE                                    *HandleBuffer;
+  UINTN                                         HandleCount;
+  UINTN                                         Index;
+  EFI_PCI_IO_PROTOCOL                           *PciIo;
+  UINT32                                        *Record;
+  UINTN                                         Segment;
+  UINTN                                         Bus;
+  UINTN                                         Device;
+  UINTN                                         Function;
+
+  Status = gBS->LocateHandleBuffer (
+                  ByProtocol,
+                  &gEfiPciIoProtocolGuid,
+                  NULL,
+                  &HandleCount,
+                  &HandleBuffer
+                  );
+  if (EFI_ERROR (Status)) {
+    HandleCount  = 0;
+    HandleBuffer = NULL;
+  }
+
+  Record = AllocateZeroPool ((1 + 2 * HandleCount) * sizeof (UINT32));
+  if (Record == NULL) {
+    if (HandleBuffer != NULL) {
+      FreePool (HandleBuffer);
+    }
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Facs = (EFI_ACPI_6_5_FIRMWARE_ACPI_CONTROL_STRUCTURE *) EfiLocateFirstAcpiTable (EFI_ACPI_6_5_FIRMWARE_ACPI_CONTROL_STRUCTURE_SIGNATURE);
+  if (Facs != NULL) {
+    Record[0] = Facs->HardwareSignature;
+  }
+
+  for (Index = 0; Index < HandleCount; Index++) {
+    Status = gBS->HandleProtocol (HandleBuffer[Index], &gEfiPciIoProtocolGuid, (VOID **) &PciIo);
+    if (EFI_ERROR (Status)) {
+      continue;
+    }
+    PciIo->GetLocation (PciIo, &Segment, &Bus, &Device, &Function);
+    Record[1 + 2 * Index] = (UINT32) ((Segment << 16) | (Bus << 8) | (Device << 3) | Function);
+    PciIo->Pci.Read (PciIo, EfiPciIoWidthUint32, PCI_VENDOR_ID_OFFSET, 1, &Record[2 + 2 * Index]);
+  }
+
+  Status = gBS->CalculateCrc32 (Record, (1 + 2 * HandleCount) * sizeof (UINT32), Signature);
+
+  FreePool (Record);
+  if (HandleBuffer != NULL) {
+    FreePool (HandleBuffer);
+  }
+  return Status;
+}
+
+/**
+  Connect the device of a boot option.
+
+  @param[in] OptionNumber      The number of the Boot#### variable.
+
+  @retval EFI_SUCCESS          The device of the boot option is connected.
+  @retval Others               The boot option is not active or its device was not found.
+**/
+EFI_STATUS
+ConnectBootOptionDevice (
+  IN UINT16                OptionNumber
+  )
+{
+  EFI_STATUS                    Status;
+  CHAR16                        OptionName[sizeof ("Boot####")];
+  EFI_BOOT_MANAGER_LOAD_OPTION  BootOption;
+  EFI_DEVICE_PATH_PROTOCOL      *FullPath;
+
+  UnicodeSPrint (OptionName, sizeof (OptionName), L"Boot%04x", OptionNumber);
+  Status = EfiBootManagerVariableToLoadOption (OptionName, &BootOption);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  if ((BootOption.Attributes & LOAD_OPTION_ACTIVE) == 0) {
+    EfiBootManagerFreeLoadOption (&BootOption);
+    return EFI_NOT_FOUND;
+  }
+
+  DumpDevicePath (OptionName, BootOption.FilePath);
+  EfiBootManagerConnectDevicePath (BootOption.FilePath, NULL);
+  FullPath = EfiBootManagerGetNextLoadOptionDevicePath (BootOption.FilePath, NULL);
+  if (FullPath == NULL) {
+    Status = EFI_NOT_FOUND;
+  } else {
+    FreePool (FullPath);
+  }
+
+  EfiBootManagerFreeLoadOption (&BootOption);
+  return Status;
+}
+
+/**
+  Connect only the consoles and the device of BootNext, or of the first
+  BootOrder entry that can be found.
+
+  @retval EFI_SUCCESS          The consoles and a boot device are connected.
+  @retval EFI_NOT_FOUND        No boot device was found.
+**/
+EFI_STATUS
+FastBootConnect (
+  VOID
+  )
+{
+  EFI_STATUS               Status;
+  UINT16                   *BootNext;
+  UINT16                   *BootOrder;
+  UINTN                    Size;
+  UINTN                    Index;
+
+  EfiBootManagerConnectAllDefaultConsoles ();
+
+  Status = GetEfiGlobalVariable2 (EFI_BOOT_NEXT_VARIABLE_NAME, (VOID **) &BootNext, &Size);
+  if (!EFI_ERROR (Status) && (BootNext != NULL)) {
+    if (Size == sizeof (UINT16)) {
+      Status = ConnectBootOptionDevice (*BootNext);
+    } else {
+      Status = EFI_NOT_FOUND;
+    }
+    FreePool (BootNext);
+    return Status;
+  }
+
+  Status = GetEfiGlobalVariable2 (EFI_BOOT_ORDER_VARIABLE_NAME, (VOID **) &BootOrder, &Size);
+  if (EFI_ERROR (Status) || (BootOrder == NULL)) {
+    return EFI_NOT_FOUND;
+  }
+
+  Status = EFI_NOT_FOUND;
+  for (Index = 0; Index < Size / sizeof (UINT16); Index++) {
+    Status = ConnectBootOptionDevice (BootOrder[Index]);
+    if (!EFI_ERROR (Status)) {
+      break;
+    }
+  }
+
+  FreePool (BootOrder);
+  return Status;
+}
+
 /**
   Connect with predeined platform connect sequence,
   the OEM/IBV can customize with their own connect sequence.
 
+  If PcdBdsFastBootConnect is set and the hardware configuration signature
+  matches the previous boot, only the consoles and the boot device are
+  connected. Otherwise, or if that fails, all controllers are connected.
+
   @param[in] BootMode          Boot mode of this boot.
+
+  @retval TRUE                 Only the consoles and the boot device were connected.
+  @retval FALSE                All controllers were connected.
 **/
-VOID
+BOOLEAN
 ConnectSequence (
   IN EFI_BOOT_MODE         BootMode
   )
 {
+  EFI_STATUS               Status;
+  UINT32                   Signature;
+  UINT32                   SavedSignature;
+  UINTN                    DataSize;
+
+  Status = EFI_UNSUPPORTED;
+  if (PcdGetBool (PcdBdsFastBootConnect) && (BootMode != BOOT_WITH_DEFAULT_SETTINGS) && (BootMode != BOOT_IN_RECOVERY_MODE)) {
+    Status = GetHwConfigSignature (&Signature);
+  }
+
+  if (!EFI_ERROR (Status)) {
+    DataSize = sizeof (SavedSignature);
+    Status = gRT->GetVariable (
+                    HW_CONFIG_SIGNATURE_VAR_NAME,
+                    &gEfiCallerIdGuid,
+                    NULL,
+                    &DataSize,
+                    &SavedSignature
+                    );
+    if (!EFI_ERROR (Status) && (SavedSignature == Signature)) {
+      Status = FastBootConnect ();
+      DEBUG ((DEBUG_INFO, "FastBootConnect - %r\n", Status));
+      if (!EFI_ERROR (Status)) {
+        mFastBootConnected = TRUE;
+        return TRUE;
+      }
+    } else {
+      DEBUG ((DEBUG_INFO, "Hardware configuration signature changed: 0x%x\n", Signature));
+    }
+
+    //
+    // Remember the configuration connected in full, for the next fast boot
+    //
+    gRT->SetVariable (
+           HW_CONFIG_SIGNATURE_VAR_NAME,
+           &gEfiCallerIdGuid,
+           EFI_VARIABLE_NON_VOLATILE | EFI_VARIABLE_BOOTSERVICE_ACCESS,
+           sizeof (Signature),
+           &Signature
+           );
+  }
+
   EfiBootManagerConnectAll ();
+  return FALSE;
 }
 
 /**
@@ -1323,6 +1537,7 @@ BdsAfterConsoleReadyBeforeBootOptionCallback (
   EFI_STATUS                    Status;
   BOOLEAN                       IsFirstBoot;
   UINTN                         DataSize;
+  BOOLEAN                       FastBoot;
 
   DEBUG ((DEBUG_INFO, "Event gBdsAfterConsoleReadyBeforeBootOptionEvent callback starts\n"));
   //
@@ -1355,7 +1570,7 @@ BdsAfterConsoleReadyBeforeBootOptionCallback (
       //
       // Perform some platform specific connect sequence
       //
-      ConnectSequence (LocalBootMode);
+      FastBoot = ConnectSequence (LocalBootMode);
 
       //
       // Only in Full Configuration boot mode we do the enumeration of boot device
@@ -1368,7 +1583,15 @@ BdsAfterConsoleReadyBeforeBootOptionCallback (
       // PXE boot option may appear after boot option enumeration
       //
 
-      EfiBootManagerRefreshAllBootOption ();
+      //
+      // The boot options are unchanged if the hardware configuration is the same
+      // as on the previous boot, so skip the refresh for a fast boot. The boot
+      // options are refreshed in BoardBootManagerUnableToBoot if no boot option
+      // could be launched.
+      //
+      if (!FastBoot) {
+        EfiBootManagerRefreshAllBootOption ();
+      }
       DataSize = sizeof (BOOLEAN);
       Status = gRT->GetVariable (
                       IS_FIRST_BOOT_VAR_NAME,
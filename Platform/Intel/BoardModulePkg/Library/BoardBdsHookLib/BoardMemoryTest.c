@@ -7,7 +7,259 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 **/
 
 #include "BoardBdsHook.h"
+#include <Library/SynchronizationLib.h>
+#include <Library/TimerLib.h>
 #include <Protocol/GenericMemoryTest.h>
+#include <Protocol/MpService.h>
+
+#define MEMORY_TEST_CHUNK_SIZE  SIZE_256MB
+#define MEMORY_TEST_PATTERN     0x5A5A5A5A5A5A5A5AULL
+
+typedef struct {
+  EFI_PHYSICAL_ADDRESS  Base;
+  UINT64                Length;
+  UINT64                StartTicks;
+  UINT64                EndTicks;
+  BOOLEAN               Error;
+} MEMORY_TEST_CHUNK;
+
+typedef struct {
+  MEMORY_TEST_CHUNK     *Chunks;
+  UINT32                ChunkCount;
+  volatile UINT32       NextChunk;
+} MEMORY_TEST_CONTEXT;
+
+/**
+  Verify that a memory range holds a pattern, reading it front to back.
+
+  @param  Base          The base of the memory range.
+  @param  Length        The length of the memory range in bytes.
+  @param  Pattern       The expected pattern.
+
+  @retval TRUE          The memory range holds the pattern.
+  @retval FALSE         The memory range does not hold the pattern.
+**/
+BOOLEAN
+VerifyMemoryPattern (
+  IN EFI_PHYSICAL_ADDRESS  Base,
+  IN UINT64                Length,
+  IN UINT64                Pattern
+  )
+{
+  volatile UINT64  *Memory;
+  UINTN            Count;
+  UINTN            Index;
+
+  Memory = (volatile UINT64 *) (UINTN) Base;
+  Count  = (UINTN) RShiftU64 (Length, 3);
+  for (Index = 0; Index < Count; Index++) {
+    if (Memory[Index] != Pattern) {
+      return FALSE;
+    }
+  }
+  return TRUE;
+}
+
+/**
+  Test memory chunks until none is left. This runs on the BSP and on
+  every AP at the same time, so it must not use any boot service.
+
+  @param  Buffer        The MEMORY_TEST_CONTEXT shared by all processors.
+**/
+VOID
+EFIAPI
+MemoryTestWorker (
+  IN OUT VOID  *Buffer
+  )
+{
+  MEMORY_TEST_CONTEXT  *Context;
+  MEMORY_TEST_CHUNK    *Chunk;
+  UINT32               Index;
+
+  Context = (MEMORY_TEST_CONTEXT *) Buffer;
+  while (TRUE) {
+    Index = InterlockedIncrement (&Context->NextChunk) - 1;
+    if (Index >= Context->ChunkCount) {
+      break;
+    }
+
+    //
+    // Fill the chunk with the pattern, then with its complement, and verify
+    // each fill with one sequential pass.
+    //
+    Chunk = &Context->Chunks[Index];
+    Chunk->StartTicks = GetPerformanceCounter ();
+    SetMem64 ((VOID *) (UINTN) Chunk->Base, (UINTN) Chunk->Length, MEMORY_TEST_PATTERN);
+    if (!VerifyMemoryPattern (Chunk->Base, Chunk->Length, MEMORY_TEST_PATTERN)) {
+      Chunk->Error = TRUE;
+    }
+    SetMem64 ((VOID *) (UINTN) Chunk->Base, (UINTN) Chunk->Length, ~MEMORY_TEST_PATTERN);
+    if (!VerifyMemoryPattern (Chunk->Base, Chunk->Length, ~MEMORY_TEST_PATTERN)) {
+      Chunk->Error = TRUE;
+    }
+    Chunk->EndTicks = GetPerformanceCounter ();
+  }
+}
+
+/**
+  Test the untested system memory on all processors.
+
+  The untested memory is split into chunks which the BSP and the APs take
+  in turn, so that the test time scales with the number of processors
+  rather than with the memory size alone.
+
+  @retval EFI_SUCCESS       All untested memory is tested without error.
+  @retval EFI_UNSUPPORTED   The memory cannot be tested in parallel.
+  @retval EFI_DEVICE_ERROR  A memory error is found.
+  @retval Others            The memory test could not be started.
+**/
+EFI_STATUS
+ParallelMemoryTest (
+  VOID
+  )
+{
+  EFI_STATUS                       Status;
+  EFI_MP_SERVICES_PROTOCOL         *MpService;
+  UINTN                            NumberOfProcessors;
+  UINTN                            NumberOfEnabledProcessors;
+  EFI_GCD_MEMORY_SPACE_DESCRIPTOR  *MemorySpaceMap;
+  UINTN                            NumberOfDescriptors;
+  UINTN                            Index;
+  UINT64                           Offset;
+  UINT64                           Capabilities;
+  UINT64                           TotalSize;
+  UINT64                           Elapsed;
+  MEMORY_TEST_CONTEXT              Context;
+  MEMORY_TEST_CHUNK                *Chunk;
+  EFI_EVENT                        WaitEvent;
+
+  Status = gBS->LocateProtocol (&gEfiMpServiceProtocolGuid, NULL, (VOID **) &MpService);
+  if (EFI_ERROR (Status)) {
+    return EFI_UNSUPPORTED;
+  }
+  Status = MpService->GetNumberOfProcessors (MpService, &NumberOfProcessors, &NumberOfEnabledProcessors);
+  if (EFI_ERROR (Status) || (NumberOfEnabledProcessors < 2)) {
+    return EFI_UNSUPPORTED;
+  }
+
+  Status = gDS->GetMemorySpaceMap (&NumberOfDescriptors, &MemorySpaceMap);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  //
+  // Split the untested memory into chunks. The generic memory test driver
+  // treats present and initialized, but not tested, reserved memory as
+  // untested.
+  //
+  Capabilities       = EFI_MEMORY_PRESENT | EFI_MEMORY_INITIALIZED;
+  Context.ChunkCount = 0;
+  Context.NextChunk  = 0;
+  Context.Chunks     = NULL;
+  TotalSize          = 0;
+  for (Index = 0; Index < NumberOfDescriptors; Index++) {
+    if ((MemorySpaceMap[Index].GcdMemoryType == EfiGcdMemoryTypeReserved) &&
+        ((MemorySpaceMap[Index].Capabilities & (Capabilities | EFI_MEMORY_TESTED)) == Capabilities)) {
+      if (MemorySpaceMap[Index].BaseAddress + MemorySpaceMap[Index].Length - 1 > MAX_ADDRESS) {
+        FreePool (MemorySpaceMap);
+        return EFI_UNSUPPORTED;
+      }
+      Context.ChunkCount += (UINT32) DivU64x64Remainder (
+                                       MemorySpaceMap[Index].Length + MEMORY_TEST_CHUNK_SIZE - 1,
+                                       MEMORY_TEST_CHUNK_SIZE,
+                                       NULL
+                                       );
+      TotalSize += MemorySpaceMap[Index].Length;
+    }
+  }
+
+  if (Context.ChunkCount != 0) {
+    Context.Chunks = AllocateZeroPool (Context.ChunkCount * sizeof (MEMORY_TEST_CHUNK));
+  }
+  if (Context.Chunks == NULL) {
+    FreePool (MemorySpaceMap);
+    return EFI_UNSUPPORTED;
+  }
+
+  Chunk = Context.Chunks;
+  for (Index = 0; Index < NumberOfDescriptors; Index++) {
+    if ((MemorySpaceMap[Index].GcdMemoryType == EfiGcdMemoryTypeReserved) &&
+        ((MemorySpaceMap[Index].Capabilities & (Capabilities | EFI_MEMORY_TESTED)) == Capabilities)) {
+      for (Offset = 0; Offset < MemorySpaceMap[Index].Length; Offset += MEMORY_TEST_CHUNK_SIZE) {
+        Chunk->Base   = MemorySpaceMap[Index].BaseAddress + Offset;
+        Chunk->Length = MIN (MEMORY_TEST_CHUNK_SIZE, MemorySpaceMap[Index].Length - Offset);
+        Chunk++;
+      }
+    }
+  }
+  FreePool (MemorySpaceMap);
+
+  DEBUG ((DEBUG_INFO, "ParallelMemoryTest: 0x%lx bytes in %u chunks on %Lu processors\n", TotalSize, Context.ChunkCount, (UINT64)NumberOfEnabledProcessors));
+
+  //
+  // Start the APs without blocking, and let the BSP test chunks as well.
+  //
+  Status = gBS->CreateEvent (0, TPL_CALLBACK, NULL, NULL, &WaitEvent);
+  if (EFI_ERROR (Status)) {
+    FreePool (Context.Chunks);
+    return Status;
+  }
+  Elapsed = GetPerformanceCounter ();
+  Status = MpService->StartupAllAPs (
+                        MpService,
+                        MemoryTestWorker,
+                        FALSE,
+                        WaitEvent,
+                        0,
+                        &Context,
+                        NULL
+                        );
+  if (EFI_ERROR (Status)) {
+    gBS->CloseEvent (WaitEvent);
+    FreePool (Context.Chunks);
+    return Status;
+  }
+  MemoryTestWorker (&Context);
+  while (gBS->CheckEvent (WaitEvent) == EFI_NOT_READY) {
+    CpuPause ();
+  }
+  gBS->CloseEvent (WaitEvent);
+  Elapsed = GetTimeInNanoSecond (GetPerformanceCounter () - Elapsed);
+
+  //
+  // Report each chunk and the overall rate.
+  //
+  Status = EFI_SUCCESS;
+  for (Index = 0; Index < Context.ChunkCount; Index++) {
+    Chunk = &Context.Chunks[Index];
+    DEBUG ((
+      Chunk->Error ? DEBUG_ERROR : DEBUG_VERBOSE,
+      "  MemoryTest 0x%lx - 0x%lx: %a, %ld MB/s\n",
+      Chunk->Base,
+      Chunk->Base + Chunk->Length - 1,
+      Chunk->Error ? "Error" : "Pass",
+      DivU64x64Remainder (
+        MultU64x32 (RShiftU64 (Chunk->Length, 20), 1000000),
+        MAX (DivU64x32 (GetTimeInNanoSecond (Chunk->EndTicks - Chunk->StartTicks), 1000), 1),
+        NULL
+        )
+      ));
+    if (Chunk->Error) {
+      Status = EFI_DEVICE_ERROR;
+    }
+  }
+  DEBUG ((
+    DEBUG_INFO,
+    "ParallelMemoryTest: %ld MB in %ld ms, %ld MB/s - %r\n",
+    RShiftU64 (TotalSize, 20),
+    DivU64x32 (Elapsed, 1000000),
+    DivU64x64Remainder (MultU64x32 (RShiftU64 (TotalSize, 20), 1000000), MAX (DivU64x32 (Elapsed, 1000), 1), NULL),
+    Status
+    ));
+
+  FreePool (Context.Chunks);
+  return Status;
+}
 
 /**
   Perform the memory test base on the memory test intensive level,
@@ -39,6 +291,16 @@ MemoryTest (
 
   RequireSoftECCInit = FALSE;
 
+  //
+  // An extensive test is run on all processors first. The generic memory
+  // test then only needs to add the tested memory to the memory map. If the
+  // parallel test cannot run or finds an error, the generic memory test
+  // does the extensive test itself and handles the error.
+  //
+  if ((Level == EXTENSIVE) && !EFI_ERROR (ParallelMemoryTest ())) {
+    Level = QUICK;
+  }
+
   Status = gBS->LocateProtocol (
                   &gEfiGenericMemTestProtocolGuid,
                   NULL,
@@ -19,6 +19,7 @@
 BOOLEAN    mHotKeypressed = FALSE;
 EFI_EVENT  HotKeyEvent    = NULL;
 UINTN      mBootMenuOptionNumber;
+BOOLEAN    mFastBootConnected = FALSE;
 
 /**
   This function is called each second during the boot manager waits timeout.
@@ -92,6 +93,18 @@ BoardBootManagerUnableToBoot (
   if (mBootMenuOptionNumber == LoadOptionNumberUnassigned) {
     return;
   }
+
+  //
+  // A fast boot connects only the consoles and the boot device, so make
+  // every device visible in the boot menu.
+  //
+  if (mFastBootConnected) {
+    DEBUG ((DEBUG_INFO, "Fast boot did not boot, connect all\n"));
+    mFastBootConnected = FALSE;
+    EfiBootManagerConnectAll ();
+    EfiBootManagerRefreshAllBootOption ();
+  }
+
   UnicodeSPrint (OptionName, sizeof (OptionName), L"Boot%04x", mBootMenuOptionNumber);
   Status = EfiBootManagerVariableToLoadOption (OptionName, &BootDeviceList);
   if (EFI_ERROR (Status)) {
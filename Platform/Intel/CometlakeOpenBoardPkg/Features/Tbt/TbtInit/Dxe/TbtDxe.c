@@ -124,13 +124,23 @@ TbtAcpiEndOfDxeCallback (
   UINT32                                Address;
   UINT16                                Length;
   UINT32                                Signature;
+  ASL_UPDATE_SESSION                    *Session;
+
+  //
+  // Patch all Names in one pass over the DSDT and reinstall it once
+  //
+  Status  = AslUpdateSessionBegin (EFI_ACPI_6_5_DIFFERENTIATED_SYSTEM_DESCRIPTION_TABLE_SIGNATURE, &Session);
+  ASSERT_EFI_ERROR (Status);
+  if (EFI_ERROR (Status)) {
+    return;
+  }
 
   Address = (UINT32) (UINTN) mTbtNvsAreaProtocol.Area;
   Length  = (UINT16) sizeof (TBT_NVS_AREA);
   DEBUG ((DEBUG_INFO, "Patch TBT NvsAreaAddress: TBT NVS Address %x Length %x\n", Address, Length));
-  Status  = UpdateNameAslCode (SIGNATURE_32 ('T','N','V','B'), &Address, sizeof (Address));
+  Status  = AslUpdateSessionUpdateName (Session, SIGNATURE_32 ('T','N','V','B'), &Address, sizeof (Address));
   ASSERT_EFI_ERROR (Status);
-  Status  = UpdateNameAslCode (SIGNATURE_32 ('T','N','V','L'), &Length, sizeof (Length));
+  Status  = AslUpdateSessionUpdateName (Session, SIGNATURE_32 ('T','N','V','L'), &Length, sizeof (Length));
   ASSERT_EFI_ERROR (Status);
 
   if (gTbtInfoHob != NULL) {
@@ -138,12 +148,15 @@ TbtAcpiEndOfDxeCallback (
       if (gTbtInfoHob-> DTbtControllerConfig.CioPlugEventGpio.AcpiGpeSignaturePorting == TRUE) {
         DEBUG ((DEBUG_INFO, "Patch ATBT Method Name\n"));
         Signature = gTbtInfoHob-> DTbtControllerConfig.CioPlugEventGpio.AcpiGpeSignature;
-        Status  = UpdateNameAslCode (SIGNATURE_32 ('A','T','B','T'), &Signature, sizeof (Signature));
+        Status  = AslUpdateSessionUpdateName (Session, SIGNATURE_32 ('A','T','B','T'), &Signature, sizeof (Signature));
         ASSERT_EFI_ERROR (Status);
       }
     }
   }
 
+  Status  = AslUpdateSessionCommit (Session);
+  ASSERT_EFI_ERROR (Status);
+
   return;
 }
 
@@ -51,6 +51,20 @@ VOID  *mLocalTable[] = {
 };
 
 EFI_ACPI_TABLE_PROTOCOL     *mAcpiTable;
+EFI_ACPI_SDT_PROTOCOL       *mAcpiSdt;
+
+//
+// CRC of an installed ACPI table, recorded when the table is installed.
+//
+typedef struct {
+  LIST_ENTRY                Link;
+  EFI_ACPI_COMMON_HEADER    *Table;
+  UINT32                    Length;
+  UINT8                     Checksum;
+  UINT32                    Crc;
+} ACPI_TABLE_CRC_ENTRY;
+
+LIST_ENTRY                  mAcpiTableCrcList = INITIALIZE_LIST_HEAD_VARIABLE (mAcpiTableCrcList);
 
 UINT32                      mNumOfBitShift = 6;
 BOOLEAN                     mForceX2ApicId;
@@ -1312,6 +1326,125 @@ GetAcpiTableCount (
   (*TableCount)++;
 }
 
+/**
+  Return whether the CRC of an ACPI table may be recorded at install time.
+
+  The FACS carries the HardwareSignature itself, and the FADT is patched in
+  place when the FACS and DSDT are installed. The DSDT and SSDTs are patched
+  in place through the ACPI SDT protocol and AslUpdateLib. A patch that
+  leaves the length and the 8-bit checksum unchanged, such as two swapped
+  bytes, cannot be told apart from the installed table, so all of these
+  tables are always calculated.
+
+  @param[in] Table        The pointer to ACPI table.
+
+  @retval TRUE   The CRC of the table may be recorded.
+  @retval FALSE  The CRC of the table must be calculated every time.
+**/
+BOOLEAN
+IsAcpiTableCrcCacheable (
+  IN  EFI_ACPI_COMMON_HEADER  *Table
+  )
+{
+  return (BOOLEAN)((Table->Signature != EFI_ACPI_6_5_FIRMWARE_ACPI_CONTROL_STRUCTURE_SIGNATURE) &&
+                   (Table->Signature != EFI_ACPI_6_5_FIXED_ACPI_DESCRIPTION_TABLE_SIGNATURE) &&
+                   (Table->Signature != EFI_ACPI_6_5_DIFFERENTIATED_SYSTEM_DESCRIPTION_TABLE_SIGNATURE) &&
+                   (Table->Signature != EFI_ACPI_6_5_SECONDARY_SYSTEM_DESCRIPTION_TABLE_SIGNATURE));
+}
+
+/**
+  Find the recorded CRC of an ACPI table.
+
+  A record only matches while the table keeps its address, length and
+  checksum. This only guards against accidental reuse of a record; tables
+  that are patched in place are never recorded, see IsAcpiTableCrcCacheable.
+
+  @param[in]  Table        The pointer to ACPI table.
+  @param[out] Crc          The recorded CRC of the table.
+
+  @retval TRUE   The CRC of the table is recorded.
+  @retval FALSE  No CRC of the table is recorded.
+**/
+BOOLEAN
+GetRecordedAcpiTableCrc (
+  IN  EFI_ACPI_COMMON_HEADER  *Table,
+  OUT UINT32                  *Crc
+  )
+{
+  LIST_ENTRY            *Link;
+  ACPI_TABLE_CRC_ENTRY  *Entry;
+
+  for (Link = GetFirstNode (&mAcpiTableCrcList);
+       !IsNull (&mAcpiTableCrcList, Link);
+       Link = GetNextNode (&mAcpiTableCrcList, Link)) {
+    Entry = BASE_CR (Link, ACPI_TABLE_CRC_ENTRY, Link);
+    if (Entry->Table == Table) {
+      if ((Entry->Length != Table->Length) ||
+          (Entry->Checksum != ((EFI_ACPI_DESCRIPTION_HEADER *)Table)->Checksum)) {
+        return FALSE;
+      }
+      *Crc = Entry->Crc;
+      return TRUE;
+    }
+  }
+  return FALSE;
+}
+
+/**
+  Record the CRC of an ACPI table when it is installed.
+
+  A table installed at the address of an uninstalled table replaces its
+  record.
+
+  @param[in] Table       A pointer to the ACPI table header.
+  @param[in] Version     The ACPI table's version.
+  @param[in] TableKey    The table key for this ACPI table.
+
+  @retval EFI_SUCCESS    The notification function completed.
+**/
+EFI_STATUS
+EFIAPI
+AcpiTableInstallNotify (
+  IN EFI_ACPI_SDT_HEADER    *Table,
+  IN EFI_ACPI_TABLE_VERSION Version,
+  IN UINTN                  TableKey
+  )
+{
+  LIST_ENTRY            *Link;
+  ACPI_TABLE_CRC_ENTRY  *Entry;
+
+  if ((Table == NULL) || !IsAcpiTableCrcCacheable ((EFI_ACPI_COMMON_HEADER *)Table)) {
+    return EFI_SUCCESS;
+  }
+
+  for (Link = GetFirstNode (&mAcpiTableCrcList);
+       !IsNull (&mAcpiTableCrcList, Link);
+       Link = GetNextNode (&mAcpiTableCrcList, Link)) {
+    Entry = BASE_CR (Link, ACPI_TABLE_CRC_ENTRY, Link);
+    if (Entry->Table == (EFI_ACPI_COMMON_HEADER *)Table) {
+      break;
+    }
+  }
+
+  if (IsNull (&mAcpiTableCrcList, Link)) {
+    Entry = AllocateZeroPool (sizeof (ACPI_TABLE_CRC_ENTRY));
+    if (Entry == NULL) {
+      return EFI_SUCCESS;
+    }
+    Entry->Table = (EFI_ACPI_COMMON_HEADER *)Table;
+    InsertTailList (&mAcpiTableCrcList, &Entry->Link);
+  }
+
+  Entry->Length   = Table->Length;
+  Entry->Checksum = Table->Checksum;
+  if (EFI_ERROR (gBS->CalculateCrc32 ((UINT8 *)Table, (UINTN)Table->Length, &Entry->Crc))) {
+    RemoveEntryList (&Entry->Link);
+    FreePool (Entry);
+  }
+
+  return EFI_SUCCESS;
+}
+
 /**
   Calculate CRC based on each offset in the ACPI table.
 
@@ -1336,6 +1469,14 @@ CalculateAcpiTableCrc (
     return;
   }
 
+  //
+  // Use the CRC recorded when the table was installed, if it is unchanged.
+  //
+  if (IsAcpiTableCrcCacheable (Table) &&
+      GetRecordedAcpiTableCrc (Table, &TableCrcRecord[TableIndex])) {
+    return;
+  }
+
   //
   // Calculate CRC value.
   //
@@ -1366,6 +1507,7 @@ IsAcpiTableChange (
   EFI_ACPI_DESCRIPTION_HEADER                   *Rsdt;
   EFI_ACPI_DESCRIPTION_HEADER                   *Xsdt;
   EFI_ACPI_6_5_FIRMWARE_ACPI_CONTROL_STRUCTURE  *FacsPtr;
+  LIST_ENTRY                                    *Link;
 
   IsRsdt         = FALSE;
   AcpiTableCount = 0;
@@ -1430,6 +1572,18 @@ IsAcpiTableChange (
   DEBUG ((DEBUG_INFO, "HardwareSignature = %x and Status = %r\n", FacsPtr->HardwareSignature, Status));
 
   FreePool (TableCrcRecord);
+
+  //
+  // The HardwareSignature is final, stop recording table CRCs.
+  //
+  if (mAcpiSdt != NULL) {
+    mAcpiSdt->RegisterNotify (FALSE, AcpiTableInstallNotify);
+  }
+  while (!IsListEmpty (&mAcpiTableCrcList)) {
+    Link = GetFirstNode (&mAcpiTableCrcList);
+    RemoveEntryList (Link);
+    FreePool (BASE_CR (Link, ACPI_TABLE_CRC_ENTRY, Link));
+  }
   DEBUG ((DEBUG_INFO, "%a() - End\n", __func__));
 }
 
@@ -1507,6 +1661,20 @@ InstallAcpiPlatform (
   Status = gBS->LocateProtocol (&gEfiAcpiTableProtocolGuid, NULL, (VOID **)&mAcpiTable);
   ASSERT_EFI_ERROR (Status);
 
+  //
+  // Record the CRC of each table as it is installed, so that the
+  // HardwareSignature at End of DXE does not rescan unchanged tables.
+  //
+  Status = gBS->LocateProtocol (&gEfiAcpiSdtProtocolGuid, NULL, (VOID **)&mAcpiSdt);
+  if (!EFI_ERROR (Status)) {
+    Status = mAcpiSdt->RegisterNotify (TRUE, AcpiTableInstallNotify);
+    if (EFI_ERROR (Status)) {
+      mAcpiSdt = NULL;
+    }
+  } else {
+    mAcpiSdt = NULL;
+  }
+
   //
   // Create an End of DXE event.
   //
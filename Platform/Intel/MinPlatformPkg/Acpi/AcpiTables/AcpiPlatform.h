@@ -38,6 +38,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Library/LocalApicLib.h>
 
 #include <Protocol/AcpiTable.h>
+#include <Protocol/AcpiSystemDescriptionTable.h>
 #include <Protocol/MpService.h>
 #include <Protocol/PciIo.h>
 
@@ -13,11 +13,13 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Base.h>
 #include <Uefi/UefiBaseType.h>
 #include <Uefi/UefiSpec.h>
+#include <Library/BaseLib.h>
 #include <Library/UefiBootServicesTableLib.h>
 #include <Library/DebugLib.h>
 #include <Library/UefiLib.h>
 #include <Library/BaseMemoryLib.h>
 #include <Library/MemoryAllocationLib.h>
+#include <Library/PerformanceLib.h>
 
 #include <Library/AslUpdateLib.h>
 
@@ -27,6 +29,29 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 static EFI_ACPI_SDT_PROTOCOL      *mAcpiSdt = NULL;
 static EFI_ACPI_TABLE_PROTOCOL    *mAcpiTable = NULL;
 
+#define ASL_NAME_INDEX_BUCKETS  64
+
+///
+/// One Name object in the table, chained per hash bucket.
+///
+typedef struct {
+  UINT32                      Signature;
+  UINT32                      Offset;
+  UINT32                      Next;
+} ASL_NAME_INDEX_ENTRY;
+
+struct _ASL_UPDATE_SESSION {
+  EFI_ACPI_DESCRIPTION_HEADER *Table;
+  UINTN                       Handle;
+  UINTN                       UpdateCount;
+  ASL_NAME_INDEX_ENTRY        *Entries;
+  UINT32                      EntryCount;
+  ///
+  /// Entry index + 1 of the first entry in each bucket, 0 if empty.
+  ///
+  UINT32                      Buckets[ASL_NAME_INDEX_BUCKETS];
+};
+
 /**
   Initialize the ASL update library state.
   This must be called at the beginning of the function calls in this library.
@@ -107,9 +132,54 @@ LocateAcpiTableByOemTableId (
   return Status;
 }
 
+/**
+  Overwrite the immediate value of a Name object in a table copy.
+
+  @param[in] Table             - The table that contains the Name.
+  @param[in] DsdtPointer       - Pointer to the Name signature in the table.
+  @param[in] Buffer            - source of data to be written over original aml
+  @param[in] Length            - length of data to be overwritten
+
+  @retval EFI_SUCCESS          - The value was updated.
+  @retval EFI_BAD_BUFFER_SIZE  - Length does not match the size of the Name data.
+**/
+STATIC
+EFI_STATUS
+AslUpdateNameData (
+  IN     EFI_ACPI_DESCRIPTION_HEADER   *Table,
+  IN     UINT8                         *DsdtPointer,
+  IN     VOID                          *Buffer,
+  IN     UINTN                         Length
+  )
+{
+  UINT8                       DataSize;
+
+  ///
+  /// Check if size of new and old data is the same
+  ///
+  DataSize = *(DsdtPointer+4);
+  if ((Length == 1 && DataSize == 0xA) ||
+      (Length == 2 && DataSize == 0xB) ||
+      (Length == 4 && DataSize == 0xC)) {
+    if ((UINTN) (DsdtPointer + 5 + Length - (UINT8 *) Table) > Table->Length) {
+      return EFI_BAD_BUFFER_SIZE;
+    }
+    CopyMem (DsdtPointer+5, Buffer, Length);
+  } else if (Length == 1 && ((*(UINT8*) Buffer) == 0 || (*(UINT8*) Buffer) == 1) && (DataSize == 0 || DataSize == 1)) {
+    CopyMem (DsdtPointer+4, Buffer, Length);
+  } else {
+    return EFI_BAD_BUFFER_SIZE;
+  }
+  return EFI_SUCCESS;
+}
+
 /**
   This procedure will update immediate value assigned to a Name.
 
+  The DSDT is searched only up to the first matching Name. For several
+  updates to the DSDT use an update session instead, which searches and
+  reinstalls the table only once.
+
   @param[in] AslSignature      - The signature of Operation Region that we want to update.
   @param[in] Buffer            - source of data to be written over original aml
   @param[in] Length            - length of data to be overwritten
@@ -129,10 +199,8 @@ UpdateNameAslCode (
   EFI_STATUS                  Status;
   EFI_ACPI_DESCRIPTION_HEADER *Table;
   UINT8                       *CurrPtr;
-  UINT32                      *Signature;
   UINT8                       *DsdtPointer;
   UINTN                       Handle;
-  UINT8                       DataSize;
 
   if (mAcpiTable == NULL) {
     InitializeAslUpdateLib ();
@@ -161,50 +229,34 @@ UpdateNameAslCode (
 
   ///
   /// Loop through the ASL looking for values that we must fix up.
+  /// A Name needs the signature and one more byte of data.
   ///
-  for (DsdtPointer = CurrPtr; DsdtPointer <= (CurrPtr + ((EFI_ACPI_COMMON_HEADER *) CurrPtr)->Length); DsdtPointer++) {
+  for (DsdtPointer = CurrPtr + sizeof (EFI_ACPI_DESCRIPTION_HEADER); DsdtPointer + 5 <= CurrPtr + Table->Length; DsdtPointer++) {
     ///
-    /// Get a pointer to compare for signature
+    /// Check if this is the Name signature we are looking for
     ///
-    Signature = (UINT32 *) DsdtPointer;
-    ///
-    /// Check if this is the Device Object signature we are looking for
-    ///
-    if ((*Signature) == AslSignature) {
-      ///
-      /// Look for Name Encoding
-      ///
-      if (*(DsdtPointer-1) == AML_NAME_OP) {
-        ///
-        /// Check if size of new and old data is the same
-        ///
-        DataSize = *(DsdtPointer+4);
-        if ((Length == 1 && DataSize == 0xA) ||
-            (Length == 2 && DataSize == 0xB) ||
-            (Length == 4 && DataSize == 0xC)) {
-          CopyMem (DsdtPointer+5, Buffer, Length);
-        } else if (Length == 1 && ((*(UINT8*) Buffer) == 0 || (*(UINT8*) Buffer) == 1) && (DataSize == 0 || DataSize == 1)) {
-          CopyMem (DsdtPointer+4, Buffer, Length);
-        } else {
-          FreePool (Table);
-          return EFI_BAD_BUFFER_SIZE;
-        }
-        Status = mAcpiTable->UninstallAcpiTable (
-                               mAcpiTable,
-                               Handle
-                               );
-        Handle = 0;
-        Status = mAcpiTable->InstallAcpiTable (
-                               mAcpiTable,
-                               Table,
-                               Table->Length,
-                               &Handle
-                               );
+    if ((*(DsdtPointer-1) == AML_NAME_OP) && (ReadUnaligned32 ((UINT32 *) DsdtPointer) == AslSignature)) {
+      Status = AslUpdateNameData (Table, DsdtPointer, Buffer, Length);
+      if (EFI_ERROR (Status)) {
         FreePool (Table);
         return Status;
       }
+      Status = mAcpiTable->UninstallAcpiTable (
+                             mAcpiTable,
+                             Handle
+                             );
+      Handle = 0;
+      Status = mAcpiTable->InstallAcpiTable (
+                             mAcpiTable,
+                             Table,
+                             Table->Length,
+                             &Handle
+                             );
+      FreePool (Table);
+      return Status;
     }
   }
+  FreePool (Table);
   return EFI_NOT_FOUND;
 }
 
@@ -313,3 +365,255 @@ LocateAcpiTableBySignature (
   ///
   return Status;
 }
+
+/**
+  Return the name index bucket of a Name signature.
+
+  @param[in] Signature         - The signature of the Name.
+
+  @return The bucket index.
+**/
+STATIC
+UINTN
+AslNameIndexBucket (
+  IN     UINT32                        Signature
+  )
+{
+  return (UINTN)((Signature ^ (Signature >> 8) ^ (Signature >> 16) ^ (Signature >> 24)) & (ASL_NAME_INDEX_BUCKETS - 1));
+}
+
+/**
+  Find the first Name object of a signature in the table of an update session.
+
+  @param[in] Session           - The update session.
+  @param[in] AslSignature      - The signature of the Name.
+
+  @return Pointer to the Name signature in the table, NULL if it is not found.
+**/
+STATIC
+UINT8 *
+AslNameIndexLookup (
+  IN     ASL_UPDATE_SESSION            *Session,
+  IN     UINT32                        AslSignature
+  )
+{
+  UINT32                      Link;
+
+  for (Link = Session->Buckets[AslNameIndexBucket (AslSignature)]; Link != 0; Link = Session->Entries[Link - 1].Next) {
+    if (Session->Entries[Link - 1].Signature == AslSignature) {
+      return (UINT8 *) Session->Table + Session->Entries[Link - 1].Offset;
+    }
+  }
+  return NULL;
+}
+
+/**
+  This procedure starts a batch of updates to an ACPI table.
+  The table is parsed once and the names in it are indexed, so that every
+  following update is applied in place without searching the table again.
+
+  @param[in]  TableSignature   - The signature of the ACPI table to update, e.g. the DSDT.
+  @param[out] Session          - Updated with the new update session.
+
+  @retval EFI_SUCCESS          - The function completed successfully.
+  @retval EFI_INVALID_PARAMETER - Session is NULL.
+  @retval EFI_NOT_FOUND        - Failed to locate AcpiTable.
+  @retval EFI_NOT_READY        - Not ready to locate AcpiTable.
+  @retval EFI_OUT_OF_RESOURCES - Not enough memory to build the name index.
+**/
+EFI_STATUS
+EFIAPI
+AslUpdateSessionBegin (
+  IN     UINT32                        TableSignature,
+  OUT    ASL_UPDATE_SESSION            **Session
+  )
+{
+  EFI_STATUS                  Status;
+  ASL_UPDATE_SESSION          *NewSession;
+  UINT8                       *CurrPtr;
+  UINT32                      Offset;
+  UINT32                      Signature;
+  UINT32                      Link;
+  UINTN                       Bucket;
+
+  if (Session == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if (mAcpiTable == NULL) {
+    InitializeAslUpdateLib ();
+    if (mAcpiTable == NULL) {
+      return EFI_NOT_READY;
+    }
+  }
+
+  PERF_INMODULE_BEGIN ("AslUpdateSession");
+
+  NewSession = AllocateZeroPool (sizeof (ASL_UPDATE_SESSION));
+  if (NewSession == NULL) {
+    PERF_INMODULE_END ("AslUpdateSession");
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  ///
+  /// Locate table with matching signature
+  ///
+  Status = LocateAcpiTableBySignature (
+             TableSignature,
+             &NewSession->Table,
+             &NewSession->Handle
+             );
+  if (EFI_ERROR (Status)) {
+    FreePool (NewSession);
+    PERF_INMODULE_END ("AslUpdateSession");
+    return Status;
+  }
+
+  ///
+  /// Size the index with the Name encodings in the AML, then record the
+  /// first Name object of each signature. A Name needs the signature and
+  /// one more byte of data after the Name encoding.
+  ///
+  CurrPtr = (UINT8 *) NewSession->Table;
+  for (Offset = sizeof (EFI_ACPI_DESCRIPTION_HEADER); Offset + 5 <= NewSession->Table->Length; Offset++) {
+    if (CurrPtr[Offset - 1] == AML_NAME_OP) {
+      NewSession->EntryCount++;
+    }
+  }
+
+  if (NewSession->EntryCount != 0) {
+    NewSession->Entries = AllocatePool (NewSession->EntryCount * sizeof (ASL_NAME_INDEX_ENTRY));
+    if (NewSession->Entries == NULL) {
+      FreePool (NewSession->Table);
+      FreePool (NewSession);
+      PERF_INMODULE_END ("AslUpdateSession");
+      return EFI_OUT_OF_RESOURCES;
+    }
+  }
+
+  NewSession->EntryCount = 0;
+  for (Offset = sizeof (EFI_ACPI_DESCRIPTION_HEADER); Offset + 5 <= NewSession->Table->Length; Offset++) {
+    if (CurrPtr[Offset - 1] != AML_NAME_OP) {
+      continue;
+    }
+    Signature = ReadUnaligned32 ((UINT32 *) (CurrPtr + Offset));
+    Bucket = AslNameIndexBucket (Signature);
+    for (Link = NewSession->Buckets[Bucket]; Link != 0; Link = NewSession->Entries[Link - 1].Next) {
+      if (NewSession->Entries[Link - 1].Signature == Signature) {
+        break;
+      }
+    }
+    if (Link != 0) {
+      continue;
+    }
+    NewSession->Entries[NewSession->EntryCount].Signature = Signature;
+    NewSession->Entries[NewSession->EntryCount].Offset    = Offset;
+    NewSession->Entries[NewSession->EntryCount].Next      = NewSession->Buckets[Bucket];
+    NewSession->EntryCount++;
+    NewSession->Buckets[Bucket] = NewSession->EntryCount;
+  }
+
+  *Session = NewSession;
+  return EFI_SUCCESS;
+}
+
+/**
+  This procedure will update immediate value assigned to a Name in the table
+  of an update session. The table is not reinstalled until the session is
+  committed.
+
+  @param[in] Session           - The update session.
+  @param[in] AslSignature      - The signature of the Name that we want to update.
+  @param[in] Buffer            - source of data to be written over original aml
+  @param[in] Length            - length of data to be overwritten
+
+  @retval EFI_SUCCESS          - The function completed successfully.
+  @retval EFI_INVALID_PARAMETER - Session or Buffer is NULL.
+  @retval EFI_NOT_FOUND        - The Name is not in the table.
+  @retval EFI_BAD_BUFFER_SIZE  - Length does not match the size of the Name data.
+**/
+EFI_STATUS
+EFIAPI
+AslUpdateSessionUpdateName (
+  IN     ASL_UPDATE_SESSION            *Session,
+  IN     UINT32                        AslSignature,
+  IN     VOID                          *Buffer,
+  IN     UINTN                         Length
+  )
+{
+  EFI_STATUS                  Status;
+  UINT8                       *DsdtPointer;
+
+  if ((Session == NULL) || (Buffer == NULL)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  DsdtPointer = AslNameIndexLookup (Session, AslSignature);
+  if (DsdtPointer == NULL) {
+    return EFI_NOT_FOUND;
+  }
+
+  Status = AslUpdateNameData (Session->Table, DsdtPointer, Buffer, Length);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  Session->UpdateCount++;
+  return EFI_SUCCESS;
+}
+
+/**
+  This procedure ends an update session. If any Name was updated, the table
+  is reinstalled once; the ACPI table protocol updates its checksum.
+  The session is freed in all cases.
+
+  @param[in] Session           - The update session.
+
+  @retval EFI_SUCCESS          - The function completed successfully.
+  @retval EFI_INVALID_PARAMETER - Session is NULL.
+  @retval Others               - The table could not be reinstalled.
+**/
+EFI_STATUS
+EFIAPI
+AslUpdateSessionCommit (
+  IN     ASL_UPDATE_SESSION            *Session
+  )
+{
+  EFI_STATUS                  Status;
+
+  if (Session == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  Status = EFI_SUCCESS;
+  if (Session->UpdateCount != 0) {
+    Status = mAcpiTable->UninstallAcpiTable (
+                           mAcpiTable,
+                           Session->Handle
+                           );
+    Session->Handle = 0;
+    Status = mAcpiTable->InstallAcpiTable (
+                           mAcpiTable,
+                           Session->Table,
+                           Session->Table->Length,
+                           &Session->Handle
+                           );
+  }
+
+  DEBUG ((
+    DEBUG_INFO,
+    "AslUpdateSession: %u names indexed, %Lu updates - %r\n",
+    Session->EntryCount,
+    (UINT64)Session->UpdateCount,
+    Status
+    ));
+
+  if (Session->Entries != NULL) {
+    FreePool (Session->Entries);
+  }
+  FreePool (Session->Table);
+  FreePool (Session);
+
+  PERF_INMODULE_END ("AslUpdateSession");
+  return Status;
+}
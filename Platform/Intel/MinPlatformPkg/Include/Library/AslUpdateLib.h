@@ -21,6 +21,11 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Protocol/AcpiTable.h>
 #include <Protocol/AcpiSystemDescriptionTable.h>
 
+///
+/// Opaque state of a batch of updates to one ACPI table.
+///
+typedef struct _ASL_UPDATE_SESSION ASL_UPDATE_SESSION;
+
 /**
   This procedure will update immediate value assigned to a Name.
 
@@ -110,4 +115,69 @@ LocateAcpiTableBySignature (
   IN OUT  UINTN                         *Handle
   );
 
+/**
+  This procedure starts a batch of updates to an ACPI table.
+  The table is parsed once and the names in it are indexed, so that every
+  following update is applied in place without searching the table again.
+
+  @param[in]  TableSignature            The signature of the ACPI table to update, e.g. the DSDT.
+  @param[out] Session                   Updated with the new update session.
+
+  @retval EFI_SUCCESS                   The function completed successfully.
+  @retval EFI_INVALID_PARAMETER         Session is NULL.
+  @retval EFI_NOT_FOUND                 Failed to locate AcpiTable.
+  @retval EFI_NOT_READY                 Not ready to locate AcpiTable.
+  @retval EFI_OUT_OF_RESOURCES          Not enough memory to build the name index.
+  @retval EFI_UNSUPPORTED               The function is not supported in this library
+**/
+EFI_STATUS
+EFIAPI
+AslUpdateSessionBegin (
+  IN     UINT32                        TableSignature,
+  OUT    ASL_UPDATE_SESSION            **Session
+  );
+
+/**
+  This procedure will update immediate value assigned to a Name in the table
+  of an update session. The table is not reinstalled until the session is
+  committed.
+
+  @param[in] Session                    The update session.
+  @param[in] AslSignature               The signature of the Name that we want to update.
+  @param[in] Buffer                     source of data to be written over original aml
+  @param[in] Length                     length of data to be overwritten
+
+  @retval EFI_SUCCESS                   The function completed successfully.
+  @retval EFI_INVALID_PARAMETER         Session or Buffer is NULL.
+  @retval EFI_NOT_FOUND                 The Name is not in the table.
+  @retval EFI_BAD_BUFFER_SIZE           Length does not match the size of the Name data.
+  @retval EFI_UNSUPPORTED               The function is not supported in this library
+**/
+EFI_STATUS
+EFIAPI
+AslUpdateSessionUpdateName (
+  IN     ASL_UPDATE_SESSION            *Session,
+  IN     UINT32                        AslSignature,
+  IN     VOID                          *Buffer,
+  IN     UINTN                         Length
+  );
+
+/**
+  This procedure ends an update session. If any Name was updated, the table
+  is reinstalled once; the ACPI table protocol updates its checksum.
+  The session is freed in all cases.
+
+  @param[in] Session                    The update session.
+
+  @retval EFI_SUCCESS                   The function completed successfully.
+  @retval EFI_INVALID_PARAMETER         Session is NULL.
+  @retval EFI_UNSUPPORTED               The function is not supported in this library
+  @retval Others                        The table could not be reinstalled.
+**/
+EFI_STATUS
+EFIAPI
+AslUpdateSessionCommit (
+  IN     ASL_UPDATE_SESSION            *Session
+  );
+
 #endif
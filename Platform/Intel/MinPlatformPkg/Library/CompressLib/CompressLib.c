@@ -15,18 +15,9 @@
 #include <Library/MemoryAllocationLib.h>
 #include <Library/BaseMemoryLib.h>
 #include <Library/DebugLib.h>
+#include <Library/PcdLib.h>
 #include <Uefi/UefiBaseType.h>
 
-#define SHELL_FREE_NON_NULL(Pointer)  \
-  do {                                \
-    if ((Pointer) != NULL) {          \
-      FreePool((Pointer));            \
-      (Pointer) = NULL;               \
-    }                                 \
-  } while(FALSE)
-
-
-
 //
 // Macro Definitions
 //
@@ -40,9 +31,6 @@ typedef INT16             NODE;
 #define BLKSIZ            (1U << 14)  // 16 * 1024U
 #define PERC_FLAG         0x8000U
 #define CODE_BIT          16
-#define NIL               0
-#define MAX_HASH_VAL      (3 * WNDSIZ + (WNDSIZ / 512 + 1) * MAX_UINT8)
-#define HASH(LoopVar7, LoopVar5)        ((LoopVar7) + ((LoopVar5) << (WNDBIT - 9)) + WNDSIZ * 2)
 #define CRCPOLY           0xA001
 #define UPDATE_CRC(LoopVar5)     mCrc = mCrcTable[(mCrc ^ (LoopVar5)) & 0xFF] ^ (mCrc >> UINT8_BIT)
 
@@ -60,6 +48,42 @@ typedef INT16             NODE;
 #else
   #define                 NPT NP
 #endif
+
+//
+// Hash chain match finder. Every position in the text buffer is linked to
+// the previous position whose first THRESHOLD bytes hash to the same value.
+//
+#define HC_HASH_BITS      15
+#define HC_HASH_SIZE      (1U << HC_HASH_BITS)
+#define HC_NIL            MAX_UINT16
+#define HC_HASH(Pos)      ((((UINT32) mText[Pos] << 10) ^ ((UINT32) mText[(Pos) + 1] << 5) ^ mText[(Pos) + 2]) & (HC_HASH_SIZE - 1))
+
+#define TEXT_SIZE         (WNDSIZ * 2 + MAXMATCH)
+#define ARENA_SIZE        (TEXT_SIZE + HC_HASH_SIZE * sizeof (UINT16) + WNDSIZ * 2 * sizeof (UINT16) + BLKSIZ)
+
+#define MIN_COMPRESS_LEVEL      1
+#define MAX_COMPRESS_LEVEL      9
+
+///
+/// Match finder effort for one compression level.
+///
+typedef struct {
+  UINT16    MaxChain;     ///< Most hash chain entries compared per position.
+  UINT16    NiceLength;   ///< Stop searching once a match this long is found.
+} COMPRESS_LEVEL;
+
+STATIC CONST COMPRESS_LEVEL  mCompressLevels[MAX_COMPRESS_LEVEL] = {
+  {    4,  16 },
+  {    8,  32 },
+  {   16,  64 },
+  {   32, 128 },
+  {   64, MAXMATCH },
+  {  128, MAXMATCH },
+  {  256, MAXMATCH },
+  { 1024, MAXMATCH },
+  { 4096, MAXMATCH }
+};
+
 //
 // Function Prototypes
 //
@@ -83,9 +107,8 @@ STATIC UINT8  *mDst;
 STATIC UINT8  *mSrcUpperLimit;
 STATIC UINT8  *mDstUpperLimit;
 
-STATIC UINT8  *mLevel;
+STATIC UINT8  *mArena = NULL;
 STATIC UINT8  *mText;
-STATIC UINT8  *mChildCount;
 STATIC UINT8  *mBuf;
 STATIC UINT8  mCLen[NC];
 STATIC UINT8  mPTLen[NPT];
@@ -118,11 +141,10 @@ STATIC UINT16 mTFreq[2 * NT - 1];
 
 STATIC NODE   mPos;
 STATIC NODE   mMatchPos;
-STATIC NODE   mAvail;
-STATIC NODE   *mPosition;
-STATIC NODE   *mParent;
-STATIC NODE   *mPrev;
-STATIC NODE   *mNext = NULL;
+STATIC UINT16 *mHashHead;
+STATIC UINT16 *mHashPrev;
+STATIC UINT32 mMaxChain;
+STATIC INT32  mNiceLength;
 INT32         mHuffmanDepth = 0;
 
 /**
@@ -184,7 +206,11 @@ PutDword (
 }
 
 /**
-  Allocate memory spaces for data structures used in compression process.
+  Set up the working memory used in compression process.
+
+  All buffers are carved out of a single arena that is allocated on first
+  use and kept for later calls, so repeated compression does not go back
+  to the pool allocator. CompressLibDestructor() frees the arena.
 
   @retval EFI_SUCCESS           Memory was allocated successfully.
   @retval EFI_OUT_OF_RESOURCES  A memory allocation failed.
@@ -195,52 +221,51 @@ AllocateMemory (
   VOID
   )
 {
-  mText       = AllocateZeroPool (WNDSIZ * 2 + MAXMATCH);
-  mLevel      = AllocateZeroPool ((WNDSIZ + MAX_UINT8 + 1) * sizeof (*mLevel));
-  mChildCount = AllocateZeroPool ((WNDSIZ + MAX_UINT8 + 1) * sizeof (*mChildCount));
-  mPosition   = AllocateZeroPool ((WNDSIZ + MAX_UINT8 + 1) * sizeof (*mPosition));
-  mParent     = AllocateZeroPool (WNDSIZ * 2 * sizeof (*mParent));
-  mPrev       = AllocateZeroPool (WNDSIZ * 2 * sizeof (*mPrev));
-  mNext       = AllocateZeroPool ((MAX_HASH_VAL + 1) * sizeof (*mNext));
-
-  mBufSiz     = BLKSIZ;
-  mBuf        = AllocateZeroPool (mBufSiz);
-  while (mBuf == NULL) {
-    mBufSiz = (mBufSiz / 10U) * 9U;
-    if (mBufSiz < 4 * 1024U) {
+  if (mArena == NULL) {
+    mArena = AllocatePool (ARENA_SIZE);
+    if (mArena == NULL) {
       return EFI_OUT_OF_RESOURCES;
     }
-
-    mBuf = AllocateZeroPool (mBufSiz);
   }
 
+  mText     = mArena;
+  mHashHead = (UINT16 *) (mText + TEXT_SIZE);
+  mHashPrev = mHashHead + HC_HASH_SIZE;
+  mBuf      = (UINT8 *) (mHashPrev + WNDSIZ * 2);
+  mBufSiz   = BLKSIZ;
+
+  //
+  // Bytes past the end of the source are hashed too, so start from a known
+  // state to keep the output identical for identical input.
+  //
+  ZeroMem (mText, TEXT_SIZE);
   mBuf[0] = 0;
 
   return EFI_SUCCESS;
 }
 
 /**
-  Called when compression is completed to free memory previously allocated.
+  Free the arena kept by AllocateMemory() when the module that uses this
+  library is unloaded.
 
+  @retval RETURN_SUCCESS  The arena was freed or never allocated.
 **/
-VOID
+RETURN_STATUS
 EFIAPI
-FreeMemory (
+CompressLibDestructor (
   VOID
   )
 {
-  SHELL_FREE_NON_NULL (mText);
-  SHELL_FREE_NON_NULL (mLevel);
-  SHELL_FREE_NON_NULL (mChildCount);
-  SHELL_FREE_NON_NULL (mPosition);
-  SHELL_FREE_NON_NULL (mParent);
-  SHELL_FREE_NON_NULL (mPrev);
-  SHELL_FREE_NON_NULL (mNext);
-  SHELL_FREE_NON_NULL (mBuf);
+  if (mArena != NULL) {
+    FreePool (mArena);
+    mArena = NULL;
+  }
+
+  return RETURN_SUCCESS;
 }
 
 /**
-  Initialize String Info Log data structures.
+  Initialize the hash chains and select the match finder effort.
 **/
 VOID
 EFIAPI
@@ -248,330 +273,104 @@ InitSlide (
   VOID
   )
 {
-  NODE  LoopVar1;
+  UINTN  Level;
 
-  SetMem (mLevel + WNDSIZ, (MAX_UINT8 + 1) * sizeof (UINT8), 1);
-  SetMem (mPosition + WNDSIZ, (MAX_UINT8 + 1) * sizeof (NODE), 0);
+  SetMem (mHashHead, HC_HASH_SIZE * sizeof (UINT16), 0xFF);
 
-  SetMem (mParent + WNDSIZ, WNDSIZ * sizeof (NODE), 0);
-
-  mAvail = 1;
-  for (LoopVar1 = 1; LoopVar1 < WNDSIZ - 1; LoopVar1++) {
-    mNext[LoopVar1] = (NODE) (LoopVar1 + 1);
+  Level = PcdGet8 (PcdCompressLibLevel);
+  if (Level < MIN_COMPRESS_LEVEL) {
+    Level = MIN_COMPRESS_LEVEL;
+  } else if (Level > MAX_COMPRESS_LEVEL) {
+    Level = MAX_COMPRESS_LEVEL;
   }
 
-  mNext[WNDSIZ - 1] = NIL;
-  SetMem (mNext + WNDSIZ * 2, (MAX_HASH_VAL - WNDSIZ * 2 + 1) * sizeof (NODE), 0);
-}
-
-/**
-  Find child node given the parent node and the edge character
-
-  @param[in] LoopVar6       The parent node.
-  @param[in] LoopVar5       The edge character.
-
-  @return             The child node.
-  @retval NIL(Zero)   No child could be found.
-
-**/
-NODE
-EFIAPI
-Child (
-  IN NODE   LoopVar6,
-  IN UINT8  LoopVar5
-  )
-{
-  NODE  LoopVar4;
-
-  LoopVar4      = mNext[HASH (LoopVar6, LoopVar5)];
-  mParent[NIL]  = LoopVar6;  /* sentinel */
-  while (mParent[LoopVar4] != LoopVar6) {
-    LoopVar4 = mNext[LoopVar4];
-  }
-
-  return LoopVar4;
-}
-
-/**
-  Create a new child for a given parent node.
-
-  @param[in] LoopVar6       The parent node.
-  @param[in] LoopVar5       The edge character.
-  @param[in] LoopVar4       The child node.
-
-**/
-VOID
-EFIAPI
-MakeChild (
-  IN NODE   LoopVar6,
-  IN UINT8  LoopVar5,
-  IN NODE   LoopVar4
-  )
-{
-  NODE  LoopVar12;
-
-  NODE  LoopVar10;
-
-  LoopVar12          = (NODE) HASH (LoopVar6, LoopVar5);
-  LoopVar10          = mNext[LoopVar12];
-  mNext[LoopVar12]   = LoopVar4;
-  mNext[LoopVar4]    = LoopVar10;
-  mPrev[LoopVar10]   = LoopVar4;
-  mPrev[LoopVar4]    = LoopVar12;
-  mParent[LoopVar4]  = LoopVar6;
-  mChildCount[LoopVar6]++;
-}
-
-/**
-  Split a node.
-
-  @param[in] Old     The node to split.
-
-**/
-VOID
-EFIAPI
-Split (
-  IN NODE Old
-  )
-{
-  NODE  New;
-
-  NODE  LoopVar10;
-
-  New               = mAvail;
-  mAvail            = mNext[New];
-  mChildCount[New]  = 0;
-  LoopVar10         = mPrev[Old];
-  mPrev[New]        = LoopVar10;
-  mNext[LoopVar10]  = New;
-  LoopVar10         = mNext[Old];
-  mNext[New]        = LoopVar10;
-  mPrev[LoopVar10]  = New;
-  mParent[New]      = mParent[Old];
-  mLevel[New]       = (UINT8) mMatchLen;
-  mPosition[New]    = mPos;
-  MakeChild (New, mText[mMatchPos + mMatchLen], Old);
-  MakeChild (New, mText[mPos + mMatchLen], mPos);
+  mMaxChain   = mCompressLevels[Level - 1].MaxChain;
+  mNiceLength = mCompressLevels[Level - 1].NiceLength;
 }
 
 /**
-  Insert string info for current position into the String Info Log.
-
+  Rebase the hash chains after the text buffer moved down by WNDSIZ bytes.
+  Positions that fell out of the buffer are dropped.
 **/
 VOID
 EFIAPI
-InsertNode (
+SlideHashChains (
   VOID
   )
 {
-  NODE  LoopVar6;
-
-  NODE  LoopVar4;
-
-  NODE  LoopVar2;
-
-  NODE  LoopVar10;
-  UINT8 LoopVar5;
-  UINT8 *TempString3;
-  UINT8 *TempString2;
-
-  if (mMatchLen >= 4) {
-    //
-    // We have just got a long match, the target tree
-    // can be located by MatchPos + 1. Travese the tree
-    // from bottom up to get to a proper starting point.
-    // The usage of PERC_FLAG ensures proper node deletion
-    // in DeleteNode() later.
-    //
-    mMatchLen--;
-    LoopVar4 = (NODE) ((mMatchPos + 1) | WNDSIZ);
-    LoopVar6 = mParent[LoopVar4];
-    while (LoopVar6 == NIL) {
-      LoopVar4 = mNext[LoopVar4];
-      LoopVar6 = mParent[LoopVar4];
-    }
-
-    while (mLevel[LoopVar6] >= mMatchLen) {
-      LoopVar4 = LoopVar6;
-      LoopVar6 = mParent[LoopVar6];
-    }
+  UINT32  Index;
+  UINT16  Pos;
 
-    LoopVar10 = LoopVar6;
-    while (mPosition[LoopVar10] < 0) {
-      mPosition[LoopVar10]  = mPos;
-      LoopVar10             = mParent[LoopVar10];
-    }
-
-    if (LoopVar10 < WNDSIZ) {
-      mPosition[LoopVar10] = (NODE) (mPos | PERC_FLAG);
-    }
-  } else {
-    //
-    // Locate the target tree
-    //
-    LoopVar6 = (NODE) (mText[mPos] + WNDSIZ);
-    LoopVar5 = mText[mPos + 1];
-    LoopVar4 = Child (LoopVar6, LoopVar5);
-    if (LoopVar4 == NIL) {
-      MakeChild (LoopVar6, LoopVar5, mPos);
-      mMatchLen = 1;
-      return;
-    }
-
-    mMatchLen = 2;
+  for (Index = 0; Index < HC_HASH_SIZE; Index++) {
+    Pos               = mHashHead[Index];
+    mHashHead[Index]  = (UINT16) ((Pos != HC_NIL && Pos >= WNDSIZ) ? Pos - WNDSIZ : HC_NIL);
   }
-  //
-  // Traverse down the tree to find a match.
-  // Update Position value along the route.
-  // Node split or creation is involved.
-  //
-  for (;;) {
-    if (LoopVar4 >= WNDSIZ) {
-      LoopVar2  = MAXMATCH;
-      mMatchPos = LoopVar4;
-    } else {
-      LoopVar2  = mLevel[LoopVar4];
-      mMatchPos = (NODE) (mPosition[LoopVar4] & ~PERC_FLAG);
-    }
-
-    if (mMatchPos >= mPos) {
-      mMatchPos -= WNDSIZ;
-    }
-
-    TempString3 = &mText[mPos + mMatchLen];
-    TempString2 = &mText[mMatchPos + mMatchLen];
-    while (mMatchLen < LoopVar2) {
-      if (*TempString3 != *TempString2) {
-        Split (LoopVar4);
-        return;
-      }
-
-      mMatchLen++;
-      TempString3++;
-      TempString2++;
-    }
 
-    if (mMatchLen >= MAXMATCH) {
-      break;
-    }
-
-    mPosition[LoopVar4]  = mPos;
-    LoopVar6             = LoopVar4;
-    LoopVar4             = Child (LoopVar6, *TempString3);
-    if (LoopVar4 == NIL) {
-      MakeChild (LoopVar6, *TempString3, mPos);
-      return;
-    }
-
-    mMatchLen++;
+  for (Index = 0; Index < WNDSIZ; Index++) {
+    Pos               = mHashPrev[Index + WNDSIZ];
+    mHashPrev[Index]  = (UINT16) ((Pos != HC_NIL && Pos >= WNDSIZ) ? Pos - WNDSIZ : HC_NIL);
   }
-
-  LoopVar10             = mPrev[LoopVar4];
-  mPrev[mPos]           = LoopVar10;
-  mNext[LoopVar10]      = mPos;
-  LoopVar10             = mNext[LoopVar4];
-  mNext[mPos]           = LoopVar10;
-  mPrev[LoopVar10]      = mPos;
-  mParent[mPos]         = LoopVar6;
-  mParent[LoopVar4]     = NIL;
-
-  //
-  // Special usage of 'next'
-  //
-  mNext[LoopVar4] = mPos;
-
 }
 
 /**
-  Delete outdated string info. (The Usage of PERC_FLAG
-  ensures a clean deletion).
+  Insert the current position into its hash chain and search the chain for
+  the longest match within the window.
 
+  On return mMatchLen holds the length of the longest match found and
+  mMatchPos its text position. mMatchLen is 0 when the chain holds no
+  candidate and may be below THRESHOLD; Encode() sends a character instead
+  of such a short match.
 **/
 VOID
 EFIAPI
-DeleteNode (
+InsertNode (
   VOID
   )
 {
-  NODE  LoopVar6;
-
-  NODE  LoopVar4;
-
-  NODE  LoopVar11;
-
-  NODE  LoopVar10;
-
-  NODE  LoopVar9;
-
-  if (mParent[mPos] == NIL) {
-    return;
-  }
-
-  LoopVar4             = mPrev[mPos];
-  LoopVar11            = mNext[mPos];
-  mNext[LoopVar4]      = LoopVar11;
-  mPrev[LoopVar11]     = LoopVar4;
-  LoopVar4             = mParent[mPos];
-  mParent[mPos]        = NIL;
-  if (LoopVar4 >= WNDSIZ) {
+  UINT32  Hash;
+  UINT32  Chain;
+  UINT16  Candidate;
+  INT32   MinPos;
+  INT32   Limit;
+  INT32   Length;
+  UINT8   *Current;
+  UINT8   *Reference;
+
+  mMatchLen = 0;
+
+  Hash             = HC_HASH (mPos);
+  Candidate        = mHashHead[Hash];
+  mHashPrev[mPos]  = Candidate;
+  mHashHead[Hash]  = (UINT16) mPos;
+
+  Limit = MIN (MAXMATCH, mRemainder);
+  if (Limit < THRESHOLD) {
     return;
   }
 
-  mChildCount[LoopVar4]--;
-  if (mChildCount[LoopVar4] > 1) {
-    return;
-  }
-
-  LoopVar10 = (NODE) (mPosition[LoopVar4] & ~PERC_FLAG);
-  if (LoopVar10 >= mPos) {
-    LoopVar10 -= WNDSIZ;
-  }
-
-  LoopVar11 = LoopVar10;
-  LoopVar6 = mParent[LoopVar4];
-  LoopVar9 = mPosition[LoopVar6];
-  while ((LoopVar9 & PERC_FLAG) != 0) {
-    LoopVar9 &= ~PERC_FLAG;
-    if (LoopVar9 >= mPos) {
-      LoopVar9 -= WNDSIZ;
-    }
-
-    if (LoopVar9 > LoopVar11) {
-      LoopVar11 = LoopVar9;
-    }
-
-    mPosition[LoopVar6]  = (NODE) (LoopVar11 | WNDSIZ);
-    LoopVar6             = mParent[LoopVar6];
-    LoopVar9             = mPosition[LoopVar6];
-  }
-
-  if (LoopVar6 < WNDSIZ) {
-    if (LoopVar9 >= mPos) {
-      LoopVar9 -= WNDSIZ;
-    }
+  MinPos  = mPos - WNDSIZ;
+  Current = &mText[mPos];
+  for (Chain = mMaxChain; Chain > 0 && Candidate != HC_NIL && (INT32) Candidate >= MinPos; Chain--) {
+    Reference = &mText[Candidate];
+    //
+    // Only a candidate that also matches the byte just past the current
+    // best can improve on it.
+    //
+    if (Reference[mMatchLen] == Current[mMatchLen] && Reference[0] == Current[0]) {
+      for (Length = 1; Length < Limit && Reference[Length] == Current[Length]; Length++) {
+      }
 
-    if (LoopVar9 > LoopVar11) {
-      LoopVar11 = LoopVar9;
+      if (Length > mMatchLen) {
+        mMatchLen = Length;
+        mMatchPos = (NODE) Candidate;
+        if (Length >= Limit || Length >= mNiceLength) {
+          break;
+        }
+      }
     }
 
-    mPosition[LoopVar6] = (NODE) (LoopVar11 | WNDSIZ | PERC_FLAG);
+    Candidate = mHashPrev[Candidate];
   }
-
-  LoopVar11           = Child (LoopVar4, mText[LoopVar10 + mLevel[LoopVar4]]);
-  LoopVar10           = mPrev[LoopVar11];
-  LoopVar9            = mNext[LoopVar11];
-  mNext[LoopVar10]    = LoopVar9;
-  mPrev[LoopVar9]     = LoopVar10;
-  LoopVar10           = mPrev[LoopVar4];
-  mNext[LoopVar10]    = LoopVar11;
-  mPrev[LoopVar11]    = LoopVar10;
-  LoopVar10           = mNext[LoopVar4];
-  mPrev[LoopVar10]    = LoopVar11;
-  mNext[LoopVar11]    = LoopVar10;
-  mParent[LoopVar11]  = mParent[LoopVar4];
-  mParent[LoopVar4]   = NIL;
-  mNext[LoopVar4]     = mAvail;
-  mAvail              = LoopVar4;
 }
 
 /**
@@ -624,24 +423,20 @@ GetNextMatch (
   )
 {
   INT32 LoopVar8;
-  VOID  *Temp;
 
   mRemainder--;
   mPos++;
   if (mPos == WNDSIZ * 2) {
-    Temp = AllocateZeroPool (WNDSIZ + MAXMATCH);
-    if (Temp == NULL) {
-      return (FALSE);
-    }
-    CopyMem (Temp, &mText[WNDSIZ], WNDSIZ + MAXMATCH);
-    CopyMem (&mText[0], Temp, WNDSIZ + MAXMATCH);
-    FreePool (Temp);
+    //
+    // CopyMem() handles the overlapping move, no bounce buffer is needed.
+    //
+    CopyMem (&mText[0], &mText[WNDSIZ], WNDSIZ + MAXMATCH);
     LoopVar8 = FreadCrc (&mText[WNDSIZ + MAXMATCH], WNDSIZ);
     mRemainder += LoopVar8;
     mPos = WNDSIZ;
+    SlideHashChains ();
   }
 
-  DeleteNode ();
   InsertNode ();
 
   return (TRUE);
@@ -1292,7 +1087,6 @@ Encode (
 
   Status = AllocateMemory ();
   if (EFI_ERROR (Status)) {
-    FreeMemory ();
     return Status;
   }
 
@@ -1347,7 +1141,6 @@ Encode (
   }
 
   HufEncodeEnd ();
-  FreeMemory ();
   return (Status);
 }
 
@@ -1380,12 +1173,8 @@ Compress (
   mBufSiz         = 0;
   mBuf            = NULL;
   mText           = NULL;
-  mLevel          = NULL;
-  mChildCount     = NULL;
-  mPosition       = NULL;
-  mParent         = NULL;
-  mPrev           = NULL;
-  mNext           = NULL;
+  mHashHead       = NULL;
+  mHashPrev       = NULL;
 
   mSrc            = SrcBuffer;
   mSrcUpperLimit  = mSrc + SrcSize;
@@ -0,0 +1,468 @@
+/** @file
+  Host based unit test and benchmark of CompressLib.
+
+  Every corpus buffer is compressed with CompressLib and decompressed with
+  the UefiDecompressLib instance from MdePkg, so the tests check that the
+  hash chain match finder still produces a valid EFI compression stream.
+  The benchmark reports the compression throughput and ratio on a mixed
+  corpus.
+
+  Copyright (c) 2026, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <time.h>
+#include <Uefi.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/CompressLib.h>
+#include <Library/DebugLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/UefiDecompressLib.h>
+#include <Library/UnitTestLib.h>
+
+#define UNIT_TEST_NAME     "CompressLib Host Test"
+#define UNIT_TEST_VERSION  "1.0"
+
+#define BENCHMARK_SIZE     SIZE_1MB
+#define BENCHMARK_ROUNDS   4
+
+typedef enum {
+  CorpusZero,
+  CorpusRandom,
+  CorpusText,
+  CorpusLongRepeat,
+  CorpusTable,
+  CorpusMixed
+} CORPUS_KIND;
+
+typedef struct {
+  CHAR8          *Name;
+  CORPUS_KIND    Kind;
+  UINTN          Size;
+} CORPUS;
+
+//
+// The sizes cover empty and tiny inputs, inputs shorter than a match, a
+// single 16KB block, and inputs long enough to slide the 8KB window many
+// times.
+//
+STATIC CORPUS  mCorpus[] = {
+  { "Empty",                CorpusText,       0         },
+  { "One byte",             CorpusText,       1         },
+  { "Two bytes",            CorpusZero,       2         },
+  { "Three bytes",          CorpusZero,       3         },
+  { "Zero 64KB",            CorpusZero,       SIZE_64KB },
+  { "Random 4KB",           CorpusRandom,     SIZE_4KB  },
+  { "Random 100KB",         CorpusRandom,     100000    },
+  { "Text 16KB",            CorpusText,       SIZE_16KB },
+  { "Text 300KB",           CorpusText,       300000    },
+  { "Long repeats 200KB",   CorpusLongRepeat, 200000    },
+  { "Table 128KB",          CorpusTable,      SIZE_128KB },
+  { "Mixed 512KB",          CorpusMixed,      SIZE_512KB }
+};
+
+STATIC CONST CHAR8  *mWords[] = {
+  "Variable", "Memory", "Config", "Hob", "PcdGet", "Status", " = ", ";\n",
+  "EFI_SUCCESS", "  ", "if (", ") {\n", "}\n", "return ", "Index", "0x"
+};
+
+/**
+  Return the next value of a fixed linear congruential generator, so the
+  corpus is the same on every run.
+
+  @param[in, out] Seed  Generator state.
+
+  @return A pseudo random 32-bit value.
+**/
+STATIC
+UINT32
+NextRandom (
+  IN OUT UINT32  *Seed
+  )
+{
+  *Seed = *Seed * 1103515245 + 12345;
+  return *Seed >> 8;
+}
+
+/**
+  Fill a buffer with corpus data of the given kind.
+
+  @param[in]  Kind    The kind of data to generate.
+  @param[out] Buffer  The buffer to fill.
+  @param[in]  Size    The number of bytes to generate.
+**/
+STATIC
+VOID
+FillCorpus (
+  IN  CORPUS_KIND  Kind,
+  OUT UINT8        *Buffer,
+  IN  UINTN        Size
+  )
+{
+  UINT32       Seed;
+  UINTN        Index;
+  UINTN        Length;
+  CONST CHAR8  *Word;
+
+  Seed = 0x5EED;
+  switch (Kind) {
+    case CorpusZero:
+      ZeroMem (Buffer, Size);
+      break;
+
+    case CorpusRandom:
+      for (Index = 0; Index < Size; Index++) {
+        Buffer[Index] = (UINT8)NextRandom (&Seed);
+      }
+
+      break;
+
+    case CorpusText:
+      for (Index = 0; Index < Size; Index += Length) {
+        Word   = mWords[NextRandom (&Seed) % ARRAY_SIZE (mWords)];
+        Length = MIN (AsciiStrLen (Word), Size - Index);
+        CopyMem (&Buffer[Index], Word, Length);
+      }
+
+      break;
+
+    case CorpusLongRepeat:
+      //
+      // Runs longer than the longest match, repeated at distances just
+      // inside and just outside the window.
+      //
+      for (Index = 0; Index < Size; Index++) {
+        if ((Index % 9000) < 600) {
+          Buffer[Index] = (UINT8)(Index % 7);
+        } else if ((Index >= 8191) && ((Index / 1024) % 3 == 0)) {
+          Buffer[Index] = Buffer[Index - 8191];
+        } else {
+          Buffer[Index] = (UINT8)NextRandom (&Seed);
+        }
+      }
+
+      break;
+
+    case CorpusTable:
+      for (Index = 0; Index + sizeof (UINT32) <= Size; Index += sizeof (UINT32)) {
+        WriteUnaligned32 ((UINT32 *)&Buffer[Index], (UINT32)(0x80000000 | (Index * 3) | (NextRandom (&Seed) & 0x3)));
+      }
+
+      for ( ; Index < Size; Index++) {
+        Buffer[Index] = 0;
+      }
+
+      break;
+
+    case CorpusMixed:
+      for (Index = 0; Index < Size; Index += Length) {
+        Length = MIN (SIZE_16KB + (NextRandom (&Seed) % SIZE_16KB), Size - Index);
+        FillCorpus ((CORPUS_KIND)(NextRandom (&Seed) % CorpusMixed), &Buffer[Index], Length);
+      }
+
+      break;
+  }
+}
+
+/**
+  Compress a buffer into a newly allocated buffer.
+
+  @param[in]  Source          The data to compress.
+  @param[in]  SourceSize      The number of bytes in Source.
+  @param[out] Compressed      The compressed data. The caller frees it.
+  @param[out] CompressedSize  The number of bytes in Compressed.
+
+  @return The status returned by Compress().
+**/
+STATIC
+EFI_STATUS
+CompressToPool (
+  IN  UINT8   *Source,
+  IN  UINTN   SourceSize,
+  OUT UINT8   **Compressed,
+  OUT UINT64  *CompressedSize
+  )
+{
+  UINTN  BufferSize;
+
+  //
+  // Incompressible data grows by a few bytes per 16KB block, plus the
+  // header and the terminating byte.
+  //
+  BufferSize  = SourceSize + SourceSize / 8 + SIZE_1KB;
+  *Compressed = AllocatePool (BufferSize);
+  if (*Compressed == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  *CompressedSize = BufferSize;
+  return Compress (Source, SourceSize, *Compressed, CompressedSize);
+}
+
+/**
+  Decompress a buffer with UefiDecompressLib and compare it to the source.
+
+  @param[in] Source          The original data.
+  @param[in] SourceSize      The number of bytes in Source.
+  @param[in] Compressed      The compressed data.
+  @param[in] CompressedSize  The number of bytes in Compressed.
+
+  @retval UNIT_TEST_PASSED  The data decompressed to the original.
+**/
+STATIC
+UNIT_TEST_STATUS
+CheckDecompress (
+  IN UINT8   *Source,
+  IN UINTN   SourceSize,
+  IN UINT8   *Compressed,
+  IN UINT64  CompressedSize
+  )
+{
+  RETURN_STATUS  Status;
+  UINT32         DestinationSize;
+  UINT32         ScratchSize;
+  UINT8          *Destination;
+  VOID           *Scratch;
+
+  Status = UefiDecompressGetInfo (Compressed, (UINT32)CompressedSize, &DestinationSize, &ScratchSize);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+  UT_ASSERT_EQUAL (DestinationSize, SourceSize);
+
+  Destination = AllocatePool (DestinationSize + 1);
+  Scratch     = AllocatePool (ScratchSize);
+  UT_ASSERT_NOT_NULL (Destination);
+  UT_ASSERT_NOT_NULL (Scratch);
+
+  Status = UefiDecompress (Compressed, Destination, Scratch);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+  UT_ASSERT_MEM_EQUAL (Destination, Source, SourceSize);
+
+  FreePool (Destination);
+  FreePool (Scratch);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  A corpus buffer compresses into a stream that the EFI decompressor
+  restores, and compressing it again gives the same stream.
+
+  @param[in] Context  Pointer to the CORPUS to compress.
+
+  @retval UNIT_TEST_PASSED  The round trip restored the data.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+RoundTrip (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  CORPUS      *Corpus;
+  UINT8       *Source;
+  UINT8       *Compressed;
+  UINT8       *Again;
+  UINT64      CompressedSize;
+  UINT64      AgainSize;
+  EFI_STATUS  Status;
+
+  Corpus = (CORPUS *)Context;
+  Source = AllocatePool (Corpus->Size + 1);
+  UT_ASSERT_NOT_NULL (Source);
+  FillCorpus (Corpus->Kind, Source, Corpus->Size);
+
+  Status = CompressToPool (Source, Corpus->Size, &Compressed, &CompressedSize);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+  UT_ASSERT_EQUAL (CheckDecompress (Source, Corpus->Size, Compressed, CompressedSize), UNIT_TEST_PASSED);
+
+  //
+  // The arena is reused by the second call and must not leak state from
+  // the first one into the output.
+  //
+  Status = CompressToPool (Source, Corpus->Size, &Again, &AgainSize);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+  UT_ASSERT_EQUAL (AgainSize, CompressedSize);
+  UT_ASSERT_MEM_EQUAL (Again, Compressed, (UINTN)CompressedSize);
+
+  UT_LOG_INFO ("%a: %ld -> %ld bytes\n", Corpus->Name, (UINT64)Corpus->Size, CompressedSize);
+
+  FreePool (Source);
+  FreePool (Compressed);
+  FreePool (Again);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  A destination buffer that is too small returns EFI_BUFFER_TOO_SMALL and
+  the size that is needed, and that size is enough.
+
+  @param[in] Context  Unused.
+
+  @retval UNIT_TEST_PASSED  The required size was reported.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+BufferTooSmall (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  UINT8       *Source;
+  UINT8       *Compressed;
+  UINT64      CompressedSize;
+  UINT64      Required;
+  EFI_STATUS  Status;
+
+  Source = AllocatePool (SIZE_64KB);
+  UT_ASSERT_NOT_NULL (Source);
+  FillCorpus (CorpusText, Source, SIZE_64KB);
+
+  Compressed = AllocatePool (SIZE_64KB);
+  UT_ASSERT_NOT_NULL (Compressed);
+
+  Required = 16;
+  Status   = Compress (Source, SIZE_64KB, Compressed, &Required);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_BUFFER_TOO_SMALL);
+  UT_ASSERT_TRUE (Required > 16);
+
+  CompressedSize = Required;
+  Status         = Compress (Source, SIZE_64KB, Compressed, &CompressedSize);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+  UT_ASSERT_EQUAL (CompressedSize, Required);
+  UT_ASSERT_EQUAL (CheckDecompress (Source, SIZE_64KB, Compressed, CompressedSize), UNIT_TEST_PASSED);
+
+  FreePool (Source);
+  FreePool (Compressed);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Report the compression throughput and ratio on the mixed corpus.
+
+  @param[in] Context  Unused.
+
+  @retval UNIT_TEST_PASSED  The benchmark ran.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+CompressBenchmark (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  UINT8       *Source;
+  UINT8       *Compressed;
+  UINT64      CompressedSize;
+  UINTN       Round;
+  clock_t     Start;
+  UINT64      Ticks;
+  EFI_STATUS  Status;
+
+  Source = AllocatePool (BENCHMARK_SIZE);
+  UT_ASSERT_NOT_NULL (Source);
+  FillCorpus (CorpusMixed, Source, BENCHMARK_SIZE);
+
+  Compressed     = NULL;
+  CompressedSize = 0;
+  Start          = clock ();
+  for (Round = 0; Round < BENCHMARK_ROUNDS; Round++) {
+    if (Compressed != NULL) {
+      FreePool (Compressed);
+    }
+
+    Status = CompressToPool (Source, BENCHMARK_SIZE, &Compressed, &CompressedSize);
+    UT_ASSERT_NOT_EFI_ERROR (Status);
+  }
+
+  Ticks = (UINT64)(clock () - Start);
+  UT_ASSERT_EQUAL (CheckDecompress (Source, BENCHMARK_SIZE, Compressed, CompressedSize), UNIT_TEST_PASSED);
+
+  //
+  // KB per second, with the clock ticks rounded up to avoid a division by
+  // zero on a fast host.
+  //
+  UT_LOG_INFO (
+    "Compress: %ld KB/s, %ld -> %ld bytes (%ld%%)\n",
+    DivU64x64Remainder (MultU64x32 ((UINT64)BENCHMARK_SIZE * BENCHMARK_ROUNDS / SIZE_1KB, CLOCKS_PER_SEC), Ticks + 1, NULL),
+    (UINT64)BENCHMARK_SIZE,
+    CompressedSize,
+    DivU64x64Remainder (MultU64x32 (CompressedSize, 100), BENCHMARK_SIZE, NULL)
+    );
+
+  FreePool (Source);
+  FreePool (Compressed);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Initialize the unit test framework, suites and test cases, and run them.
+
+  @retval EFI_SUCCESS           All test cases were dispatched.
+  @retval EFI_OUT_OF_RESOURCES  There are not enough resources available to
+                                initialize the unit tests.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+UnitTestingEntry (
+  VOID
+  )
+{
+  EFI_STATUS                  Status;
+  UNIT_TEST_FRAMEWORK_HANDLE  Framework;
+  UNIT_TEST_SUITE_HANDLE      RoundTripTests;
+  UNIT_TEST_SUITE_HANDLE      Benchmark;
+  UINTN                       Index;
+
+  Framework = NULL;
+
+  DEBUG ((DEBUG_INFO, "%a v%a\n", UNIT_TEST_NAME, UNIT_TEST_VERSION));
+
+  Status = InitUnitTestFramework (&Framework, UNIT_TEST_NAME, gEfiCallerBaseName, UNIT_TEST_VERSION);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in InitUnitTestFramework. Status = %r\n", Status));
+    goto EXIT;
+  }
+
+  Status = CreateUnitTestSuite (&RoundTripTests, Framework, "Round Trip Tests", "CompressLib.RoundTrip", NULL, NULL);
+  if (EFI_ERROR (Status)) {
+    Status = EFI_OUT_OF_RESOURCES;
+    goto EXIT;
+  }
+
+  for (Index = 0; Index < ARRAY_SIZE (mCorpus); Index++) {
+    AddTestCase (RoundTripTests, mCorpus[Index].Name, "RoundTrip", RoundTrip, NULL, NULL, &mCorpus[Index]);
+  }
+
+  AddTestCase (RoundTripTests, "Buffer too small reports the required size", "BufferTooSmall", BufferTooSmall, NULL, NULL, NULL);
+
+  Status = CreateUnitTestSuite (&Benchmark, Framework, "Compress Benchmark", "CompressLib.Benchmark", NULL, NULL);
+  if (EFI_ERROR (Status)) {
+    Status = EFI_OUT_OF_RESOURCES;
+    goto EXIT;
+  }
+
+  AddTestCase (Benchmark, "Mixed 1MB corpus", "Benchmark", CompressBenchmark, NULL, NULL, NULL);
+
+  Status = RunAllTestSuites (Framework);
+
+EXIT:
+  if (Framework) {
+    FreeUnitTestFramework (Framework);
+  }
+
+  return Status;
+}
+
+/**
+  Standard POSIX C entry point for host based unit test execution.
+**/
+int
+main (
+  int   argc,
+  char  *argv[]
+  )
+{
+  return UnitTestingEntry ();
+}
@@ -7,6 +7,7 @@
 
 **/
 
+#include <Guid/EventGroup.h>
 #include <Guid/IdleLoopEvent.h>
 #include <Uefi.h>
 #include <Library/CacheMaintenanceLib.h>
@@ -307,6 +308,26 @@ IdleLoopEventCallback (
   CpuSleep ();
 }
 
+/**
+  Callback function for the ExitBootServices event. Reports the number of
+  TLB refill exceptions taken during boot.
+
+  @param  Event                 Event whose notification function is being invoked.
+  @param  Context               The pointer to the notification function's context,
+                                which is implementation-dependent.
+
+  @param VOID
+**/
+VOID
+EFIAPI
+ExitBootServicesEventCallback (
+  IN EFI_EVENT                Event,
+  IN VOID                     *Context
+  )
+{
+  DEBUG ((DEBUG_INFO, "TLB refill exceptions: %Lu\n", GetTlbRefillCount ()));
+}
+
 //
 // Globals used to initialize the protocol
 //
@@ -342,6 +363,7 @@ CpuDxeInitialize (
 {
   EFI_STATUS  Status;
   EFI_EVENT    IdleLoopEvent;
+  EFI_EVENT    ExitBootServicesEvent;
 
   InitializeExceptions (&Cpu);
 
@@ -363,5 +385,18 @@ CpuDxeInitialize (
                   &IdleLoopEvent
                   );
   ASSERT_EFI_ERROR (Status);
+
+  //
+  // Report the TLB refill exception count at ExitBootServices
+  //
+  Status = gBS->CreateEventEx (
+                  EVT_NOTIFY_SIGNAL,
+                  TPL_CALLBACK,
+                  ExitBootServicesEventCallback,
+                  NULL,
+                  &gEfiEventExitBootServicesGuid,
+                  &ExitBootServicesEvent
+                  );
+  ASSERT_EFI_ERROR (Status);
   return Status;
 }
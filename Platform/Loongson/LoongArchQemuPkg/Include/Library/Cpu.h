@@ -209,6 +209,7 @@
 /* Kscratch registers */
 #define LOONGARCH_CSR_KS0           0x30
 #define LOONGARCH_CSR_KS1           0x31
+#define LOONGARCH_CSR_KS2           0x32    /* KScratch for TLB refill counter */
 
 /* Stable timer registers */
 #define LOONGARCH_CSR_TMCFG         0x41
@@ -224,6 +225,9 @@
 #define LOONGARCH_CSR_TLBRSAVE      0x8b    /* KScratch for TLB refill exception */
 #define LOONGARCH_CSR_PGD           0x1b    /* Page table base */
 
+/* Invalid all tlb */
+#define INVTLB_ALL                  0x0
+
 /* Invalid addr with global=1 or matched asid in current tlb */
 #define INVTLB_ADDR_GTRUE_OR_ASID   0x6
 
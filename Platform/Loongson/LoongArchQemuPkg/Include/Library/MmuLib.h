@@ -70,6 +70,19 @@ LoongArchSetMemoryRegionNoExec (
   IN  UINTN                Length
   );
 
+/**
+  Returns the number of TLB refill exceptions taken since the MMU was
+  configured.
+
+  @param  VOID
+
+  @retval  The number of TLB refill exceptions.
+**/
+UINT64
+GetTlbRefillCount (
+  VOID
+  );
+
 /**
   Create a page table and initialize the MMU.
 
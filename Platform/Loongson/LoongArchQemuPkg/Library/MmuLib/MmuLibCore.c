@@ -22,6 +22,24 @@
 #include "page.h"
 #include "mmu.h"
 
+//
+// Above this many invtlb a flush invalidates the whole TLB instead of
+// issuing one invtlb per page.
+//
+#define TLB_FLUSH_PAGE_THRESHOLD  64
+
+//
+// Virtual address range whose translations were changed or removed while
+// updating the page table. It is invalidated once the update is complete.
+// PageSize is the smallest page size of the changed translations, so a
+// range that only held huge pages is invalidated once per huge page.
+//
+typedef struct {
+  UINTN  Start;
+  UINTN  End;
+  UINTN  PageSize;
+} TLB_FLUSH_RANGE;
+
 BOOLEAN  mMmuInited = FALSE;
 /**
   Check to see if mmu successfully initializes.
@@ -472,6 +490,142 @@ GetHugePageAttributes (
   return Attributes;
 }
 
+/**
+  Adds a virtual address range to the range that needs a TLB invalidation.
+
+  @param  Flush  A pointer to the pending TLB flush range.
+  @param  Start  The start address of the changed range.
+  @param  End  The end address of the changed range.
+  @param  PageSize  The page size the changed range was mapped with.
+
+  @retval  VOID
+**/
+VOID
+AddTlbFlushRange (
+  IN OUT TLB_FLUSH_RANGE *Flush,
+  IN     UINTN           Start,
+  IN     UINTN           End,
+  IN     UINTN           PageSize
+  )
+{
+  if (Flush->Start == Flush->End) {
+    Flush->Start = Start;
+    Flush->End = End;
+    Flush->PageSize = PageSize;
+    return;
+  }
+
+  if (PageSize < Flush->PageSize) {
+    Flush->PageSize = PageSize;
+  }
+
+  if (Start < Flush->Start) {
+    Flush->Start = Start;
+  }
+
+  if (End > Flush->End) {
+    Flush->End = End;
+  }
+}
+
+/**
+  Invalidates the TLB entries of the pending TLB flush range.
+
+  Small ranges are invalidated page by page so that unrelated translations
+  stay cached, larger ones invalidate the whole TLB with a single invtlb.
+  A range that only held huge pages needs one invtlb per huge page, since
+  an invtlb by address drops the entry that maps the whole huge page.
+
+  @param  Flush  A pointer to the pending TLB flush range.
+
+  @retval  VOID
+**/
+VOID
+FlushTlbRange (
+  IN OUT TLB_FLUSH_RANGE *Flush
+  )
+{
+  UINTN Address;
+
+  if (Flush->Start == Flush->End) {
+    return;
+  }
+
+  if (((Flush->End - Flush->Start) / Flush->PageSize) > TLB_FLUSH_PAGE_THRESHOLD) {
+    LoongarchInvalidTlbAll ();
+  } else {
+    for (Address = Flush->Start & ~(Flush->PageSize - 1);
+         Address < Flush->End;
+         Address += Flush->PageSize) {
+      LoongarchInvalidTlb (Address);
+    }
+  }
+
+  Flush->Start = 0;
+  Flush->End = 0;
+  Flush->PageSize = 0;
+}
+
+/**
+  Merges a page table back into a huge page.
+
+  If all the page table entries under the page middle directory map the
+  huge page range contiguously with the same Attributes, the page table is
+  replaced by a single huge page entry and freed.
+
+  @param  Pmd  A pointer to the page middle directory.
+  @param  Address  An address within the huge page range.
+  @param  Flush  A pointer to the pending TLB flush range.
+
+  @retval  TRUE  The page table was merged into a huge page.
+  @retval  FALSE The page table was left unchanged.
+**/
+BOOLEAN
+MergePageToHugePage (
+  IN     PMD             *Pmd,
+  IN     UINTN           Address,
+  IN OUT TLB_FLUSH_RANGE *Flush
+  )
+{
+  PTE *Pte;
+  UINTN Index;
+  UINTN Attributes;
+  UINTN HugePageStart;
+
+  if ((pmd_none (*Pmd)) ||
+      (IS_HUGE_PAGE (Pmd->PmdVal)))
+  {
+    return FALSE;
+  }
+
+  Pte = (PTE *)PMD_VAL (*Pmd);
+  HugePageStart = Address & PMD_MASK;
+  Attributes = GET_PAGE_ATTRIBUTES (Pte[0]);
+
+  //
+  // A huge page entry is always global, see MAKE_HUGE_PTE and IS_HUGE_PAGE.
+  //
+  if (((Attributes & PAGE_VALID) == 0) ||
+      ((Attributes & PAGE_GLOBAL) == 0))
+  {
+    return FALSE;
+  }
+
+  for (Index = 0; Index < ENTRYS_PER_PTE; Index++) {
+    if (PTE_VAL (Pte[Index]) !=
+        PTE_VAL (MAKE_PTE (HugePageStart + Index * EFI_PAGE_SIZE, Attributes)))
+    {
+      return FALSE;
+    }
+  }
+
+  SetPmd (Pmd, (PTE *)MAKE_HUGE_PTE (HugePageStart, Attributes));
+  PteFree (Pte);
+  AddTlbFlushRange (Flush, HugePageStart, HugePageStart + HUGE_PAGE_SIZE, EFI_PAGE_SIZE);
+
+  return TRUE;
+}
+
 /**
   Establishes a page table entry based on the specified memory region.
 
@@ -479,16 +633,18 @@ GetHugePageAttributes (
   @param  Address  The memory space start address.
   @param  End  The end address of the memory space.
   @param  Attributes  Memory space Attributes.
+  @param  Flush  A pointer to the pending TLB flush range.
 
   @retval     EFI_SUCCESS   The page table entry was created successfully.
   @retval     EFI_OUT_OF_RESOURCES  Page table entry establishment failed due to resource exhaustion.
 **/
 EFI_STATUS
 MemoryMapPteRange (
-  IN PMD *Pmd,
-  IN UINTN Address,
-  IN UINTN End,
-  IN UINTN Attributes
+  IN     PMD             *Pmd,
+  IN     UINTN           Address,
+  IN     UINTN           End,
+  IN     UINTN           Attributes,
+  IN OUT TLB_FLUSH_RANGE *Flush
   )
 {
   PTE *Pte;
@@ -516,7 +672,7 @@ MemoryMapPteRange (
 
     SetPte (Pte, PteVal);
     if (UpDate) {
-      LoongarchInvalidTlb(Address);
+      AddTlbFlushRange (Flush, Address, Address + EFI_PAGE_SIZE, EFI_PAGE_SIZE);
     }
   } while (Pte++, Address += EFI_PAGE_SIZE, Address != End);
 
@@ -530,16 +686,18 @@ MemoryMapPteRange (
   @param  Address  The memory space start address.
   @param  End  The end address of the memory space.
   @param  Attributes  Memory space Attributes.
+  @param  Flush  A pointer to the pending TLB flush range.
 
   @retval  EFI_SUCCESS   The page table entry was created successfully.
   @retval  EFI_OUT_OF_RESOURCES  Page table entry establishment failed due to resource exhaustion.
 **/
 EFI_STATUS
 ConvertHugePageToPage (
-  IN  PMD *Pmd,
-  IN UINTN Address,
-  IN UINTN End,
-  IN UINTN Attributes
+  IN     PMD             *Pmd,
+  IN     UINTN           Address,
+  IN     UINTN           End,
+  IN     UINTN           Attributes,
+  IN OUT TLB_FLUSH_RANGE *Flush
   )
 {
   UINTN OldAttributes;
@@ -547,28 +705,42 @@ ConvertHugePageToPage (
   UINTN HugePageStart;
   EFI_STATUS Status;
 
+  Status = EFI_SUCCESS;
+  HugePageStart = Address & PMD_MASK;
+  HugePageEnd = HugePageStart + HUGE_PAGE_SIZE;
+
   if ((pmd_none (*Pmd)) ||
       (!IS_HUGE_PAGE (Pmd->PmdVal)))
   {
-    Status |= MemoryMapPteRange (Pmd, Address, End, Attributes);
+    Status |= MemoryMapPteRange (Pmd, Address, End, Attributes, Flush);
   } else {
     OldAttributes = GetHugePageAttributes(Pmd);
     SetPmd (Pmd, (PTE *)PcdGet64 (PcdInvalidPte));
-    HugePageStart = Address & PMD_MASK;
-    HugePageEnd = HugePageStart + HUGE_PAGE_SIZE;
     ASSERT (HugePageEnd >= End);
 
+    //
+    // The huge page translation may still be cached.
+    //
+    AddTlbFlushRange (Flush, HugePageStart, HugePageEnd, HUGE_PAGE_SIZE);
+
     if (Address > HugePageStart) {
-      Status |= MemoryMapPteRange (Pmd, HugePageStart, Address, OldAttributes);
+      Status |= MemoryMapPteRange (Pmd, HugePageStart, Address, OldAttributes, Flush);
     }
 
-    Status |= MemoryMapPteRange (Pmd, Address, End, Attributes);
+    Status |= MemoryMapPteRange (Pmd, Address, End, Attributes, Flush);
 
     if (End < HugePageEnd) {
-      Status |= MemoryMapPteRange (Pmd, End, HugePageEnd, OldAttributes);
+      Status |= MemoryMapPteRange (Pmd, End, HugePageEnd, OldAttributes, Flush);
     }
   }
 
+  //
+  // The update may have made the whole huge page range uniform again.
+  //
+  if (!EFI_ERROR (Status)) {
+    MergePageToHugePage (Pmd, HugePageStart, Flush);
+  }
+
   return Status;
 }
 
@@ -579,20 +751,24 @@ ConvertHugePageToPage (
   @param  Address  The memory space start address.
   @param  End  The end address of the memory space.
   @param  Attributes  Memory space Attributes.
+  @param  Flush  A pointer to the pending TLB flush range.
 
   @retval     EFI_SUCCESS   The page middle directory was created successfully.
   @retval     EFI_OUT_OF_RESOURCES  Page middle directory establishment failed due to resource exhaustion.
 **/
 EFI_STATUS
 MemoryMapPmdRange (
-  IN PUD *Pud,
-  IN UINTN Address,
-  IN UINTN End,
-  IN UINTN Attributes
+  IN     PUD             *Pud,
+  IN     UINTN           Address,
+  IN     UINTN           End,
+  IN     UINTN           Attributes,
+  IN OUT TLB_FLUSH_RANGE *Flush
   )
 {
   PMD *Pmd;
+  PTE *Pte;
   UINTN Next;
+  EFI_STATUS Status;
 
   Pmd = PmdAllocGet (Pud, Address);
   if (!Pmd) {
@@ -601,22 +777,44 @@ MemoryMapPmdRange (
 
   do {
     Next = PMD_ADDRESS_END (Address, End);
+    //
+    // A fully covered huge page range is always mapped by a huge page, even
+    // if it was split into pages before.
+    //
     if (((Address & (~PMD_MASK)) == 0) &&
-        ((Next &  (~PMD_MASK)) == 0) &&
-        (pmd_none (*Pmd) || IS_HUGE_PAGE (Pmd->PmdVal)))
+        ((Next &  (~PMD_MASK)) == 0))
     {
       DEBUG ((DEBUG_VERBOSE,
         "%a %d Address %p  PGD_INDEX %p PUD_INDEX   %p PMD_INDEX  %p MAKE_HUGE_PTE  %p\n",
         __func__, __LINE__,  Address, PGD_INDEX (Address), PUD_INDEX (Address), PMD_INDEX (Address),
         MAKE_HUGE_PTE (Address, Attributes)));
 
+      Pte = NULL;
+      if (!pmd_none (*Pmd)) {
+        if (!IS_HUGE_PAGE (Pmd->PmdVal)) {
+          Pte = (PTE *)PMD_VAL (*Pmd);
+        }
+
+        if (Pte != NULL) {
+          AddTlbFlushRange (Flush, Address, Next, EFI_PAGE_SIZE);
+        } else if (PMD_VAL (*Pmd) != (UINTN)MAKE_HUGE_PTE (Address, Attributes)) {
+          AddTlbFlushRange (Flush, Address, Next, HUGE_PAGE_SIZE);
+        }
+      }
+
       SetPmd (Pmd, (PTE *)MAKE_HUGE_PTE (Address, Attributes));
+      if (Pte != NULL) {
+        PteFree (Pte);
+      }
     } else {
-      ConvertHugePageToPage (Pmd, Address, Next, Attributes);
+      Status = ConvertHugePageToPage (Pmd, Address, Next, Attributes, Flush);
+      if (EFI_ERROR (Status)) {
+        return Status;
+      }
     }
   } while (Pmd++, Address = Next, Address != End);
 
-  return 0;
+  return EFI_SUCCESS;
 }
 
 /**
@@ -626,16 +824,18 @@ MemoryMapPmdRange (
   @param  Address  The memory space start address.
   @param  End  The end address of the memory space.
   @param  Attributes  Memory space Attributes.
+  @param  Flush  A pointer to the pending TLB flush range.
 
   @retval     EFI_SUCCESS   The page upper directory was created successfully.
   @retval     EFI_OUT_OF_RESOURCES  Page upper directory establishment failed due to resource exhaustion.
 **/
 EFI_STATUS
 MemoryMapPudRange (
-  IN PGD *Pgd,
-  IN UINTN Address,
-  IN UINTN End,
-  IN UINTN Attributes
+  IN     PGD             *Pgd,
+  IN     UINTN           Address,
+  IN     UINTN           End,
+  IN     UINTN           Attributes,
+  IN OUT TLB_FLUSH_RANGE *Flush
   )
 {
   PUD *Pud;
@@ -648,7 +848,7 @@ MemoryMapPudRange (
 
   do {
     Next = PUD_ADDRESS_END (Address, End);
-    if (MemoryMapPmdRange (Pud, Address, Next, Attributes)) {
+    if (MemoryMapPmdRange (Pud, Address, Next, Attributes, Flush)) {
       return EFI_OUT_OF_RESOURCES;
     }
   } while (Pud++, Address = Next, Address != End);
@@ -658,6 +858,9 @@ MemoryMapPudRange (
 /**
   Establishes a page global directory based on the specified memory region.
 
+  The TLB entries of all the changed translations are invalidated once, after
+  the whole range has been updated.
+
   @param  Start  The memory space start address.
   @param  End  The end address of the memory space.
   @param  Attributes  Memory space Attributes.
@@ -676,17 +879,25 @@ MemoryMapPageRange (
   UINTN Next;
   UINTN Address = Start;
   EFI_STATUS Err;
+  TLB_FLUSH_RANGE Flush;
+
+  Flush.Start = 0;
+  Flush.End = 0;
+  Flush.PageSize = 0;
+  Err = EFI_SUCCESS;
 
   Pgd = PgdOffset (Address);
   do {
     Next = PGD_ADDRESS_END (Address, End);
-    Err = MemoryMapPudRange (Pgd, Address, Next, Attributes);
+    Err = MemoryMapPudRange (Pgd, Address, Next, Attributes, &Flush);
     if (Err) {
-      return Err;
+      break;
     }
   } while (Pgd++, Address = Next, Address != End);
 
-  return EFI_SUCCESS;
+  FlushTlbRange (&Flush);
+
+  return Err;
 }
 
 /**
@@ -799,17 +1010,25 @@ GetLoongArchMemoryRegion (
     if (Pte == NULL) {
       return EFI_SUCCESS;
     }
-    AttributesTmp = GET_PAGE_ATTRIBUTES (*Pte);
     if (IS_HUGE_PAGE (Pte->PteVal)) {
+      AttributesTmp = GET_PAGE_ATTRIBUTES (*Pte);
       if (AttributesTmp == Attributes) {
          *RegionLength += HUGE_PAGE_SIZE;
       }
       BaseAddress += HUGE_PAGE_SIZE;
     } else {
-      if (AttributesTmp == Attributes) {
-        *RegionLength += EFI_PAGE_SIZE;
-      }
-      BaseAddress += EFI_PAGE_SIZE;
+      //
+      // Walk the rest of this page table directly instead of starting
+      // again from the page global directory for every page.
+      //
+      do {
+        AttributesTmp = GET_PAGE_ATTRIBUTES (*Pte);
+        if (AttributesTmp == Attributes) {
+          *RegionLength += EFI_PAGE_SIZE;
+        }
+        BaseAddress += EFI_PAGE_SIZE;
+        Pte++;
+      } while (((BaseAddress & (~PMD_MASK)) != 0) && (BaseAddress <= EndAddress));
     }
 
     if (BaseAddress > EndAddress) {
@@ -868,6 +1087,36 @@ LoongArchSetMemoryRegionNoExec (
   return EFI_SUCCESS;
 }
 
+/**
+  Returns the number of TLB refill exceptions taken since the MMU was
+  configured.
+
+  The TLB refill handler counts in HandleTlbRefillCount of its own copy at
+  the TLB refill entry, so the counter is read from there.
+
+  @param  VOID
+
+  @retval  The number of TLB refill exceptions.
+**/
+UINT64
+GetTlbRefillCount (
+  VOID
+  )
+{
+  UINTN  TlbReEntry;
+
+  if (!MmuIsInit ()) {
+    return 0;
+  }
+
+  TlbReEntry = GetTlbRefillFuncBase ();
+  if (TlbReEntry == 0) {
+    return 0;
+  }
+
+  return *(volatile UINT64 *)(TlbReEntry + (UINTN)(HandleTlbRefillCount - HandleTlbRefill));
+}
+
 /**
   Check to see if mmu successfully initializes and saves the result.
 
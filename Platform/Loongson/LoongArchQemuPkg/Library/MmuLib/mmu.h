@@ -54,6 +54,7 @@ typedef struct {
 #define MAX_VIRTUAL_MEMORY_MAP_DESCRIPTORS (128)
 
 extern CHAR8 HandleTlbRefill[], HandleTlbRefillEnd[];
+extern CHAR8 HandleTlbRefillCount[];
 
 /*
  Invalid corresponding TLB entries are based on the address given
@@ -68,6 +69,19 @@ LoongarchInvalidTlb (
   UINTN Address
   );
 
+/*
+ Invalid all TLB entries
+
+ @param  VOID
+
+ @retval  none
+*/
+extern
+VOID
+LoongarchInvalidTlbAll (
+  VOID
+  );
+
 /*
  Set Tlb Refill function to hardware
 
@@ -81,6 +95,19 @@ SetTlbRefillFuncBase (
   UINTN Address
   );
 
+/*
+ Get Tlb Refill function base from hardware
+
+ @param  VOID
+
+ @retval  The address of tlb refill function
+*/
+extern
+UINTN
+GetTlbRefillFuncBase (
+  VOID
+  );
+
 /*
   Set Cpu Status Register Page Size.
 
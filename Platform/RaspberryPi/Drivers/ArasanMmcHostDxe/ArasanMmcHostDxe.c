@@ -18,6 +18,23 @@ UINT32 LastExecutedCommand = (UINT32) -1;
 STATIC RASPBERRY_PI_FIRMWARE_PROTOCOL *mFwProtocol;
 STATIC UINTN mMmcHsBase;
 
+STATIC MMC_DATA_MODE mDataMode = MmcDataPio;
+STATIC ADMA2_DESCRIPTOR *mAdmaTable;
+STATIC EFI_PHYSICAL_ADDRESS mAdmaTableDeviceAddress;
+STATIC VOID *mAdmaTableMapping;
+
+//
+// Block data commands are only issued once Read/WriteBlockData
+// provides the buffer, so that DMA can be set up first.
+//
+STATIC BOOLEAN mCmdPending = FALSE;
+STATIC UINT32 mPendingCmd;
+STATIC UINT32 mPendingArg;
+
+STATIC EFI_EVENT mLedTimer;
+STATIC BOOLEAN mLedOn = FALSE;
+STATIC EFI_EVENT mExitBootServicesEvent;
+
 STATIC
 UINT32
 EFIAPI
@@ -68,6 +85,73 @@ SdMmioAndThenOr32 (
 }
 
 
+STATIC
+VOID
+EFIAPI
+LedTimerCallback (
+  IN EFI_EVENT  Event,
+  IN VOID       *Context
+  )
+{
+  mFwProtocol->SetLed (FALSE);
+  mLedOn = FALSE;
+}
+
+/**
+   Signals data transfer activity. The LED is switched on at most once per
+   burst and switched off by a timer once the card has gone idle, instead
+   of two mailbox calls around every block.
+**/
+STATIC
+VOID
+LedActivity (
+  VOID
+  )
+{
+  if (mLedTimer == NULL) {
+    return;
+  }
+
+  if (!mLedOn) {
+    mFwProtocol->SetLed (TRUE);
+    mLedOn = TRUE;
+  }
+
+  gBS->SetTimer (mLedTimer, TimerRelative, LED_IDLE_TIMEOUT);
+}
+
+/**
+   Cancels the idle timer and switches the activity LED off right away,
+   after a failed transfer or when the driver is going away.
+**/
+STATIC
+VOID
+LedIdle (
+  VOID
+  )
+{
+  if (mLedTimer == NULL) {
+    return;
+  }
+
+  gBS->SetTimer (mLedTimer, TimerCancel, 0);
+  if (mLedOn) {
+    mFwProtocol->SetLed (FALSE);
+    mLedOn = FALSE;
+  }
+}
+
+STATIC
+VOID
+EFIAPI
+ExitBootServicesCallback (
+  IN EFI_EVENT  Event,
+  IN VOID       *Context
+  )
+{
+  LedIdle ();
+}
+
 /**
    These SD commands are optional, according to the SD Spec
 **/
@@ -325,32 +409,29 @@ MMCBuildDevicePath (
   return EFI_SUCCESS;
 }
 
+/**
+   Issues an already translated command and waits for its completion.
+
+   A non-zero BlockCount programs the block count for the data phase of
+   the command, which is then performed using DMA if UseDma is TRUE.
+**/
+STATIC
 EFI_STATUS
-MMCSendCommand (
-  IN EFI_MMC_HOST_PROTOCOL    *This,
-  IN MMC_CMD                  MmcCmd,
-  IN UINT32                   Argument
+SendTranslatedCommand (
+  IN UINT32   MmcCmd,
+  IN UINT32   Argument,
+  IN BOOLEAN  IsAppCmd,
+  IN UINT32   BlockCount,
+  IN BOOLEAN  UseDma
   )
 {
   UINTN MmcStatus;
   UINTN RetryCount = 0;
   UINTN CmdSendOKMask;
   EFI_STATUS Status = EFI_SUCCESS;
-  BOOLEAN IsAppCmd = (LastExecutedCommand == CMD55);
   BOOLEAN IsDATCmd = FALSE;
   BOOLEAN IsADTCCmd = FALSE;
 
-  DEBUG ((DEBUG_MMCHOST_SD, "ArasanMMCHost: MMCSendCommand(MmcCmd: %08x, Argument: %08x)\n", MmcCmd, Argument));
-
-  if (IgnoreCommand (MmcCmd)) {
-    return EFI_SUCCESS;
-  }
-
-  MmcCmd = TranslateCommand (MmcCmd, Argument);
-  if (MmcCmd == 0xffffffff) {
-    return EFI_UNSUPPORTED;
-  }
-
   if ((MmcCmd & CMD_R1_ADTC) == CMD_R1_ADTC) {
     IsADTCCmd = TRUE;
   }
@@ -387,6 +468,10 @@ MMCSendCommand (
     SdMmioWrite32 (MMCHS_BLK, 8);
   } else if (!IsAppCmd && MmcCmd == CMD6) {
     SdMmioWrite32 (MMCHS_BLK, 64);
+  } else if (IsADTCCmd && BlockCount != 0) {
+    SdMmioWrite32 (MMCHS_BLK, BLEN_512BYTES | SDMA_BOUNDARY_512K |
+      (BlockCount << BLOCK_COUNT_SHIFT));
+    MmcCmd |= UseDma ? (DE_ENABLE | BCE_ENABLE) : BCE_ENABLE;
   } else if (IsADTCCmd) {
     SdMmioWrite32 (MMCHS_BLK, BLEN_512BYTES);
   }
@@ -451,11 +536,59 @@ Exit:
   if (EFI_ERROR (Status)) {
     LastExecutedCommand = (UINT32) -1;
   } else {
-    LastExecutedCommand = MmcCmd;
+    LastExecutedCommand = MmcCmd & ~(DE_ENABLE | BCE_ENABLE);
   }
   return Status;
 }
 
+/**
+   Returns TRUE for the block read and write commands whose data phase
+   can be performed using DMA.
+**/
+STATIC
+BOOLEAN
+IsBlockDataCommand (
+  IN UINT32 MmcCmd
+  )
+{
+  return (MmcCmd == CMD_READ_SINGLE_BLOCK ||
+          MmcCmd == CMD_READ_MULTIPLE_BLOCK ||
+          MmcCmd == CMD_WRITE_SINGLE_BLOCK ||
+          MmcCmd == CMD_WRITE_MULTIPLE_BLOCK);
+}
+
+EFI_STATUS
+MMCSendCommand (
+  IN EFI_MMC_HOST_PROTOCOL    *This,
+  IN MMC_CMD                  MmcCmd,
+  IN UINT32                   Argument
+  )
+{
+  BOOLEAN IsAppCmd = (LastExecutedCommand == CMD55);
+
+  DEBUG ((DEBUG_MMCHOST_SD, "ArasanMMCHost: MMCSendCommand(MmcCmd: %08x, Argument: %08x)\n", MmcCmd, Argument));
+
+  if (IgnoreCommand (MmcCmd)) {
+    return EFI_SUCCESS;
+  }
+
+  MmcCmd = TranslateCommand (MmcCmd, Argument);
+  if (MmcCmd == 0xffffffff) {
+    return EFI_UNSUPPORTED;
+  }
+
+  mCmdPending = FALSE;
+  if (mDataMode != MmcDataPio && !IsAppCmd && IsBlockDataCommand (MmcCmd)) {
+    mPendingCmd = MmcCmd;
+    mPendingArg = Argument;
+    mCmdPending = TRUE;
+    LastExecutedCommand = MmcCmd;
+    return EFI_SUCCESS;
+  }
+
+  return SendTranslatedCommand (MmcCmd, Argument, IsAppCmd, 0, FALSE);
+}
+
 EFI_STATUS
 MMCNotifyState (
   IN EFI_MMC_HOST_PROTOCOL    *This,
@@ -465,6 +598,7 @@ MMCNotifyState (
   EFI_STATUS Status;
   UINTN ClockFrequency;
   UINT32 Divisor;
+  UINT32 Capabilities;
 
   DEBUG ((DEBUG_MMCHOST_SD, "ArasanMMCHost: MMCNotifyState(State: %d)\n", State));
 
@@ -514,6 +648,22 @@ MMCNotifyState (
 
       DEBUG ((DEBUG_MMCHOST_SD, "ArasanMMCHost: AC12 %X HCTL %X\n", MmioRead32(MMCHS_AC12),MmioRead32(MMCHS_HCTL)));
 
+      // Prefer ADMA2, then SDMA, for block data transfers if enabled
+      Capabilities = MmioRead32 (MMCHS_CAPA);
+      if (!FeaturePcdGet (PcdArasanMmcFirmwareDma)) {
+        mDataMode = MmcDataPio;
+      } else if ((Capabilities & ADMA2_SUPPORT) != 0 && mAdmaTable != NULL) {
+        mDataMode = MmcDataAdma2;
+        SdMmioAndThenOr32 (MMCHS_HCTL, (UINT32) ~DMAS_MASK, DMAS_ADMA2_32);
+      } else if ((Capabilities & SDMA_SUPPORT) != 0) {
+        mDataMode = MmcDataSdma;
+        SdMmioAndThenOr32 (MMCHS_HCTL, (UINT32) ~DMAS_MASK, DMAS_SDMA);
+      } else {
+        mDataMode = MmcDataPio;
+      }
+      DEBUG ((DEBUG_INFO, "ArasanMMCHost: using %a data transfers\n",
+        mDataMode == MmcDataAdma2 ? "ADMA2" : mDataMode == MmcDataSdma ? "SDMA" : "PIO"));
+
       // Enable interrupts
       SdMmioWrite32 (MMCHS_IE, ALL_EN);
     }
@@ -678,6 +828,165 @@ MMCReceiveResponse (
   return EFI_SUCCESS;
 }
 
+/**
+   Performs the data phase of the pending block command using DMA.
+
+   @retval EFI_UNSUPPORTED   The buffer cannot be used for DMA, the command
+                             has not been issued.
+**/
+STATIC
+EFI_STATUS
+TransferBlockDataDma (
+  IN BOOLEAN  IsWrite,
+  IN UINTN    Length,
+  IN VOID     *Buffer
+  )
+{
+  EFI_STATUS Status;
+  EFI_STATUS UnmapStatus;
+  EFI_PHYSICAL_ADDRESS DeviceAddress;
+  EFI_PHYSICAL_ADDRESS NextBoundary;
+  VOID *Mapping;
+  UINTN MapLength;
+  UINTN Offset;
+  UINTN Index;
+  UINTN MmcStatus;
+  UINTN RetryCount;
+  UINTN MaxRetryCount;
+  UINT32 DescLength;
+
+  if (Length == 0 || (Length % BLEN_512BYTES) != 0 ||
+      Length / BLEN_512BYTES > MAX_DMA_BLOCK_COUNT) {
+    return EFI_UNSUPPORTED;
+  }
+
+  MapLength = Length;
+  Status = DmaMap (IsWrite ? MapOperationBusMasterRead : MapOperationBusMasterWrite,
+             Buffer, &MapLength, &DeviceAddress, &Mapping);
+  if (EFI_ERROR (Status)) {
+    return EFI_UNSUPPORTED;
+  }
+
+  if (MapLength < Length || (DeviceAddress & 0x3) != 0 ||
+      DeviceAddress + Length - 1 > MAX_UINT32) {
+    DmaUnmap (Mapping);
+    return EFI_UNSUPPORTED;
+  }
+
+  if (mDataMode == MmcDataAdma2) {
+    for (Offset = 0, Index = 0; Offset < Length; Offset += DescLength, Index++) {
+      DescLength = (UINT32) MIN (Length - Offset, ADMA2_MAX_LENGTH);
+      mAdmaTable[Index].Attributes = ADMA2_VALID | ADMA2_ACT_TRAN;
+      mAdmaTable[Index].Length = (UINT16) DescLength;
+      mAdmaTable[Index].Address = (UINT32) (DeviceAddress + Offset);
+    }
+    mAdmaTable[Index - 1].Attributes |= ADMA2_END;
+    SdMmioWrite32 (MMCHS_ADMA_ADDR, (UINT32) mAdmaTableDeviceAddress);
+  } else {
+    SdMmioWrite32 (MMCHS_SDMA_ADDR, (UINT32) DeviceAddress);
+  }
+  NextBoundary = ALIGN_VALUE (DeviceAddress + 1, SDMA_BOUNDARY_SIZE);
+
+  LedActivity ();
+
+  Status = SendTranslatedCommand (mPendingCmd, mPendingArg, FALSE,
+             (UINT32) (Length / BLEN_512BYTES), TRUE);
+  if (EFI_ERROR (Status)) {
+    goto Unmap;
+  }
+
+  //
+  // There is no progress indication with ADMA2, so allow for the
+  // transfer time of the whole request.
+  //
+  MaxRetryCount = MAX_RETRY_COUNT * (1 + Length / SIZE_1MB);
+  RetryCount = 0;
+  while (RetryCount < MaxRetryCount) {
+    MmcStatus = MmioRead32 (MMCHS_INT_STAT);
+    if ((MmcStatus & ERRI) != 0) {
+      DEBUG ((DEBUG_ERROR, "%a(%u): MMC_CMD%u ERRI MmcStatus 0x%x AdmaErr 0x%x\n",
+        __func__, __LINE__, MMC_CMD_NUM (mPendingCmd), MmcStatus,
+        MmioRead32 (MMCHS_ADMA_ERR)));
+      SoftReset (SRC | SRD);
+      LedIdle ();
+      Status = EFI_DEVICE_ERROR;
+      goto Unmap;
+    }
+
+    if ((MmcStatus & TC) != 0) {
+      SdMmioWrite32 (MMCHS_INT_STAT, TC | DMA_INT);
+      goto Unmap;
+    }
+
+    if ((MmcStatus & DMA_INT) != 0) {
+      //
+      // SDMA paused at a buffer boundary, restart it from there.
+      //
+      SdMmioWrite32 (MMCHS_INT_STAT, DMA_INT);
+      if (mDataMode == MmcDataSdma) {
+        SdMmioWrite32 (MMCHS_SDMA_ADDR, (UINT32) NextBoundary);
+        NextBoundary += SDMA_BOUNDARY_SIZE;
+      }
+      continue;
+    }
+
+    gBS->Stall (STALL_AFTER_RETRY_US);
+    RetryCount++;
+  }
+
+  DEBUG ((DEBUG_ERROR, "%a(%u): MMC_CMD%u transfer TIMEOUT MmcStatus 0x%x\n",
+    __func__, __LINE__, MMC_CMD_NUM (mPendingCmd), MmcStatus));
+  SoftReset (SRC | SRD);
+  LedIdle ();
+  Status = EFI_TIMEOUT;
+
+Unmap:
+  UnmapStatus = DmaUnmap (Mapping);
+  if (!EFI_ERROR (Status)) {
+    Status = UnmapStatus;
+  }
+  return Status;
+}
+
+/**
+   Issues the pending block command, using DMA when possible.
+
+   @retval EFI_SUCCESS       The command was issued for a PIO transfer.
+   @retval EFI_ALREADY_STARTED  The data was transferred using DMA.
+**/
+STATIC
+EFI_STATUS
+StartPendingCommand (
+  IN BOOLEAN  IsWrite,
+  IN UINTN    Length,
+  IN VOID     *Buffer
+  )
+{
+  EFI_STATUS Status;
+  UINT32 BlockCount;
+
+  if (!mCmdPending) {
+    return EFI_SUCCESS;
+  }
+  mCmdPending = FALSE;
+
+  Status = TransferBlockDataDma (IsWrite, Length, Buffer);
+  if (Status != EFI_UNSUPPORTED) {
+    return EFI_ERROR (Status) ? Status : EFI_ALREADY_STARTED;
+  }
+
+  //
+  // The buffer cannot be used for DMA, fall back to PIO. The block count
+  // is still programmed, as MMCIsHwBlockCount() reports it to MmcDxe.
+  //
+  BlockCount = 0;
+  if (Length != 0 && (Length % BLEN_512BYTES) == 0 &&
+      Length / BLEN_512BYTES <= MAX_DMA_BLOCK_COUNT) {
+    BlockCount = (UINT32) (Length / BLEN_512BYTES);
+  }
+  return SendTranslatedCommand (mPendingCmd, mPendingArg, FALSE, BlockCount, FALSE);
+}
+
 EFI_STATUS
 MMCReadBlockData (
   IN EFI_MMC_HOST_PROTOCOL    *This,
@@ -686,6 +995,7 @@ MMCReadBlockData (
   IN UINT32*                  Buffer
   )
 {
+  EFI_STATUS Status;
   UINTN MmcStatus;
   UINTN RemLength;
   UINTN Count;
@@ -703,6 +1013,15 @@ MMCReadBlockData (
     return EFI_INVALID_PARAMETER;
   }
 
+  Status = StartPendingCommand (FALSE, Length, Buffer);
+  if (Status == EFI_ALREADY_STARTED) {
+    return EFI_SUCCESS;
+  } else if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  LedActivity ();
+
   RemLength = Length;
   while (RemLength != 0) {
     UINTN RetryCount = 0;
@@ -715,12 +1034,10 @@ MMCReadBlockData (
         /*
          * Data is ready.
          */
-        mFwProtocol->SetLed (TRUE);
         for (Count = 0; Count < BlockLen; Count += 4, Buffer++) {
           *Buffer = MmioRead32 (MMCHS_DATA);
         }
-
-        mFwProtocol->SetLed (FALSE);
+        gBS->Stall (STALL_AFTER_READ_US);
         break;
       }
 
@@ -731,11 +1048,11 @@ MMCReadBlockData (
     if (RetryCount == MAX_RETRY_COUNT) {
       DEBUG ((DEBUG_ERROR, "%a(%u): %lu/%lu MMCHS_INT_STAT: %08x\n",
         __func__, __LINE__, Length - RemLength, Length, MmcStatus));
+      LedIdle ();
       return EFI_TIMEOUT;
     }
 
     RemLength -= BlockLen;
-    gBS->Stall (STALL_AFTER_READ_US);
   }
 
   SdMmioWrite32 (MMCHS_INT_STAT, BRR);
@@ -750,6 +1067,7 @@ MMCWriteBlockData (
   IN UINT32*                  Buffer
   )
 {
+  EFI_STATUS Status;
   UINTN MmcStatus;
   UINTN RemLength;
   UINTN Count;
@@ -767,6 +1085,15 @@ MMCWriteBlockData (
     return EFI_INVALID_PARAMETER;
   }
 
+  Status = StartPendingCommand (TRUE, Length, Buffer);
+  if (Status == EFI_ALREADY_STARTED) {
+    return EFI_SUCCESS;
+  } else if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  LedActivity ();
+
   RemLength = Length;
   while (RemLength != 0) {
     UINTN RetryCount = 0;
@@ -779,12 +1106,10 @@ MMCWriteBlockData (
         /*
          * Can write data.
          */
-        mFwProtocol->SetLed (TRUE);
         for (Count = 0; Count < BlockLen; Count += 4, Buffer++) {
           SdMmioWrite32 (MMCHS_DATA, *Buffer);
         }
-
-        mFwProtocol->SetLed (FALSE);
+        gBS->Stall (STALL_AFTER_WRITE_US);
         break;
       }
 
@@ -795,11 +1120,11 @@ MMCWriteBlockData (
     if (RetryCount == MAX_RETRY_COUNT) {
       DEBUG ((DEBUG_ERROR, "%a(%u): %lu/%lu MMCHS_INT_STAT: %08x\n",
         __func__, __LINE__, Length - RemLength, Length, MmcStatus));
+      LedIdle ();
       return EFI_TIMEOUT;
     }
 
     RemLength -= BlockLen;
-    gBS->Stall (STALL_AFTER_WRITE_US);
   }
 
   SdMmioWrite32 (MMCHS_INT_STAT, BWR);
@@ -814,6 +1139,18 @@ MMCIsMultiBlock (
   return TRUE;
 }
 
+/**
+   Block data commands are deferred and issued with the block count
+   programmed, unless the driver runs in plain PIO mode.
+**/
+BOOLEAN
+MMCIsHwBlockCount (
+  IN EFI_MMC_HOST_PROTOCOL *This
+  )
+{
+  return mDataMode != MmcDataPio;
+}
+
 EFI_MMC_HOST_PROTOCOL gMMCHost =
 {
   MMC_HOST_PROTOCOL_REVISION,
@@ -826,7 +1163,8 @@ EFI_MMC_HOST_PROTOCOL gMMCHost =
   MMCReadBlockData,
   MMCWriteBlockData,
   NULL,
-  MMCIsMultiBlock
+  MMCIsMultiBlock,
+  MMCIsHwBlockCount
 };
 
 EFI_STATUS
@@ -837,6 +1175,7 @@ MMCInitialize (
 {
   EFI_STATUS Status;
   EFI_HANDLE Handle = NULL;
+  UINTN TableSize;
 
   DEBUG ((DEBUG_MMCHOST_SD, "ArasanMMCHost: MMCInitialize()\n"));
 
@@ -858,6 +1197,46 @@ MMCInitialize (
     return Status;
   }
 
+  Status = gBS->CreateEvent (EVT_TIMER | EVT_NOTIFY_SIGNAL, TPL_CALLBACK,
+                  LedTimerCallback, NULL, &mLedTimer);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_WARN, "ArasanMMCHost: no activity LED: %r\n", Status));
+    mLedTimer = NULL;
+  } else {
+    //
+    // Do not leave the LED on, or the timer armed, for the OS.
+    //
+    Status = gBS->CreateEventEx (EVT_NOTIFY_SIGNAL, TPL_CALLBACK,
+                    ExitBootServicesCallback, NULL,
+                    &gEfiEventExitBootServicesGuid, &mExitBootServicesEvent);
+    ASSERT_EFI_ERROR (Status);
+  }
+
+  //
+  // The ADMA2 descriptor table is only needed if the controller
+  // turns out to support it, failing here just means SDMA or PIO.
+  //
+  Status = EFI_UNSUPPORTED;
+  if (FeaturePcdGet (PcdArasanMmcFirmwareDma)) {
+    Status = DmaAllocateBuffer (EfiBootServicesData, ADMA2_TABLE_PAGES,
+               (VOID **)&mAdmaTable);
+  }
+  if (!EFI_ERROR (Status)) {
+    TableSize = EFI_PAGES_TO_SIZE (ADMA2_TABLE_PAGES);
+    Status = DmaMap (MapOperationBusMasterCommonBuffer, mAdmaTable, &TableSize,
+               &mAdmaTableDeviceAddress, &mAdmaTableMapping);
+    if (EFI_ERROR (Status) ||
+        mAdmaTableDeviceAddress + TableSize - 1 > MAX_UINT32) {
+      if (!EFI_ERROR (Status)) {
+        DmaUnmap (mAdmaTableMapping);
+      }
+      DmaFreeBuffer (ADMA2_TABLE_PAGES, mAdmaTable);
+      mAdmaTable = NULL;
+    }
+  } else {
+    mAdmaTable = NULL;
+  }
+
   Status = gBS->InstallMultipleProtocolInterfaces (
                   &Handle,
                   &gRaspberryPiMmcHostProtocolGuid,
@@ -865,6 +1244,20 @@ MMCInitialize (
                   NULL
                 );
   ASSERT_EFI_ERROR (Status);
+  if (EFI_ERROR (Status)) {
+    if (mAdmaTable != NULL) {
+      DmaUnmap (mAdmaTableMapping);
+      DmaFreeBuffer (ADMA2_TABLE_PAGES, mAdmaTable);
+      mAdmaTable = NULL;
+    }
+    if (mExitBootServicesEvent != NULL) {
+      gBS->CloseEvent (mExitBootServicesEvent);
+    }
+    if (mLedTimer != NULL) {
+      gBS->CloseEvent (mLedTimer);
+      mLedTimer = NULL;
+    }
+  }
 
   return Status;
 }
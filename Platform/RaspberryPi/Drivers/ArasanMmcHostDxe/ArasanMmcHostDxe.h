@@ -21,6 +21,8 @@
 #include <Library/BaseMemoryLib.h>
 #include <Library/DmaLib.h>
 
+#include <Guid/EventGroup.h>
+
 #include <Protocol/EmbeddedExternalDevice.h>
 #include <Protocol/BlockIo.h>
 #include <Protocol/DevicePath.h>
@@ -42,4 +44,42 @@
 
 #define MAX_DIVISOR_VALUE 1023
 
+//
+// The activity LED is switched off once no data transfer has been
+// started for this long (in 100ns units).
+//
+#define LED_IDLE_TIMEOUT (100 * 1000 * 10)
+
+//
+// Largest transfer that can be described to the controller in one go,
+// limited by the 16-bit block count register.
+//
+#define MAX_DMA_BLOCK_COUNT 0xFFFF
+
+typedef enum {
+  MmcDataPio,
+  MmcDataSdma,
+  MmcDataAdma2
+} MMC_DATA_MODE;
+
+//
+// ADMA2 descriptor for 32-bit addressing (SD Host Controller Spec 3.00).
+//
+#pragma pack(1)
+typedef struct {
+  UINT16 Attributes;
+  UINT16 Length;
+  UINT32 Address;
+} ADMA2_DESCRIPTOR;
+#pragma pack()
+
+#define ADMA2_VALID       BIT0
+#define ADMA2_END         BIT1
+#define ADMA2_INT         BIT2
+#define ADMA2_ACT_TRAN    BIT5
+
+#define ADMA2_MAX_LENGTH  SIZE_32KB
+#define ADMA2_TABLE_PAGES \
+  EFI_SIZE_TO_PAGES (((MAX_DMA_BLOCK_COUNT * BLEN_512BYTES) / ADMA2_MAX_LENGTH + 2) * sizeof (ADMA2_DESCRIPTOR))
+
 #endif
@@ -47,6 +47,7 @@ STATIC UINT32 mModelFamily = 0;
 STATIC UINT32 mModelInstalledMB = 0;
 STATIC UINT32 mModelRevision = 0;
 STATIC UINT32 mCoreClockRate = 0;
+STATIC UINT32 mArmMaxClockRate = 0;
 
 STATIC EFI_MAC_ADDRESS  mMacAddress;
 
@@ -157,6 +158,70 @@ RegisterDevices (
   }
 }
 
+/*
+ * Fetch everything we need from the VideoCore firmware up front, in a
+ * single mailbox transaction.
+ */
+STATIC VOID
+QueryFirmwareProperties (
+  VOID
+  )
+{
+  EFI_STATUS                      Status;
+  UINT32                          CoreClock[2];
+  UINT32                          ArmMaxClock[2];
+  RASPBERRY_PI_FIRMWARE_PROPERTY  Properties[3];
+  UINTN                           Count;
+
+  CoreClock[0] = RPI_MBOX_CLOCK_RATE_CORE;
+  CoreClock[1] = 0;
+  ArmMaxClock[0] = RPI_MBOX_CLOCK_RATE_ARM;
+  ArmMaxClock[1] = 0;
+
+  ZeroMem (Properties, sizeof (Properties));
+  Properties[0].TagId = RPI_MBOX_GET_CLOCK_RATE;
+  Properties[0].BufferSize = sizeof (CoreClock);
+  Properties[0].RequestSize = sizeof (CoreClock[0]);
+  Properties[0].Buffer = CoreClock;
+  Properties[1].TagId = RPI_MBOX_GET_MAX_CLOCK_RATE;
+  Properties[1].BufferSize = sizeof (ArmMaxClock);
+  Properties[1].RequestSize = sizeof (ArmMaxClock[0]);
+  Properties[1].Buffer = ArmMaxClock;
+  Count = 2;
+
+  if (mModelFamily == 4) {
+    //
+    // Get the MAC address from the firmware.
+    //
+    Properties[2].TagId = RPI_MBOX_GET_MAC_ADDRESS;
+    Properties[2].BufferSize = NET_ETHER_ADDR_LEN;
+    Properties[2].Buffer = mMacAddress.Addr;
+    Count++;
+  }
+
+  Status = mFwProtocol->GetProperties (Properties, Count);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_WARN, "%a: firmware query incomplete: %r\n", __func__, Status));
+  }
+
+  if (Properties[0].ResponseSize < sizeof (CoreClock)) {
+    DEBUG ((DEBUG_ERROR, "Couldn't get the Raspberry Pi core clock rate\n"));
+  } else {
+    mCoreClockRate = CoreClock[1];
+    PcdSet32S (PcdMiniUartClockRate, mCoreClockRate);
+  }
+
+  if (Properties[1].ResponseSize < sizeof (ArmMaxClock)) {
+    DEBUG ((DEBUG_ERROR, "Couldn't get the default CPU speed\n"));
+  } else {
+    mArmMaxClockRate = ArmMaxClock[1];
+  }
+
+  if (mModelFamily == 4 && Properties[2].ResponseSize < NET_ETHER_ADDR_LEN) {
+    DEBUG ((DEBUG_WARN, "%a: failed to retrieve MAC address\n", __func__));
+  }
+}
+
 STATIC EFI_STATUS
 InstallHiiPages (
   VOID
@@ -424,16 +489,6 @@ SetupVariables (
     ASSERT_EFI_ERROR (Status);
   }
 
-  if (mModelFamily == 4) {
-    //
-    // Get the MAC address from the firmware.
-    //
-    Status = mFwProtocol->GetMacAddress (mMacAddress.Addr);
-    if (EFI_ERROR (Status)) {
-      DEBUG ((DEBUG_WARN, "%a: failed to retrieve MAC address\n", __func__));
-    }
-  }
-
   return EFI_SUCCESS;
 }
 
@@ -460,10 +515,7 @@ ApplyVariables (
      * What the Raspberry Pi Foundation calls "max clock rate" is really the default value
      * from: https://www.raspberrypi.org/documentation/configuration/config-txt/overclocking.md
      */
-    Status = mFwProtocol->GetMaxClockRate (RPI_MBOX_CLOCK_RATE_ARM, &Rate);
-    if (Status != EFI_SUCCESS) {
-      DEBUG ((DEBUG_ERROR, "Couldn't read default CPU speed %r\n", Status));
-    }
+    Rate = mArmMaxClockRate;
     break;
   case CHIPSET_CPU_CLOCK_MAX:
     Rate = FixedPcdGet32 (PcdCpuMaxSpeedMHz) * FREQ_1_MHZ;
@@ -954,12 +1006,7 @@ ConfigInitialize (
   mModelInstalledMB = BoardRevisionGetMemorySize (mModelRevision) / 1024 / 1024;
   DEBUG ((DEBUG_INFO, "Current Raspberry Pi installed RAM size is %d MB\n", mModelInstalledMB));
 
-  Status = mFwProtocol->GetClockRate (RPI_MBOX_CLOCK_RATE_CORE, &mCoreClockRate);
-  if (Status != EFI_SUCCESS) {
-    DEBUG ((DEBUG_ERROR, "Couldn't get the Raspberry Pi core clock rate: %r\n", Status));
-  } else {
-    PcdSet32S (PcdMiniUartClockRate, mCoreClockRate);
-  }
+  QueryFirmwareProperties ();
 
   Status = SetupVariables ();
   if (Status != EFI_SUCCESS) {
@@ -107,17 +107,40 @@ MMC_HOST_INSTANCE* CreateMmcHostInstance (
   MmcHostInstance->BlockIo.WriteBlocks = MmcWriteBlocks;
   MmcHostInstance->BlockIo.FlushBlocks = MmcFlushBlocks;
 
+  MmcHostInstance->BlockIo2.Media = MmcHostInstance->BlockIo.Media;
+  MmcHostInstance->BlockIo2.Reset = MmcResetEx;
+  MmcHostInstance->BlockIo2.ReadBlocksEx = MmcReadBlocksEx;
+  MmcHostInstance->BlockIo2.WriteBlocksEx = MmcWriteBlocksEx;
+  MmcHostInstance->BlockIo2.FlushBlocksEx = MmcFlushBlocksEx;
+
+  InitializeListHead (&MmcHostInstance->RequestQueue);
+  Status = gBS->CreateEvent (
+                  EVT_TIMER | EVT_NOTIFY_SIGNAL,
+                  TPL_CALLBACK,
+                  MmcProcessRequestQueue,
+                  MmcHostInstance,
+                  &MmcHostInstance->QueueEvent
+                );
+  if (EFI_ERROR (Status)) {
+    goto FREE_MEDIA;
+  }
+
+  //
+  // Without a merge buffer queued requests are simply done one by one.
+  //
+  MmcHostInstance->MergeBuffer = AllocatePages (EFI_SIZE_TO_PAGES (MMC_MAX_MERGE_SIZE));
+
   MmcHostInstance->MmcHost = MmcHost;
 
   // Create DevicePath for the new MMC Host
   Status = MmcHost->BuildDevicePath (MmcHost, &NewDevicePathNode);
   if (EFI_ERROR (Status)) {
-    goto FREE_MEDIA;
+    goto FREE_QUEUE;
   }
 
   DevicePath = (EFI_DEVICE_PATH_PROTOCOL*)AllocatePool (END_DEVICE_PATH_LENGTH);
   if (DevicePath == NULL) {
-    goto FREE_MEDIA;
+    goto FREE_QUEUE;
   }
 
   SetDevicePathEndNode (DevicePath);
@@ -127,6 +150,7 @@ MMC_HOST_INSTANCE* CreateMmcHostInstance (
   Status = gBS->InstallMultipleProtocolInterfaces (
                   &MmcHostInstance->MmcHandle,
                   &gEfiBlockIoProtocolGuid, &MmcHostInstance->BlockIo,
+                  &gEfiBlockIo2ProtocolGuid, &MmcHostInstance->BlockIo2,
                   &gEfiDevicePathProtocolGuid, MmcHostInstance->DevicePath,
                   NULL
                 );
@@ -139,6 +163,12 @@ MMC_HOST_INSTANCE* CreateMmcHostInstance (
 FREE_DEVICE_PATH:
   FreePool (DevicePath);
 
+FREE_QUEUE:
+  if (MmcHostInstance->MergeBuffer != NULL) {
+    FreePages (MmcHostInstance->MergeBuffer, EFI_SIZE_TO_PAGES (MMC_MAX_MERGE_SIZE));
+  }
+  gBS->CloseEvent (MmcHostInstance->QueueEvent);
+
 FREE_MEDIA:
   FreePool (MmcHostInstance->BlockIo.Media);
 
@@ -158,11 +188,19 @@ EFI_STATUS DestroyMmcHostInstance (
   Status = gBS->UninstallMultipleProtocolInterfaces (
                   MmcHostInstance->MmcHandle,
                   &gEfiBlockIoProtocolGuid, &(MmcHostInstance->BlockIo),
+                  &gEfiBlockIo2ProtocolGuid, &(MmcHostInstance->BlockIo2),
                   &gEfiDevicePathProtocolGuid, MmcHostInstance->DevicePath,
                   NULL
                 );
   ASSERT_EFI_ERROR (Status);
 
+  // Fail whatever is still queued
+  gBS->CloseEvent (MmcHostInstance->QueueEvent);
+  MmcAbortRequestQueue (MmcHostInstance, EFI_ABORTED);
+  if (MmcHostInstance->MergeBuffer != NULL) {
+    FreePages (MmcHostInstance->MergeBuffer, EFI_SIZE_TO_PAGES (MMC_MAX_MERGE_SIZE));
+  }
+
   // Free Memory allocated for the instance
   if (MmcHostInstance->BlockIo.Media) {
     FreePool (MmcHostInstance->BlockIo.Media);
@@ -363,6 +401,9 @@ CheckCardsCallback (
     ASSERT (MmcHostInstance != NULL);
 
     if (MmcHostInstance->MmcHost->IsCardPresent (MmcHostInstance->MmcHost) == !MmcHostInstance->Initialized) {
+      // Requests queued for the previous media can no longer complete
+      MmcAbortRequestQueue (MmcHostInstance, EFI_MEDIA_CHANGED);
+
       MmcHostInstance->State = MmcHwInitializationState;
       MmcHostInstance->BlockIo.Media->MediaPresent = !MmcHostInstance->Initialized;
       MmcHostInstance->Initialized = !MmcHostInstance->Initialized;
@@ -385,6 +426,17 @@ CheckCardsCallback (
       if (EFI_ERROR (Status)) {
         Print (L"MMC Card: Error reinstalling BlockIo interface\n");
       }
+
+      Status = gBS->ReinstallProtocolInterface (
+                      (MmcHostInstance->MmcHandle),
+                      &gEfiBlockIo2ProtocolGuid,
+                      &(MmcHostInstance->BlockIo2),
+                      &(MmcHostInstance->BlockIo2)
+                    );
+
+      if (EFI_ERROR (Status)) {
+        Print (L"MMC Card: Error reinstalling BlockIo2 interface\n");
+      }
     }
 
     CurrentLink = CurrentLink->ForwardLink;
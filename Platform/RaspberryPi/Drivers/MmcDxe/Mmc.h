@@ -15,6 +15,7 @@
 
 #include <Protocol/DiskIo.h>
 #include <Protocol/BlockIo.h>
+#include <Protocol/BlockIo2.h>
 #include <Protocol/DevicePath.h>
 #include <Protocol/RpiMmcHost.h>
 
@@ -71,6 +72,14 @@
 
 #define BUSWIDTH_4                          4
 
+#define SD_SCR_CMD23_SUPPORTED              BIT1  // SCR bit [33]
+
+//
+// Largest run of queued BLOCK_IO2 requests that is merged into a single
+// multiple block transfer.
+//
+#define MMC_MAX_MERGE_SIZE                  SIZE_1MB
+
 typedef enum {
   UNKNOWN_CARD,
   MMC_CARD,              //MMC card
@@ -328,6 +337,7 @@ typedef struct {
   CID       CIDData;
   CSD       CSDData;
   ECSD      *ECSDData;                         // MMC V4 extended card specific
+  BOOLEAN   SetBlockCount;                     // CMD23 is supported
 } CARD_INFO;
 
 typedef struct _MMC_HOST_INSTANCE {
@@ -338,16 +348,36 @@ typedef struct _MMC_HOST_INSTANCE {
 
   MMC_STATE                 State;
   EFI_BLOCK_IO_PROTOCOL     BlockIo;
+  EFI_BLOCK_IO2_PROTOCOL    BlockIo2;
   CARD_INFO                 CardInfo;
   EFI_MMC_HOST_PROTOCOL     *MmcHost;
 
   BOOLEAN                   Initialized;
+
+  LIST_ENTRY                RequestQueue;     // Pending BLOCK_IO2 requests
+  EFI_EVENT                 QueueEvent;
+  VOID                      *MergeBuffer;     // MMC_MAX_MERGE_SIZE bytes
 } MMC_HOST_INSTANCE;
 
 #define MMC_HOST_INSTANCE_SIGNATURE                 SIGNATURE_32('m', 'm', 'c', 'h')
 #define MMC_HOST_INSTANCE_FROM_BLOCK_IO_THIS(a)     CR (a, MMC_HOST_INSTANCE, BlockIo, MMC_HOST_INSTANCE_SIGNATURE)
+#define MMC_HOST_INSTANCE_FROM_BLOCK_IO2_THIS(a)    CR (a, MMC_HOST_INSTANCE, BlockIo2, MMC_HOST_INSTANCE_SIGNATURE)
 #define MMC_HOST_INSTANCE_FROM_LINK(a)              CR (a, MMC_HOST_INSTANCE, Link, MMC_HOST_INSTANCE_SIGNATURE)
 
+typedef struct {
+  UINTN                     Signature;
+  LIST_ENTRY                Link;
+  UINTN                     Transfer;
+  UINT32                    MediaId;
+  EFI_LBA                   Lba;
+  UINTN                     BufferSize;
+  VOID                      *Buffer;
+  EFI_BLOCK_IO2_TOKEN       *Token;
+} MMC_IO_REQUEST;
+
+#define MMC_IO_REQUEST_SIGNATURE                    SIGNATURE_32('m', 'm', 'c', 'r')
+#define MMC_IO_REQUEST_FROM_LINK(a)                 CR (a, MMC_IO_REQUEST, Link, MMC_IO_REQUEST_SIGNATURE)
+
 
 EFI_STATUS
 EFIAPI
@@ -481,6 +511,148 @@ MmcFlushBlocks (
   IN EFI_BLOCK_IO_PROTOCOL  *This
   );
 
+/**
+  Reset the block device.
+
+  This function implements EFI_BLOCK_IO2_PROTOCOL.Reset(). Requests that
+  are still queued are completed with EFI_ABORTED.
+
+  @param  This                   Indicates a pointer to the calling context.
+  @param  ExtendedVerification   Indicates that the driver may perform a more exhaustive
+                                 verification operation of the device during reset.
+
+  @retval EFI_SUCCESS            The block device was reset.
+  @retval EFI_DEVICE_ERROR       The block device is not functioning correctly and could not be reset.
+
+**/
+EFI_STATUS
+EFIAPI
+MmcResetEx (
+  IN EFI_BLOCK_IO2_PROTOCOL   *This,
+  IN BOOLEAN                  ExtendedVerification
+  );
+
+/**
+  Reads the requested number of blocks from the device.
+
+  This function implements EFI_BLOCK_IO2_PROTOCOL.ReadBlocksEx(). With a
+  token carrying an event the request is queued, merged with adjacent
+  queued requests and completed in the background; otherwise it is
+  performed synchronously.
+
+  @param  This                   Indicates a pointer to the calling context.
+  @param  MediaId                The media ID that the read request is for.
+  @param  Lba                    The starting logical block address to read from on the device.
+  @param  Token                  A pointer to the token associated with the transaction.
+  @param  BufferSize             The size of the Buffer in bytes.
+                                 This must be a multiple of the intrinsic block size of the device.
+  @param  Buffer                 A pointer to the destination buffer for the data.
+
+  @retval EFI_SUCCESS            The read request was queued, or the data was read correctly.
+  @retval EFI_DEVICE_ERROR       The device reported an error while attempting to perform the read operation.
+  @retval EFI_NO_MEDIA           There is no media in the device.
+  @retval EFI_MEDIA_CHANGED      The MediaId is not for the current media.
+  @retval EFI_BAD_BUFFER_SIZE    The BufferSize parameter is not a multiple of the intrinsic block size of the device.
+  @retval EFI_INVALID_PARAMETER  The read request contains LBAs that are not valid,
+                                 or the buffer is not on proper alignment.
+  @retval EFI_OUT_OF_RESOURCES   The request could not be queued.
+
+**/
+EFI_STATUS
+EFIAPI
+MmcReadBlocksEx (
+  IN     EFI_BLOCK_IO2_PROTOCOL *This,
+  IN     UINT32                 MediaId,
+  IN     EFI_LBA                Lba,
+  IN OUT EFI_BLOCK_IO2_TOKEN    *Token,
+  IN     UINTN                  BufferSize,
+  OUT    VOID                   *Buffer
+  );
+
+/**
+  Writes a specified number of blocks to the device.
+
+  This function implements EFI_BLOCK_IO2_PROTOCOL.WriteBlocksEx(). With a
+  token carrying an event the request is queued, merged with adjacent
+  queued requests and completed in the background; otherwise it is
+  performed synchronously.
+
+  @param  This                   Indicates a pointer to the calling context.
+  @param  MediaId                The media ID that the write request is for.
+  @param  Lba                    The starting logical block address to be written.
+  @param  Token                  A pointer to the token associated with the transaction.
+  @param  BufferSize             The size of the Buffer in bytes.
+                                 This must be a multiple of the intrinsic block size of the device.
+  @param  Buffer                 Pointer to the source buffer for the data.
+
+  @retval EFI_SUCCESS            The write request was queued, or the data was written correctly.
+  @retval EFI_WRITE_PROTECTED    The device cannot be written to.
+  @retval EFI_NO_MEDIA           There is no media in the device.
+  @retval EFI_MEDIA_CHANGED      The MediaId is not for the current media.
+  @retval EFI_DEVICE_ERROR       The device reported an error while attempting to perform the write operation.
+  @retval EFI_BAD_BUFFER_SIZE    The BufferSize parameter is not a multiple of the intrinsic
+                                 block size of the device.
+  @retval EFI_INVALID_PARAMETER  The write request contains LBAs that are not valid,
+                                 or the buffer is not on proper alignment.
+  @retval EFI_OUT_OF_RESOURCES   The request could not be queued.
+
+**/
+EFI_STATUS
+EFIAPI
+MmcWriteBlocksEx (
+  IN     EFI_BLOCK_IO2_PROTOCOL *This,
+  IN     UINT32                 MediaId,
+  IN     EFI_LBA                Lba,
+  IN OUT EFI_BLOCK_IO2_TOKEN    *Token,
+  IN     UINTN                  BufferSize,
+  IN     VOID                   *Buffer
+  );
+
+/**
+  Completes all queued requests.
+
+  This function implements EFI_BLOCK_IO2_PROTOCOL.FlushBlocksEx().
+
+  @param  This                   Indicates a pointer to the calling context.
+  @param  Token                  A pointer to the token associated with the transaction.
+
+  @retval EFI_SUCCESS            All outstanding data were written to the device.
+
+**/
+EFI_STATUS
+EFIAPI
+MmcFlushBlocksEx (
+  IN     EFI_BLOCK_IO2_PROTOCOL *This,
+  IN OUT EFI_BLOCK_IO2_TOKEN    *Token
+  );
+
+/**
+  Services the BLOCK_IO2 request queue of an MMC host instance.
+
+  @param  Event                  The queue event, unused.
+  @param  Context                The MMC_HOST_INSTANCE.
+
+**/
+VOID
+EFIAPI
+MmcProcessRequestQueue (
+  IN  EFI_EVENT   Event,
+  IN  VOID        *Context
+  );
+
+/**
+  Completes every queued BLOCK_IO2 request without performing it.
+
+  @param  MmcHostInstance        The MMC host instance.
+  @param  Status                 The transaction status reported to the caller.
+
+**/
+VOID
+MmcAbortRequestQueue (
+  IN MMC_HOST_INSTANCE      *MmcHostInstance,
+  IN EFI_STATUS             Status
+  );
+
 EFI_STATUS
 MmcNotifyState (
   IN MMC_HOST_INSTANCE      *MmcHostInstance,
@@ -7,6 +7,7 @@
  **/
 
 #include <Library/BaseMemoryLib.h>
+#include <Library/MemoryAllocationLib.h>
 
 #include "Mmc.h"
 
@@ -230,10 +231,29 @@ MmcTransferBlock (
   MMC_HOST_INSTANCE       *MmcHostInstance;
   EFI_MMC_HOST_PROTOCOL   *MmcHost;
   UINTN                   CmdArg;
+  BOOLEAN                 SetBlockCount;
 
   MmcHostInstance = MMC_HOST_INSTANCE_FROM_BLOCK_IO_THIS (This);
   MmcHost = MmcHostInstance->MmcHost;
 
+  //
+  // With CMD23 the card ends a multiple block transfer by itself,
+  // saving the CMD12 round trip. This needs the host to stop after
+  // the same number of blocks, so only use it if the host programs
+  // the block count in hardware.
+  //
+  SetBlockCount = (Cmd == MMC_CMD18 || Cmd == MMC_CMD25) &&
+                  MmcHostInstance->CardInfo.SetBlockCount &&
+                  MMC_HOST_HAS_ISHWBLOCKCOUNT (MmcHost) &&
+                  MmcHost->IsHwBlockCount (MmcHost);
+  if (SetBlockCount) {
+    Status = MmcHost->SendCommand (MmcHost, MMC_CMD23, BufferSize / This->Media->BlockSize);
+    if (EFI_ERROR (Status)) {
+      DEBUG ((DEBUG_ERROR, "%a(MMC_CMD23): Error %r\n", __func__, Status));
+      return Status;
+    }
+  }
+
   //Set command argument based on the card access mode (Byte mode or Block mode)
   if ((MmcHostInstance->CardInfo.OCRData.AccessMode & MMC_OCR_ACCESS_MASK) ==
       MMC_OCR_ACCESS_SECTOR) {
@@ -262,10 +282,10 @@ MmcTransferBlock (
   }
 
   if (EFI_ERROR (Status) ||
-      BufferSize > This->Media->BlockSize) {
+      (BufferSize > This->Media->BlockSize && !SetBlockCount)) {
     /*
      * CMD12 needs to be set for multiblock (to transition from
-     * RECV to PROG) or for errors.
+     * RECV to PROG) or for errors, unless CMD23 was used.
      */
     EFI_STATUS Status2 = MmcStopTransmission (MmcHost);
     if (EFI_ERROR (Status2)) {
@@ -287,10 +307,12 @@ MmcTransferBlock (
   // For reads, should be already in TRAN. For writes, wait
   // until programming finishes.
   //
-  Status = WaitUntilTran (MmcHostInstance);
-  if (EFI_ERROR (Status)) {
-    DEBUG ((DEBUG_ERROR, "WaitUntilTran after write failed\n"));
-    return Status;
+  if (Transfer != MMC_IOBLOCKS_READ) {
+    Status = WaitUntilTran (MmcHostInstance);
+    if (EFI_ERROR (Status)) {
+      DEBUG ((DEBUG_ERROR, "WaitUntilTran after write failed\n"));
+      return Status;
+    }
   }
 
   Status = MmcNotifyState (MmcHostInstance, MmcTransferState);
@@ -314,25 +336,20 @@ MmcTransferBlock (
   return Status;
 }
 
+STATIC
 EFI_STATUS
-MmcIoBlocks (
+MmcCheckIoRequest (
   IN EFI_BLOCK_IO_PROTOCOL    *This,
   IN UINTN                    Transfer,
   IN UINT32                   MediaId,
   IN EFI_LBA                  Lba,
   IN UINTN                    BufferSize,
-  OUT VOID                    *Buffer
+  IN VOID                     *Buffer
   )
 {
-  EFI_STATUS              Status;
-  UINTN                   Cmd;
   MMC_HOST_INSTANCE       *MmcHostInstance;
   EFI_MMC_HOST_PROTOCOL   *MmcHost;
-  UINTN                   BytesRemainingToBeTransfered;
-  UINTN                   BlockCount;
-  UINTN                   ConsumeSize;
 
-  BlockCount = 1;
   MmcHostInstance = MMC_HOST_INSTANCE_FROM_BLOCK_IO_THIS (This);
   ASSERT (MmcHostInstance != NULL);
   MmcHost = MmcHostInstance->MmcHost;
@@ -351,12 +368,6 @@ MmcIoBlocks (
     return EFI_NO_MEDIA;
   }
 
-  if (PcdGet32 (PcdMmcDisableMulti) == 0 &&
-      MMC_HOST_HAS_ISMULTIBLOCK (MmcHost) &&
-      MmcHost->IsMultiBlock (MmcHost)) {
-    BlockCount = (BufferSize + This->Media->BlockSize - 1) / This->Media->BlockSize;
-  }
-
   // All blocks must be within the device
   if ((Lba + (BufferSize / This->Media->BlockSize)) > (This->Media->LastBlock + 1)) {
     return EFI_INVALID_PARAMETER;
@@ -381,14 +392,61 @@ MmcIoBlocks (
     return EFI_INVALID_PARAMETER;
   }
 
+  return EFI_SUCCESS;
+}
+
+EFI_STATUS
+MmcIoBlocks (
+  IN EFI_BLOCK_IO_PROTOCOL    *This,
+  IN UINTN                    Transfer,
+  IN UINT32                   MediaId,
+  IN EFI_LBA                  Lba,
+  IN UINTN                    BufferSize,
+  OUT VOID                    *Buffer
+  )
+{
+  EFI_STATUS              Status;
+  UINTN                   Cmd;
+  MMC_HOST_INSTANCE       *MmcHostInstance;
+  EFI_MMC_HOST_PROTOCOL   *MmcHost;
+  UINTN                   BytesRemainingToBeTransfered;
+  UINTN                   BlockCount;
+  UINTN                   ConsumeSize;
+  EFI_TPL                 OldTpl;
+
+  Status = MmcCheckIoRequest (This, Transfer, MediaId, Lba, BufferSize, Buffer);
+  if (EFI_ERROR (Status) || BufferSize == 0) {
+    return Status;
+  }
+
+  BlockCount = 1;
+  MmcHostInstance = MMC_HOST_INSTANCE_FROM_BLOCK_IO_THIS (This);
+  MmcHost = MmcHostInstance->MmcHost;
+
+  if (PcdGet32 (PcdMmcDisableMulti) == 0 &&
+      MMC_HOST_HAS_ISMULTIBLOCK (MmcHost) &&
+      MmcHost->IsMultiBlock (MmcHost)) {
+    BlockCount = (BufferSize + This->Media->BlockSize - 1) / This->Media->BlockSize;
+  }
+
+  //
+  // Keep the request queue and card detection from issuing commands
+  // in the middle of this transfer.
+  //
+  OldTpl = gBS->RaiseTPL (TPL_CALLBACK);
+
+  //
+  // Every transfer leaves the card in TRAN, so only the state on
+  // entry needs to be checked.
+  //
+  Status = WaitUntilTran (MmcHostInstance);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "WaitUntilTran before IO failed"));
+    goto Exit;
+  }
+
   BytesRemainingToBeTransfered = BufferSize;
   while (BytesRemainingToBeTransfered > 0) {
-    Status = WaitUntilTran (MmcHostInstance);
-    if (EFI_ERROR (Status)) {
-      DEBUG ((DEBUG_ERROR, "WaitUntilTran before IO failed"));
-      return Status;
-    }
-
     if (Transfer == MMC_IOBLOCKS_READ) {
       if (BlockCount == 1) {
         // Read a single block
@@ -415,17 +473,19 @@ MmcIoBlocks (
     Status = MmcTransferBlock (This, Cmd, Transfer, MediaId, Lba, ConsumeSize, Buffer, &ConsumeSize);
     if (EFI_ERROR (Status)) {
       DEBUG ((DEBUG_ERROR, "%a(): Failed to transfer block and Status:%r\n", __func__, Status));
-      return Status;
+      goto Exit;
     }
 
     BytesRemainingToBeTransfered -= ConsumeSize;
     if (BytesRemainingToBeTransfered > 0) {
-      Lba += BlockCount;
+      Lba += ConsumeSize / This->Media->BlockSize;
       Buffer = (UINT8*)Buffer + ConsumeSize;
     }
   }
 
-  return EFI_SUCCESS;
+Exit:
+  gBS->RestoreTPL (OldTpl);
+  return Status;
 }
 
 EFI_STATUS
@@ -462,3 +522,251 @@ MmcFlushBlocks (
 {
   return EFI_SUCCESS;
 }
+
+/**
+  Completes a queued request and releases it.
+**/
+STATIC
+VOID
+MmcCompleteRequest (
+  IN MMC_IO_REQUEST   *Request,
+  IN EFI_STATUS       Status
+  )
+{
+  RemoveEntryList (&Request->Link);
+  Request->Token->TransactionStatus = Status;
+  gBS->SignalEvent (Request->Token->Event);
+  FreePool (Request);
+}
+
+VOID
+EFIAPI
+MmcProcessRequestQueue (
+  IN  EFI_EVENT   Event,
+  IN  VOID        *Context
+  )
+{
+  MMC_HOST_INSTANCE       *MmcHostInstance;
+  EFI_BLOCK_IO_PROTOCOL   *BlockIo;
+  LIST_ENTRY              *Queue;
+  LIST_ENTRY              *Link;
+  LIST_ENTRY              *Last;
+  MMC_IO_REQUEST          *First;
+  MMC_IO_REQUEST          *Request;
+  EFI_LBA                 NextLba;
+  UINTN                   MergedSize;
+  UINTN                   Offset;
+  EFI_STATUS              Status;
+  BOOLEAN                 Done;
+
+  MmcHostInstance = Context;
+  BlockIo = &MmcHostInstance->BlockIo;
+  Queue = &MmcHostInstance->RequestQueue;
+
+  while (!IsListEmpty (Queue)) {
+    First = MMC_IO_REQUEST_FROM_LINK (GetFirstNode (Queue));
+
+    //
+    // Gather the following requests that continue where the previous one
+    // ends, so that they can be done as one multiple block transfer.
+    //
+    Last = &First->Link;
+    MergedSize = First->BufferSize;
+    NextLba = First->Lba + First->BufferSize / BlockIo->Media->BlockSize;
+    if (MmcHostInstance->MergeBuffer != NULL) {
+      for (Link = GetNextNode (Queue, Last); !IsNull (Queue, Link); Link = GetNextNode (Queue, Link)) {
+        Request = MMC_IO_REQUEST_FROM_LINK (Link);
+        if (Request->Transfer != First->Transfer ||
+            Request->MediaId != First->MediaId ||
+            Request->Lba != NextLba ||
+            MergedSize + Request->BufferSize > MMC_MAX_MERGE_SIZE) {
+          break;
+        }
+        MergedSize += Request->BufferSize;
+        NextLba += Request->BufferSize / BlockIo->Media->BlockSize;
+        Last = Link;
+      }
+    }
+
+    if (Last == &First->Link) {
+      Status = MmcIoBlocks (BlockIo, First->Transfer, First->MediaId, First->Lba,
+                 First->BufferSize, First->Buffer);
+    } else {
+      if (First->Transfer == MMC_IOBLOCKS_WRITE) {
+        Offset = 0;
+        for (Link = &First->Link; ; Link = GetNextNode (Queue, Link)) {
+          Request = MMC_IO_REQUEST_FROM_LINK (Link);
+          CopyMem ((UINT8 *)MmcHostInstance->MergeBuffer + Offset, Request->Buffer, Request->BufferSize);
+          Offset += Request->BufferSize;
+          if (Link == Last) {
+            break;
+          }
+        }
+      }
+
+      Status = MmcIoBlocks (BlockIo, First->Transfer, First->MediaId, First->Lba,
+                 MergedSize, MmcHostInstance->MergeBuffer);
+
+      if (!EFI_ERROR (Status) && First->Transfer == MMC_IOBLOCKS_READ) {
+        Offset = 0;
+        for (Link = &First->Link; ; Link = GetNextNode (Queue, Link)) {
+          Request = MMC_IO_REQUEST_FROM_LINK (Link);
+          CopyMem (Request->Buffer, (UINT8 *)MmcHostInstance->MergeBuffer + Offset, Request->BufferSize);
+          Offset += Request->BufferSize;
+          if (Link == Last) {
+            break;
+          }
+        }
+      }
+    }
+
+    do {
+      Link = GetFirstNode (Queue);
+      Done = (Link == Last);
+      MmcCompleteRequest (MMC_IO_REQUEST_FROM_LINK (Link), Status);
+    } while (!Done);
+  }
+}
+
+VOID
+MmcAbortRequestQueue (
+  IN MMC_HOST_INSTANCE      *MmcHostInstance,
+  IN EFI_STATUS             Status
+  )
+{
+  EFI_TPL                 OldTpl;
+
+  OldTpl = gBS->RaiseTPL (TPL_CALLBACK);
+  while (!IsListEmpty (&MmcHostInstance->RequestQueue)) {
+    MmcCompleteRequest (
+      MMC_IO_REQUEST_FROM_LINK (GetFirstNode (&MmcHostInstance->RequestQueue)),
+      Status);
+  }
+  gBS->RestoreTPL (OldTpl);
+}
+
+STATIC
+EFI_STATUS
+MmcQueueIoBlocks (
+  IN     EFI_BLOCK_IO2_PROTOCOL *This,
+  IN     UINTN                  Transfer,
+  IN     UINT32                 MediaId,
+  IN     EFI_LBA                Lba,
+  IN OUT EFI_BLOCK_IO2_TOKEN    *Token,
+  IN     UINTN                  BufferSize,
+  IN     VOID                   *Buffer
+  )
+{
+  EFI_STATUS              Status;
+  MMC_HOST_INSTANCE       *MmcHostInstance;
+  MMC_IO_REQUEST          *Request;
+  EFI_TPL                 OldTpl;
+
+  MmcHostInstance = MMC_HOST_INSTANCE_FROM_BLOCK_IO2_THIS (This);
+
+  if (Token == NULL || Token->Event == NULL) {
+    return MmcIoBlocks (&MmcHostInstance->BlockIo, Transfer, MediaId, Lba, BufferSize, Buffer);
+  }
+
+  Status = MmcCheckIoRequest (&MmcHostInstance->BlockIo, Transfer, MediaId, Lba, BufferSize, Buffer);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  if (BufferSize == 0) {
+    Token->TransactionStatus = EFI_SUCCESS;
+    gBS->SignalEvent (Token->Event);
+    return EFI_SUCCESS;
+  }
+
+  Request = AllocatePool (sizeof (MMC_IO_REQUEST));
+  if (Request == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Request->Signature = MMC_IO_REQUEST_SIGNATURE;
+  Request->Transfer = Transfer;
+  Request->MediaId = MediaId;
+  Request->Lba = Lba;
+  Request->BufferSize = BufferSize;
+  Request->Buffer = Buffer;
+  Request->Token = Token;
+
+  //
+  // The queue is serviced on the next timer tick, which gives the caller
+  // a chance to submit the adjacent requests that can be merged.
+  //
+  OldTpl = gBS->RaiseTPL (TPL_CALLBACK);
+  InsertTailList (&MmcHostInstance->RequestQueue, &Request->Link);
+  gBS->SetTimer (MmcHostInstance->QueueEvent, TimerRelative, 0);
+  gBS->RestoreTPL (OldTpl);
+
+  return EFI_SUCCESS;
+}
+
+EFI_STATUS
+EFIAPI
+MmcResetEx (
+  IN EFI_BLOCK_IO2_PROTOCOL   *This,
+  IN BOOLEAN                  ExtendedVerification
+  )
+{
+  MMC_HOST_INSTANCE       *MmcHostInstance;
+
+  MmcHostInstance = MMC_HOST_INSTANCE_FROM_BLOCK_IO2_THIS (This);
+  MmcAbortRequestQueue (MmcHostInstance, EFI_ABORTED);
+
+  return MmcReset (&MmcHostInstance->BlockIo, ExtendedVerification);
+}
+
+EFI_STATUS
+EFIAPI
+MmcReadBlocksEx (
+  IN     EFI_BLOCK_IO2_PROTOCOL *This,
+  IN     UINT32                 MediaId,
+  IN     EFI_LBA                Lba,
+  IN OUT EFI_BLOCK_IO2_TOKEN    *Token,
+  IN     UINTN                  BufferSize,
+  OUT    VOID                   *Buffer
+  )
+{
+  return MmcQueueIoBlocks (This, MMC_IOBLOCKS_READ, MediaId, Lba, Token, BufferSize, Buffer);
+}
+
+EFI_STATUS
+EFIAPI
+MmcWriteBlocksEx (
+  IN     EFI_BLOCK_IO2_PROTOCOL *This,
+  IN     UINT32                 MediaId,
+  IN     EFI_LBA                Lba,
+  IN OUT EFI_BLOCK_IO2_TOKEN    *Token,
+  IN     UINTN                  BufferSize,
+  IN     VOID                   *Buffer
+  )
+{
+  return MmcQueueIoBlocks (This, MMC_IOBLOCKS_WRITE, MediaId, Lba, Token, BufferSize, Buffer);
+}
+
+EFI_STATUS
+EFIAPI
+MmcFlushBlocksEx (
+  IN     EFI_BLOCK_IO2_PROTOCOL *This,
+  IN OUT EFI_BLOCK_IO2_TOKEN    *Token
+  )
+{
+  MMC_HOST_INSTANCE       *MmcHostInstance;
+  EFI_TPL                 OldTpl;
+
+  MmcHostInstance = MMC_HOST_INSTANCE_FROM_BLOCK_IO2_THIS (This);
+
+  OldTpl = gBS->RaiseTPL (TPL_CALLBACK);
+  MmcProcessRequestQueue (NULL, MmcHostInstance);
+  gBS->RestoreTPL (OldTpl);
+
+  if (Token != NULL && Token->Event != NULL) {
+    Token->TransactionStatus = EFI_SUCCESS;
+    gBS->SignalEvent (Token->Event);
+  }
+
+  return EFI_SUCCESS;
+}
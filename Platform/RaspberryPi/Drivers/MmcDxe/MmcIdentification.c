@@ -675,6 +675,8 @@ InitializeSdMmcDevice (
      return Status;
   }
 
+  MmcHostInstance->CardInfo.SetBlockCount = (Scr.CMD_SUPPORT & SD_SCR_CMD23_SUPPORTED) != 0;
+
   if (Scr.SD_SPEC == 2) {
     if (Scr.SD_SPEC3 == 1) {
       if (Scr.SD_SPEC4 == 1) {
@@ -956,6 +958,7 @@ InitializeMmcDevice (
 
   BlockCount = 1;
   MmcHost = MmcHostInstance->MmcHost;
+  MmcHostInstance->CardInfo.SetBlockCount = FALSE;
 
   Status = MmcIdentificationMode (MmcHostInstance);
   if (EFI_ERROR (Status)) {
@@ -972,6 +975,7 @@ InitializeMmcDevice (
   if (MmcHostInstance->CardInfo.CardType != EMMC_CARD) {
     Status = InitializeSdMmcDevice (MmcHostInstance);
   } else {
+    MmcHostInstance->CardInfo.SetBlockCount = TRUE;
     Status = InitializeEmmcDevice (MmcHostInstance);
   }
   if (EFI_ERROR (Status)) {
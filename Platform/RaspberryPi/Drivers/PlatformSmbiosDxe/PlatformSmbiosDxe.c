@@ -59,6 +59,18 @@
 
 STATIC RASPBERRY_PI_FIRMWARE_PROTOCOL *mFwProtocol;
 STATIC UINT32                         mBoardRevisionCode;
+STATIC UINT32                         mFirmwareRevision[1];
+STATIC UINT32                         mMaxCpuClock[2] = { RPI_MBOX_CLOCK_RATE_ARM, 0 };
+STATIC UINT32                         mCurrentCpuClock[2] = { RPI_MBOX_CLOCK_RATE_ARM, 0 };
+
+//
+// Firmware properties used by the SMBIOS tables, fetched in one go
+//
+STATIC RASPBERRY_PI_FIRMWARE_PROPERTY mFwProperties[] = {
+  { RPI_MBOX_GET_REVISION, sizeof (mFirmwareRevision), 0, 0, mFirmwareRevision },
+  { RPI_MBOX_GET_MAX_CLOCK_RATE, sizeof (mMaxCpuClock), sizeof (UINT32), 0, mMaxCpuClock },
+  { RPI_MBOX_GET_CLOCK_RATE, sizeof (mCurrentCpuClock), sizeof (UINT32), 0, mCurrentCpuClock },
+};
 
 /***********************************************************************
         SMBIOS data definition  TYPE0  BIOS Information
@@ -744,7 +756,6 @@ BIOSInfoUpdateSmbiosType0 (
   )
 {
   UINT32 EpochSeconds = 0;
-  EFI_STATUS Status = EFI_SUCCESS;
   EFI_TIME Time;
   INTN   i;
   INTN   State = 0;
@@ -754,10 +765,10 @@ BIOSInfoUpdateSmbiosType0 (
   INTN   Day = TIME_BUILD_DAY;
 
   // Populate the Firmware major and minor.
-  Status = mFwProtocol->GetFirmwareRevision (&EpochSeconds);
-  if (EFI_ERROR (Status)) {
-    DEBUG ((DEBUG_ERROR, "Failed to get firmware revision: %r\n", Status));
+  if (mFwProperties[0].ResponseSize < sizeof (mFirmwareRevision)) {
+    DEBUG ((DEBUG_ERROR, "Failed to get firmware revision\n"));
   } else {
+    EpochSeconds = mFirmwareRevision[0];
     // The firmware revision is really an epoch time which we convert to a
     // YY.MM major.minor. This is good enough for our purpose, where this
     // revision is merely provided as a loose indicator of when the
@@ -948,7 +959,6 @@ ProcessorInfoUpdateSmbiosType4 (
   IN UINTN MaxCpus
   )
 {
-  EFI_STATUS Status;
   UINT32     Rate;
   UINT64     *ProcessorId;
 
@@ -959,18 +969,18 @@ ProcessorInfoUpdateSmbiosType4 (
   mProcessorInfoType4.ThreadCount = (UINT8)MaxCpus;
   mProcessorInfoType4.ThreadCount2 = (UINT8)MaxCpus;
 
-  Status = mFwProtocol->GetMaxClockRate (RPI_MBOX_CLOCK_RATE_ARM, &Rate);
-  if (Status != EFI_SUCCESS) {
-    DEBUG ((DEBUG_ERROR, "Couldn't get the max CPU speed: %r\n", Status));
+  if (mFwProperties[1].ResponseSize < sizeof (mMaxCpuClock)) {
+    DEBUG ((DEBUG_ERROR, "Couldn't get the max CPU speed\n"));
   } else {
+    Rate = mMaxCpuClock[1];
     mProcessorInfoType4.MaxSpeed = Rate / 1000000;
     DEBUG ((DEBUG_INFO, "Max CPU speed: %uHz\n", Rate));
   }
 
-  Status = mFwProtocol->GetClockRate (RPI_MBOX_CLOCK_RATE_ARM, &Rate);
-  if (Status != EFI_SUCCESS) {
-    DEBUG ((DEBUG_ERROR, "Couldn't get the current CPU speed: %r\n", Status));
+  if (mFwProperties[2].ResponseSize < sizeof (mCurrentCpuClock)) {
+    DEBUG ((DEBUG_ERROR, "Couldn't get the current CPU speed\n"));
   } else {
+    Rate = mCurrentCpuClock[1];
     mProcessorInfoType4.CurrentSpeed = Rate / 1000000;
     DEBUG ((DEBUG_INFO, "Current CPU speed: %uHz\n", Rate));
   }
@@ -1130,6 +1140,12 @@ PlatformSmbiosDriverEntryPoint (
         __func__, Status));
   }
 
+  Status = mFwProtocol->GetProperties (mFwProperties, ARRAY_SIZE (mFwProperties));
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_WARN, "%a: failed to get some firmware properties: %r\n",
+      __func__, Status));
+  }
+
   BIOSInfoUpdateSmbiosType0 ();
 
   SysInfoUpdateSmbiosType1 ();
@@ -282,6 +282,17 @@ STATIC UINTN mDmaBufferBusAddress;
 
 STATIC SPIN_LOCK mMailboxLock;
 
+//
+// Number of mailbox round-trips performed so far
+//
+STATIC UINTN mMailboxTransactions;
+
+//
+// The MAC address is fixed, and is asked for by several drivers
+//
+STATIC UINT8   mMacAddress[6];
+STATIC BOOLEAN mMacAddressValid;
+
 STATIC
 BOOLEAN
 DrainMailbox (
@@ -376,6 +387,7 @@ MailboxTransaction (
   //
   MmioWrite32 (mMboxBaseAddress + BCM2836_MBOX_WRITE_OFFSET,
     (UINT32)((UINTN)mDmaBufferBusAddress | Channel));
+  mMailboxTransactions++;
 
   ArmDataSynchronizationBarrier ();
 
@@ -512,6 +524,11 @@ RpiFirmwareGetMacAddress (
   EFI_STATUS                  Status;
   UINT32                      Result;
 
+  if (mMacAddressValid) {
+    CopyMem (MacAddress, mMacAddress, sizeof (mMacAddress));
+    return EFI_SUCCESS;
+  }
+
   if (!AcquireSpinLockOrFail (&mMailboxLock)) {
     DEBUG ((DEBUG_ERROR, "%a: failed to acquire spinlock\n", __func__));
     return EFI_DEVICE_ERROR;
@@ -538,9 +555,12 @@ RpiFirmwareGetMacAddress (
     return EFI_DEVICE_ERROR;
   }
 
-  CopyMem (MacAddress, Cmd->TagBody.MacAddress, sizeof (Cmd->TagBody.MacAddress));
+  CopyMem (mMacAddress, Cmd->TagBody.MacAddress, sizeof (mMacAddress));
+  mMacAddressValid = TRUE;
   ReleaseSpinLock (&mMailboxLock);
 
+  CopyMem (MacAddress, mMacAddress, sizeof (mMacAddress));
+
   return EFI_SUCCESS;
 }
 
@@ -1421,6 +1441,141 @@ RpiFirmwareSetRtc (
   return Status;
 }
 
+/**
+  Pack a set of property tags into one buffer and submit them to the
+  VideoCore in a single mailbox transaction, instead of paying for a
+  round-trip per tag.
+
+  @param  Properties    Array of tags. On input, the first RequestSize bytes
+                        of each Buffer are sent as the tag value. On output,
+                        Buffer holds the response and ResponseSize is set to
+                        the length reported by the firmware, or 0 if the tag
+                        was not handled.
+  @param  Count         Number of entries in Properties.
+
+  @retval EFI_SUCCESS             All tags were handled by the firmware.
+  @retval EFI_INVALID_PARAMETER   An entry is malformed.
+  @retval EFI_BUFFER_TOO_SMALL    The tags do not fit in the mailbox buffer.
+  @retval EFI_DEVICE_ERROR        The transaction failed, or at least one tag
+                                  was not handled (see ResponseSize).
+
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+RpiFirmwareGetProperties (
+  IN OUT  RASPBERRY_PI_FIRMWARE_PROPERTY  *Properties,
+  IN      UINTN                           Count
+  )
+{
+  RPI_FW_BUFFER_HEAD          *BufferHead;
+  RPI_FW_TAG_HEAD             *TagHead;
+  UINT8                       *Ptr;
+  UINTN                       Length;
+  UINTN                       Index;
+  UINT32                      ValueSize;
+  EFI_STATUS                  Status;
+  UINT32                      Result;
+
+  if (Properties == NULL || Count == 0) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  Length = sizeof (RPI_FW_BUFFER_HEAD) + sizeof (UINT32);
+  for (Index = 0; Index < Count; Index++) {
+    if (Properties[Index].Buffer == NULL ||
+        Properties[Index].RequestSize > Properties[Index].BufferSize) {
+      return EFI_INVALID_PARAMETER;
+    }
+    Length += sizeof (RPI_FW_TAG_HEAD) +
+              ALIGN_VALUE (Properties[Index].BufferSize, sizeof (UINT32));
+  }
+
+  if (Length > mDmaBufferSize) {
+    return EFI_BUFFER_TOO_SMALL;
+  }
+
+  if (!AcquireSpinLockOrFail (&mMailboxLock)) {
+    DEBUG ((DEBUG_ERROR, "%a: failed to acquire spinlock\n", __func__));
+    return EFI_DEVICE_ERROR;
+  }
+
+  ZeroMem (mDmaBuffer, Length);
+
+  BufferHead = mDmaBuffer;
+  BufferHead->BufferSize  = (UINT32)Length;
+  BufferHead->Response    = 0;
+
+  Ptr = (UINT8 *)(BufferHead + 1);
+  for (Index = 0; Index < Count; Index++) {
+    ValueSize = ALIGN_VALUE (Properties[Index].BufferSize, sizeof (UINT32));
+
+    TagHead = (RPI_FW_TAG_HEAD *)Ptr;
+    TagHead->TagId        = Properties[Index].TagId;
+    TagHead->TagSize      = ValueSize;
+    TagHead->TagValueSize = 0;
+    CopyMem (TagHead + 1, Properties[Index].Buffer,
+      Properties[Index].RequestSize);
+
+    Ptr += sizeof (RPI_FW_TAG_HEAD) + ValueSize;
+  }
+  //
+  // The end tag was cleared along with the rest of the buffer
+  //
+
+  Status = MailboxTransaction (BufferHead->BufferSize, RPI_MBOX_VC_CHANNEL, &Result);
+
+  if (EFI_ERROR (Status) ||
+      BufferHead->Response != RPI_MBOX_RESP_SUCCESS) {
+    DEBUG ((DEBUG_ERROR,
+      "%a: mailbox transaction error: Status == %r, Response == 0x%x\n",
+      __func__, Status, BufferHead->Response));
+    ReleaseSpinLock (&mMailboxLock);
+    return EFI_DEVICE_ERROR;
+  }
+
+  Ptr = (UINT8 *)(BufferHead + 1);
+  for (Index = 0; Index < Count; Index++) {
+    ValueSize = ALIGN_VALUE (Properties[Index].BufferSize, sizeof (UINT32));
+    TagHead = (RPI_FW_TAG_HEAD *)Ptr;
+
+    if ((TagHead->TagValueSize & RPI_MBOX_VALUE_SIZE_RESPONSE_MASK) == 0) {
+      DEBUG ((DEBUG_WARN, "%a: tag 0x%x was not handled\n",
+        __func__, Properties[Index].TagId));
+      Properties[Index].ResponseSize = 0;
+      Status = EFI_DEVICE_ERROR;
+    } else {
+      Properties[Index].ResponseSize = TagHead->TagValueSize &
+                                       ~RPI_MBOX_VALUE_SIZE_RESPONSE_MASK;
+      CopyMem (Properties[Index].Buffer, TagHead + 1,
+        MIN (Properties[Index].ResponseSize, Properties[Index].BufferSize));
+
+      if (Properties[Index].TagId == RPI_MBOX_GET_MAC_ADDRESS &&
+          Properties[Index].ResponseSize >= sizeof (mMacAddress) &&
+          Properties[Index].BufferSize >= sizeof (mMacAddress)) {
+        CopyMem (mMacAddress, Properties[Index].Buffer, sizeof (mMacAddress));
+        mMacAddressValid = TRUE;
+      }
+    }
+
+    Ptr += sizeof (RPI_FW_TAG_HEAD) + ValueSize;
+  }
+
+  ReleaseSpinLock (&mMailboxLock);
+
+  return Status;
+}
+
+STATIC
+UINTN
+EFIAPI
+RpiFirmwareGetTransactionCount (
+  VOID
+  )
+{
+  return mMailboxTransactions;
+}
+
 STATIC RASPBERRY_PI_FIRMWARE_PROTOCOL mRpiFirmwareProtocol = {
   RpiFirmwareSetPowerState,
   RpiFirmwareGetMacAddress,
@@ -1444,6 +1599,8 @@ STATIC RASPBERRY_PI_FIRMWARE_PROTOCOL mRpiFirmwareProtocol = {
   RpiFirmwareNotifyGpioSetCfg,
   RpiFirmwareGetRtc,
   RpiFirmwareSetRtc,
+  RpiFirmwareGetProperties,
+  RpiFirmwareGetTransactionCount,
 };
 
 STATIC
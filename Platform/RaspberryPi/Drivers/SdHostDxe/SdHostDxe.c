@@ -799,7 +799,8 @@ EFI_MMC_HOST_PROTOCOL gMmcHost =
     SdReadBlockData,
     SdWriteBlockData,
     SdSetIos,
-    SdIsMultiBlock
+    SdIsMultiBlock,
+    NULL
   };
 
 EFI_STATUS
@@ -86,6 +86,30 @@ EFI_FW_VOL_BLOCK_DEVICE mFvbDeviceTemplate = {
 };
 
 
+STATIC
+VOID
+MarkDirty (
+  IN UINTN Address,
+  IN UINTN Length
+  )
+{
+  UINTN Block;
+  UINTN LastBlock;
+
+  if (Length == 0) {
+    return;
+  }
+
+  Block = (Address - mFvInstance->FvBase) / mFvInstance->BlockSize;
+  LastBlock = (Address - mFvInstance->FvBase + Length - 1) / mFvInstance->BlockSize;
+  for (; Block <= LastBlock; Block++) {
+    mFvInstance->DirtyBlocks[Block / 8] |= (UINT8)(1 << (Block % 8));
+  }
+
+  mFvInstance->Dirty = TRUE;
+}
+
+
 EFI_STATUS
 VarStoreWrite (
   IN     UINTN Address,
@@ -94,7 +118,7 @@ VarStoreWrite (
   )
 {
   CopyMem ((VOID*)Address, Buffer, *NumBytes);
-  mFvInstance->Dirty = TRUE;
+  MarkDirty (Address, *NumBytes);
 
   return EFI_SUCCESS;
 }
@@ -107,7 +131,7 @@ VarStoreErase (
   )
 {
   SetMem ((VOID*)Address, LbaLength, 0xff);
-  mFvInstance->Dirty = TRUE;
+  MarkDirty (Address, LbaLength);
 
   return EFI_SUCCESS;
 }
@@ -843,6 +867,18 @@ FvbInitialize (
   mFvInstance->FvBase = (UINTN)BaseAddress;
   mFvInstance->FvLength = (UINTN)Length;
   mFvInstance->Offset = StartOffset;
+  mFvInstance->BlockSize = PcdGet32 (PcdFirmwareBlockSize);
+
+  //
+  // Track modified blocks, so that only those are written back to the
+  // image file.
+  //
+  mFvInstance->DirtyBlocks = AllocateRuntimeZeroPool (DIRTY_BITMAP_SIZE (mFvInstance));
+  if (mFvInstance->DirtyBlocks == NULL) {
+    FreePool (mFvInstance);
+    mFvInstance = NULL;
+    return EFI_OUT_OF_RESOURCES;
+  }
   /*
    * Should I parse config.txt instead and find the real name?
    */
@@ -33,8 +33,16 @@ typedef struct {
   EFI_DEVICE_PATH_PROTOCOL   *Device;
   CHAR16                     *MappedFile;
   BOOLEAN                    Dirty;
+  UINTN                      BlockSize;
+  UINT8                      *DirtyBlocks;  // One bit per block of BlockSize
+  UINT64                     BytesFlushed;
 } EFI_FW_VOL_INSTANCE;
 
+#define DIRTY_BITMAP_SIZE(Instance) \
+  (((Instance)->FvLength / (Instance)->BlockSize + 7) / 8)
+#define IS_BLOCK_DIRTY(Instance, Block) \
+  (((Instance)->DirtyBlocks[(Block) / 8] & (1 << ((Block) % 8))) != 0)
+
 extern EFI_FW_VOL_INSTANCE *mFvInstance;
 
 typedef struct {
@@ -10,6 +10,8 @@
 
 #include "VarBlockService.h"
 
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
 #include <Protocol/ResetNotification.h>
 
 //
@@ -110,6 +112,7 @@ FvbVirtualAddressChangeEvent (
 {
   EfiConvertPointer (0x0, (VOID**)&mFvInstance->FvBase);
   EfiConvertPointer (0x0, (VOID**)&mFvInstance->VolumeHeader);
+  EfiConvertPointer (0x0, (VOID**)&mFvInstance->DirtyBlocks);
   EfiConvertPointer (0x0, (VOID**)&mFvInstance);
 }
 
@@ -134,14 +137,28 @@ InstallVirtualAddressChangeHandler (
 }
 
 
+//
+// Write the modified blocks of the variable store back to the image file,
+// one FileWrite per run of consecutive dirty blocks. With Full set every
+// block is written, for an image file that is not known to already hold
+// the unmodified blocks.
+//
 STATIC
 EFI_STATUS
 DoDump (
-  IN EFI_DEVICE_PATH_PROTOCOL *Device
+  IN  EFI_DEVICE_PATH_PROTOCOL *Device,
+  IN  BOOLEAN                  Full,
+  OUT UINTN                    *BytesWritten
   )
 {
   EFI_STATUS Status;
   EFI_FILE_PROTOCOL *File;
+  UINTN NumBlocks;
+  UINTN Block;
+  UINTN End;
+  UINTN Start;
+
+  *BytesWritten = 0;
 
   Status = FileOpen (Device,
              mFvInstance->MappedFile,
@@ -152,11 +169,32 @@ DoDump (
     return Status;
   }
 
-  Status = FileWrite (File,
-             mFvInstance->Offset,
-             mFvInstance->FvBase,
-             mFvInstance->FvLength);
+  NumBlocks = mFvInstance->FvLength / mFvInstance->BlockSize;
+  for (Block = 0; Block < NumBlocks && !EFI_ERROR (Status); Block = End) {
+    if (!Full && !IS_BLOCK_DIRTY (mFvInstance, Block)) {
+      End = Block + 1;
+      continue;
+    }
+
+    for (End = Block + 1; End < NumBlocks && (Full || IS_BLOCK_DIRTY (mFvInstance, End)); End++) {
+    }
+
+    Start = Block * mFvInstance->BlockSize;
+    Status = FileWrite (File,
+               mFvInstance->Offset + Start,
+               mFvInstance->FvBase + Start,
+               (End - Block) * mFvInstance->BlockSize);
+    if (!EFI_ERROR (Status)) {
+      *BytesWritten += (End - Block) * mFvInstance->BlockSize;
+    }
+  }
   FileClose (File);
+
+  if (!EFI_ERROR (Status)) {
+    ZeroMem (mFvInstance->DirtyBlocks, DIRTY_BITMAP_SIZE (mFvInstance));
+    mFvInstance->Dirty = FALSE;
+    mFvInstance->BytesFlushed += *BytesWritten;
+  }
   return Status;
 }
 
@@ -164,11 +202,12 @@ DoDump (
 STATIC
 VOID
 DumpVars (
-  VOID
+  IN BOOLEAN OnReset
   )
 {
   EFI_STATUS Status;
   RETURN_STATUS PcdStatus;
+  UINTN BytesWritten;
 
   if (mFvInstance->Device == NULL) {
     DEBUG ((DEBUG_INFO, "Variable store not found?\n"));
@@ -180,26 +219,26 @@ DumpVars (
     return;
   }
 
-  Status = DoDump (mFvInstance->Device);
+  Status = DoDump (mFvInstance->Device, FALSE, &BytesWritten);
   if (EFI_ERROR (Status)) {
     DEBUG ((DEBUG_ERROR, "Couldn't dump '%s'\n", mFvInstance->MappedFile));
     ASSERT_EFI_ERROR (Status);
     return;
   }
 
-  DEBUG ((DEBUG_INFO, "Variables dumped!\n"));
+  DEBUG ((DEBUG_INFO, "Variables dumped! %u bytes written, %lu in total\n",
+    BytesWritten, mFvInstance->BytesFlushed));
 
   //
   // Add a reset delay to give time for slow/cached devices
   // to flush the NV variables write to permanent storage.
   // But only do so if this won't reduce an existing user-set delay.
+  // Variables written out earlier have had that time already.
   //
-  if (PcdGet32 (PcdPlatformResetDelay) < PLATFORM_RESET_DELAY) {
+  if (OnReset && PcdGet32 (PcdPlatformResetDelay) < PLATFORM_RESET_DELAY) {
     PcdStatus = PcdSet32S (PcdPlatformResetDelay, PLATFORM_RESET_DELAY);
     ASSERT_RETURN_ERROR (PcdStatus);
   }
-
-  mFvInstance->Dirty = FALSE;
 }
 
 STATIC
@@ -210,7 +249,20 @@ DumpVarsOnEvent (
   IN VOID *Context
   )
 {
-  DumpVars ();
+  DumpVars (FALSE);
+}
+
+STATIC
+VOID
+EFIAPI
+DumpVarsOnTimer (
+  IN EFI_EVENT Event,
+  IN VOID *Context
+  )
+{
+  if (mFvInstance->Dirty && mFvInstance->Device != NULL) {
+    DumpVars (FALSE);
+  }
 }
 
 STATIC
@@ -223,7 +275,7 @@ DumpVarsOnReset (
   IN VOID            *ResetData OPTIONAL
   )
 {
-  DumpVars ();
+  DumpVars (TRUE);
 }
 
 VOID
@@ -252,7 +304,7 @@ ReadyToBootHandler (
                 );
   ASSERT_EFI_ERROR (Status);
 
-  DumpVars ();
+  DumpVars (FALSE);
   Status = gBS->CloseEvent (Event);
   ASSERT_EFI_ERROR (Status);
 }
@@ -265,6 +317,7 @@ InstallDumpVarEventHandlers (
 {
   EFI_STATUS                       Status;
   EFI_EVENT                        ReadyToBootEvent;
+  EFI_EVENT                        WriteBehindEvent;
   EFI_RESET_NOTIFICATION_PROTOCOL  *ResetNotify;
 
   Status = gBS->CreateEventEx (
@@ -290,6 +343,25 @@ InstallDumpVarEventHandlers (
                             );
     ASSERT_EFI_ERROR (Status);
   }
+
+  if (FixedPcdGet32 (PcdVarStoreWriteBehindMs) != 0) {
+    Status = gBS->CreateEvent (
+                    EVT_TIMER | EVT_NOTIFY_SIGNAL,
+                    TPL_CALLBACK,
+                    DumpVarsOnTimer,
+                    NULL,
+                    &WriteBehindEvent
+                  );
+    ASSERT_EFI_ERROR (Status);
+    if (!EFI_ERROR (Status)) {
+      Status = gBS->SetTimer (
+                      WriteBehindEvent,
+                      TimerPeriodic,
+                      MultU64x32 (FixedPcdGet32 (PcdVarStoreWriteBehindMs), 10 * 1000)
+                    );
+      ASSERT_EFI_ERROR (Status);
+    }
+  }
 }
 
 
@@ -304,6 +376,7 @@ OnSimpleFileSystemInstall (
   UINTN HandleSize;
   EFI_HANDLE Handle;
   EFI_DEVICE_PATH_PROTOCOL *Device;
+  UINTN BytesWritten;
 
   if ((mFvInstance->Device != NULL) &&
       !EFI_ERROR (CheckStoreExists (mFvInstance->Device))) {
@@ -334,7 +407,13 @@ OnSimpleFileSystemInstall (
       continue;
     }
 
-    Status = DoDump (Device);
+    //
+    // This is the first device found, or a different one from before, so
+    // its image file may not match the blocks that were never modified.
+    // Write the whole store; later dumps to the same device only write
+    // the dirty blocks.
+    //
+    Status = DoDump (Device, TRUE, &BytesWritten);
     if (EFI_ERROR (Status)) {
       DEBUG ((DEBUG_ERROR, "Couldn't update '%s'\n", mFvInstance->MappedFile));
       ASSERT_EFI_ERROR (Status);
@@ -167,6 +167,30 @@ EFI_STATUS
   IN   UINT32                     Value
   );
 
+//
+// A single property tag, as submitted through GET_PROPERTIES
+//
+typedef struct {
+  UINT32  TagId;
+  UINT32  BufferSize;     // Size of Buffer, in bytes
+  UINT32  RequestSize;    // Number of bytes of Buffer to send
+  UINT32  ResponseSize;   // Response length reported by the firmware
+  VOID    *Buffer;
+} RASPBERRY_PI_FIRMWARE_PROPERTY;
+
+typedef
+EFI_STATUS
+(EFIAPI *GET_PROPERTIES) (
+  IN OUT  RASPBERRY_PI_FIRMWARE_PROPERTY  *Properties,
+  IN      UINTN                           Count
+  );
+
+typedef
+UINTN
+(EFIAPI *GET_TRANSACTION_COUNT) (
+  VOID
+  );
+
 typedef struct {
   SET_POWER_STATE        SetPowerState;
   GET_MAC_ADDRESS        GetMacAddress;
@@ -190,6 +214,8 @@ typedef struct {
   GPIO_SET_CFG           SetGpioConfig;
   GET_RTC                GetRtc;
   SET_RTC                SetRtc;
+  GET_PROPERTIES         GetProperties;
+  GET_TRANSACTION_COUNT  GetTransactionCount;
 } RASPBERRY_PI_FIRMWARE_PROTOCOL;
 
 extern EFI_GUID gRaspberryPiFirmwareProtocolGuid;
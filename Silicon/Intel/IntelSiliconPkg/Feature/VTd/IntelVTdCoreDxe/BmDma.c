@@ -25,6 +25,7 @@ typedef struct {
 typedef struct {
   UINT32                                    Signature;
   LIST_ENTRY                                Link;
+  LIST_ENTRY                                AddressLink;
   EDKII_IOMMU_OPERATION                     Operation;
   UINTN                                     NumberOfBytes;
   UINTN                                     NumberOfPages;
@@ -33,8 +34,206 @@ typedef struct {
   LIST_ENTRY                                HandleList;
 } MAP_INFO;
 #define MAP_INFO_FROM_LINK(a) CR (a, MAP_INFO, Link, MAP_INFO_SIGNATURE)
+#define MAP_INFO_FROM_ADDRESS_LINK(a) CR (a, MAP_INFO, AddressLink, MAP_INFO_SIGNATURE)
+
+//
+// Active mappings are hashed twice: by the MAP_INFO pointer returned as the
+// Mapping handle, and by DeviceAddress. This keeps Unmap() and the attribute
+// sync lookups independent of the number of in-flight mappings.
+//
+#define MAP_INFO_HASH_SIZE              256
+#define MAP_INFO_HASH(Mapping)          ((((UINTN) (Mapping)) >> 4) % MAP_INFO_HASH_SIZE)
+#define MAP_INFO_ADDRESS_HASH(Address)  ((UINTN) RShiftU64 ((Address), EFI_PAGE_SHIFT) % MAP_INFO_HASH_SIZE)
+
+LIST_ENTRY                        gMaps[MAP_INFO_HASH_SIZE];
+LIST_ENTRY                        gMapsByAddress[MAP_INFO_HASH_SIZE];
+BOOLEAN                           gMapsInitialized = FALSE;
+
+//
+// Unmapped MAP_INFO structures are kept for reuse instead of being freed.
+//
+LIST_ENTRY                        gFreeMapInfos = INITIALIZE_LIST_HEAD_VARIABLE(gFreeMapInfos);
+
+//
+// Freed below-4GB bounce buffers of up to BOUNCE_BUFFER_POOL_MAX_PAGES pages are
+// kept in per-size pools, so that a remapped transfer does not need to go to the
+// page allocator each time. A pooled buffer stores its free list link in itself.
+//
+#define BOUNCE_BUFFER_POOL_MAX_PAGES  16
+#define BOUNCE_BUFFER_POOL_DEPTH      8
+
+LIST_ENTRY                        gBounceBufferPool[BOUNCE_BUFFER_POOL_MAX_PAGES];
+UINTN                             gBounceBufferPoolCount[BOUNCE_BUFFER_POOL_MAX_PAGES];
 
-LIST_ENTRY                        gMaps = INITIALIZE_LIST_HEAD_VARIABLE(gMaps);
+/**
+  Initialize the mapping hash tables and bounce buffer pools.
+
+  Must be called at VTD_TPL_LEVEL.
+**/
+VOID
+InitializeMapTables (
+  VOID
+  )
+{
+  UINTN  Index;
+
+  if (gMapsInitialized) {
+    return;
+  }
+
+  for (Index = 0; Index < MAP_INFO_HASH_SIZE; Index++) {
+    InitializeListHead (&gMaps[Index]);
+    InitializeListHead (&gMapsByAddress[Index]);
+  }
+
+  for (Index = 0; Index < BOUNCE_BUFFER_POOL_MAX_PAGES; Index++) {
+    InitializeListHead (&gBounceBufferPool[Index]);
+    gBounceBufferPoolCount[Index] = 0;
+  }
+
+  gMapsInitialized = TRUE;
+}
+
+/**
+  Find an active MAP_INFO from the Mapping handle returned by Map().
+
+  Must be called at VTD_TPL_LEVEL.
+
+  @param[in]  Mapping        The mapping.
+
+  @return The MAP_INFO, or NULL if Mapping is not an active mapping.
+**/
+MAP_INFO *
+FindMapInfo (
+  IN VOID                                      *Mapping
+  )
+{
+  LIST_ENTRY               *Head;
+  LIST_ENTRY               *Link;
+
+  if (!gMapsInitialized) {
+    return NULL;
+  }
+
+  Head = &gMaps[MAP_INFO_HASH (Mapping)];
+  for (Link = GetFirstNode (Head)
+       ; !IsNull (Head, Link)
+       ; Link = GetNextNode (Head, Link)
+       ) {
+    if (Link == &((MAP_INFO *) Mapping)->Link) {
+      return MAP_INFO_FROM_LINK (Link);
+    }
+  }
+
+  return NULL;
+}
+
+/**
+  Allocate a bounce buffer for a remapped transfer.
+
+  Buffers of up to BOUNCE_BUFFER_POOL_MAX_PAGES pages are served from the pools
+  when a pooled buffer ends at or below the maximum address. New ones are
+  allocated below both the maximum address and 4GB, so that once pooled they
+  can also serve transfers that must stay below 4GB.
+
+  @param[in]      NumberOfPages  The number of pages to allocate.
+  @param[in, out] Address        On input, the maximum address of the buffer.
+                                 On output, the base address of the buffer.
+
+  @retval EFI_SUCCESS           The buffer is allocated.
+  @retval EFI_OUT_OF_RESOURCES  The buffer could not be allocated.
+**/
+EFI_STATUS
+AllocateBounceBuffer (
+  IN     UINTN                                 NumberOfPages,
+  IN OUT EFI_PHYSICAL_ADDRESS                  *Address
+  )
+{
+  LIST_ENTRY               *Head;
+  LIST_ENTRY               *Link;
+  EFI_TPL                  OriginalTpl;
+
+  if (NumberOfPages > BOUNCE_BUFFER_POOL_MAX_PAGES) {
+    return gBS->AllocatePages (AllocateMaxAddress, EfiBootServicesData, NumberOfPages, Address);
+  }
+
+  OriginalTpl = gBS->RaiseTPL (VTD_TPL_LEVEL);
+  InitializeMapTables ();
+  Head = &gBounceBufferPool[NumberOfPages - 1];
+  for (Link = GetFirstNode (Head)
+       ; !IsNull (Head, Link)
+       ; Link = GetNextNode (Head, Link)
+       ) {
+    if ((EFI_PHYSICAL_ADDRESS) (UINTN) Link + EFI_PAGES_TO_SIZE (NumberOfPages) - 1 <= *Address) {
+      RemoveEntryList (Link);
+      gBounceBufferPoolCount[NumberOfPages - 1]--;
+      gBS->RestoreTPL (OriginalTpl);
+
+      *Address = (EFI_PHYSICAL_ADDRESS) (UINTN) Link;
+      return EFI_SUCCESS;
+    }
+  }
+  gBS->RestoreTPL (OriginalTpl);
+
+  *Address = MIN (*Address, SIZE_4GB - 1);
+  return gBS->AllocatePages (AllocateMaxAddress, EfiBootServicesData, NumberOfPages, Address);
+}
+
+/**
+  Free a bounce buffer allocated by AllocateBounceBuffer().
+
+  @param[in]  Address        The base address of the buffer.
+  @param[in]  NumberOfPages  The number of pages of the buffer.
+**/
+VOID
+FreeBounceBuffer (
+  IN EFI_PHYSICAL_ADDRESS                      Address,
+  IN UINTN                                     NumberOfPages
+  )
+{
+  EFI_TPL                  OriginalTpl;
+
+  if (NumberOfPages <= BOUNCE_BUFFER_POOL_MAX_PAGES) {
+    OriginalTpl = gBS->RaiseTPL (VTD_TPL_LEVEL);
+    if (gBounceBufferPoolCount[NumberOfPages - 1] < BOUNCE_BUFFER_POOL_DEPTH) {
+      InsertHeadList (&gBounceBufferPool[NumberOfPages - 1], (LIST_ENTRY *) (UINTN) Address);
+      gBounceBufferPoolCount[NumberOfPages - 1]++;
+      gBS->RestoreTPL (OriginalTpl);
+      return;
+    }
+    gBS->RestoreTPL (OriginalTpl);
+  }
+
+  gBS->FreePages (Address, NumberOfPages);
+}
+
+/**
+  Release the bounce buffer pools and the MAP_INFO structures kept for reuse.
+
+  This is called at ExitBootServices, where the memory allocation services
+  must not be used anymore. The pooled pages and MAP_INFO structures are
+  EfiBootServicesData, so they go back to the OS together with the rest of the
+  boot services memory. Emptying the lists makes sure they are not handed out
+  again.
+**/
+VOID
+ReleaseBounceBufferPools (
+  VOID
+  )
+{
+  UINTN                    Index;
+  EFI_TPL                  OriginalTpl;
+
+  OriginalTpl = gBS->RaiseTPL (VTD_TPL_LEVEL);
+  InitializeMapTables ();
+  for (Index = 0; Index < BOUNCE_BUFFER_POOL_MAX_PAGES; Index++) {
+    InitializeListHead (&gBounceBufferPool[Index]);
+    gBounceBufferPoolCount[Index] = 0;
+  }
+
+  InitializeListHead (&gFreeMapInfos);
+  gBS->RestoreTPL (OriginalTpl);
+}
 
 /**
   This function fills DeviceHandle/IoMmuAccess to the MAP_HANDLE_INFO,
@@ -56,6 +255,7 @@ SyncDeviceHandleToMapInfo (
 {
   MAP_INFO                 *MapInfo;
   MAP_HANDLE_INFO          *MapHandleInfo;
+  LIST_ENTRY               *Head;
   LIST_ENTRY               *Link;
   EFI_TPL                  OriginalTpl;
 
@@ -63,12 +263,14 @@ SyncDeviceHandleToMapInfo (
   // Find MapInfo according to DeviceAddress
   //
   OriginalTpl = gBS->RaiseTPL (VTD_TPL_LEVEL);
+  InitializeMapTables ();
   MapInfo = NULL;
-  for (Link = GetFirstNode (&gMaps)
-       ; !IsNull (&gMaps, Link)
-       ; Link = GetNextNode (&gMaps, Link)
+  Head = &gMapsByAddress[MAP_INFO_ADDRESS_HASH (DeviceAddress)];
+  for (Link = GetFirstNode (Head)
+       ; !IsNull (Head, Link)
+       ; Link = GetNextNode (Head, Link)
        ) {
-    MapInfo = MAP_INFO_FROM_LINK (Link);
+    MapInfo = MAP_INFO_FROM_ADDRESS_LINK (Link);
     if (MapInfo->DeviceAddress == DeviceAddress) {
       break;
     }
@@ -225,9 +427,18 @@ IoMmuMap (
 
   //
   // Allocate a MAP_INFO structure to remember the mapping when Unmap() is
-  // called later.
+  // called later. Reuse one released by a previous Unmap() if possible.
   //
-  MapInfo = AllocatePool (sizeof (MAP_INFO));
+  MapInfo = NULL;
+  OriginalTpl = gBS->RaiseTPL (VTD_TPL_LEVEL);
+  if (!IsListEmpty (&gFreeMapInfos)) {
+    MapInfo = BASE_CR (GetFirstNode (&gFreeMapInfos), MAP_INFO, Link);
+    RemoveEntryList (&MapInfo->Link);
+  }
+  gBS->RestoreTPL (OriginalTpl);
+  if (MapInfo == NULL) {
+    MapInfo = AllocatePool (sizeof (MAP_INFO));
+  }
   if (MapInfo == NULL) {
     *NumberOfBytes = 0;
     DEBUG ((DEBUG_ERROR, "IoMmuMap: %r\n", EFI_OUT_OF_RESOURCES));
@@ -249,12 +460,7 @@ IoMmuMap (
   // Allocate a buffer below 4GB to map the transfer to.
   //
   if (NeedRemap) {
-    Status = gBS->AllocatePages (
-                    AllocateMaxAddress,
-                    EfiBootServicesData,
-                    MapInfo->NumberOfPages,
-                    &MapInfo->DeviceAddress
-                    );
+    Status = AllocateBounceBuffer (MapInfo->NumberOfPages, &MapInfo->DeviceAddress);
     if (EFI_ERROR (Status)) {
       FreePool (MapInfo);
       *NumberOfBytes = 0;
@@ -280,7 +486,9 @@ IoMmuMap (
   }
 
   OriginalTpl = gBS->RaiseTPL (VTD_TPL_LEVEL);
-  InsertTailList (&gMaps, &MapInfo->Link);
+  InitializeMapTables ();
+  InsertTailList (&gMaps[MAP_INFO_HASH (MapInfo)], &MapInfo->Link);
+  InsertTailList (&gMapsByAddress[MAP_INFO_ADDRESS_HASH (MapInfo->DeviceAddress)], &MapInfo->AddressLink);
   gBS->RestoreTPL (OriginalTpl);
 
   //
@@ -318,7 +526,6 @@ IoMmuUnmap (
 {
   MAP_INFO                 *MapInfo;
   MAP_HANDLE_INFO          *MapHandleInfo;
-  LIST_ENTRY               *Link;
   EFI_TPL                  OriginalTpl;
 
   DEBUG ((DEBUG_VERBOSE, "IoMmuUnmap: 0x%08x\n", Mapping));
@@ -329,25 +536,17 @@ IoMmuUnmap (
   }
 
   OriginalTpl = gBS->RaiseTPL (VTD_TPL_LEVEL);
-  MapInfo = NULL;
-  for (Link = GetFirstNode (&gMaps)
-       ; !IsNull (&gMaps, Link)
-       ; Link = GetNextNode (&gMaps, Link)
-       ) {
-    MapInfo = MAP_INFO_FROM_LINK (Link);
-    if (MapInfo == Mapping) {
-      break;
-    }
-  }
+  MapInfo = FindMapInfo (Mapping);
   //
   // Mapping is not a valid value returned by Map()
   //
-  if (MapInfo != Mapping) {
+  if (MapInfo == NULL) {
     gBS->RestoreTPL (OriginalTpl);
     DEBUG ((DEBUG_ERROR, "IoMmuUnmap: %r\n", EFI_INVALID_PARAMETER));
     return EFI_INVALID_PARAMETER;
   }
   RemoveEntryList (&MapInfo->Link);
+  RemoveEntryList (&MapInfo->AddressLink);
   gBS->RestoreTPL (OriginalTpl);
 
   //
@@ -375,14 +574,20 @@ IoMmuUnmap (
     }
 
     //
-    // Free the mapped buffer and the MAP_INFO structure.
+    // Free the mapped buffer.
     //
-    gBS->FreePages (MapInfo->DeviceAddress, MapInfo->NumberOfPages);
+    FreeBounceBuffer (MapInfo->DeviceAddress, MapInfo->NumberOfPages);
   }
 
   VTdLogAddEvent (VTDLOG_DXE_IOMMU_UNMAP, MapInfo->NumberOfBytes, MapInfo->DeviceAddress);
 
-  FreePool (Mapping);
+  //
+  // Keep the MAP_INFO structure for reuse by a later Map().
+  //
+  MapInfo->Signature = 0;
+  OriginalTpl = gBS->RaiseTPL (VTD_TPL_LEVEL);
+  InsertHeadList (&gFreeMapInfos, &MapInfo->Link);
+  gBS->RestoreTPL (OriginalTpl);
   return EFI_SUCCESS;
 }
 
@@ -517,26 +722,16 @@ GetDeviceInfoFromMapping (
   )
 {
   MAP_INFO                 *MapInfo;
-  LIST_ENTRY               *Link;
 
   if (Mapping == NULL) {
     return EFI_INVALID_PARAMETER;
   }
 
-  MapInfo = NULL;
-  for (Link = GetFirstNode (&gMaps)
-       ; !IsNull (&gMaps, Link)
-       ; Link = GetNextNode (&gMaps, Link)
-       ) {
-    MapInfo = MAP_INFO_FROM_LINK (Link);
-    if (MapInfo == Mapping) {
-      break;
-    }
-  }
+  MapInfo = FindMapInfo (Mapping);
   //
   // Mapping is not a valid value returned by Map()
   //
-  if (MapInfo != Mapping) {
+  if (MapInfo == NULL) {
     return EFI_INVALID_PARAMETER;
   }
 
@@ -610,6 +610,14 @@ OnExitBootServices (
 
   DEBUG ((DEBUG_INFO, "Invalidate all\n"));
   for (VtdIndex = 0; VtdIndex < mVtdUnitNumber; VtdIndex++) {
+    DEBUG ((
+      DEBUG_INFO,
+      "VTd(%d) IOTLB invalidations - Global: %Lu, Selective: %Lu\n",
+      VtdIndex,
+      (UINT64)mVtdUnitInformation[VtdIndex].GlobalIotlbInvalidations,
+      (UINT64)mVtdUnitInformation[VtdIndex].SelectiveIotlbInvalidations
+      ));
+
     VtdLibFlushWriteBuffer (mVtdUnitInformation[VtdIndex].VtdUnitBaseAddress);
 
     InvalidateContextCache (VtdIndex);
@@ -617,6 +625,8 @@ OnExitBootServices (
     InvalidateIOTLB (VtdIndex);
   }
 
+  ReleaseBounceBufferPools ();
+
   if ((PcdGet8(PcdVTdPolicyPropertyMask) & BIT1) == 0) {
     DisableDmar ();
     DumpVtdRegsAll ();
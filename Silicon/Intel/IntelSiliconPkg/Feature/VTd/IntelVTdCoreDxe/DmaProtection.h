@@ -79,6 +79,9 @@ typedef struct {
   UINT8                            EnableQueuedInvalidation;
   VOID                             *QiDescBuffer;
   UINTN                            QiDescBufferSize;
+  UINTN                            GlobalIotlbInvalidations;
+  UINTN                            SelectiveIotlbInvalidations;
+  UINT64                           MergedPageSize;
 } VTD_UNIT_INFORMATION;
 
 //
@@ -217,6 +220,25 @@ InvalidateVtdIOTLBGlobal (
   IN UINTN  VtdIndex
   );
 
+/**
+  Invalid the VTd IOTLB entries of a domain for a memory range.
+
+  @param[in]  VtdIndex              The index of VTd engine.
+  @param[in]  DomainIdentifier      The domain ID whose translations changed.
+  @param[in]  BaseAddress           The base of the memory range.
+  @param[in]  Length                The length of the memory range.
+
+  @retval EFI_SUCCESS           VTd IOTLB entries are invalidated.
+  @retval EFI_DEVICE_ERROR      VTd IOTLB entries are not invalidated.
+**/
+EFI_STATUS
+InvalidateVtdIOTLBPage (
+  IN UINTN   VtdIndex,
+  IN UINT16  DomainIdentifier,
+  IN UINT64  BaseAddress,
+  IN UINT64  Length
+  );
+
 /**
   Dump VTd registers.
 
@@ -534,6 +556,14 @@ GetDeviceInfoFromMapping (
   OUT UINTN                                    *NumberOfPages
   );
 
+/**
+  Release the bounce buffer pools and the MAP_INFO structures kept for reuse.
+**/
+VOID
+ReleaseBounceBufferPools (
+  VOID
+  );
+
 /**
   Initialize DMA protection.
 **/
@@ -20,6 +20,19 @@ CreateExtContextEntry (
   IN UINTN  VtdIndex
   );
 
+typedef struct {
+  LIST_ENTRY  Link;
+  UINTN       VtdIndex;
+  VOID        *PageTable;
+} PENDING_FREE_PAGE_TABLE;
+
+//
+// Page tables released by merging split pages back into large pages. They are
+// only freed after the IOTLB and paging-structure caches have been invalidated,
+// so that the hardware never walks a reused page.
+//
+LIST_ENTRY  mPendingFreePageTables = INITIALIZE_LIST_HEAD_VARIABLE (mPendingFreePageTables);
+
 /**
   Allocate zero pages.
 
@@ -194,11 +207,17 @@ CreateSecondLevelPagingEntryTable (
   VTD_SECOND_LEVEL_PAGING_ENTRY  *Lvl2PtEntry;
   UINT64                         BaseAddress;
   UINT64                         EndAddress;
+  BOOLEAN                        Use1GPage;
 
   if (MemoryLimit == 0) {
     return NULL;
   }
 
+  //
+  // Use 1G pages for the fully covered 1G regions if the engine supports them.
+  //
+  Use1GPage = (BOOLEAN)((mVtdUnitInformation[VtdIndex].CapReg.Bits.SLLPS & BIT1) != 0);
+
   Lvl4PagesStart = 0;
   Lvl4PagesEnd   = 0;
   Lvl4PtEntry    = NULL;
@@ -293,6 +312,24 @@ CreateSecondLevelPagingEntryTable (
 
       Lvl3PtEntry = (VTD_SECOND_LEVEL_PAGING_ENTRY *)(UINTN)VTD_64BITS_ADDRESS(Lvl4PtEntry[Index4].Bits.AddressLo, Lvl4PtEntry[Index4].Bits.AddressHi);
       for (Index3 = Lvl3Start; Index3 <= Lvl3End; Index3++) {
+        if ((Lvl3PtEntry[Index3].Uint64 == 0) && Use1GPage &&
+            ((BaseAddress & (SIZE_1GB - 1)) == 0) && (BaseAddress + SIZE_1GB <= MemoryLimit)) {
+          Lvl3PtEntry[Index3].Uint64 = BaseAddress;
+          SetSecondLevelPagingEntryAttribute (&Lvl3PtEntry[Index3], IoMmuAccess);
+          Lvl3PtEntry[Index3].Bits.PageSize = 1;
+          BaseAddress += SIZE_1GB;
+          if (BaseAddress >= MemoryLimit) {
+            break;
+          }
+          continue;
+        }
+        if (Lvl3PtEntry[Index3].Bits.PageSize != 0) {
+          BaseAddress = ALIGN_VALUE_LOW(BaseAddress, SIZE_1GB) + SIZE_1GB;
+          if (BaseAddress >= MemoryLimit) {
+            break;
+          }
+          continue;
+        }
         if (Lvl3PtEntry[Index3].Uint64 == 0) {
           Lvl3PtEntry[Index3].Uint64 = (UINT64)(UINTN)AllocateZeroPages (1);
           if (Lvl3PtEntry[Index3].Uint64 == 0) {
@@ -331,6 +368,34 @@ CreateSecondLevelPagingEntryTable (
   return SecondLevelPagingEntry;
 }
 
+/**
+  Create an empty top level table for a device domain.
+
+  Only the top level page is allocated. The lower levels are allocated by
+  GetSecondLevelPageTableEntry when SetPageAttribute first touches an
+  address in them, so a device only pays for the ranges it maps.
+
+  @param[in]  VtdIndex                    The index of the VTd engine.
+
+  @return The second level paging entry, or NULL if it cannot be allocated.
+**/
+VTD_SECOND_LEVEL_PAGING_ENTRY *
+CreateSecondLevelPagingRoot (
+  IN UINTN   VtdIndex
+  )
+{
+  VTD_SECOND_LEVEL_PAGING_ENTRY *SecondLevelPagingEntry;
+
+  SecondLevelPagingEntry = AllocateZeroPages (1);
+  if (SecondLevelPagingEntry == NULL) {
+    DEBUG ((DEBUG_ERROR,"Could not Alloc LVL4 or LVL5 PT. \n"));
+    return NULL;
+  }
+  FlushPageTableMemory (VtdIndex, (UINTN)SecondLevelPagingEntry, EFI_PAGES_TO_SIZE(1));
+
+  return SecondLevelPagingEntry;
+}
+
 /**
   Create second level paging entry.
 
@@ -496,18 +561,55 @@ DumpSecondLevelPagingEntry (
 /**
   Invalid page entry.
 
-  @param VtdIndex  The VTd engine index.
+  A context change needs a global invalidation. If only the pages of one
+  domain changed, just the IOTLB entries of that domain for the modified
+  range are invalidated. The range is widened to the large pages which were
+  merged, and the page tables released by the merge are freed afterwards.
+
+  @param VtdIndex          The VTd engine index.
+  @param DomainIdentifier  The domain ID whose pages were modified.
+  @param BaseAddress       The base of the modified memory range.
+  @param Length            The length of the modified memory range.
 **/
 VOID
 InvalidatePageEntry (
-  IN UINTN                 VtdIndex
+  IN UINTN                 VtdIndex,
+  IN UINT16                DomainIdentifier,
+  IN UINT64                BaseAddress,
+  IN UINT64                Length
   )
 {
-  if (mVtdUnitInformation[VtdIndex].HasDirtyContext || mVtdUnitInformation[VtdIndex].HasDirtyPages) {
+  UINT64                   MergedPageSize;
+  UINT64                   EndAddress;
+  LIST_ENTRY               *Link;
+  PENDING_FREE_PAGE_TABLE  *PendingFree;
+
+  MergedPageSize = mVtdUnitInformation[VtdIndex].MergedPageSize;
+  if (MergedPageSize != 0) {
+    EndAddress  = ALIGN_VALUE (BaseAddress + Length, MergedPageSize);
+    BaseAddress = ALIGN_VALUE_LOW (BaseAddress, MergedPageSize);
+    Length      = EndAddress - BaseAddress;
+  }
+
+  if (mVtdUnitInformation[VtdIndex].HasDirtyContext) {
     InvalidateVtdIOTLBGlobal (VtdIndex);
+  } else if (mVtdUnitInformation[VtdIndex].HasDirtyPages) {
+    InvalidateVtdIOTLBPage (VtdIndex, DomainIdentifier, BaseAddress, Length);
   }
   mVtdUnitInformation[VtdIndex].HasDirtyContext = FALSE;
   mVtdUnitInformation[VtdIndex].HasDirtyPages = FALSE;
+  mVtdUnitInformation[VtdIndex].MergedPageSize = 0;
+
+  Link = GetFirstNode (&mPendingFreePageTables);
+  while (!IsNull (&mPendingFreePageTables, Link)) {
+    PendingFree = BASE_CR (Link, PENDING_FREE_PAGE_TABLE, Link);
+    Link = GetNextNode (&mPendingFreePageTables, Link);
+    if (PendingFree->VtdIndex == VtdIndex) {
+      RemoveEntryList (&PendingFree->Link);
+      FreePages (PendingFree->PageTable, 1);
+      FreePool (PendingFree);
+    }
+  }
 }
 
 #define VTD_PG_R                   BIT0
@@ -824,6 +926,151 @@ SplitSecondLevelPage (
   }
 }
 
+/**
+  This function merges the small page entries of one page table back into a
+  single large page entry, if they map the large page contiguously with the
+  same attributes.
+
+  The page table is not freed here. It is queued and freed by
+  InvalidatePageEntry() once the hardware caches have been invalidated.
+
+  @param[in]  VtdIndex         The index used to identify a VTd engine.
+  @param[in]  PageEntry        The page entry pointing to the small page table.
+  @param[in]  MergeAttribute   The page attribute of the merged page entry.
+
+  @retval TRUE   The page entry is merged.
+  @retval FALSE  The page entry is not merged.
+**/
+BOOLEAN
+MergeSecondLevelPage (
+  IN  UINTN                             VtdIndex,
+  IN  VTD_SECOND_LEVEL_PAGING_ENTRY     *PageEntry,
+  IN  PAGE_ATTRIBUTE                    MergeAttribute
+  )
+{
+  UINT64                   *SubPageEntry;
+  UINT64                   SubPageLength;
+  UINT64                   SubPageFlags;
+  UINT64                   AddressMask;
+  UINT64                   BaseAddress;
+  UINT64                   Attribute;
+  UINTN                    Index;
+  PENDING_FREE_PAGE_TABLE  *PendingFree;
+
+  if (((PageEntry->Uint64 & VTD_PG_PS) != 0) || ((PageEntry->Uint64 & PAGING_4K_ADDRESS_MASK_64) == 0)) {
+    return FALSE;
+  }
+
+  if (MergeAttribute == Page2M) {
+    //
+    // Merge 4K to 2M
+    //
+    SubPageLength = SIZE_4KB;
+    SubPageFlags  = 0;
+    AddressMask   = PAGING_2M_ADDRESS_MASK_64;
+  } else if (MergeAttribute == Page1G) {
+    //
+    // Merge 2M to 1G, only if the VTd engine supports 1G pages.
+    //
+    if ((mVtdUnitInformation[VtdIndex].CapReg.Bits.SLLPS & BIT1) == 0) {
+      return FALSE;
+    }
+    SubPageLength = SIZE_2MB;
+    SubPageFlags  = VTD_PG_PS;
+    AddressMask   = PAGING_1G_ADDRESS_MASK_64;
+  } else {
+    return FALSE;
+  }
+
+  SubPageEntry = (UINT64 *)(UINTN)(PageEntry->Uint64 & PAGING_4K_ADDRESS_MASK_64);
+  BaseAddress  = SubPageEntry[0] & AddressMask;
+  Attribute    = SubPageEntry[0] & PAGE_PROGATE_BITS;
+  for (Index = 0; Index < SIZE_4KB / sizeof(UINT64); Index++) {
+    if (SubPageEntry[Index] != ((BaseAddress + SubPageLength * Index) | SubPageFlags | Attribute)) {
+      return FALSE;
+    }
+  }
+
+  PendingFree = AllocatePool (sizeof (PENDING_FREE_PAGE_TABLE));
+  if (PendingFree == NULL) {
+    return FALSE;
+  }
+  PendingFree->VtdIndex  = VtdIndex;
+  PendingFree->PageTable = SubPageEntry;
+  InsertTailList (&mPendingFreePageTables, &PendingFree->Link);
+
+  DEBUG ((DEBUG_VERBOSE, "Merge - 0x%x\n", SubPageEntry));
+  PageEntry->Uint64 = BaseAddress | VTD_PG_PS | Attribute;
+  FlushPageTableMemory (VtdIndex, (UINTN)PageEntry, sizeof(*PageEntry));
+
+  if (mVtdUnitInformation[VtdIndex].MergedPageSize < PageAttributeToLength (MergeAttribute)) {
+    mVtdUnitInformation[VtdIndex].MergedPageSize = PageAttributeToLength (MergeAttribute);
+  }
+  mVtdUnitInformation[VtdIndex].HasDirtyPages = TRUE;
+  return TRUE;
+}
+
+/**
+  Merge the split pages around a modified memory range back into large pages
+  where the range has become uniform again.
+
+  @param[in]  VtdIndex                The index used to identify a VTd engine.
+  @param[in]  SecondLevelPagingEntry  The second level paging entry in VTd table for the device.
+  @param[in]  BaseAddress             The base of the modified memory range.
+  @param[in]  Length                  The length of the modified memory range.
+**/
+VOID
+MergeSecondLevelPageRange (
+  IN UINTN                         VtdIndex,
+  IN VTD_SECOND_LEVEL_PAGING_ENTRY *SecondLevelPagingEntry,
+  IN UINT64                        BaseAddress,
+  IN UINT64                        Length
+  )
+{
+  UINT64                         Address;
+  UINT64                         EndAddress;
+  UINT64                         *L4PageTable;
+  UINT64                         *L3PageTable;
+  UINT64                         *L2PageTable;
+
+  Address    = ALIGN_VALUE_LOW (BaseAddress, SIZE_2MB);
+  EndAddress = BaseAddress + Length;
+
+  while (Address < EndAddress) {
+    if (mVtdUnitInformation[VtdIndex].Is5LevelPaging) {
+      L4PageTable = (UINT64 *)(UINTN)(((UINT64 *)SecondLevelPagingEntry)[(UINTN)RShiftU64 (Address, 48) & PAGING_VTD_INDEX_MASK] & PAGING_4K_ADDRESS_MASK_64);
+    } else {
+      L4PageTable = (UINT64 *)SecondLevelPagingEntry;
+    }
+    L3PageTable = NULL;
+    if (L4PageTable != NULL) {
+      L3PageTable = (UINT64 *)(UINTN)(L4PageTable[(UINTN)RShiftU64 (Address, 39) & PAGING_VTD_INDEX_MASK] & PAGING_4K_ADDRESS_MASK_64);
+    }
+    if (L3PageTable == NULL) {
+      Address = ALIGN_VALUE_LOW (Address, SIZE_1GB) + SIZE_1GB;
+      continue;
+    }
+
+    L3PageTable = &L3PageTable[(UINTN)RShiftU64 (Address, 30) & PAGING_VTD_INDEX_MASK];
+    L2PageTable = (UINT64 *)(UINTN)(*L3PageTable & PAGING_4K_ADDRESS_MASK_64);
+    if (((*L3PageTable & VTD_PG_PS) != 0) || (L2PageTable == NULL)) {
+      Address = ALIGN_VALUE_LOW (Address, SIZE_1GB) + SIZE_1GB;
+      continue;
+    }
+
+    do {
+      MergeSecondLevelPage (
+        VtdIndex,
+        (VTD_SECOND_LEVEL_PAGING_ENTRY *)&L2PageTable[(UINTN)RShiftU64 (Address, 21) & PAGING_VTD_INDEX_MASK],
+        Page2M
+        );
+      Address += SIZE_2MB;
+    } while ((Address < EndAddress) && ((Address & PAGING_1G_MASK) != 0));
+
+    MergeSecondLevelPage (VtdIndex, (VTD_SECOND_LEVEL_PAGING_ENTRY *)L3PageTable, Page1G);
+  }
+}
+
 /**
   Set VTd attribute for a system memory on second level page entry
 
@@ -860,6 +1107,8 @@ SetSecondLevelPagingAttribute (
   PAGE_ATTRIBUTE                 SplitAttribute;
   EFI_STATUS                     Status;
   BOOLEAN                        IsEntryModified;
+  UINT64                         MergeBase;
+  UINT64                         MergeLength;
 
   DEBUG ((DEBUG_VERBOSE,"SetSecondLevelPagingAttribute (%d) (0x%016lx - 0x%016lx : %x) \n", VtdIndex, BaseAddress, Length, IoMmuAccess));
   DEBUG ((DEBUG_VERBOSE,"  SecondLevelPagingEntry Base - 0x%x\n", SecondLevelPagingEntry));
@@ -873,6 +1122,8 @@ SetSecondLevelPagingAttribute (
     return EFI_UNSUPPORTED;
   }
 
+  MergeBase   = BaseAddress;
+  MergeLength = Length;
   while (Length != 0) {
     PageEntry = GetSecondLevelPageTableEntry (VtdIndex, SecondLevelPagingEntry, BaseAddress, mVtdUnitInformation[VtdIndex].Is5LevelPaging, &PageAttribute);
     if (PageEntry == NULL) {
@@ -905,6 +1156,11 @@ SetSecondLevelPagingAttribute (
     }
   }
 
+  //
+  // The range may have made a split page uniform again
+  //
+  MergeSecondLevelPageRange (VtdIndex, SecondLevelPagingEntry, MergeBase, MergeLength);
+
   return EFI_SUCCESS;
 }
 
@@ -1002,7 +1258,10 @@ SetAccessAttribute (
 
   if (ExtContextEntry != NULL) {
     if (ExtContextEntry->Bits.Present == 0) {
-      SecondLevelPagingEntry = CreateSecondLevelPagingEntry (VtdIndex, 0, mVtdUnitInformation[VtdIndex].Is5LevelPaging);
+      SecondLevelPagingEntry = CreateSecondLevelPagingRoot (VtdIndex);
+      if (SecondLevelPagingEntry == NULL) {
+        return EFI_OUT_OF_RESOURCES;
+      }
       DEBUG ((DEBUG_VERBOSE,"SecondLevelPagingEntry - 0x%x (S%04x B%02x D%02x F%02x) New\n", SecondLevelPagingEntry, Segment, SourceId.Bits.Bus, SourceId.Bits.Device, SourceId.Bits.Function));
       Pt = (UINT64)RShiftU64 ((UINT64)(UINTN)SecondLevelPagingEntry, 12);
 
@@ -1019,7 +1278,10 @@ SetAccessAttribute (
     }
   } else if (ContextEntry != NULL) {
     if (ContextEntry->Bits.Present == 0) {
-      SecondLevelPagingEntry = CreateSecondLevelPagingEntry (VtdIndex, 0, mVtdUnitInformation[VtdIndex].Is5LevelPaging);
+      SecondLevelPagingEntry = CreateSecondLevelPagingRoot (VtdIndex);
+      if (SecondLevelPagingEntry == NULL) {
+        return EFI_OUT_OF_RESOURCES;
+      }
       DEBUG ((DEBUG_VERBOSE,"SecondLevelPagingEntry - 0x%x (S%04x B%02x D%02x F%02x) New\n", SecondLevelPagingEntry, Segment, SourceId.Bits.Bus, SourceId.Bits.Device, SourceId.Bits.Function));
       Pt = (UINT64)RShiftU64 ((UINT64)(UINTN)SecondLevelPagingEntry, 12);
 
@@ -1054,7 +1316,7 @@ SetAccessAttribute (
     }
   }
 
-  InvalidatePageEntry (VtdIndex);
+  InvalidatePageEntry (VtdIndex, DomainIdentifier, BaseAddress, Length);
 
   return EFI_SUCCESS;
 }
@@ -278,6 +278,108 @@ InvalidateVtdIOTLBGlobal (
   //
   if (mVtdUnitInformation[VtdIndex].HasDirtyContext || mVtdUnitInformation[VtdIndex].HasDirtyPages) {
     InvalidateIOTLB (VtdIndex);
+    mVtdUnitInformation[VtdIndex].GlobalIotlbInvalidations++;
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Invalid the VTd IOTLB entries of a domain for a memory range.
+
+  A single page-selective-within-domain invalidation is issued, covering the
+  smallest naturally aligned power-of-2 region that contains the range. If the
+  hardware does not support page-selective invalidation, or the region exceeds
+  the maximum address mask, the whole domain is invalidated instead.
+
+  @param[in]  VtdIndex              The index of VTd engine.
+  @param[in]  DomainIdentifier      The domain ID whose translations changed.
+  @param[in]  BaseAddress           The base of the memory range.
+  @param[in]  Length                The length of the memory range.
+
+  @retval EFI_SUCCESS           VTd IOTLB entries are invalidated.
+  @retval EFI_DEVICE_ERROR      VTd IOTLB entries are not invalidated.
+**/
+EFI_STATUS
+InvalidateVtdIOTLBPage (
+  IN UINTN   VtdIndex,
+  IN UINT16  DomainIdentifier,
+  IN UINT64  BaseAddress,
+  IN UINT64  Length
+  )
+{
+  VTD_UNIT_INFORMATION  *VtdUnitInfo;
+  UINTN                 IotlbRegAddress;
+  UINT64                Reg64;
+  UINT64                Granularity;
+  UINT8                 AddressMask;
+  QI_256_DESC           QiDesc;
+
+  if (!mVtdEnabled) {
+    return EFI_SUCCESS;
+  }
+
+  VtdUnitInfo = &mVtdUnitInformation[VtdIndex];
+
+  DEBUG((DEBUG_VERBOSE, "InvalidateVtdIOTLBPage(%d) DID 0x%x (0x%016lx - 0x%lx)\n", VtdIndex, DomainIdentifier, BaseAddress, Length));
+
+  //
+  // Find the smallest naturally aligned region of 2^AddressMask pages covering the range
+  //
+  AddressMask = 0;
+  while ((AddressMask < 52) &&
+         (RShiftU64 (BaseAddress, VTD_PAGE_SHIFT + AddressMask) != RShiftU64 (BaseAddress + Length - 1, VTD_PAGE_SHIFT + AddressMask))) {
+    AddressMask++;
+  }
+  BaseAddress &= ~(LShiftU64 (VTD_PAGE_SIZE, AddressMask) - 1);
+
+  if ((VtdUnitInfo->CapReg.Bits.PSI != 0) && (AddressMask <= VtdUnitInfo->CapReg.Bits.MAMV)) {
+    Granularity = 3;
+  } else {
+    Granularity = 2;
+    BaseAddress = 0;
+    AddressMask = 0;
+  }
+
+  //
+  // Write Buffer Flush before invalidation
+  //
+  VtdLibFlushWriteBuffer (VtdUnitInfo->VtdUnitBaseAddress);
+
+  VtdUnitInfo->SelectiveIotlbInvalidations++;
+
+  if (VtdUnitInfo->EnableQueuedInvalidation == 0) {
+    //
+    // Register-based Invalidation
+    //
+    IotlbRegAddress = VtdUnitInfo->VtdUnitBaseAddress + (VtdUnitInfo->ECapReg.Bits.IRO * 16);
+    Reg64 = MmioRead64 (IotlbRegAddress + R_IOTLB_REG);
+    if ((Reg64 & B_IOTLB_REG_IVT) != 0) {
+      DEBUG ((DEBUG_ERROR,"ERROR: InvalidateVtdIOTLBPage: B_IOTLB_REG_IVT is set for VTD(%d)\n", VtdIndex));
+      return EFI_DEVICE_ERROR;
+    }
+
+    if (Granularity == 3) {
+      MmioWrite64 (IotlbRegAddress + R_IVA_REG, BaseAddress | AddressMask);
+    }
+
+    Reg64 &= ((~B_IOTLB_REG_IVT) & (~B_IOTLB_REG_IIRG_MASK) & (~LShiftU64 (0xFFFF, 32)));
+    Reg64 |= (B_IOTLB_REG_IVT | ((Granularity == 3) ? V_IOTLB_REG_IIRG_PAGE : V_IOTLB_REG_IIRG_DOMAIN) | LShiftU64 (DomainIdentifier, 32));
+    MmioWrite64 (IotlbRegAddress + R_IOTLB_REG, Reg64);
+
+    do {
+      Reg64 = MmioRead64 (IotlbRegAddress + R_IOTLB_REG);
+    } while ((Reg64 & B_IOTLB_REG_IVT) != 0);
+  } else {
+    //
+    // Queued Invalidation
+    //
+    QiDesc.Uint64[0] = QI_IOTLB_DID(DomainIdentifier) | QI_IOTLB_DR(CAP_READ_DRAIN(VtdUnitInfo->CapReg.Uint64)) | QI_IOTLB_DW(CAP_WRITE_DRAIN(VtdUnitInfo->CapReg.Uint64)) | QI_IOTLB_GRAN(Granularity) | QI_IOTLB_TYPE;
+    QiDesc.Uint64[1] = QI_IOTLB_ADDR(BaseAddress) | QI_IOTLB_IH(0) | QI_IOTLB_AM(AddressMask);
+    QiDesc.Uint64[2] = 0;
+    QiDesc.Uint64[3] = 0;
+
+    return SubmitQueuedInvalidationDescriptor(VtdUnitInfo->VtdUnitBaseAddress, &QiDesc);
   }
 
   return EFI_SUCCESS;
@@ -291,13 +291,20 @@ AddMadtTable (
   New += sizeof (EFI_ACPI_6_0_MULTIPLE_APIC_DESCRIPTION_TABLE_HEADER);
 
   // Add new GICC structures for the Cores
-  for (CoreIndex = 0; CoreIndex < PcdGet32 (PcdCoreCount); CoreIndex++) {
+  for (CoreIndex = 0; CoreIndex < NumCores; CoreIndex++) {
     EFI_ACPI_6_0_GIC_STRUCTURE *GiccPtr;
+    CONST FDT_HELPER_CPU_INFO  *CpuInfo;
 
     CopyMem (New, &Gicc, sizeof (EFI_ACPI_6_0_GIC_STRUCTURE));
     GiccPtr = (EFI_ACPI_6_0_GIC_STRUCTURE *) New;
     GiccPtr->AcpiProcessorUid = CoreIndex;
-    GiccPtr->MPIDR = FdtHelperGetMpidr (CoreIndex);
+    CpuInfo = FdtHelperGetCpuInfo (CoreIndex);
+    if (CpuInfo != NULL) {
+      GiccPtr->MPIDR = CpuInfo->Mpidr;
+      if (!CpuInfo->Enabled) {
+        GiccPtr->Flags = 0;
+      }
+    }
     New += sizeof (EFI_ACPI_6_0_GIC_STRUCTURE);
   }
 
@@ -485,26 +492,42 @@ AddSsdtTable (
 
 /*
  * A function that adds the PPTT ACPI table.
+ *
+ * The processor hierarchy follows the socket/cluster/core/thread layout of
+ * the cpu-map in the device tree. Qemu numbers its CPUs linearly through
+ * that hierarchy, so a new package/cluster/core node is started whenever the
+ * corresponding level of the topology changes from one CPU to the next.
+ * Each core has private L1 caches and each cluster a private L2.
  */
 EFI_STATUS
 AddPpttTable (
   IN EFI_ACPI_TABLE_PROTOCOL   *AcpiTable
   )
 {
-  EFI_STATUS            Status;
-  UINTN                 TableHandle;
-  UINT32                TableSize;
-  EFI_PHYSICAL_ADDRESS  PageAddress;
-  UINT8                 *New;
-  UINT32                CpuId;
-  UINT32                NumCores = PcdGet32 (PcdCoreCount);
+  EFI_STATUS                 Status;
+  UINTN                      TableHandle;
+  UINT32                     TableSize;
+  EFI_PHYSICAL_ADDRESS       PageAddress;
+  UINT8                      *New;
+  UINT32                     CpuId;
+  UINT32                     NumCores = PcdGet32 (PcdCoreCount);
+  FDT_HELPER_CPU_TOPOLOGY    *Topology;
+  BOOLEAN                    HasThreads;
+  BOOLEAN                    NewPackage;
+  BOOLEAN                    NewCluster;
+  BOOLEAN                    NewCore;
+  UINT32                     PackageOffset;
+  UINT32                     ClusterOffset;
+  UINT32                     CoreOffset;
 
   EFI_ACPI_6_3_PPTT_STRUCTURE_CACHE L1DCache = SBSAQEMU_ACPI_PPTT_L1_D_CACHE_STRUCT;
   EFI_ACPI_6_3_PPTT_STRUCTURE_CACHE L1ICache = SBSAQEMU_ACPI_PPTT_L1_I_CACHE_STRUCT;
   EFI_ACPI_6_3_PPTT_STRUCTURE_CACHE L2Cache = SBSAQEMU_ACPI_PPTT_L2_CACHE_STRUCT;
 
+  EFI_ACPI_6_3_PPTT_STRUCTURE_PROCESSOR Package = SBSAQEMU_ACPI_PPTT_PACKAGE_STRUCT;
   EFI_ACPI_6_3_PPTT_STRUCTURE_PROCESSOR Cluster = SBSAQEMU_ACPI_PPTT_CLUSTER_STRUCT;
   EFI_ACPI_6_3_PPTT_STRUCTURE_PROCESSOR Core = SBSAQEMU_ACPI_PPTT_CORE_STRUCT;
+  EFI_ACPI_6_3_PPTT_STRUCTURE_PROCESSOR Thread = SBSAQEMU_ACPI_PPTT_THREAD_STRUCT;
 
   EFI_ACPI_DESCRIPTION_HEADER Header =
     SBSAQEMU_ACPI_HEADER (
@@ -512,11 +535,27 @@ AddPpttTable (
       EFI_ACPI_DESCRIPTION_HEADER,
       EFI_ACPI_6_3_PROCESSOR_PROPERTIES_TOPOLOGY_TABLE_REVISION);
 
+  Topology = AllocatePool (sizeof (FDT_HELPER_CPU_TOPOLOGY) * NumCores);
+  if (Topology == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Status = FdtHelperGetCpuTopology (Topology, NumCores, &HasThreads);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_INFO, "No cpu-map in device tree, assuming a single cluster\n"));
+  }
+
+  if (HasThreads) {
+    // Cores are no longer leaves, the threads below them are
+    Core.Flags.AcpiProcessorIdValid = EFI_ACPI_6_3_PPTT_PROCESSOR_ID_INVALID;
+    Core.Flags.NodeIsALeaf = EFI_ACPI_6_3_PPTT_NODE_IS_NOT_LEAF;
+  }
+
+  // Size for the worst case, where each CPU sits in its own package,
+  // cluster and core. The actual length is set once the table is built.
   TableSize = sizeof (EFI_ACPI_DESCRIPTION_HEADER) +
-    sizeof (EFI_ACPI_6_3_PPTT_STRUCTURE_PROCESSOR) +
     (sizeof (EFI_ACPI_6_3_PPTT_STRUCTURE_CACHE) * 3) +
-    (sizeof (EFI_ACPI_6_3_PPTT_STRUCTURE_PROCESSOR) * NumCores) +
-    (sizeof (UINT32) * 2 * NumCores);
+    ((Package.Length + Cluster.Length + Core.Length + Thread.Length) * NumCores);
 
   Status = gBS->AllocatePages (
                   AllocateAnyPages,
@@ -526,6 +565,7 @@ AddPpttTable (
                   );
   if (EFI_ERROR(Status)) {
     DEBUG ((DEBUG_ERROR, "Failed to allocate pages for PPTT table\n"));
+    FreePool (Topology);
     return EFI_OUT_OF_RESOURCES;
   }
 
@@ -534,21 +574,14 @@ AddPpttTable (
 
   // Add the ACPI Description table header
   CopyMem (New, &Header, sizeof (EFI_ACPI_DESCRIPTION_HEADER));
-  ((EFI_ACPI_DESCRIPTION_HEADER*) New)->Length = TableSize;
   New += sizeof (EFI_ACPI_DESCRIPTION_HEADER);
 
-  // Add the Cluster PPTT structure
-  CopyMem (New, &Cluster, sizeof (EFI_ACPI_6_3_PPTT_STRUCTURE_PROCESSOR));
-  New += sizeof (EFI_ACPI_6_3_PPTT_STRUCTURE_PROCESSOR);
-
-  // Add L1 D Cache structure
+  // Add L1 D Cache structure. L2 is found through the cluster.
   CopyMem (New, &L1DCache, sizeof (EFI_ACPI_6_3_PPTT_STRUCTURE_CACHE));
-  ((EFI_ACPI_6_3_PPTT_STRUCTURE_CACHE*) New)->NextLevelOfCache = L2_CACHE_INDEX;
   New += sizeof (EFI_ACPI_6_3_PPTT_STRUCTURE_CACHE);
 
   // Add L1 I Cache structure
   CopyMem (New, &L1ICache, sizeof (EFI_ACPI_6_3_PPTT_STRUCTURE_CACHE));
-  ((EFI_ACPI_6_3_PPTT_STRUCTURE_CACHE*) New)->NextLevelOfCache = L2_CACHE_INDEX;
   New += sizeof (EFI_ACPI_6_3_PPTT_STRUCTURE_CACHE);
 
   // Add L2 Cache structure
@@ -556,22 +589,71 @@ AddPpttTable (
   ((EFI_ACPI_6_3_PPTT_STRUCTURE_CACHE*) New)->NextLevelOfCache = 0; /* L2 is LLC */
   New += sizeof (EFI_ACPI_6_3_PPTT_STRUCTURE_CACHE);
 
+  ASSERT ((New - (UINT8 *)(UINTN) PageAddress) == PROCESSOR_INDEX);
+
+  PackageOffset = 0;
+  ClusterOffset = 0;
+  CoreOffset = 0;
+
   for (CpuId = 0; CpuId < NumCores; CpuId++) {
-    EFI_ACPI_6_3_PPTT_STRUCTURE_PROCESSOR *CorePtr;
+    EFI_ACPI_6_3_PPTT_STRUCTURE_PROCESSOR *NodePtr;
     UINT32                                *PrivateResourcePtr;
 
-    CopyMem (New, &Core, sizeof (EFI_ACPI_6_3_PPTT_STRUCTURE_PROCESSOR));
-    CorePtr = (EFI_ACPI_6_3_PPTT_STRUCTURE_PROCESSOR *) New;
-    CorePtr->Parent = CLUSTER_INDEX;
-    CorePtr->AcpiProcessorId = CpuId;
-    New += sizeof (EFI_ACPI_6_3_PPTT_STRUCTURE_PROCESSOR);
+    NewPackage = (CpuId == 0) ||
+                 (Topology[CpuId].Socket != Topology[CpuId - 1].Socket);
+    NewCluster = NewPackage ||
+                 (Topology[CpuId].Cluster != Topology[CpuId - 1].Cluster);
+    NewCore    = NewCluster ||
+                 (Topology[CpuId].Core != Topology[CpuId - 1].Core);
+
+    if (NewPackage) {
+      PackageOffset = New - (UINT8 *)(UINTN) PageAddress;
+      CopyMem (New, &Package, sizeof (EFI_ACPI_6_3_PPTT_STRUCTURE_PROCESSOR));
+      NodePtr = (EFI_ACPI_6_3_PPTT_STRUCTURE_PROCESSOR *) New;
+      NodePtr->AcpiProcessorId = Topology[CpuId].Socket;
+      New += Package.Length;
+    }
+
+    if (NewCluster) {
+      ClusterOffset = New - (UINT8 *)(UINTN) PageAddress;
+      CopyMem (New, &Cluster, sizeof (EFI_ACPI_6_3_PPTT_STRUCTURE_PROCESSOR));
+      NodePtr = (EFI_ACPI_6_3_PPTT_STRUCTURE_PROCESSOR *) New;
+      NodePtr->Parent = PackageOffset;
+      New += sizeof (EFI_ACPI_6_3_PPTT_STRUCTURE_PROCESSOR);
+
+      PrivateResourcePtr = (UINT32 *) New;
+      PrivateResourcePtr[0] = L2_CACHE_INDEX;
+      New += sizeof (UINT32);
+    }
+
+    if (NewCore) {
+      CoreOffset = New - (UINT8 *)(UINTN) PageAddress;
+      CopyMem (New, &Core, sizeof (EFI_ACPI_6_3_PPTT_STRUCTURE_PROCESSOR));
+      NodePtr = (EFI_ACPI_6_3_PPTT_STRUCTURE_PROCESSOR *) New;
+      NodePtr->Parent = ClusterOffset;
+      NodePtr->AcpiProcessorId = HasThreads ? 0 : CpuId;
+      New += sizeof (EFI_ACPI_6_3_PPTT_STRUCTURE_PROCESSOR);
+
+      PrivateResourcePtr = (UINT32 *) New;
+      PrivateResourcePtr[0] = L1_D_CACHE_INDEX;
+      PrivateResourcePtr[1] = L1_I_CACHE_INDEX;
+      New += (2 * sizeof (UINT32));
+    }
 
-    PrivateResourcePtr = (UINT32 *) New;
-    PrivateResourcePtr[0] = L1_D_CACHE_INDEX;
-    PrivateResourcePtr[1] = L1_I_CACHE_INDEX;
-    New += (2 * sizeof (UINT32));
+    if (HasThreads) {
+      CopyMem (New, &Thread, sizeof (EFI_ACPI_6_3_PPTT_STRUCTURE_PROCESSOR));
+      NodePtr = (EFI_ACPI_6_3_PPTT_STRUCTURE_PROCESSOR *) New;
+      NodePtr->Parent = CoreOffset;
+      NodePtr->AcpiProcessorId = CpuId;
+      New += sizeof (EFI_ACPI_6_3_PPTT_STRUCTURE_PROCESSOR);
+    }
   }
 
+  FreePool (Topology);
+
+  TableSize = New - (UINT8 *)(UINTN) PageAddress;
+  ((EFI_ACPI_DESCRIPTION_HEADER*) PageAddress)->Length = TableSize;
+
   // Perform Checksum
   AcpiPlatformChecksum ((UINT8*) PageAddress, TableSize);
 
@@ -588,6 +670,177 @@ AddPpttTable (
   return Status;
 }
 
+/*
+ * A function that adds the SRAT ACPI table.
+ */
+EFI_STATUS
+AddSratTable (
+  IN EFI_ACPI_TABLE_PROTOCOL   *AcpiTable
+  )
+{
+  EFI_STATUS            Status;
+  UINTN                 TableHandle;
+  UINT32                TableSize;
+  EFI_PHYSICAL_ADDRESS  PageAddress;
+  UINT8                 *New;
+  UINT32                CpuId;
+  UINT32                NumCores = PcdGet32 (PcdCoreCount);
+  UINTN                 NumMemNodes;
+  UINTN                 MemIndex;
+  UINT64                MemBase;
+  UINT64                MemSize;
+  UINT32                NumaNodeId;
+
+  EFI_ACPI_6_4_SYSTEM_RESOURCE_AFFINITY_TABLE_HEADER Header = {
+    SBSAQEMU_ACPI_HEADER (
+      EFI_ACPI_6_4_SYSTEM_RESOURCE_AFFINITY_TABLE_SIGNATURE,
+      EFI_ACPI_6_4_SYSTEM_RESOURCE_AFFINITY_TABLE_HEADER,
+      EFI_ACPI_6_4_SYSTEM_RESOURCE_AFFINITY_TABLE_REVISION),
+    1,                          // Reserved1, must be 1 for compatibility
+    EFI_ACPI_RESERVED_QWORD     // Reserved2
+  };
+
+  NumMemNodes = 0;
+  while (!EFI_ERROR (FdtHelperGetMemoryNode (NumMemNodes, &MemBase, &MemSize,
+                       &NumaNodeId))) {
+    NumMemNodes++;
+  }
+
+  TableSize = sizeof (EFI_ACPI_6_4_SYSTEM_RESOURCE_AFFINITY_TABLE_HEADER) +
+              (sizeof (EFI_ACPI_6_4_GICC_AFFINITY_STRUCTURE) * NumCores) +
+              (sizeof (EFI_ACPI_6_4_MEMORY_AFFINITY_STRUCTURE) * NumMemNodes);
+
+  Status = gBS->AllocatePages (
+                  AllocateAnyPages,
+                  EfiACPIReclaimMemory,
+                  EFI_SIZE_TO_PAGES (TableSize),
+                  &PageAddress
+                  );
+  if (EFI_ERROR(Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed to allocate pages for SRAT table\n"));
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  New = (UINT8 *)(UINTN) PageAddress;
+  ZeroMem (New, TableSize);
+
+  // Add the ACPI Description table header
+  CopyMem (New, &Header, sizeof (EFI_ACPI_6_4_SYSTEM_RESOURCE_AFFINITY_TABLE_HEADER));
+  ((EFI_ACPI_DESCRIPTION_HEADER*) New)->Length = TableSize;
+  New += sizeof (EFI_ACPI_6_4_SYSTEM_RESOURCE_AFFINITY_TABLE_HEADER);
+
+  // Add a GICC Affinity structure for each core
+  for (CpuId = 0; CpuId < NumCores; CpuId++) {
+    EFI_ACPI_6_4_GICC_AFFINITY_STRUCTURE *GiccAffinity;
+
+    GiccAffinity = (EFI_ACPI_6_4_GICC_AFFINITY_STRUCTURE *) New;
+    GiccAffinity->Type = EFI_ACPI_6_4_GICC_AFFINITY;
+    GiccAffinity->Length = sizeof (EFI_ACPI_6_4_GICC_AFFINITY_STRUCTURE);
+    GiccAffinity->ProximityDomain = FdtHelperGetCpuNumaNodeId (CpuId);
+    GiccAffinity->AcpiProcessorUid = CpuId;
+    GiccAffinity->Flags = EFI_ACPI_6_4_GICC_ENABLED;
+    New += sizeof (EFI_ACPI_6_4_GICC_AFFINITY_STRUCTURE);
+  }
+
+  // Add a Memory Affinity structure for each memory node
+  for (MemIndex = 0; MemIndex < NumMemNodes; MemIndex++) {
+    EFI_ACPI_6_4_MEMORY_AFFINITY_STRUCTURE *MemAffinity;
+
+    FdtHelperGetMemoryNode (MemIndex, &MemBase, &MemSize, &NumaNodeId);
+
+    MemAffinity = (EFI_ACPI_6_4_MEMORY_AFFINITY_STRUCTURE *) New;
+    MemAffinity->Type = EFI_ACPI_6_4_MEMORY;
+    MemAffinity->Length = sizeof (EFI_ACPI_6_4_MEMORY_AFFINITY_STRUCTURE);
+    MemAffinity->ProximityDomain = NumaNodeId;
+    MemAffinity->AddressBaseLow = (UINT32) MemBase;
+    MemAffinity->AddressBaseHigh = (UINT32) (MemBase >> 32);
+    MemAffinity->LengthLow = (UINT32) MemSize;
+    MemAffinity->LengthHigh = (UINT32) (MemSize >> 32);
+    MemAffinity->Flags = (MemSize != 0) ? EFI_ACPI_6_4_MEMORY_ENABLED : 0;
+    New += sizeof (EFI_ACPI_6_4_MEMORY_AFFINITY_STRUCTURE);
+  }
+
+  // Perform Checksum
+  AcpiPlatformChecksum ((UINT8*) PageAddress, TableSize);
+
+  Status = AcpiTable->InstallAcpiTable (
+                        AcpiTable,
+                        (EFI_ACPI_COMMON_HEADER *)PageAddress,
+                        TableSize,
+                        &TableHandle
+                        );
+  if (EFI_ERROR(Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed to install SRAT table\n"));
+  }
+
+  return Status;
+}
+
+/*
+ * A function that adds the SLIT ACPI table.
+ */
+EFI_STATUS
+AddSlitTable (
+  IN EFI_ACPI_TABLE_PROTOCOL   *AcpiTable,
+  IN UINT32                    NumaNodes
+  )
+{
+  EFI_STATUS            Status;
+  UINTN                 TableHandle;
+  UINT32                TableSize;
+  EFI_PHYSICAL_ADDRESS  PageAddress;
+  UINT8                 *New;
+
+  EFI_ACPI_6_4_SYSTEM_LOCALITY_DISTANCE_INFORMATION_TABLE_HEADER Header = {
+    SBSAQEMU_ACPI_HEADER (
+      EFI_ACPI_6_4_SYSTEM_LOCALITY_INFORMATION_TABLE_SIGNATURE,
+      EFI_ACPI_6_4_SYSTEM_LOCALITY_DISTANCE_INFORMATION_TABLE_HEADER,
+      EFI_ACPI_6_4_SYSTEM_LOCALITY_DISTANCE_INFORMATION_TABLE_REVISION),
+    0                           // NumberOfSystemLocalities
+  };
+
+  TableSize = sizeof (EFI_ACPI_6_4_SYSTEM_LOCALITY_DISTANCE_INFORMATION_TABLE_HEADER) +
+              (NumaNodes * NumaNodes);
+
+  Status = gBS->AllocatePages (
+                  AllocateAnyPages,
+                  EfiACPIReclaimMemory,
+                  EFI_SIZE_TO_PAGES (TableSize),
+                  &PageAddress
+                  );
+  if (EFI_ERROR(Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed to allocate pages for SLIT table\n"));
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  New = (UINT8 *)(UINTN) PageAddress;
+  ZeroMem (New, TableSize);
+
+  // Add the ACPI Description table header
+  Header.NumberOfSystemLocalities = NumaNodes;
+  CopyMem (New, &Header, sizeof (EFI_ACPI_6_4_SYSTEM_LOCALITY_DISTANCE_INFORMATION_TABLE_HEADER));
+  ((EFI_ACPI_DESCRIPTION_HEADER*) New)->Length = TableSize;
+  New += sizeof (EFI_ACPI_6_4_SYSTEM_LOCALITY_DISTANCE_INFORMATION_TABLE_HEADER);
+
+  // Add the distance matrix
+  FdtHelperGetNumaDistances (New, NumaNodes);
+
+  // Perform Checksum
+  AcpiPlatformChecksum ((UINT8*) PageAddress, TableSize);
+
+  Status = AcpiTable->InstallAcpiTable (
+                        AcpiTable,
+                        (EFI_ACPI_COMMON_HEADER *)PageAddress,
+                        TableSize,
+                        &TableHandle
+                        );
+  if (EFI_ERROR(Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed to install SLIT table\n"));
+  }
+
+  return Status;
+}
+
 /*
  * A function that adds the GTDT ACPI table.
  */
@@ -759,6 +1012,7 @@ InitializeSbsaQemuAcpiDxe (
   EFI_STATUS                     Status;
   EFI_ACPI_TABLE_PROTOCOL        *AcpiTable;
   UINT32                         NumCores;
+  UINT32                         NumaNodes;
 
   // Parse the device tree and get the number of CPUs
   NumCores = FdtHelperCountCpus ();
@@ -805,6 +1059,22 @@ InitializeSbsaQemuAcpiDxe (
     DEBUG ((DEBUG_ERROR, "Failed to add GTDT table\n"));
   }
 
+  // Only describe the NUMA layout if Qemu was started with -numa
+  NumaNodes = FdtHelperCountNumaNodes ();
+  if (NumaNodes > 0) {
+    Status = AddSratTable (AcpiTable);
+    if (EFI_ERROR (Status)) {
+      DEBUG ((DEBUG_ERROR, "Failed to add SRAT table\n"));
+    }
+  }
+
+  if (NumaNodes > 1) {
+    Status = AddSlitTable (AcpiTable, NumaNodes);
+    if (EFI_ERROR (Status)) {
+      DEBUG ((DEBUG_ERROR, "Failed to add SLIT table\n"));
+    }
+  }
+
   Status = DisableXhciOnOlderPlatVer ();
   if (EFI_ERROR (Status)) {
     DEBUG ((DEBUG_ERROR, "Failed to handle XHCI enablement\n"));
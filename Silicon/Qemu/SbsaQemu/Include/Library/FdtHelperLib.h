@@ -10,6 +10,39 @@
 #ifndef FDT_HELPER_LIB_
 #define FDT_HELPER_LIB_
 
+//
+// Position of a CPU in the socket/cluster/core/thread hierarchy
+//
+typedef struct {
+  UINT32    Socket;
+  UINT32    Cluster;
+  UINT32    Core;
+  UINT32    Thread;
+} FDT_HELPER_CPU_TOPOLOGY;
+
+//
+// Per-CPU information gathered from the device tree
+//
+typedef struct {
+  UINT64                    Mpidr;
+  UINT32                    NumaNodeId;
+  FDT_HELPER_CPU_TOPOLOGY   Topology;
+  BOOLEAN                   Enabled;
+} FDT_HELPER_CPU_INFO;
+
+/**
+  Get the information gathered from the device tree for a given cpu.
+
+  @param [in]   CpuId    Index of cpu to retrieve the information for.
+
+  @retval                Information about CPU at index <CpuId>, or NULL
+                         if there is no such CPU.
+**/
+CONST FDT_HELPER_CPU_INFO *
+FdtHelperGetCpuInfo (
+  IN UINTN   CpuId
+  );
+
 /**
   Get MPIDR for a given cpu from device tree passed by Qemu.
 
@@ -33,4 +66,83 @@ FdtHelperCountCpus (
   VOID
   );
 
+/**
+  Get the NUMA node a given cpu belongs to.
+
+  @param [in]   CpuId    Index of cpu to retrieve the NUMA node for.
+
+  @retval                NUMA node of CPU at index <CpuId>, or 0 if the
+                         device tree has no NUMA information.
+**/
+UINT32
+FdtHelperGetCpuNumaNodeId (
+  IN UINTN   CpuId
+  );
+
+/**
+  Get the range and NUMA node of a memory node.
+
+  @param [in]   Index       Index of the memory node.
+  @param [out]  Base        Base address of the memory.
+  @param [out]  Size        Size of the memory.
+  @param [out]  NumaNodeId  NUMA node the memory belongs to.
+
+  @retval EFI_SUCCESS       The memory node was found.
+  @retval EFI_NOT_FOUND     There are fewer than Index + 1 memory nodes.
+**/
+EFI_STATUS
+FdtHelperGetMemoryNode (
+  IN  UINTN   Index,
+  OUT UINT64  *Base,
+  OUT UINT64  *Size,
+  OUT UINT32  *NumaNodeId
+  );
+
+/** Get the number of NUMA nodes described by the device tree.
+
+    @return The highest numa-node-id used by a CPU or memory node plus one,
+            or 0 if the device tree has no NUMA information.
+**/
+UINT32
+FdtHelperCountNumaNodes (
+  VOID
+  );
+
+/** Get the distances between NUMA nodes from /distance-map.
+
+    Nodes not covered by the distance matrix default to 10 (local)
+    and 20 (remote), as per the ACPI specification.
+
+    @param [out]  Distances     NodeCount x NodeCount matrix of distances.
+    @param [in]   NodeCount     Number of NUMA nodes.
+**/
+VOID
+FdtHelperGetNumaDistances (
+  OUT UINT8   *Distances,
+  IN  UINT32  NodeCount
+  );
+
+/** Get the socket/cluster/core/thread position of every CPU from the
+    /cpus/cpu-map node.
+
+    CPUs not covered by the cpu-map are left as socket 0, cluster 0,
+    core <CpuId>, thread 0.
+
+    @param [out]  Topology      Array of CpuCount entries to fill in.
+    @param [in]   CpuCount      Number of CPUs, as returned by
+                                FdtHelperCountCpus ().
+    @param [out]  HasThreads    Set to TRUE if the cpu-map describes SMT
+                                threads.
+
+    @retval EFI_SUCCESS         The topology was read from the cpu-map.
+    @retval EFI_NOT_FOUND       There is no cpu-map; Topology describes a
+                                single cluster.
+**/
+EFI_STATUS
+FdtHelperGetCpuTopology (
+  OUT FDT_HELPER_CPU_TOPOLOGY   *Topology,
+  IN  UINT32                    CpuCount,
+  OUT BOOLEAN                   *HasThreads
+  );
+
 #endif /* FDT_HELPER_LIB_ */
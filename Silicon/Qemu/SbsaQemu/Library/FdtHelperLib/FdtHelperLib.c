@@ -9,13 +9,377 @@
 **/
 
 #include <Uefi.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
 #include <Library/DebugLib.h>
 #include <Library/FdtHelperLib.h>
+#include <Library/MemoryAllocationLib.h>
 #include <Library/PcdLib.h>
 #include <libfdt.h>
 
-STATIC INT32 mFdtFirstCpuOffset;
-STATIC INT32 mFdtCpuNodeSize;
+//
+// Per-CPU information, gathered in a single pass over /cpus the first time
+// any of the CPU helpers is called. The node offsets are kept alongside,
+// sorted, so cpu-map phandles can be mapped back to a CPU index.
+//
+STATIC FDT_HELPER_CPU_INFO  *mCpuInfo;
+STATIC INT32                *mCpuNodeOffsets;
+STATIC UINT32               mCpuCount;
+STATIC BOOLEAN              mCpuMapFound;
+STATIC BOOLEAN              mCpuHasThreads;
+
+/**
+  Check whether a node is a CPU node, as opposed to e.g. /cpus/cpu-map.
+
+  @param [in]   DeviceTreeBase  Device tree blob.
+  @param [in]   Node            Node offset.
+
+  @retval TRUE                  Node is a CPU node.
+**/
+STATIC
+BOOLEAN
+IsCpuNode (
+  IN CONST VOID   *DeviceTreeBase,
+  IN INT32        Node
+  )
+{
+  CONST CHAR8   *Type;
+  INT32         Len;
+
+  Type = fdt_getprop (DeviceTreeBase, Node, "device_type", &Len);
+  return (Type != NULL && AsciiStrnCmp (Type, "cpu", Len) == 0);
+}
+
+/**
+  Read the numa-node-id property of a node.
+
+  @param [in]   DeviceTreeBase  Device tree blob.
+  @param [in]   Node            Node offset.
+  @param [out]  NumaNodeId      NUMA node of the device.
+
+  @retval TRUE                  The node has a numa-node-id property.
+**/
+STATIC
+BOOLEAN
+GetNumaNodeId (
+  IN  CONST VOID  *DeviceTreeBase,
+  IN  INT32       Node,
+  OUT UINT32      *NumaNodeId
+  )
+{
+  CONST UINT32  *Prop;
+  INT32         Len;
+
+  Prop = fdt_getprop (DeviceTreeBase, Node, "numa-node-id", &Len);
+  if (Prop == NULL || Len != sizeof (UINT32)) {
+    *NumaNodeId = 0;
+    return FALSE;
+  }
+
+  *NumaNodeId = fdt32_to_cpu (ReadUnaligned32 (Prop));
+  return TRUE;
+}
+
+/**
+  Find the index of the Nth memory node in the device tree.
+
+  @param [in]   DeviceTreeBase  Device tree blob.
+  @param [in]   Index           Index of the memory node to find.
+
+  @return                       Node offset, or a negative value if there
+                                are fewer than Index + 1 memory nodes.
+**/
+STATIC
+INT32
+FindMemoryNode (
+  IN CONST VOID   *DeviceTreeBase,
+  IN UINTN        Index
+  )
+{
+  INT32   Node;
+
+  Node = fdt_node_offset_by_prop_value (DeviceTreeBase, -1, "device_type",
+           "memory", sizeof ("memory"));
+  while (Node >= 0 && Index-- > 0) {
+    Node = fdt_node_offset_by_prop_value (DeviceTreeBase, Node, "device_type",
+             "memory", sizeof ("memory"));
+  }
+
+  return Node;
+}
+
+/**
+  Parse the index out of a cpu-map node name, e.g. 3 for "cluster3".
+
+  @param [in]   DeviceTreeBase  Device tree blob.
+  @param [in]   Node            Node offset.
+  @param [in]   Prefix          Expected name prefix.
+  @param [out]  Index           Index following the prefix.
+
+  @retval TRUE                  The node name starts with Prefix.
+**/
+STATIC
+BOOLEAN
+GetCpuMapIndex (
+  IN  CONST VOID    *DeviceTreeBase,
+  IN  INT32         Node,
+  IN  CONST CHAR8   *Prefix,
+  OUT UINT32        *Index
+  )
+{
+  CONST CHAR8   *Name;
+  UINTN         PrefixLen;
+
+  Name = fdt_get_name (DeviceTreeBase, Node, NULL);
+  PrefixLen = AsciiStrLen (Prefix);
+  if (Name == NULL || AsciiStrnCmp (Name, Prefix, PrefixLen) != 0) {
+    return FALSE;
+  }
+
+  *Index = (UINT32)AsciiStrDecimalToUintn (Name + PrefixLen);
+  return TRUE;
+}
+
+/**
+  Find the index of a CPU from the offset of its node.
+
+  @param [in]   Node     Offset of the CPU node.
+
+  @return                Index of the CPU, or -1 if Node is not a CPU node.
+**/
+STATIC
+INTN
+FindCpuByNode (
+  IN INT32    Node
+  )
+{
+  UINTN   Low;
+  UINTN   High;
+  UINTN   Mid;
+
+  // Nodes are visited in offset order, so the table is sorted.
+  Low = 0;
+  High = mCpuCount;
+  while (Low < High) {
+    Mid = (Low + High) / 2;
+    if (mCpuNodeOffsets[Mid] == Node) {
+      return Mid;
+    }
+    if (mCpuNodeOffsets[Mid] < Node) {
+      Low = Mid + 1;
+    } else {
+      High = Mid;
+    }
+  }
+
+  return -1;
+}
+
+/**
+  Record the position of the CPU a cpu-map leaf node refers to.
+
+  @param [in]   DeviceTreeBase  Device tree blob.
+  @param [in]   Node            cpu-map leaf node.
+  @param [in]   Position        Socket/cluster/core/thread of the leaf.
+
+  @retval TRUE                  The leaf refers to a known CPU.
+**/
+STATIC
+BOOLEAN
+SetCpuTopology (
+  IN  CONST VOID                *DeviceTreeBase,
+  IN  INT32                     Node,
+  IN  FDT_HELPER_CPU_TOPOLOGY   *Position
+  )
+{
+  CONST UINT32  *Phandle;
+  INT32         Len;
+  INTN          CpuId;
+
+  Phandle = fdt_getprop (DeviceTreeBase, Node, "cpu", &Len);
+  if (Phandle == NULL || Len != sizeof (UINT32)) {
+    return FALSE;
+  }
+
+  CpuId = FindCpuByNode (fdt_node_offset_by_phandle (DeviceTreeBase,
+                           fdt32_to_cpu (ReadUnaligned32 (Phandle))));
+  if (CpuId < 0) {
+    return FALSE;
+  }
+
+  CopyMem (&mCpuInfo[CpuId].Topology, Position, sizeof (*Position));
+  return TRUE;
+}
+
+/**
+  Fill in the topology of each CPU from the /cpus/cpu-map node.
+
+  @param [in]   DeviceTreeBase  Device tree blob.
+**/
+STATIC
+VOID
+ParseCpuMap (
+  IN CONST VOID   *DeviceTreeBase
+  )
+{
+  INT32                     CpuMap;
+  INT32                     Socket;
+  INT32                     Cluster;
+  INT32                     Core;
+  INT32                     Thread;
+  FDT_HELPER_CPU_TOPOLOGY   Position;
+
+  CpuMap = fdt_path_offset (DeviceTreeBase, "/cpus/cpu-map");
+  if (CpuMap < 0) {
+    return;
+  }
+
+  mCpuMapFound = TRUE;
+
+  // QEMU always describes sockets, clusters and cores, and adds
+  // threads below the cores when there is more than one per core.
+  ZeroMem (&Position, sizeof (Position));
+  fdt_for_each_subnode (Socket, DeviceTreeBase, CpuMap) {
+    if (!GetCpuMapIndex (DeviceTreeBase, Socket, "socket", &Position.Socket)) {
+      continue;
+    }
+    fdt_for_each_subnode (Cluster, DeviceTreeBase, Socket) {
+      if (!GetCpuMapIndex (DeviceTreeBase, Cluster, "cluster", &Position.Cluster)) {
+        continue;
+      }
+      fdt_for_each_subnode (Core, DeviceTreeBase, Cluster) {
+        if (!GetCpuMapIndex (DeviceTreeBase, Core, "core", &Position.Core)) {
+          continue;
+        }
+        Position.Thread = 0;
+        if (SetCpuTopology (DeviceTreeBase, Core, &Position)) {
+          continue;
+        }
+        fdt_for_each_subnode (Thread, DeviceTreeBase, Core) {
+          if (GetCpuMapIndex (DeviceTreeBase, Thread, "thread", &Position.Thread) &&
+              SetCpuTopology (DeviceTreeBase, Thread, &Position)) {
+            mCpuHasThreads = TRUE;
+          }
+        }
+      }
+    }
+  }
+}
+
+/**
+  Walk /cpus once and build the per-CPU table used by all CPU helpers.
+
+  @retval TRUE                  The table is available.
+**/
+STATIC
+BOOLEAN
+BuildCpuTable (
+  VOID
+  )
+{
+  VOID          *DeviceTreeBase;
+  INT32         CpuNode;
+  INT32         Node;
+  UINT32        Count;
+  UINT32        CpuId;
+  CONST UINT64  *RegVal;
+  CONST CHAR8   *NodeStatus;
+  INT32         Len;
+
+  if (mCpuInfo != NULL) {
+    return TRUE;
+  }
+
+  DeviceTreeBase = (VOID *)(UINTN)PcdGet64 (PcdDeviceTreeBaseAddress);
+  ASSERT (DeviceTreeBase != NULL);
+
+  // Make sure we have a valid device tree blob
+  ASSERT (fdt_check_header (DeviceTreeBase) == 0);
+
+  CpuNode = fdt_path_offset (DeviceTreeBase, "/cpus");
+  if (CpuNode <= 0) {
+    DEBUG ((DEBUG_ERROR, "Unable to locate /cpus in device tree\n"));
+    return FALSE;
+  }
+
+  // Count the CPU subnodes first, so the table can be sized. /cpus may
+  // also contain the cpu-map describing the topology, which is skipped.
+  Count = 0;
+  fdt_for_each_subnode (Node, DeviceTreeBase, CpuNode) {
+    if (IsCpuNode (DeviceTreeBase, Node)) {
+      Count++;
+    }
+  }
+
+  if (Count == 0) {
+    return FALSE;
+  }
+
+  mCpuInfo = AllocateZeroPool (Count * sizeof (*mCpuInfo));
+  mCpuNodeOffsets = AllocatePool (Count * sizeof (*mCpuNodeOffsets));
+  if (mCpuInfo == NULL || mCpuNodeOffsets == NULL) {
+    if (mCpuInfo != NULL) {
+      FreePool (mCpuInfo);
+      mCpuInfo = NULL;
+    }
+    if (mCpuNodeOffsets != NULL) {
+      FreePool (mCpuNodeOffsets);
+      mCpuNodeOffsets = NULL;
+    }
+    return FALSE;
+  }
+
+  CpuId = 0;
+  fdt_for_each_subnode (Node, DeviceTreeBase, CpuNode) {
+    if (!IsCpuNode (DeviceTreeBase, Node)) {
+      continue;
+    }
+
+    mCpuNodeOffsets[CpuId] = Node;
+
+    RegVal = fdt_getprop (DeviceTreeBase, Node, "reg", &Len);
+    if (RegVal == NULL || Len != sizeof (UINT64)) {
+      DEBUG ((DEBUG_ERROR, "Couldn't find reg property for CPU:%d\n", CpuId));
+    } else {
+      mCpuInfo[CpuId].Mpidr = fdt64_to_cpu (ReadUnaligned64 (RegVal));
+    }
+
+    GetNumaNodeId (DeviceTreeBase, Node, &mCpuInfo[CpuId].NumaNodeId);
+
+    NodeStatus = fdt_getprop (DeviceTreeBase, Node, "status", &Len);
+    mCpuInfo[CpuId].Enabled = (NodeStatus == NULL ||
+                               AsciiStrnCmp (NodeStatus, "okay", Len) == 0);
+
+    // Until the cpu-map says otherwise, each CPU is a core of its own
+    mCpuInfo[CpuId].Topology.Core = CpuId;
+    CpuId++;
+  }
+
+  mCpuCount = Count;
+  ParseCpuMap (DeviceTreeBase);
+
+  return TRUE;
+}
+
+/**
+  Get the information gathered from the device tree for a given cpu.
+
+  @param [in]   CpuId    Index of cpu to retrieve the information for.
+
+  @retval                Information about CPU at index <CpuId>, or NULL
+                         if there is no such CPU.
+**/
+CONST FDT_HELPER_CPU_INFO *
+FdtHelperGetCpuInfo (
+  IN UINTN   CpuId
+  )
+{
+  if (!BuildCpuTable () || CpuId >= mCpuCount) {
+    return NULL;
+  }
+
+  return &mCpuInfo[CpuId];
+}
 
 /**
   Get MPIDR for a given cpu from device tree passed by Qemu.
@@ -29,23 +393,15 @@ FdtHelperGetMpidr (
   IN UINTN   CpuId
   )
 {
-  VOID           *DeviceTreeBase;
-  CONST UINT64   *RegVal;
-  INT32          Len;
+  CONST FDT_HELPER_CPU_INFO   *CpuInfo;
 
-  DeviceTreeBase = (VOID *)(UINTN)PcdGet64 (PcdDeviceTreeBaseAddress);
-  ASSERT (DeviceTreeBase != NULL);
-
-  RegVal = fdt_getprop (DeviceTreeBase,
-             mFdtFirstCpuOffset + (CpuId * mFdtCpuNodeSize),
-             "reg",
-             &Len);
-  if (!RegVal) {
-    DEBUG ((DEBUG_ERROR, "Couldn't find reg property for CPU:%d\n", CpuId));
+  CpuInfo = FdtHelperGetCpuInfo (CpuId);
+  if (CpuInfo == NULL) {
+    DEBUG ((DEBUG_ERROR, "Couldn't find CPU:%d\n", CpuId));
     return 0;
   }
 
-  return (fdt64_to_cpu (ReadUnaligned64 (RegVal)));
+  return CpuInfo->Mpidr;
 }
 
 /** Walks through the Device Tree created by Qemu and counts the number
@@ -59,40 +415,219 @@ FdtHelperCountCpus (
   VOID
   )
 {
-  VOID   *DeviceTreeBase;
-  INT32  Node;
-  INT32  Prev;
-  INT32  CpuNode;
-  UINT32 CpuCount;
+  if (!BuildCpuTable ()) {
+    return 0;
+  }
+
+  return mCpuCount;
+}
+
+/**
+  Get the NUMA node a given cpu belongs to.
+
+  @param [in]   CpuId    Index of cpu to retrieve the NUMA node for.
+
+  @retval                NUMA node of CPU at index <CpuId>, or 0 if the
+                         device tree has no NUMA information.
+**/
+UINT32
+FdtHelperGetCpuNumaNodeId (
+  IN UINTN   CpuId
+  )
+{
+  CONST FDT_HELPER_CPU_INFO   *CpuInfo;
+
+  CpuInfo = FdtHelperGetCpuInfo (CpuId);
+  if (CpuInfo == NULL) {
+    return 0;
+  }
+
+  return CpuInfo->NumaNodeId;
+}
+
+/**
+  Get the range and NUMA node of a memory node.
+
+  @param [in]   Index       Index of the memory node.
+  @param [out]  Base        Base address of the memory.
+  @param [out]  Size        Size of the memory.
+  @param [out]  NumaNodeId  NUMA node the memory belongs to.
+
+  @retval EFI_SUCCESS       The memory node was found.
+  @retval EFI_NOT_FOUND     There are fewer than Index + 1 memory nodes.
+**/
+EFI_STATUS
+FdtHelperGetMemoryNode (
+  IN  UINTN   Index,
+  OUT UINT64  *Base,
+  OUT UINT64  *Size,
+  OUT UINT32  *NumaNodeId
+  )
+{
+  VOID          *DeviceTreeBase;
+  CONST UINT64  *RegProp;
+  INT32         Node;
+  INT32         Len;
 
   DeviceTreeBase = (VOID *)(UINTN)PcdGet64 (PcdDeviceTreeBaseAddress);
   ASSERT (DeviceTreeBase != NULL);
 
-  // Make sure we have a valid device tree blob
-  ASSERT (fdt_check_header (DeviceTreeBase) == 0);
+  Node = FindMemoryNode (DeviceTreeBase, Index);
+  if (Node < 0) {
+    return EFI_NOT_FOUND;
+  }
 
-  CpuNode = fdt_path_offset (DeviceTreeBase, "/cpus");
-  if (CpuNode <= 0) {
-    DEBUG ((DEBUG_ERROR, "Unable to locate /cpus in device tree\n"));
-    return 0;
+  // Like SbsaQemuLib, assume two 8 byte quantities for base and size.
+  RegProp = fdt_getprop (DeviceTreeBase, Node, "reg", &Len);
+  if (RegProp == NULL || Len != (2 * sizeof (UINT64))) {
+    DEBUG ((DEBUG_ERROR, "Failed to parse memory node %d\n", Index));
+    *Base = 0;
+    *Size = 0;
+  } else {
+    *Base = fdt64_to_cpu (ReadUnaligned64 (RegProp));
+    *Size = fdt64_to_cpu (ReadUnaligned64 (RegProp + 1));
   }
 
-  CpuCount = 0;
+  GetNumaNodeId (DeviceTreeBase, Node, NumaNodeId);
+  return EFI_SUCCESS;
+}
+
+/** Get the number of NUMA nodes described by the device tree.
+
+    @return The highest numa-node-id used by a CPU or memory node plus one,
+            or 0 if the device tree has no NUMA information.
+**/
+UINT32
+FdtHelperCountNumaNodes (
+  VOID
+  )
+{
+  VOID    *DeviceTreeBase;
+  INT32   CpuNode;
+  INT32   Node;
+  UINT32  NumaNodeId;
+  UINT32  NumaNodeCount;
+  UINTN   Index;
 
-  // Walk through /cpus node and count the number of subnodes.
-  // The count of these subnodes corresponds to the number of
-  // CPUs created by Qemu.
-  Prev = fdt_first_subnode (DeviceTreeBase, CpuNode);
-  mFdtFirstCpuOffset = Prev;
-  while (1) {
-    CpuCount++;
-    Node = fdt_next_subnode (DeviceTreeBase, Prev);
+  DeviceTreeBase = (VOID *)(UINTN)PcdGet64 (PcdDeviceTreeBaseAddress);
+  ASSERT (DeviceTreeBase != NULL);
+
+  NumaNodeCount = 0;
+
+  CpuNode = fdt_path_offset (DeviceTreeBase, "/cpus");
+  if (CpuNode > 0) {
+    fdt_for_each_subnode (Node, DeviceTreeBase, CpuNode) {
+      if (IsCpuNode (DeviceTreeBase, Node) &&
+          GetNumaNodeId (DeviceTreeBase, Node, &NumaNodeId)) {
+        NumaNodeCount = MAX (NumaNodeCount, NumaNodeId + 1);
+      }
+    }
+  }
+
+  for (Index = 0; ; Index++) {
+    Node = FindMemoryNode (DeviceTreeBase, Index);
     if (Node < 0) {
       break;
     }
-    mFdtCpuNodeSize = Node - Prev;
-    Prev = Node;
+    if (GetNumaNodeId (DeviceTreeBase, Node, &NumaNodeId)) {
+      NumaNodeCount = MAX (NumaNodeCount, NumaNodeId + 1);
+    }
+  }
+
+  return NumaNodeCount;
+}
+
+/** Get the distances between NUMA nodes from /distance-map.
+
+    Nodes not covered by the distance matrix default to 10 (local)
+    and 20 (remote), as per the ACPI specification.
+
+    @param [out]  Distances     NodeCount x NodeCount matrix of distances.
+    @param [in]   NodeCount     Number of NUMA nodes.
+**/
+VOID
+FdtHelperGetNumaDistances (
+  OUT UINT8   *Distances,
+  IN  UINT32  NodeCount
+  )
+{
+  VOID          *DeviceTreeBase;
+  CONST UINT32  *Matrix;
+  INT32         Node;
+  INT32         Len;
+  UINT32        From;
+  UINT32        To;
+  UINT32        Distance;
+  UINTN         Index;
+
+  DeviceTreeBase = (VOID *)(UINTN)PcdGet64 (PcdDeviceTreeBaseAddress);
+  ASSERT (DeviceTreeBase != NULL);
+
+  for (From = 0; From < NodeCount; From++) {
+    for (To = 0; To < NodeCount; To++) {
+      Distances[From * NodeCount + To] = (From == To) ? 10 : 20;
+    }
+  }
+
+  Node = fdt_path_offset (DeviceTreeBase, "/distance-map");
+  if (Node < 0) {
+    return;
+  }
+
+  // The matrix is a list of <from to distance> triplets.
+  Matrix = fdt_getprop (DeviceTreeBase, Node, "distance-matrix", &Len);
+  if (Matrix == NULL) {
+    return;
+  }
+
+  for (Index = 0; Index + 3 <= Len / sizeof (UINT32); Index += 3) {
+    From     = fdt32_to_cpu (ReadUnaligned32 (&Matrix[Index]));
+    To       = fdt32_to_cpu (ReadUnaligned32 (&Matrix[Index + 1]));
+    Distance = fdt32_to_cpu (ReadUnaligned32 (&Matrix[Index + 2]));
+    if (From >= NodeCount || To >= NodeCount || Distance > MAX_UINT8) {
+      DEBUG ((DEBUG_ERROR, "Ignoring bad distance-map entry %d -> %d (%d)\n",
+        From, To, Distance));
+      continue;
+    }
+    Distances[From * NodeCount + To] = (UINT8)Distance;
+  }
+}
+
+/** Get the socket/cluster/core/thread position of every CPU from the
+    /cpus/cpu-map node.
+
+    CPUs not covered by the cpu-map are left as socket 0, cluster 0,
+    core <CpuId>, thread 0.
+
+    @param [out]  Topology      Array of CpuCount entries to fill in.
+    @param [in]   CpuCount      Number of CPUs, as returned by
+                                FdtHelperCountCpus ().
+    @param [out]  HasThreads    Set to TRUE if the cpu-map describes SMT
+                                threads.
+
+    @retval EFI_SUCCESS         The topology was read from the cpu-map.
+    @retval EFI_NOT_FOUND       There is no cpu-map; Topology describes a
+                                single cluster.
+**/
+EFI_STATUS
+FdtHelperGetCpuTopology (
+  OUT FDT_HELPER_CPU_TOPOLOGY   *Topology,
+  IN  UINT32                    CpuCount,
+  OUT BOOLEAN                   *HasThreads
+  )
+{
+  UINT32    CpuId;
+
+  *HasThreads = FALSE;
+  ZeroMem (Topology, CpuCount * sizeof (*Topology));
+  if (!BuildCpuTable ()) {
+    return EFI_NOT_FOUND;
+  }
+
+  for (CpuId = 0; CpuId < MIN (CpuCount, mCpuCount); CpuId++) {
+    CopyMem (&Topology[CpuId], &mCpuInfo[CpuId].Topology, sizeof (*Topology));
   }
 
-  return CpuCount;
+  *HasThreads = mCpuHasThreads;
+  return mCpuMapFound ? EFI_SUCCESS : EFI_NOT_FOUND;
 }